@@ -16,12 +16,17 @@
 #include "core/emf/propagators/fdtd4.h"
 #include "core/emf/propagators/fdtd_general.h"
 
+#ifdef FFTW
+#include "core/emf/propagators/psatd.h"
+#endif
+
 #include "core/emf/filters/filter.h"
 #include "core/emf/filters/binomial2.h"
 #include "core/emf/filters/compensator.h"
 #include "core/emf/filters/strided_binomial.h"
 #include "core/emf/filters/general_binomial.h"
 #include "core/emf/filters/sweeping_binomial.h"
+#include "core/emf/filters/multipass_binomial.h"
 
 
 #include "core/emf/boundaries/damping_tile.h"
@@ -63,6 +68,12 @@ auto declare_tile(
     .def("update_boundaries",   &emf::Tile<D>::update_boundaries,
             py::arg("grid"),
             py::arg("iarr")=iarr)
+    .def("set_halo_owners",     &emf::Tile<D>::set_halo_owners)
+    .def("set_current_depth",   &emf::Tile<D>::set_current_depth)
+    .def("unpack_halos",        &emf::Tile<D>::unpack_halos)
+    .def("copy_halos",          &emf::Tile<D>::copy_halos)
+    .def("shm_halo_words",      &emf::Tile<D>::shm_halo_words)
+    .def_readonly("packed_halos", &emf::Tile<D>::packed_halos)
     .def("get_grids",             &emf::Tile<D>::get_grids,
         py::arg("i")=0,
         py::return_value_policy::reference,
@@ -108,6 +119,7 @@ auto declare_TileDamped(
   .def_readwrite("fld1",     &emf::damping::Tile<D,S>::fld1)
   .def_readwrite("fld2",     &emf::damping::Tile<D,S>::fld2)
   .def_readwrite("ksupp",    &emf::damping::Tile<D,S>::ksupp)
+  .def_readwrite("fused_damping", &emf::damping::Tile<D,S>::fused_damping)
   .def("damp_fields",        &emf::damping::Tile<D,S>::damp_fields);
 }
 
@@ -376,13 +388,25 @@ void bind_emf(py::module& m_sub)
   // fdtd2 propagator
   py::class_<emf::FDTD2<1>, Propagator<1>, PyFDTD2<1>>(m_1d, "FDTD2")
     .def(py::init<>())
-    .def_readwrite("corr",     &emf::FDTD2<1>::corr);
+    .def_readwrite("corr",     &emf::FDTD2<1>::corr)
+    .def("push_half_b_e",      &emf::FDTD2<1>::push_half_b_e)
+    .def("push_e_damped",      &emf::FDTD2<1>::push_e_damped);
 
   // fdtd4 propagator
   py::class_<emf::FDTD4<1>, Propagator<1>, PyFDTD4<1> >(m_1d, "FDTD4")
     .def_readwrite("corr",     &emf::FDTD4<1>::corr)
+    .def("push_half_b_e",      &emf::FDTD4<1>::push_half_b_e)
+    .def("push_e_damped",      &emf::FDTD4<1>::push_e_damped)
     .def(py::init<>());
 
+#ifdef FFTW
+  // local pseudo-spectral propagator
+  py::class_<emf::PSATD<1>>(m_1d, "PSATD", emfpropag1d)
+    .def(py::init<>())
+    .def_readwrite("corr",     &emf::PSATD<1>::corr)
+    .def_readwrite("order",    &emf::PSATD<1>::order);
+#endif
+
   // fdtd2 propagator with perfectly matched ouer layer
   py::class_<emf::FDTD2_pml<1>> pml1d(m_1d, "FDTD2_pml", emfpropag1d);
   pml1d
@@ -413,6 +437,8 @@ void bind_emf(py::module& m_sub)
   // fdtd2 propagator
   py::class_<emf::FDTD2<2>>(m_2d, "FDTD2", emfpropag2d)
     .def_readwrite("corr",     &emf::FDTD2<2>::corr)
+    .def("push_half_b_e",      &emf::FDTD2<2>::push_half_b_e)
+    .def("push_e_damped",      &emf::FDTD2<2>::push_e_damped)
     .def(py::init<>());
     
   // fdtd2 propagator with perfectly matched ouer layer
@@ -437,8 +463,18 @@ void bind_emf(py::module& m_sub)
   // fdtd4 propagator
   py::class_<emf::FDTD4<2>, Propagator<2>, PyFDTD4<2> >(m_2d, "FDTD4")
     .def_readwrite("corr",     &emf::FDTD4<2>::corr)
+    .def("push_half_b_e",      &emf::FDTD4<2>::push_half_b_e)
+    .def("push_e_damped",      &emf::FDTD4<2>::push_e_damped)
     .def(py::init<>());
 
+#ifdef FFTW
+  // local pseudo-spectral propagator
+  py::class_<emf::PSATD<2>>(m_2d, "PSATD", emfpropag2d)
+    .def(py::init<>())
+    .def_readwrite("corr",     &emf::PSATD<2>::corr)
+    .def_readwrite("order",    &emf::PSATD<2>::order);
+#endif
+
 
   //--------------------------------------------------
   // 3D Propagator bindings
@@ -451,7 +487,9 @@ void bind_emf(py::module& m_sub)
   // fdtd2 propagator
   py::class_<emf::FDTD2<3>>(m_3d, "FDTD2", emfpropag3d)
     .def(py::init<>())
-    .def_readwrite("corr",     &emf::FDTD2<3>::corr);
+    .def_readwrite("corr",     &emf::FDTD2<3>::corr)
+    .def("push_half_b_e",      &emf::FDTD2<3>::push_half_b_e)
+    .def("push_e_damped",      &emf::FDTD2<3>::push_e_damped);
 
   // fdtd2 propagator with perfectly matched ouer layer
   py::class_<emf::FDTD2_pml<3>> pml3d(m_3d, "FDTD2_pml", emfpropag3d);
@@ -475,8 +513,18 @@ void bind_emf(py::module& m_sub)
   // fdtd4 propagator
   py::class_<emf::FDTD4<3>, Propagator<3>, PyFDTD4<3> >(m_3d, "FDTD4")
     .def_readwrite("corr",     &emf::FDTD4<3>::corr)
+    .def("push_half_b_e",      &emf::FDTD4<3>::push_half_b_e)
+    .def("push_e_damped",      &emf::FDTD4<3>::push_e_damped)
     .def(py::init<>());
 
+#ifdef FFTW
+  // local pseudo-spectral propagator
+  py::class_<emf::PSATD<3>>(m_3d, "PSATD", emfpropag3d)
+    .def(py::init<>())
+    .def_readwrite("corr",     &emf::PSATD<3>::corr)
+    .def_readwrite("order",    &emf::PSATD<3>::order);
+#endif
+
 
   // fdtd general propagator
   //py::class_<emf::FDTDGen<3>, Propagator<3>, PyFDTDGen<3> >(m_3d, "FDTDGen")
@@ -503,6 +551,13 @@ void bind_emf(py::module& m_sub)
   py::class_<emf::Binomial2<1>>(m_1d, "Binomial2", emffilter1d)
     .def(py::init<int, int, int>())
     .def("solve",      &emf::Binomial2<1>::solve);
+
+  // all passes with one halo exchange; compute for all local tiles, then solve
+  py::class_<emf::MultiPassBinomial2<1>>(m_1d, "MultiPassBinomial2", emffilter1d)
+    .def(py::init<int, int, int, int>(), py::arg("Nx"), py::arg("Ny"), py::arg("Nz"), py::arg("npasses"))
+    .def_readwrite("npasses",  &emf::MultiPassBinomial2<1>::npasses)
+    .def("compute",            &emf::MultiPassBinomial2<1>::compute)
+    .def("solve",              &emf::MultiPassBinomial2<1>::solve);
   
   // 2D Filter bindings
   py::class_< emf::Filter<2>, PyFilter<2> > emffilter2d(m_2d, "Filter");
@@ -517,6 +572,13 @@ void bind_emf(py::module& m_sub)
     .def(py::init<int, int, int>())
     .def("solve",      &emf::Binomial2<2>::solve);
 
+  // all passes with one halo exchange; compute for all local tiles, then solve
+  py::class_<emf::MultiPassBinomial2<2>>(m_2d, "MultiPassBinomial2", emffilter2d)
+    .def(py::init<int, int, int, int>(), py::arg("Nx"), py::arg("Ny"), py::arg("Nz"), py::arg("npasses"))
+    .def_readwrite("npasses",  &emf::MultiPassBinomial2<2>::npasses)
+    .def("compute",            &emf::MultiPassBinomial2<2>::compute)
+    .def("solve",              &emf::MultiPassBinomial2<2>::solve);
+
   py::class_<emf::General3p<2>>(m_2d, "General3p", emffilter2d)
     .def(py::init<int, int, int>())
     .def_readwrite("alpha",    &emf::General3p<2>::alpha)
@@ -550,6 +612,13 @@ void bind_emf(py::module& m_sub)
     .def(py::init<int, int, int>())
     .def("solve",      &emf::Binomial2<3>::solve);
 
+  // all passes with one halo exchange; compute for all local tiles, then solve
+  py::class_<emf::MultiPassBinomial2<3>>(m_3d, "MultiPassBinomial2", emffilter3d)
+    .def(py::init<int, int, int, int>(), py::arg("Nx"), py::arg("Ny"), py::arg("Nz"), py::arg("npasses"))
+    .def_readwrite("npasses",  &emf::MultiPassBinomial2<3>::npasses)
+    .def("compute",            &emf::MultiPassBinomial2<3>::compute)
+    .def("solve",              &emf::MultiPassBinomial2<3>::solve);
+
 
 
   //--------------------------------------------------
@@ -577,7 +646,8 @@ void bind_emf(py::module& m_sub)
     .def("insert_em",          &emf::Conductor<1>::insert_em)
     .def("update_b",           &emf::Conductor<1>::update_b)
     .def("update_j",           &emf::Conductor<1>::update_j)
-    .def("update_e",           &emf::Conductor<1>::update_e);
+    .def("update_e",           &emf::Conductor<1>::update_e)
+    .def("clear_cache",        &emf::Conductor<1>::clear_cache);
 
     
   // 2D rotating conductor
@@ -602,7 +672,8 @@ void bind_emf(py::module& m_sub)
     .def("insert_em",          &emf::Conductor<2>::insert_em)
     .def("update_b",           &emf::Conductor<2>::update_b)
     .def("update_j",           &emf::Conductor<2>::update_j)
-    .def("update_e",           &emf::Conductor<2>::update_e);
+    .def("update_e",           &emf::Conductor<2>::update_e)
+    .def("clear_cache",        &emf::Conductor<2>::clear_cache);
 
 
   // 3D rotating conductor
@@ -627,7 +698,8 @@ void bind_emf(py::module& m_sub)
     .def("insert_em",          &emf::Conductor<3>::insert_em)
     .def("update_e",           &emf::Conductor<3>::update_e)
     .def("update_j",           &emf::Conductor<3>::update_j)
-    .def("update_b",           &emf::Conductor<3>::update_b);
+    .def("update_b",           &emf::Conductor<3>::update_b)
+    .def("clear_cache",        &emf::Conductor<3>::clear_cache);
 
 
   //--------------------------------------------------
@@ -635,7 +707,10 @@ void bind_emf(py::module& m_sub)
   
   // 1D 
   py::class_<h5io::FieldsWriter<1>>(m_1d, "FieldsWriter")
+    .def_readwrite("async_io", &h5io::FieldsWriter<1>::async)
     .def(py::init<const std::string&, int, int, int, int, int, int, int>())
+    .def(py::init<const std::string&, int, int, int, int, int, int, int, bool>())
+    .def_readonly("parallel", &h5io::FieldsWriter<1>::parallel)
     .def("write",   &h5io::FieldsWriter<1>::write) 
     .def("get_slice", [](h5io::FieldsWriter<1> &s, int k)
             {
@@ -647,7 +722,10 @@ void bind_emf(py::module& m_sub)
 
   // 2D 
   py::class_<h5io::FieldsWriter<2>>(m_2d, "FieldsWriter")
+    .def_readwrite("async_io", &h5io::FieldsWriter<2>::async)
     .def(py::init<const std::string&, int, int, int, int, int, int, int>())
+    .def(py::init<const std::string&, int, int, int, int, int, int, int, bool>())
+    .def_readonly("parallel", &h5io::FieldsWriter<2>::parallel)
     .def("write",   &h5io::FieldsWriter<2>::write) 
     .def("get_slice", [](h5io::FieldsWriter<2> &s, int k)
             {
@@ -660,16 +738,33 @@ void bind_emf(py::module& m_sub)
 
   // 3D 
   py::class_<h5io::FieldsWriter<3>>(m_3d, "FieldsWriter")
+    .def_readwrite("async_io", &h5io::FieldsWriter<3>::async)
     .def(py::init<const std::string&, int, int, int, int, int, int, int>())
+    .def(py::init<const std::string&, int, int, int, int, int, int, int, bool>())
+    .def_readonly("parallel", &h5io::FieldsWriter<3>::parallel)
     .def("write",   &h5io::FieldsWriter<3>::write);
 
+  // shared file output with MPI-IO needs HDF5 built with --enable-parallel
+  m_sub.def("has_parallel_hdf5", &h5io::has_parallel_hdf5);
+
+  // background io thread used by writers with async_io = True
+  m_sub.def("wait_io", &h5io::wait_io, py::call_guard<py::gil_scoped_release>());
+  m_sub.def("io_stats", []()
+            {
+                auto s = h5io::IOThread::get().pop_stats();
+                return py::make_tuple(s.busy, s.waited, s.jobs);
+            },
+            "(busy, waited, jobs) of the io thread since the last call");
+
   // 3D; root only field storage
   py::class_<h5io::MasterFieldsWriter<3>>(m_3d, "MasterFieldsWriter")
+    .def_readwrite("async_io", &h5io::MasterFieldsWriter<3>::async)
     .def(py::init<const std::string&, int, int, int, int, int, int, int>())
     .def("write",   &h5io::MasterFieldsWriter<3>::write);
 
   // slice writer; only in 3D
   py::class_<h5io::FieldSliceWriter>(m_3d, "FieldSliceWriter")
+    .def_readwrite("async_io", &h5io::FieldSliceWriter::async)
     .def_readwrite("ind",  &h5io::FieldSliceWriter::ind)
     .def(py::init<const std::string&, int, int, int, int, int, int, int, int, int>())
     .def("write",        &h5io::FieldSliceWriter::write)
@@ -687,16 +782,19 @@ void bind_emf(py::module& m_sub)
 
   // 1D
   m_1d.def("read_grids",        &emf::read_grids<1>);
-  m_1d.def("write_grids",       &emf::write_grids<1>);
+  m_1d.def("write_grids",       &emf::write_grids<1>,
+      py::arg("grid"), py::arg("lap"), py::arg("dir"), py::arg("async_io")=false);
 
 
   // 2D
-  m_2d.def("write_grids",        &emf::write_grids<2>);
+  m_2d.def("write_grids",        &emf::write_grids<2>,
+      py::arg("grid"), py::arg("lap"), py::arg("dir"), py::arg("async_io")=false);
   m_2d.def("read_grids",         &emf::read_grids<2>);
 
 
   // 3D
-  m_3d.def("write_grids",        &emf::write_grids<3>);
+  m_3d.def("write_grids",        &emf::write_grids<3>,
+      py::arg("grid"), py::arg("lap"), py::arg("dir"), py::arg("async_io")=false);
   m_3d.def("read_grids",         &emf::read_grids<3>);
 
 
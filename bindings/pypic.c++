@@ -34,6 +34,12 @@ namespace py = pybind11;
 #include "core/pic/depositers/esikerpov_2nd.h"
 #include "core/pic/depositers/esikerpov_4th.h"
 
+#include "core/pic/fused.h"
+#include "core/pic/scheduler.h"
+#include "core/pic/injector.h"
+#include "core/pic/balance.h"
+#include "core/pic/samplers.h"
+
 #include "core/pic/communicate.h"
 
 #include "core/pic/boundaries/wall.h"
@@ -56,6 +62,36 @@ namespace py = pybind11;
 namespace pic {
 
 
+//--------------------------------------------------
+// numpy arrays from/to particle containers
+
+/// contiguous numpy input; other dtypes and layouts are converted
+template<typename T>
+using pyarr_in = py::array_t<T, py::array::c_style | py::array::forcecast>;
+
+/// numpy view of n values at ptr owned by container s; keeps s alive.
+// NOTE: the view is invalidated by anything that changes the particle number of s
+template<typename T, size_t D>
+py::array_t<T> prtcl_view(pic::ParticleContainer<D>& s, T* ptr, size_t n, bool writable)
+{
+  if(n == 0) return py::array_t<T>(0);
+
+  auto base = py::cast(&s, py::return_value_policy::reference); // existing python object of s
+  py::array_t<T> arr({n}, {sizeof(T)}, ptr, base);
+  if(!writable) arr.attr("setflags")(py::arg("write")=false);
+
+  return arr;
+}
+
+/// copy a numpy array over n values at ptr
+template<typename T>
+void prtcl_set(T* ptr, size_t n, const pyarr_in<T>& a)
+{
+  if(static_cast<size_t>(a.size()) != n) throw py::value_error("array length does not match the number of particles");
+  std::copy(a.data(), a.data() + n, ptr);
+}
+
+
 //--------------------------------------------------
 template<size_t D>
 auto declare_tile(
@@ -74,6 +110,8 @@ auto declare_tile(
                )
     .def(py::init<int, int, int>())
     .def_readwrite("cfl",       &pic::Tile<D>::cfl)
+    .def_readwrite("compact_particle_messages", &pic::Tile<D>::compact_particle_messages)
+    .def_readwrite("check_particle_messages",   &pic::Tile<D>::check_particle_messages)
     .def("get_container",       &pic::Tile<D>::get_container, 
         py::return_value_policy::reference, py::keep_alive<1,0>())
     .def("set_container",       &pic::Tile<D>::set_container)
@@ -85,7 +123,10 @@ auto declare_tile(
     .def("pack_all_particles",           &pic::Tile<D>::pack_all_particles)
     .def("unpack_incoming_particles",    &pic::Tile<D>::unpack_incoming_particles)
     .def("delete_all_particles",         &pic::Tile<D>::delete_all_particles)
-    .def("shrink_to_fit_all_particles",  &pic::Tile<D>::shrink_to_fit_all_particles);
+    .def("shrink_to_fit_all_particles",  &pic::Tile<D>::shrink_to_fit_all_particles)
+    .def("sort_particles_in_cells",      &pic::Tile<D>::sort_particles_in_cells, py::arg("full")=true,
+        "sort particles of each container into cell order; full=False only moves particles outside of their cell range. "
+        "Interpolated fields (Epart/Bpart) are not permuted.");
 }
 
 template<size_t D>
@@ -109,7 +150,75 @@ auto declare_prtcl_container(
         {
           s.add_particle({xx,yy,zz}, {vx,vy,vz}, wgt);
         })
+    .def("append_particles", [](pic::ParticleContainer<D>& s,
+          pyarr_in<float> x,  pyarr_in<float> y,  pyarr_in<float> z,
+          pyarr_in<float> ux, pyarr_in<float> uy, pyarr_in<float> uz,
+          pyarr_in<float> w)
+        {
+          const size_t n = x.size();
+          for(auto* a : {&y, &z, &ux, &uy, &uz, &w}) 
+            if(static_cast<size_t>(a->size()) != n) throw py::value_error("append_particles: arrays must have equal lengths");
+
+          s.append_particles(n, x.data(), y.data(), z.data(), ux.data(), uy.data(), uz.data(), w.data());
+        }, py::arg("x"), py::arg("y"), py::arg("z"), py::arg("ux"), py::arg("uy"), py::arg("uz"), py::arg("w"))
+    //--------------------------------------------------
+    // numpy views of the particle arrays without a copy; read-only unless writable=True.
+    // Location views are always read-only: a write would leave cells_sorted set
+    // after particles left their cell, so locations are changed with set_loc.
+    .def("loc_view", [](pic::ParticleContainer<D>& s, size_t idim)
+        {
+          if(idim >= 3) throw py::index_error();
+          return prtcl_view(s, s.size() ? &s.loc(idim, 0) : nullptr, s.size(), false);
+        }, py::arg("idim"),
+        "read-only view of the locations; use set_loc to change them")
+    .def("vel_view", [](pic::ParticleContainer<D>& s, size_t idim, bool writable)
+        {
+          if(idim >= 3) throw py::index_error();
+          return prtcl_view(s, s.size() ? &s.vel(idim, 0) : nullptr, s.size(), writable);
+        }, py::arg("idim"), py::arg("writable")=false)
+    .def("wgt_view", [](pic::ParticleContainer<D>& s, bool writable)
+        {
+          return prtcl_view(s, s.size() ? &s.wgt(0) : nullptr, s.size(), writable);
+        }, py::arg("writable")=false)
+    .def("id_view", [](pic::ParticleContainer<D>& s, size_t idim, bool writable)
+        {
+          if(idim >= 2) throw py::index_error();
+          return prtcl_view(s, s.size() ? &s.id(idim, 0) : nullptr, s.size(), writable);
+        }, py::arg("idim"), py::arg("writable")=false)
+    .def("info_view", [](pic::ParticleContainer<D>& s)
+        {
+          return prtcl_view(s, s.size() ? &s.info(0) : nullptr, s.size(), false);
+        })
+
+    // bulk setters of existing particles from numpy arrays
+    .def("set_loc", [](pic::ParticleContainer<D>& s, size_t idim, pyarr_in<float> a)
+        {
+          if(idim >= 3) throw py::index_error();
+          prtcl_set(s.size() ? &s.loc(idim, 0) : nullptr, s.size(), a);
+          s.cells_sorted = false;
+        })
+    .def("set_vel", [](pic::ParticleContainer<D>& s, size_t idim, pyarr_in<float> a)
+        {
+          if(idim >= 3) throw py::index_error();
+          prtcl_set(s.size() ? &s.vel(idim, 0) : nullptr, s.size(), a);
+        })
+    .def("set_wgt", [](pic::ParticleContainer<D>& s, pyarr_in<float> a)
+        {
+          prtcl_set(s.size() ? &s.wgt(0) : nullptr, s.size(), a);
+        })
+
     .def("set_keygen_state", &pic::ParticleContainer<D>::set_keygen_state)
+    .def("sort_in_cells",    &pic::ParticleContainer<D>::sort_in_cells, py::arg("lens"), py::arg("full")=true,
+        "sort particles into cell order of a tile with mesh lengths lens; full=False only moves particles outside of their cell range. "
+        "Interpolated fields (Epart/Bpart) are not permuted.")
+    .def_readonly("cells_sorted", &pic::ParticleContainer<D>::cells_sorted)
+    .def("enable_tracking",  &pic::ParticleContainer<D>::enable_tracking, py::arg("stride"), py::arg("cutoff"))
+    .def_readonly("track_stride", &pic::ParticleContainer<D>::track_stride)
+    .def_readonly("track_cutoff", &pic::ParticleContainer<D>::track_cutoff)
+    .def("tracked", [](pic::ParticleContainer<D>& s) 
+        {
+          return std::vector<int>(s.tracked.begin(), s.tracked.end()); 
+        })
     .def("loc",          [](pic::ParticleContainer<D>& s, size_t idim) 
         {
           return s.loc(idim); 
@@ -202,6 +311,8 @@ auto declare_prtcl_container(
         if (ip >= nparts) throw py::index_error();
         if ( v >= 12)     throw py::index_error();
 
+        if(v < 3) s.cells_sorted = false; // location changed; cell order no longer valid
+
         if(v == 0) s.loc(0, ip) = val;
         if(v == 1) s.loc(1, ip) = val;
         if(v == 2) s.loc(2, ip) = val;
@@ -317,6 +428,125 @@ class PyDepositer : public Depositer3V<D>
 };
 
 
+//--------------------------------------------------
+// fused interpolate-push-deposit kernels
+
+template<size_t D, class Push>
+using FusedLinearZigZag = pic::FusedKernel<D,3, pic::LinearInterpolator<D,3>, Push, pic::ZigZag<D,3>>;
+
+template<size_t D, class Push>
+void declare_fused(
+    py::module& m,
+    const std::string& pyclass_name) 
+{
+  using F = FusedLinearZigZag<D,Push>;
+
+  py::class_<F>(m, pyclass_name.c_str())
+    .def(py::init<>())
+    .def("solve", &F::solve)
+    .def_readwrite("private_currents", &F::private_currents)
+    .def_readwrite("bx_ext",  &F::bx_ext)
+    .def_readwrite("by_ext",  &F::by_ext)
+    .def_readwrite("bz_ext",  &F::bz_ext)
+    .def_readwrite("ex_ext",  &F::ex_ext)
+    .def_readwrite("ey_ext",  &F::ey_ext)
+    .def_readwrite("ez_ext",  &F::ez_ext)
+    .def_readwrite("dipole_B0",    &F::dipole_B0)
+    .def_readwrite("dipole_chi",   &F::dipole_chi)
+    .def_readwrite("dipole_phase", &F::dipole_phase)
+    .def_readwrite("dipole_cenx",  &F::dipole_cenx)
+    .def_readwrite("dipole_ceny",  &F::dipole_ceny)
+    .def_readwrite("dipole_cenz",  &F::dipole_cenz)
+    .def("set_ext_table", &F::set_ext_table, 
+        py::arg("axis"), py::arg("x0"), py::arg("dx"), py::arg("values"));
+}
+
+
+//--------------------------------------------------
+// C++ lap scheduler
+
+// fused kernels are depositers whose solve does the whole particle update
+template<size_t D, class F>
+void def_scheduler_fused(py::class_<pic::TaskScheduler<D>>& c)
+{
+  using TS = pic::TaskScheduler<D>;
+
+  c.def("add_solver", [](TS& s, const std::string& name, F& solver, const std::string& nhood) {
+        s.add_solver(name, static_cast<pic::Depositer<D,3>&>(solver), nhood); },
+      py::arg("name"), py::arg("solver"), py::arg("nhood")="local", py::keep_alive<1,3>());
+}
+
+template<size_t D>
+void declare_scheduler(
+    py::module& m,
+    const std::string& pyclass_name) 
+{
+  using TS = pic::TaskScheduler<D>;
+
+  py::class_<TS> c(m, pyclass_name.c_str());
+  c.def(py::init<corgi::Grid<D>&>(), py::keep_alive<1,2>())
+    .def_readwrite("threads",      &TS::threads)
+    .def_readwrite("overlap",      &TS::overlap)
+    .def_readwrite("shm_exchange", &TS::shm_exchange)
+    .def_readwrite("timings",      &TS::timings)
+    .def("clear",       &TS::clear)
+    .def("add_mpi",     &TS::add_mpi, py::arg("name"), py::arg("method"))
+    .def("add_tile_op", &TS::add_tile_op, 
+        py::arg("name"), py::arg("method"), py::arg("nhood")="all", py::arg("args")=std::vector<int>{})
+    .def("add_solver", py::overload_cast<const std::string&, pic::Pusher<D,3>&, const std::string&, int>(&TS::add_solver),
+        py::arg("name"), py::arg("solver"), py::arg("nhood")="local", py::arg("ispc")=-1, py::keep_alive<1,3>())
+    .def("add_solver", py::overload_cast<const std::string&, pic::Interpolator<D,3>&, const std::string&>(&TS::add_solver),
+        py::arg("name"), py::arg("solver"), py::arg("nhood")="local", py::keep_alive<1,3>())
+    .def("add_solver", py::overload_cast<const std::string&, pic::Depositer<D,3>&, const std::string&>(&TS::add_solver),
+        py::arg("name"), py::arg("solver"), py::arg("nhood")="local", py::keep_alive<1,3>())
+    .def("add_solver", py::overload_cast<const std::string&, emf::Filter<D>&, const std::string&>(&TS::add_solver),
+        py::arg("name"), py::arg("solver"), py::arg("nhood")="local", py::keep_alive<1,3>())
+    .def("add_solver", py::overload_cast<const std::string&, emf::Propagator<D>&, const std::string&, const std::string&>(&TS::add_solver),
+        py::arg("name"), py::arg("solver"), py::arg("method"), py::arg("nhood")="local", py::keep_alive<1,3>())
+    .def("add_solver", py::overload_cast<const std::string&, emf::MultiPassBinomial2<D>&, const std::string&, const std::string&>(&TS::add_solver),
+        py::arg("name"), py::arg("solver"), py::arg("method"), py::arg("nhood")="local", py::keep_alive<1,3>())
+    // python solvers and methods; called with the GIL, tile after tile
+    .def("add_op", [](TS& s, const std::string& name, py::object solver, const std::string& method, 
+                      const std::string& nhood, py::list args) {
+          py::object f = solver.attr(method.c_str());
+          py::tuple extra(args);
+          s.add_op(name, [f, extra](corgi::Tile<D>& tile) {
+              py::gil_scoped_acquire gil;
+              f(py::cast(&tile, py::return_value_policy::reference), *extra);
+              }, nhood, false);
+        }, 
+        py::arg("name"), py::arg("solver"), py::arg("method"), py::arg("nhood")="local", py::arg("args")=py::list())
+    .def("run", &TS::run, py::call_guard<py::gil_scoped_release>());
+
+  def_scheduler_fused<D, FusedLinearZigZag<D, pic::BorisPusher<D,3>>>(c);
+  def_scheduler_fused<D, FusedLinearZigZag<D, pic::VayPusher<D,3>>>(c);
+  def_scheduler_fused<D, FusedLinearZigZag<D, pic::HigueraCaryPusher<D,3>>>(c);
+}
+
+
+//--------------------------------------------------
+// C++ plasma injector
+
+template<size_t D>
+void declare_injector(
+    py::module& m,
+    const std::string& pyclass_name) 
+{
+  using BI = pic::BulkInjector<D>;
+
+  py::class_<BI>(m, pyclass_name.c_str())
+    .def(py::init<uint32_t>(), py::arg("seed")=0)
+    .def_readwrite("seed", &BI::seed)
+    .def("add_species", &BI::add_species,
+        py::arg("ispc"), py::arg("ppc"), py::arg("theta"),
+        py::arg("gamma")=0.0, py::arg("direction")=1, py::arg("dims")=3,
+        py::arg("weight")=1.0f, py::arg("aligned")=true)
+    // density(x, y, z, ispc) of a python function; called from the main thread only
+    .def("set_density", [](BI& s, py::function f) {
+          s.density = [f](double x, double y, double z, int ispc) { return f(x, y, z, ispc).template cast<double>(); };
+        })
+    .def("inject", &BI::inject);
+}
 
 
 //--------------------------------------------------
@@ -358,6 +588,15 @@ void bind_pic(py::module& m_sub)
     .def_readwrite("ex_ext",  &pic::Pusher<1,3>::ex_ext)
     .def_readwrite("ey_ext",  &pic::Pusher<1,3>::ey_ext)
     .def_readwrite("ez_ext",  &pic::Pusher<1,3>::ez_ext)
+    .def_readwrite("use_simd",     &pic::Pusher<1,3>::use_simd)
+    .def_readwrite("dipole_B0",    &pic::Pusher<1,3>::dipole_B0)
+    .def_readwrite("dipole_chi",   &pic::Pusher<1,3>::dipole_chi)
+    .def_readwrite("dipole_phase", &pic::Pusher<1,3>::dipole_phase)
+    .def_readwrite("dipole_cenx",  &pic::Pusher<1,3>::dipole_cenx)
+    .def_readwrite("dipole_ceny",  &pic::Pusher<1,3>::dipole_ceny)
+    .def_readwrite("dipole_cenz",  &pic::Pusher<1,3>::dipole_cenz)
+    .def("set_ext_table", &pic::Pusher<1,3>::set_ext_table, 
+        py::arg("axis"), py::arg("x0"), py::arg("dx"), py::arg("values"))
     //.def("solve", &pic::Pusher<1,3>::solve);
     //.def("solve", py::overload_cast<pic::Tile<1>&>(     &pic::Pusher<1,3>::solve))
     //.def("solve", py::overload_cast<pic::Tile<1>&, int>(&pic::Pusher<1,3>::solve));
@@ -389,6 +628,15 @@ void bind_pic(py::module& m_sub)
     .def_readwrite("ex_ext",  &pic::Pusher<2,3>::ex_ext)
     .def_readwrite("ey_ext",  &pic::Pusher<2,3>::ey_ext)
     .def_readwrite("ez_ext",  &pic::Pusher<2,3>::ez_ext)
+    .def_readwrite("use_simd",     &pic::Pusher<2,3>::use_simd)
+    .def_readwrite("dipole_B0",    &pic::Pusher<2,3>::dipole_B0)
+    .def_readwrite("dipole_chi",   &pic::Pusher<2,3>::dipole_chi)
+    .def_readwrite("dipole_phase", &pic::Pusher<2,3>::dipole_phase)
+    .def_readwrite("dipole_cenx",  &pic::Pusher<2,3>::dipole_cenx)
+    .def_readwrite("dipole_ceny",  &pic::Pusher<2,3>::dipole_ceny)
+    .def_readwrite("dipole_cenz",  &pic::Pusher<2,3>::dipole_cenz)
+    .def("set_ext_table", &pic::Pusher<2,3>::set_ext_table, 
+        py::arg("axis"), py::arg("x0"), py::arg("dx"), py::arg("values"))
     // NOTE: intel compiler has trouble with new overload_cast since its c++14 feature; hence we use the old & nasty c cast
     //.def("solve", py::overload_cast<pic::Tile<2>&>(     &pic::Pusher<2,3>::solve))
     //.def("solve", py::overload_cast<pic::Tile<2>&, int>(&pic::Pusher<2,3>::solve));
@@ -462,6 +710,15 @@ void bind_pic(py::module& m_sub)
     .def_readwrite("ex_ext",  &pic::Pusher<3,3>::ex_ext)
     .def_readwrite("ey_ext",  &pic::Pusher<3,3>::ey_ext)
     .def_readwrite("ez_ext",  &pic::Pusher<3,3>::ez_ext)
+    .def_readwrite("use_simd",     &pic::Pusher<3,3>::use_simd)
+    .def_readwrite("dipole_B0",    &pic::Pusher<3,3>::dipole_B0)
+    .def_readwrite("dipole_chi",   &pic::Pusher<3,3>::dipole_chi)
+    .def_readwrite("dipole_phase", &pic::Pusher<3,3>::dipole_phase)
+    .def_readwrite("dipole_cenx",  &pic::Pusher<3,3>::dipole_cenx)
+    .def_readwrite("dipole_ceny",  &pic::Pusher<3,3>::dipole_ceny)
+    .def_readwrite("dipole_cenz",  &pic::Pusher<3,3>::dipole_cenz)
+    .def("set_ext_table", &pic::Pusher<3,3>::set_ext_table, 
+        py::arg("axis"), py::arg("x0"), py::arg("dx"), py::arg("values"))
     //.def("solve", &pic::Pusher<3,3>::solve);
     //.def("solve", py::overload_cast<pic::Tile<3>&>(     &pic::Pusher<3,3>::solve))
     //.def("solve", py::overload_cast<pic::Tile<3>&, int>(&pic::Pusher<3,3>::solve));
@@ -589,7 +846,8 @@ void bind_pic(py::module& m_sub)
   py::class_< pic::Depositer<1,3>, PyDepositer<1> > picdeposit1d(m_1d, "Depositer");
   picdeposit1d
     .def(py::init<>())
-    .def("solve", &pic::Depositer<1,3>::solve);
+    .def("solve", &pic::Depositer<1,3>::solve)
+    .def_readwrite("private_currents", &pic::Depositer<1,3>::private_currents);
 
   // zigzag depositer
   py::class_<pic::ZigZag<1,3>>(m_1d, "ZigZag", picdeposit1d)
@@ -604,7 +862,8 @@ void bind_pic(py::module& m_sub)
   py::class_< pic::Depositer<2,3>, PyDepositer<2> > picdeposit2d(m_2d, "Depositer");
   picdeposit2d
     .def(py::init<>())
-    .def("solve", &pic::Depositer<2,3>::solve);
+    .def("solve", &pic::Depositer<2,3>::solve)
+    .def_readwrite("private_currents", &pic::Depositer<2,3>::private_currents);
 
   // zigzag depositer
   py::class_<pic::ZigZag<2,3>>(m_2d, "ZigZag", picdeposit2d)
@@ -625,7 +884,8 @@ void bind_pic(py::module& m_sub)
   py::class_< pic::Depositer<3,3>, PyDepositer<3> > picdeposit3d(m_3d, "Depositer");
   picdeposit3d
     .def(py::init<>())
-    .def("solve", &pic::Depositer<3,3>::solve);
+    .def("solve", &pic::Depositer<3,3>::solve)
+    .def_readwrite("private_currents", &pic::Depositer<3,3>::private_currents);
 
   // zigzag depositer
   py::class_<pic::ZigZag<3,3>>(m_3d, "ZigZag", picdeposit3d)
@@ -648,6 +908,50 @@ void bind_pic(py::module& m_sub)
 
   //--------------------------------------------------
 
+  //--------------------------------------------------
+  // fused linear interpolator + pusher + zigzag depositer
+  declare_fused<1, pic::BorisPusher<1,3>>      (m_1d, "FusedBorisZigZag");
+  declare_fused<1, pic::VayPusher<1,3>>        (m_1d, "FusedVayZigZag");
+  declare_fused<1, pic::HigueraCaryPusher<1,3>>(m_1d, "FusedHigueraCaryZigZag");
+
+  declare_fused<2, pic::BorisPusher<2,3>>      (m_2d, "FusedBorisZigZag");
+  declare_fused<2, pic::VayPusher<2,3>>        (m_2d, "FusedVayZigZag");
+  declare_fused<2, pic::HigueraCaryPusher<2,3>>(m_2d, "FusedHigueraCaryZigZag");
+
+  declare_fused<3, pic::BorisPusher<3,3>>      (m_3d, "FusedBorisZigZag");
+  declare_fused<3, pic::VayPusher<3,3>>        (m_3d, "FusedVayZigZag");
+  declare_fused<3, pic::HigueraCaryPusher<3,3>>(m_3d, "FusedHigueraCaryZigZag");
+
+  //--------------------------------------------------
+  // hybrid mpi + openmp lap scheduler
+  declare_scheduler<1>(m_1d, "TaskScheduler");
+  declare_scheduler<2>(m_2d, "TaskScheduler");
+  declare_scheduler<3>(m_3d, "TaskScheduler");
+
+  //--------------------------------------------------
+  // bulk plasma injector
+  declare_injector<1>(m_1d, "BulkInjector");
+  declare_injector<2>(m_2d, "BulkInjector");
+  declare_injector<3>(m_3d, "BulkInjector");
+
+  // raw Philox4x32-10 block; for testing against the known-answer vectors
+  m_sub.def("philox4x32", [](std::array<uint32_t,4> ctr, std::array<uint32_t,2> key)
+      {
+        return toolbox::Philox::generate(ctr, key);
+      }, py::arg("ctr"), py::arg("key"));
+
+  // four-velocities of the injector for given (seed, stream); for testing the distributions
+  m_sub.def("sample_boosted_juttner", [](size_t n, double theta, double gamma, int direction, int dims, uint32_t seed)
+      {
+        py::array_t<float> ux(n), uy(n), uz(n);
+        auto rng = [seed](uint32_t i, uint32_t draw) { return toolbox::Philox::generate({{i, 0, 0, draw}}, {{seed, 0}}); };
+        pic::sampling::sample_boosted_juttner(n, rng, theta, gamma, direction, dims, 
+            ux.mutable_data(), uy.mutable_data(), uz.mutable_data());
+        return py::make_tuple(ux, uy, uz);
+      }, py::arg("n"), py::arg("theta"), py::arg("gamma")=0.0, py::arg("direction")=1, py::arg("dims")=3, py::arg("seed")=0);
+
+  //--------------------------------------------------
+
   //1 D piston
   py::class_<pic::Piston<1>>(m_1d, "Piston")
     .def(py::init<>())
@@ -704,19 +1008,34 @@ void bind_pic(py::module& m_sub)
 
   // 1D test particles
   py::class_<h5io::TestPrtclWriter<1>>(m_1d, "TestPrtclWriter")
+    .def_readwrite("async_io", &h5io::TestPrtclWriter<1>::async)
     .def(py::init<const std::string&, int, int, int, int, int, int, int, int, int>())
+    .def(py::init<const std::string&, int, int, int, int, int, int, int, int, int, int>())
+    .def_readonly("nt",     &h5io::TestPrtclWriter<1>::nt)
+    .def_readonly("nrec",   &h5io::TestPrtclWriter<1>::nrec)
+    .def("record",  &h5io::TestPrtclWriter<1>::record)
     .def("write",   &h5io::TestPrtclWriter<1>::write)
     .def_readwrite("ispc", &h5io::TestPrtclWriter<1>::ispc);
   
   // 2D test particles
   py::class_<h5io::TestPrtclWriter<2>>(m_2d, "TestPrtclWriter")
+    .def_readwrite("async_io", &h5io::TestPrtclWriter<2>::async)
     .def(py::init<const std::string&, int, int, int, int, int, int, int, int, int>())
+    .def(py::init<const std::string&, int, int, int, int, int, int, int, int, int, int>())
+    .def_readonly("nt",     &h5io::TestPrtclWriter<2>::nt)
+    .def_readonly("nrec",   &h5io::TestPrtclWriter<2>::nrec)
+    .def("record",  &h5io::TestPrtclWriter<2>::record)
     .def("write",   &h5io::TestPrtclWriter<2>::write)
     .def_readwrite("ispc", &h5io::TestPrtclWriter<2>::ispc);
 
   // 3D test particles
   py::class_<h5io::TestPrtclWriter<3>>(m_3d, "TestPrtclWriter")
+    .def_readwrite("async_io", &h5io::TestPrtclWriter<3>::async)
     .def(py::init<const std::string&, int, int, int, int, int, int, int, int, int>())
+    .def(py::init<const std::string&, int, int, int, int, int, int, int, int, int, int>())
+    .def_readonly("nt",     &h5io::TestPrtclWriter<3>::nt)
+    .def_readonly("nrec",   &h5io::TestPrtclWriter<3>::nrec)
+    .def("record",  &h5io::TestPrtclWriter<3>::record)
     .def("write",   &h5io::TestPrtclWriter<3>::write)
     .def_readwrite("ispc", &h5io::TestPrtclWriter<3>::ispc);
 
@@ -725,12 +1044,26 @@ void bind_pic(py::module& m_sub)
 
   // 1D
   py::class_<h5io::PicMomentsWriter<1>>(m_1d, "PicMomentsWriter")
+    .def_readwrite("async_io", &h5io::PicMomentsWriter<1>::async)
     .def(py::init<const std::string&, int, int, int, int, int, int, int>())
+    .def(py::init<const std::string&, int, int, int, int, int, int, int, bool>())
+    .def_readonly("parallel", &h5io::PicMomentsWriter<1>::parallel)
+    .def_property("shape", &h5io::PicMomentsWriter<1>::get_shape, &h5io::PicMomentsWriter<1>::set_shape)
+    .def("clear_moments", &h5io::PicMomentsWriter<1>::clear_moments)
+    .def("add_moment",    &h5io::PicMomentsWriter<1>::add_moment,
+        py::arg("name"), py::arg("kind"), py::arg("ispc")=-1)
     .def("write", &h5io::PicMomentsWriter<1>::write);
   
   // 2D
   py::class_<h5io::PicMomentsWriter<2>>(m_2d, "PicMomentsWriter")
+    .def_readwrite("async_io", &h5io::PicMomentsWriter<2>::async)
     .def(py::init<const std::string&, int, int, int, int, int, int, int>())
+    .def(py::init<const std::string&, int, int, int, int, int, int, int, bool>())
+    .def_readonly("parallel", &h5io::PicMomentsWriter<2>::parallel)
+    .def_property("shape", &h5io::PicMomentsWriter<2>::get_shape, &h5io::PicMomentsWriter<2>::set_shape)
+    .def("clear_moments", &h5io::PicMomentsWriter<2>::clear_moments)
+    .def("add_moment",    &h5io::PicMomentsWriter<2>::add_moment,
+        py::arg("name"), py::arg("kind"), py::arg("ispc")=-1)
     .def("write",       &h5io::PicMomentsWriter<2>::write)
     .def("get_slice", [](h5io::PicMomentsWriter<2> &s, int k)
             {
@@ -742,11 +1075,19 @@ void bind_pic(py::module& m_sub)
 
   // 3D
   py::class_<h5io::PicMomentsWriter<3>>(m_3d, "PicMomentsWriter")
+    .def_readwrite("async_io", &h5io::PicMomentsWriter<3>::async)
     .def(py::init<const std::string&, int, int, int, int, int, int, int>())
+    .def(py::init<const std::string&, int, int, int, int, int, int, int, bool>())
+    .def_readonly("parallel", &h5io::PicMomentsWriter<3>::parallel)
+    .def_property("shape", &h5io::PicMomentsWriter<3>::get_shape, &h5io::PicMomentsWriter<3>::set_shape)
+    .def("clear_moments", &h5io::PicMomentsWriter<3>::clear_moments)
+    .def("add_moment",    &h5io::PicMomentsWriter<3>::add_moment,
+        py::arg("name"), py::arg("kind"), py::arg("ispc")=-1)
     .def("write", &h5io::PicMomentsWriter<3>::write);
 
   // 3D
   py::class_<h5io::MasterPicMomentsWriter<3>>(m_3d, "MasterPicMomentsWriter")
+    .def_readwrite("async_io", &h5io::MasterPicMomentsWriter<3>::async)
     .def(py::init<const std::string&, int, int, int, int, int, int, int>())
     .def("write", &h5io::MasterPicMomentsWriter<3>::write);
 
@@ -755,17 +1096,30 @@ void bind_pic(py::module& m_sub)
   // Full IO
 
   // 1D
-  m_1d.def("write_particles",  &pic::write_particles<1>);
+  m_1d.def("write_particles",  &pic::write_particles<1>,
+      py::arg("grid"), py::arg("lap"), py::arg("dir"), py::arg("async_io")=false);
   m_1d.def("read_particles",   &pic::read_particles<1>);
   
   // 2D
-  m_2d.def("write_particles",  &pic::write_particles<2>);
+  m_2d.def("write_particles",  &pic::write_particles<2>,
+      py::arg("grid"), py::arg("lap"), py::arg("dir"), py::arg("async_io")=false);
   m_2d.def("read_particles",   &pic::read_particles<2>);
 
   // 3D
-  m_3d.def("write_particles",  &pic::write_particles<3>);
+  m_3d.def("write_particles",  &pic::write_particles<3>,
+      py::arg("grid"), py::arg("lap"), py::arg("dir"), py::arg("async_io")=false);
   m_3d.def("read_particles",   &pic::read_particles<3>);
 
+  //--------------------------------------------------
+  // dynamic load balancing
+  m_1d.def("tile_particle_counts", &pic::tile_particle_counts<1>);
+  m_2d.def("tile_particle_counts", &pic::tile_particle_counts<2>);
+  m_3d.def("tile_particle_counts", &pic::tile_particle_counts<3>);
+
+  m_1d.def("migrate_tiles", &pic::migrate_tiles<1>, py::arg("grid"), py::arg("old_owner"), py::arg("new_owner"));
+  m_2d.def("migrate_tiles", &pic::migrate_tiles<2>, py::arg("grid"), py::arg("old_owner"), py::arg("new_owner"));
+  m_3d.def("migrate_tiles", &pic::migrate_tiles<3>, py::arg("grid"), py::arg("old_owner"), py::arg("new_owner"));
+
   //--------------------------------------------------
   // wall
   auto tw13d = pic::wall::declare_tile<3, -1>(m_3d, "Tile_wall_LX");
@@ -844,6 +1198,7 @@ void bind_pic(py::module& m_sub)
     .def("insert_em",                &pic::Star<1>::insert_em)
     .def("update_b",                 &pic::Star<1>::update_b)
     .def("update_e",                 &pic::Star<1>::update_e)
+    .def("clear_cache",              &pic::Star<1>::clear_cache)
     .def("update_j",                 &pic::Star<1>::update_j)
     .def("solve",                    &pic::Star<1>::solve);
 
@@ -876,6 +1231,7 @@ void bind_pic(py::module& m_sub)
     .def("insert_em",                &pic::Star<2>::insert_em)
     .def("update_b",                 &pic::Star<2>::update_b)
     .def("update_e",                 &pic::Star<2>::update_e)
+    .def("clear_cache",              &pic::Star<2>::clear_cache)
     .def("solve",                    &pic::Star<2>::solve);
 
 
@@ -907,6 +1263,7 @@ void bind_pic(py::module& m_sub)
     .def("insert_em",                &pic::Star<3>::insert_em)
     .def("update_b",                 &pic::Star<3>::update_b)
     .def("update_e",                 &pic::Star<3>::update_e)
+    .def("clear_cache",              &pic::Star<3>::clear_cache)
     .def("solve",                    &pic::Star<3>::solve);
 
 
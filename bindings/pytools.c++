@@ -5,6 +5,7 @@
 #include "tools/mesh.h"
 #include "core/vlv/amr/mesh.h"
 #include "tools/hilbert.h"
+#include "tools/shm_window.h"
 
 #include <exception>
 
@@ -165,6 +166,20 @@ void bind_tools(pybind11::module& m)
     .def("get_level_0_cell_length", &AM3d::get_level_0_cell_length);
 
 
+  //--------------------------------------------------
+  // node-local shared memory window for mpi exchange between ranks on the same node
+  
+  m.def("shm_init", [](size_t bytes_per_rank) { toolbox::ShmWindow::get().init(bytes_per_rank); },
+      "allocate shared memory window; collective over all ranks");
+  m.def("shm_free",        []() { toolbox::ShmWindow::get().free(); });
+  m.def("shm_active",      []() { return toolbox::ShmWindow::get().active(); });
+  m.def("shm_capacity",    []() { return toolbox::ShmWindow::get().capacity_bytes(); },
+      "size of the window segment of each rank in bytes");
+  m.def("shm_on_node",     [](int rank) { return toolbox::ShmWindow::get().on_node(rank); });
+  m.def("shm_begin_phase", []() { toolbox::ShmWindow::get().begin_phase(); },
+      "start a new exchange phase; node-local barrier");
+
+
 
 
 
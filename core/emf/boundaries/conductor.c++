@@ -280,574 +280,344 @@ void emf::Conductor<D>::insert_em(
 
 
 
-template<size_t D>
-void emf::Conductor<D>::update_b(
-    emf::Tile<D>& tile)
-{
+namespace {
 
-  // helper class for staggered grid positions
-  StaggeredSphericalCoordinates coord(cenx,ceny,cenz,1.0);
+  /// loop limits, boundary flags, and location of a tile w.r.t. the conductor
+  struct Region {
 
-  // Tile limits
-  auto mins = tile.mins;
-  auto maxs = tile.maxs;
+    // loop indices; the tables cover the same cells
+    int imin, imax, jmin, jmax, kmin, kmax;
 
-  // loop indices
-  int imin, imax, jmin, jmax, kmin, kmax;
-  if(D == 1){
-    imin = -3, imax = tile.mesh_lengths[0]+3;
-    jmin =  0, jmax = 1;
-    kmin =  0, kmax = 1;
-  } else if (D == 2) {
-    imin = -3, imax = tile.mesh_lengths[0]+3;
-    jmin = -3, jmax = tile.mesh_lengths[1]+3;
-    kmin =  0, kmax = 1;
-  } else if (D == 3) {
-    imin = -3, imax = tile.mesh_lengths[0]+3;
-    jmin = -3, jmax = tile.mesh_lengths[1]+3;
-    kmin = -3, kmax = tile.mesh_lengths[2]+3;
-  }
+    // tile is at the box boundaries
+    bool left  = false;
+    bool right = false;
+    bool top   = false;
+    bool bot   = false;
+    bool front = false;
+    bool back  = false;
 
+    bool inside_star    = false;
+    bool inside_cyl_bcs = false;
 
-  auto& gs = tile.get_grids();
-
-  //-------------------------------------------------- 
-  // find if this is a corner tile
-  bool left  = false;
-  bool right = false;
-  bool top   = false;
-  bool bot   = false;
-  bool front = false;
-  bool back  = false;
+    float rbox     = 0.0;
+    float tile_len = 0.0;
 
-  Vec3<float> x1, x2, x3, x4, x5, x6, x7, x8;
-  if(D == 1){
-    if( mins[0] < 1 )    bot   = true; 
-    if( maxs[0] > Nx-1 ) top   = true; 
-
-    x1 = coord.mid().vec(mins[0], 0.0, 0.0, D); 
-    x2 = coord.mid().vec(maxs[0], 0.0, 0.0, D); 
-    x3 = coord.mid().vec(mins[0], 0.0, 0.0, D); 
-    x4 = coord.mid().vec(mins[0], 0.0, 0.0, D); 
-    x5 = coord.mid().vec(maxs[0], 0.0, 0.0, D); 
-    x6 = coord.mid().vec(maxs[0], 0.0, 0.0, D); 
-    x7 = coord.mid().vec(mins[0], 0.0, 0.0, D); 
-    x8 = coord.mid().vec(maxs[0], 0.0, 0.0, D); 
-  } else if(D == 2){
-    if( mins[1] < 1 )    bot   = true; 
-    if( mins[0] < 1 )    left  = true; 
-    if( maxs[1] > Ny-1 ) top   = true; 
-    if( maxs[0] > Nx-1 ) right = true; 
-
-    // all 8 of tile corners are compared to radius to find if we are inside the spherical region
-    x1 = coord.mid().vec(mins[0], mins[1], 0.0, D); 
-    x2 = coord.mid().vec(maxs[0], mins[1], 0.0, D); 
-    x3 = coord.mid().vec(mins[0], maxs[1], 0.0, D); 
-    x4 = coord.mid().vec(mins[0], mins[1], 0.0, D); 
-    x5 = coord.mid().vec(maxs[0], maxs[1], 0.0, D); 
-    x6 = coord.mid().vec(maxs[0], mins[1], 0.0, D); 
-    x7 = coord.mid().vec(mins[0], maxs[1], 0.0, D); 
-    x8 = coord.mid().vec(maxs[0], maxs[1], 0.0, D); 
-  } else if (D == 3) {
-    if( mins[0] < 1 )    left  = true; 
-    if( maxs[0] > Nx-1 ) right = true; 
-    if( mins[1] < 1 )    front = true; 
-    if( maxs[1] > Ny-1 ) back  = true; 
-    if( mins[2] < 1 )    bot   = true; 
-    if( maxs[2] > Nz-1 ) top   = true; 
-      
-    // all 8 of tile corners are compared to radius to find if we are inside the spherical region
-    x1 = coord.mid().vec(mins[0], mins[1], mins[2], D); 
-    x2 = coord.mid().vec(maxs[0], mins[1], mins[2], D); 
-    x3 = coord.mid().vec(mins[0], maxs[1], mins[2], D); 
-    x4 = coord.mid().vec(mins[0], mins[1], maxs[2], D); 
-    x5 = coord.mid().vec(maxs[0], maxs[1], mins[2], D); 
-    x6 = coord.mid().vec(maxs[0], mins[1], maxs[2], D); 
-    x7 = coord.mid().vec(mins[0], maxs[1], maxs[2], D); 
-    x8 = coord.mid().vec(maxs[0], maxs[1], maxs[2], D); 
-  }
-
-  const int H = 2; // halo region size for nulling of boundaries
-
-    
-  float tile_len = 0.0;
-  if( D == 1 ) tile_len = tile.mesh_lengths[0];
-  if( D == 2 ) tile_len = tile.mesh_lengths[1];
-  if( D == 3 ) tile_len = tile.mesh_lengths[2];
+    /// index of cell (i,j,k) in the tables
+    inline size_t index(int i, int j, int k) const {
+      return (i - imin) + (imax - imin)*( (j - jmin) + (jmax - jmin)*(k - kmin) );
+    }
 
-  //--------------------------------------------------
-  // inside star
-
-  // TODO this is not a bulletproof method to find if the star is inside tile;
-  //      if a small star is in the middle of the tile it can be missed...
-  bool inside_star = 
-    norm(x1) < 1.1*radius ||
-    norm(x2) < 1.1*radius ||
-    norm(x3) < 1.1*radius ||
-    norm(x4) < 1.1*radius ||
-    norm(x5) < 1.1*radius ||
-    norm(x6) < 1.1*radius ||
-    norm(x7) < 1.1*radius ||
-    norm(x8) < 1.1*radius;
+    inline size_t size() const {
+      return (imax - imin)*(jmax - jmin)*(kmax - kmin);
+    }
+  };
+
+
+  template<size_t D>
+  Region region(const emf::Conductor<D>& cd, emf::Tile<D>& tile)
+  {
+    Region rg;
+
+    // helper class for staggered grid positions
+    StaggeredSphericalCoordinates coord(cd.cenx,cd.ceny,cd.cenz,1.0);
+
+    // Tile limits
+    auto mins = tile.mins;
+    auto maxs = tile.maxs;
+
+    // loop indices
+    rg.imin = -3, rg.imax = tile.mesh_lengths[0]+3;
+    rg.jmin =  0, rg.jmax = 1;
+    rg.kmin =  0, rg.kmax = 1;
+    if(D >= 2) rg.jmin = -3, rg.jmax = tile.mesh_lengths[1]+3;
+    if(D >= 3) rg.kmin = -3, rg.kmax = tile.mesh_lengths[2]+3;
+
+    Vec3<float> x1, x2, x3, x4, x5, x6, x7, x8;
+    if(D == 1){
+      if( mins[0] < 1 )       rg.bot   = true; 
+      if( maxs[0] > cd.Nx-1 ) rg.top   = true; 
+
+      x1 = coord.mid().vec(mins[0], 0.0, 0.0, D); 
+      x2 = coord.mid().vec(maxs[0], 0.0, 0.0, D); 
+      x3 = coord.mid().vec(mins[0], 0.0, 0.0, D); 
+      x4 = coord.mid().vec(mins[0], 0.0, 0.0, D); 
+      x5 = coord.mid().vec(maxs[0], 0.0, 0.0, D); 
+      x6 = coord.mid().vec(maxs[0], 0.0, 0.0, D); 
+      x7 = coord.mid().vec(mins[0], 0.0, 0.0, D); 
+      x8 = coord.mid().vec(maxs[0], 0.0, 0.0, D); 
+    } else if(D == 2){
+      if( mins[1] < 1 )       rg.bot   = true; 
+      if( mins[0] < 1 )       rg.left  = true; 
+      if( maxs[1] > cd.Ny-1 ) rg.top   = true; 
+      if( maxs[0] > cd.Nx-1 ) rg.right = true; 
+
+      // all 8 of tile corners are compared to radius to find if we are inside the spherical region
+      x1 = coord.mid().vec(mins[0], mins[1], 0.0, D); 
+      x2 = coord.mid().vec(maxs[0], mins[1], 0.0, D); 
+      x3 = coord.mid().vec(mins[0], maxs[1], 0.0, D); 
+      x4 = coord.mid().vec(mins[0], mins[1], 0.0, D); 
+      x5 = coord.mid().vec(maxs[0], maxs[1], 0.0, D); 
+      x6 = coord.mid().vec(maxs[0], mins[1], 0.0, D); 
+      x7 = coord.mid().vec(mins[0], maxs[1], 0.0, D); 
+      x8 = coord.mid().vec(maxs[0], maxs[1], 0.0, D); 
+    } else if (D == 3) {
+      if( mins[0] < 1 )       rg.left  = true; 
+      if( maxs[0] > cd.Nx-1 ) rg.right = true; 
+      if( mins[1] < 1 )       rg.front = true; 
+      if( maxs[1] > cd.Ny-1 ) rg.back  = true; 
+      if( mins[2] < 1 )       rg.bot   = true; 
+      if( maxs[2] > cd.Nz-1 ) rg.top   = true; 
+
+      // all 8 of tile corners are compared to radius to find if we are inside the spherical region
+      x1 = coord.mid().vec(mins[0], mins[1], mins[2], D); 
+      x2 = coord.mid().vec(maxs[0], mins[1], mins[2], D); 
+      x3 = coord.mid().vec(mins[0], maxs[1], mins[2], D); 
+      x4 = coord.mid().vec(mins[0], mins[1], maxs[2], D); 
+      x5 = coord.mid().vec(maxs[0], maxs[1], mins[2], D); 
+      x6 = coord.mid().vec(maxs[0], mins[1], maxs[2], D); 
+      x7 = coord.mid().vec(mins[0], maxs[1], maxs[2], D); 
+      x8 = coord.mid().vec(maxs[0], maxs[1], maxs[2], D); 
+    }
 
-  const float b_offset = 0.0; // height offset of b smoothing
+    const int H = 2; // halo region size for nulling of boundaries
+
+    if( D == 1 ) rg.tile_len = tile.mesh_lengths[0];
+    if( D == 2 ) rg.tile_len = tile.mesh_lengths[1];
+    if( D == 3 ) rg.tile_len = tile.mesh_lengths[2];
+
+    // TODO this is not a bulletproof method to find if the star is inside tile;
+    //      if a small star is in the middle of the tile it can be missed...
+    const float radius = cd.radius;
+    rg.inside_star = 
+      norm(x1) < 1.1*radius ||
+      norm(x2) < 1.1*radius ||
+      norm(x3) < 1.1*radius ||
+      norm(x4) < 1.1*radius ||
+      norm(x5) < 1.1*radius ||
+      norm(x6) < 1.1*radius ||
+      norm(x7) < 1.1*radius ||
+      norm(x8) < 1.1*radius;
+
+    // damping on a cylindrical region around the pcap
+    // norm2d gives the length of the vector x and y components (ignoring z)
+    // this gives us the cylindrical coordinate; N/A for 1D
+    if(D == 2) {
+      rg.rbox = 0.5*cd.Nx - 0.5*tile.mesh_lengths[0]; // half of box - half tile
+                                 
+      rg.inside_cyl_bcs = 
+        norm1d(x1) > rg.rbox || norm1d(x2) > rg.rbox || norm1d(x3) > rg.rbox || norm1d(x4) > rg.rbox ||
+        norm1d(x5) > rg.rbox || norm1d(x6) > rg.rbox || norm1d(x7) > rg.rbox || norm1d(x8) > rg.rbox;
+    } else if(D == 3) {
+      rg.rbox = 0.5*cd.Nx-H-1; // half of box size in x direction (not incl halos)
+                                 
+      rg.inside_cyl_bcs = 
+        norm2d(x1) > rg.rbox || norm2d(x2) > rg.rbox || norm2d(x3) > rg.rbox || norm2d(x4) > rg.rbox ||
+        norm2d(x5) > rg.rbox || norm2d(x6) > rg.rbox || norm2d(x7) > rg.rbox || norm2d(x8) > rg.rbox;
+    }
 
-  if( inside_star) {
+    return rg;
+  }
 
-    #pragma omp parallel for
-    for(int k=kmin; k<kmax; k++) {
-      for(int j=jmin; j<jmax; j++) {
-        #pragma omp simd
-        for(int i=imin; i<imax; i++) {
 
-      // global grid coordinates
-      float iglob = (D>=1) ? i + mins[0] : 0;
-      float jglob = (D>=2) ? j + mins[1] : 0;
-      float kglob = (D>=3) ? k + mins[2] : 0;
+  /// cell is in the nulled sides of the box
+  template<size_t D>
+  inline bool inside_box_bcs(
+      const emf::Conductor<D>& cd, 
+      const Region& rg, 
+      float iglob, float jglob, float kglob)
+  {
+    const int H = 2; // halo region size for nulling of boundaries
 
-      //--------------------------------------------------
-      // bx
-      auto r1  = coord.bx().vec(iglob, jglob, kglob, D); // cartesian position vector in "star's coordinates"
-      auto bxd = B0*dipole(r1); // dipole field
-      auto h1  = abs(r1(D-1)); // cylindrical coordinate system height
-      //auto sx  = shape( norm(r1), radius + b_offset, delta); // radial smoothing parameter
-      auto sx  = shape( h1, radius + b_offset, delta); // cylindrical smoothing parameter
-
-      // by
-      auto r2  = coord.by().vec(iglob, jglob, kglob, D); // cartesian position vector in "star's coordinates"
-      auto byd = B0*dipole(r2); // dipole field
-      auto h2  = abs(r2(D-1)); // cylindrical coordinate system height
-      //auto sy  = shape( norm(r2), radius + b_offset, delta); // radial smoothing parameter
-      auto sy  = shape( h2, radius + b_offset, delta); // cylindrical smoothing parameter
-
-      // bz
-      auto r3  = coord.bz().vec(iglob, jglob, kglob, D); // cartesian position vector in "star's coordinates"
-      auto bzd = B0*dipole(r3); // dipole field
-      auto h3  = abs(r3(D-1)); // cylindrical coordinate system height
-      //auto sz  = shape( norm(r3), radius + b_offset, delta); // radial smoothing parameter
-      auto sz  = shape( h3, radius + b_offset, delta); // cylindrical smoothing parameter
+    bool inside_bot   = (D==1) ? iglob < H       : (D==2) ? jglob < H       : kglob < H; // y or z direction flip 
+    bool inside_top   = (D==1) ? iglob > cd.Nx-1 : (D==2) ? jglob > cd.Ny-1 : kglob > cd.Nz-1; // y or z direction flip 
 
+    bool inside_left  = rg.left  && iglob < H; 
+    bool inside_right = rg.right && iglob > cd.Nx-H-1; 
 
-      //--------------------------------------------------
-      // special mode to set constant background field in 1D
-      if( (D == 1) && set_const_b ) { // get value of the dipole at r=R
-        auto r1_left = coord.bx().vec(0, 0, 0, D); // cartesian position vector in "star's coordinates"
-        bxd = B0*dipole(r1_left); // dipole field at r=R
-        byd = bxd;
-        bzd = bxd;
-      }
+    bool inside_front = rg.front && jglob < H; 
+    bool inside_back  = rg.back  && jglob > cd.Ny-H-1; 
 
-      //--------------------------------------------------
-      // blending of old + new solution
-      gs.bx(i,j,k) = sx*bxd(0) + (1.0f - sx)*gs.bx(i,j,k); 
-      gs.by(i,j,k) = sy*byd(1) + (1.0f - sy)*gs.by(i,j,k); 
-      gs.bz(i,j,k) = sz*bzd(2) + (1.0f - sz)*gs.bz(i,j,k); 
-    }}}
+    // cartesian boundaries
+    return inside_left  ||
+           inside_right ||
+           inside_front ||
+           inside_back  ||
+           inside_top   ||
+           inside_bot;
   }
 
-  //--------------------------------------------------
-  // damping on a cylindrical region around the pcap
-    
-  // norm2d gives the length of the vector x and y components (ignoring z)
-  // this gives us the cylindrical coordinate
-
-  bool inside_cyl_bcs = false;
-  float rbox = 0.0;
-
-  // N/A for 1D; ignored
-
-  if(D == 2) {
-    rbox = 0.5*Nx - 0.5*tile.mesh_lengths[0]; // half of box - half tile
-                               
-    inside_cyl_bcs = 
-      norm1d(x1) > rbox || norm1d(x2) > rbox || norm1d(x3) > rbox || norm1d(x4) > rbox ||
-      norm1d(x5) > rbox || norm1d(x6) > rbox || norm1d(x7) > rbox || norm1d(x8) > rbox;
-  } else if(D == 3) {
-    rbox = 0.5*Nx-H-1; // half of box size in x direction (not incl halos)
-                               
-    inside_cyl_bcs = 
-      norm2d(x1) > rbox || norm2d(x2) > rbox || norm2d(x3) > rbox || norm2d(x4) > rbox ||
-      norm2d(x5) > rbox || norm2d(x6) > rbox || norm2d(x7) > rbox || norm2d(x8) > rbox;
-  }
 
-  if( (D>=2) && inside_cyl_bcs ) {
+  /// f <- a*f + b over the table region
+  inline void blend(
+      toolbox::Mesh<float,3>& m, 
+      const std::vector<float>& a, 
+      const std::vector<float>& b, 
+      const Region& rg)
+  {
+    const int nx = rg.imax - rg.imin;
 
     #pragma omp parallel for
-    for(int k=kmin; k<kmax; k++) {
-      for(int j=jmin; j<jmax; j++) {
+    for(int k=rg.kmin; k<rg.kmax; k++) {
+      for(int j=rg.jmin; j<rg.jmax; j++) {
+        float* f = &m(rg.imin, j, k);
+        const float* ap = a.data() + rg.index(rg.imin, j, k);
+        const float* bp = b.data() + rg.index(rg.imin, j, k);
+
         #pragma omp simd
-        for(int i=imin; i<imax; i++) {
+        for(int i=0; i<nx; i++) f[i] = ap[i]*f[i] + bp[i];
+    }}
+  }
 
-      // global grid coordinates
-      float iglob = (D>=1) ? i + mins[0] : 0;
-      float jglob = (D>=2) ? j + mins[1] : 0;
-      float kglob = (D>=3) ? k + mins[2] : 0;
+} // end of anonymous namespace
 
 
-      //--------------------------------------------------
-      // bx
-      auto r1    = coord.bx().vec(iglob, jglob, kglob, D); // cartesian position vector in "star's coordinates"
-      auto bxd   = B0*dipole(r1); // dipole field
-      auto rcyl1 = (D == 2) ? norm1d(r1) : norm2d(r1); // cylindrical radius
 
-      // by
-      auto r2    = coord.by().vec(iglob, jglob, kglob, D); // cartesian position vector in "star's coordinates"
-      auto byd   = B0*dipole(r2); // dipole field
-      auto rcyl2 = (D == 2) ? norm1d(r2) : norm2d(r2); // cylindrical radius
+template<size_t D>
+typename emf::Conductor<D>::Tables& emf::Conductor<D>::get_tables(
+    emf::Tile<D>& tile)
+{
+  std::vector<float> params = {
+    radius, period, B0, chi_mu, chi_om, phase_mu, phase_om, cenx, ceny, cenz,
+    delta, radius_pc, delta_pc, 
+    static_cast<float>(flat_surface), static_cast<float>(set_const_b),
+    static_cast<float>(Nx), static_cast<float>(Ny), static_cast<float>(Nz),
+    static_cast<float>(tile.cfl) };
+
+  for(size_t a=0; a<D; a++) params.push_back(tile.mins[a]);
+  for(size_t a=0; a<3; a++) params.push_back(tile.mesh_lengths[a]);
+
+  auto& tb = tables[tile.cid];
+  if(tb.params != params) {
+    build_b(tile, tb);
+    build_e(tile, tb);
+    tb.params = params;
+  }
 
-      // bz
-      auto r3    = coord.bz().vec(iglob, jglob, kglob, D); // cartesian position vector in "star's coordinates"
-      auto bzd   = B0*dipole(r3); // dipole field
-      auto rcyl3 = (D == 2) ? norm1d(r3) : norm2d(r3); // cylindrical radius
+  return tb;
+}
 
-      //--------------------------------------------------
-      // ver 1; tanh profile
-      auto delta_ext = 0.25f*tile_len; // 1/4 of tile size
-      auto sx = shape(rcyl1, rbox, delta_ext); 
-      auto sy = shape(rcyl2, rbox, delta_ext);
-      auto sz = shape(rcyl3, rbox, delta_ext); 
 
-      //ver 4; exp profile
-      //auto sx = 1.0f - min(1.0, exp( (rcyl1-rbox)/(3.0*tile_len) ) );
-      //auto sy = 1.0f - min(1.0, exp( (rcyl2-rbox)/(3.0*tile_len) ) );
-      //auto sz = 1.0f - min(1.0, exp( (rcyl3-rbox)/(3.0*tile_len) ) );
+template<size_t D>
+void emf::Conductor<D>::build_b(
+    emf::Tile<D>& tile,
+    Tables& tb)
+{
+  // helper class for staggered grid positions
+  StaggeredSphericalCoordinates coord(cenx,ceny,cenz,1.0);
 
-      //--------------------------------------------------
-      // damp to dipole solution
-      gs.bx(i,j,k) = sx*gs.bx(i,j,k) + (1.0f-sx)*bxd(0);
-      gs.by(i,j,k) = sy*gs.by(i,j,k) + (1.0f-sy)*byd(1);
-      gs.bz(i,j,k) = sz*gs.bz(i,j,k) + (1.0f-sz)*bzd(2);
-    }}}
-  }
+  auto mins = tile.mins;
+  auto rg = region(*this, tile);
 
+  const bool box = rg.left || rg.right || rg.front || rg.back || rg.bot || rg.top;
 
-  //--------------------------------------------------
-  // top absorping layer
+  tb.active_b = rg.inside_star || ((D>=2) && rg.inside_cyl_bcs) || rg.top || rg.bot || box;
 
-  if(top) {
+  for(int c=0; c<3; c++) {
+    tb.ab[c].clear();
+    tb.bb[c].clear();
+  }
+  if(!tb.active_b) return;
 
-    //float radius_ext = (D == 2) ? Ny - 0.5*tile_len : Nz - 0.5*tile_len;
-      
-    float radius_ext = 0.0;
-    if(D == 1) radius_ext = Nx - 0.5*tile_len;
-    if(D == 2) radius_ext = Ny - 0.5*tile_len;
-    if(D == 3) radius_ext = Nz - 0.5*tile_len;
-
-    //float radius_ext = (D == 2) ? Ny - H : Nz - H; // exp profile
-    float delta_ext  = 0.25f*tile_len; // 1/4 of tile size
-                                           
-    #pragma omp parallel for
-    for(int k=kmin; k<kmax; k++) {
-      for(int j=jmin; j<jmax; j++) {
-        #pragma omp simd
-        for(int i=imin; i<imax; i++) {
-
-          // global grid coordinates
-          const float iglob = (D>=1) ? i + mins[0] : 0;
-          const float jglob = (D>=2) ? j + mins[1] : 0;
-          const float kglob = (D>=3) ? k + mins[2] : 0;
-
-          //auto h = (D == 2 ) ? jglob : kglob; // height
-          const auto h = (D==1) ? iglob : (D==2) ? jglob : kglob; // height
-
-          //--------------------------------------------------
-          // bx
-          auto r1  = coord.bx().vec(iglob, jglob, kglob, D); // cartesian position vector in "star's coordinates"
-          auto bxd = B0*dipole(r1); // dipole field
-
-          // by
-          auto r2  = coord.by().vec(iglob, jglob, kglob, D); // cartesian position vector in "star's coordinates"
-          auto byd = B0*dipole(r2); // dipole field
-
-          // bz
-          auto r3  = coord.bz().vec(iglob, jglob, kglob, D); // cartesian position vector in "star's coordinates"
-          auto bzd = B0*dipole(r3); // dipole field
-
-
-          //--------------------------------------------------
-          // special mode to set constant background field in 1D
-          if( (D == 1) && set_const_b ) { // get value of the dipole at r=R
-            auto r1_left = coord.bx().vec(0, 0, 0, D); // cartesian position vector in "star's coordinates"
-            bxd = B0*dipole(r1_left); // dipole field at r=R
-            byd = bxd;
-            bzd = bxd;
-          }
-
-          //--------------------------------------------------
-          // ver 1; tanh profile
-          auto s = shape(h, radius_ext, delta_ext); // tanh
-
-          // ver2 linear profile
-          //float radius_ext = (D == 2) ? Ny - tile_len : Nz - tile_len;
-          //float delta_ext = 1.0*tile_len; // full tile size
-          //s = 1.0f - std::max(0.0f, std::min(1.0f, (h-radius_ext)/delta_ext) ); //RELU
-
-          //ver 3; mimic lambda profile from PML
-          //float lam = pow( (h - radius_ext)/(1.0 - radius_ext), 3);
-          //s = min(1.0f, lam);
-
-          //ver 4; exp profile
-          //auto s = 1.0f - min(1.0, exp( (h-radius_ext)/(3.0*tile_len) ) );
-
-          //--------------------------------------------------
-          // damp to dipole solution
-          gs.bx(i,j,k) = s*gs.bx(i,j,k) + (1.0f-s)*bxd(0);
-          gs.by(i,j,k) = s*gs.by(i,j,k) + (1.0f-s)*byd(1);
-          gs.bz(i,j,k) = s*gs.bz(i,j,k) + (1.0f-s)*bzd(2);
-    }}}
+  for(int c=0; c<3; c++) {
+    tb.ab[c].assign(rg.size(), 1.0f);
+    tb.bb[c].assign(rg.size(), 0.0f);
   }
 
+  const float b_offset = 0.0; // height offset of b smoothing
 
-  //--------------------------------------------------
-  // bottom absorping layer
+  // top absorbing layer; tanh profile
+  float radius_ext = 0.0;
+  if(D == 1) radius_ext = Nx - 0.5*rg.tile_len;
+  if(D == 2) radius_ext = Ny - 0.5*rg.tile_len;
+  if(D == 3) radius_ext = Nz - 0.5*rg.tile_len;
+  const float delta_ext = 0.25f*rg.tile_len; // 1/4 of tile size
 
-  if(bot) {
+  for(int k=rg.kmin; k<rg.kmax; k++) 
+  for(int j=rg.jmin; j<rg.jmax; j++) 
+  for(int i=rg.imin; i<rg.imax; i++) {
 
-    float radius_ext = 0.5*tile_len; // exp profile
-    float delta_ext  = 0.25f*tile_len; // 1/4 of tile size
-                                           
-    #pragma omp parallel for
-    for(int k=kmin; k<kmax; k++) {
-      for(int j=jmin; j<jmax; j++) {
-        #pragma omp simd
-        for(int i=imin; i<imax; i++) {
-
-          // global grid coordinates
-          const float iglob = (D>=1) ? i + mins[0] : 0;
-          const float jglob = (D>=2) ? j + mins[1] : 0;
-          const float kglob = (D>=3) ? k + mins[2] : 0;
-
-          auto rvec = coord.mid().vec(iglob, jglob, kglob, D); // cartesian position vector in "star's coordinates"
-          const auto h = (D==1) ? iglob : (D==2) ? jglob : kglob; // height
-          const auto rcyl = (D==1) ? 0.0f : (D==2) ? norm1d(rvec) : norm2d(rvec); // cylindrical radius
-
-          //--------------------------------------------------
-          // bx
-          auto r1  = coord.bx().vec(iglob, jglob, kglob, D); // cartesian position vector in "star's coordinates"
-          auto bxd = B0*dipole(r1); // dipole field
-
-          // by
-          auto r2  = coord.by().vec(iglob, jglob, kglob, D); // cartesian position vector in "star's coordinates"
-          auto byd = B0*dipole(r2); // dipole field
-
-          // bz
-          auto r3  = coord.bz().vec(iglob, jglob, kglob, D); // cartesian position vector in "star's coordinates"
-          auto bzd = B0*dipole(r3); // dipole field
-
-
-          //--------------------------------------------------
-          // special mode to set constant background field in 1D
-          if( (D == 1) && set_const_b ) { // get value of the dipole at r=R
-            auto r1_left = coord.bx().vec(0, 0, 0, D); // cartesian position vector in "star's coordinates"
-            bxd = B0*dipole(r1_left); // dipole field at r=R
-            byd = bxd;
-            bzd = bxd;
-          }
-
-          //--------------------------------------------------
-          // ver 1; tanh profile
-          //auto s = 1.0f - shape(h, radius_ext, delta_ext); // tanh
-          //if( rcyl < 1.5*radius_pc ) s = 1.0f; // act normal inside star
-
-          // tanh profile outside the cylindrical region
-          auto s = 1.0f ? rcyl < 1.5*radius_pc : 1.0f - shape(h, radius_ext, delta_ext);
-                                                    
-          //--------------------------------------------------
-          // damp to dipole solution
-          gs.bx(i,j,k) = s*gs.bx(i,j,k) + (1.0f-s)*bxd(0);
-          gs.by(i,j,k) = s*gs.by(i,j,k) + (1.0f-s)*byd(1);
-          gs.bz(i,j,k) = s*gs.bz(i,j,k) + (1.0f-s)*bzd(2);
-    }}}
+    // global grid coordinates
+    const float iglob = (D>=1) ? i + mins[0] : 0;
+    const float jglob = (D>=2) ? j + mins[1] : 0;
+    const float kglob = (D>=3) ? k + mins[2] : 0;
 
-  }
+    const auto h = (D==1) ? iglob : (D==2) ? jglob : kglob; // height
 
+    auto rvec = coord.mid().vec(iglob, jglob, kglob, D); // cartesian position vector in "star's coordinates"
+    const auto rcyl = (D==1) ? 0.0f : (D==2) ? norm1d(rvec) : norm2d(rvec); // cylindrical radius
 
+    const bool in_box = box && inside_box_bcs(*this, rg, iglob, jglob, kglob);
+    const size_t q = rg.index(i,j,k);
 
+    for(int c=0; c<3; c++) {
 
+      // cartesian position vector of the staggered component in "star's coordinates"
+      auto r  = c == 0 ? coord.bx().vec(iglob, jglob, kglob, D) :
+                c == 1 ? coord.by().vec(iglob, jglob, kglob, D) :
+                         coord.bz().vec(iglob, jglob, kglob, D);
+      auto bd = B0*dipole(r); // dipole field
 
-  //--------------------------------------------------
-  // box boundaries
+      //--------------------------------------------------
+      // special mode to set constant background field in 1D
+      if( (D == 1) && set_const_b ) { // get value of the dipole at r=R
+        auto r1_left = coord.bx().vec(0, 0, 0, D); // cartesian position vector in "star's coordinates"
+        bd = B0*dipole(r1_left); // dipole field at r=R
+      }
+      const float f0 = bd(c);
+
+      // composition of blends f <- s*f0 + (1-s)*f
+      float a = 1.0f, b = 0.0f;
+      auto add_blend = [&](float s) { 
+        a = (1.0f - s)*a; 
+        b = (1.0f - s)*b + s*f0; 
+      };
+
+      // inside star; cylindrical smoothing
+      if(rg.inside_star) add_blend( shape( abs(r(D-1)), radius + b_offset, delta) );
+
+      // damping to dipole on a cylindrical region around the pcap
+      if( (D>=2) && rg.inside_cyl_bcs ) {
+        auto rcyl_c = (D == 2) ? norm1d(r) : norm2d(r); // cylindrical radius
+        add_blend( 1.0f - shape(rcyl_c, rg.rbox, delta_ext) ); 
+      }
 
-  if( left  ||
-      right || 
-      front ||
-      back  ||
-      bot   ||
-      top
-    ){
+      // top absorbing layer
+      if(rg.top) add_blend( 1.0f - shape(h, radius_ext, delta_ext) );
 
-    #pragma omp parallel for
-    for(int k=kmin; k<kmax; k++) {
-      for(int j=jmin; j<jmax; j++) {
-        #pragma omp simd
-        for(int i=imin; i<imax; i++) {
-
-          // global grid coordinates
-          float iglob = (D>=1) ? i + mins[0] : 0;
-          float jglob = (D>=2) ? j + mins[1] : 0;
-          float kglob = (D>=3) ? k + mins[2] : 0;
-
-          //--------------------------------------------------
-          // bx
-          auto r1  = coord.bx().vec(iglob, jglob, kglob, D); // cartesian position vector in "star's coordinates"
-          auto bxd = B0*dipole(r1); // dipole field
-
-          // by
-          auto r2  = coord.by().vec(iglob, jglob, kglob, D); // cartesian position vector in "star's coordinates"
-          auto byd = B0*dipole(r2); // dipole field
-
-          // bz
-          auto r3  = coord.bz().vec(iglob, jglob, kglob, D); // cartesian position vector in "star's coordinates"
-          auto bzd = B0*dipole(r3); // dipole field
-
-          //--------------------------------------------------
-          // special mode to set constant background field in 1D
-          if( (D == 1) && set_const_b ) { // get value of the dipole at r=R
-            auto r1_left = coord.bx().vec(0, 0, 0, D); // cartesian position vector in "star's coordinates"
-            bxd = B0*dipole(r1_left); // dipole field at r=R
-            byd = bxd;
-            bzd = bxd;
-          }
-
-          //--------------------------------------------------
-          // sides
-          bool inside_bot   = (D==1) ? iglob < H    : (D==2) ? jglob < H    : kglob < H; // y or z direction flip 
-          bool inside_top   = (D==1) ? iglob > Nx-1 : (D==2) ? jglob > Ny-1 : kglob > Nz-1; // y or z direction flip 
-
-          bool inside_left  = left  && iglob < H; 
-          bool inside_right = right && iglob > Nx-H-1; 
-
-          bool inside_front = front && jglob < H; 
-          bool inside_back  = back  && jglob > Ny-H-1; 
-
-          // cartesian boundaries
-          bool inside_box_bcs = inside_left  ||
-                                inside_right ||
-                                inside_front ||
-                                inside_back  ||
-                                inside_top   ||
-                                inside_bot;
-
-          //--------------------------------------------------
-          // vector friendly application of boolean boundary
-          auto s = static_cast<float>(inside_box_bcs);
-
-          gs.bx(i,j,k) = s*bxd(0) + (1.0f-s)*gs.bx(i,j,k);
-          gs.by(i,j,k) = s*byd(1) + (1.0f-s)*gs.by(i,j,k);
-          gs.bz(i,j,k) = s*bzd(2) + (1.0f-s)*gs.bz(i,j,k);
-    }}}
-  }
+      // bottom absorbing layer
+      // NOTE: the weight is 1 outside of 1.5*radius_pc and 0 inside; the
+      //       tanh profile in height is not applied
+      if(rg.bot) add_blend( rcyl < 1.5*radius_pc ? 0.0f : 1.0f );
 
-}
+      // box boundaries
+      if(in_box) add_blend(1.0f);
 
+      tb.ab[c][q] = a;
+      tb.bb[c][q] = b;
+    }
+  }
+}
 
 
 template<size_t D>
-void emf::Conductor<D>::update_e(
-    emf::Tile<D>& tile)
+void emf::Conductor<D>::build_e(
+    emf::Tile<D>& tile,
+    Tables& tb)
 {
-
   // angular velocity
   Vec3<float> Om; 
   float Omega = 2.0*PI/period;
   if(period < EPS) Omega = 0.0; // reality check
 
-  const float c = tile.cfl; // (numerical) speed of light
-
-
   if(D == 1) Om.set(Omega, 0.0, 0.0); // Omega unit vector along y-axis
   if(D == 2) Om.set(0.0, Omega, 0.0); // Omega unit vector along y-axis
   if(D == 3) Om.set( sin(chi_om)*cos(phase_om)*Omega, sin(chi_om)*sin(phase_om)*Omega, cos(chi_om)*Omega ); 
 
-  //if(D == 3) Om.set( sin(chi_om)*Omega, 0.0,   cos(chi_om)*Omega ); // general Omega unit vector 
-    
   // helper class for staggered grid positions
   StaggeredSphericalCoordinates coord(cenx,ceny,cenz,1.0);
 
-  // Tile limits
   auto mins = tile.mins;
-  auto maxs = tile.maxs;
-
-  auto& gs = tile.get_grids();
-
-  // loop indices
-  int imin, imax, jmin, jmax, kmin, kmax;
-  if(D == 1){
-    imin = -3, imax = tile.mesh_lengths[0]+3;
-    jmin =  0, jmax = 1;
-    kmin =  0, kmax = 1;
-  } else if (D == 2) {
-    imin = -3, imax = tile.mesh_lengths[0]+3;
-    jmin = -3, jmax = tile.mesh_lengths[1]+3;
-    kmin =  0, kmax = 1;
-  } else if (D == 3) {
-    imin = -3, imax = tile.mesh_lengths[0]+3;
-    jmin = -3, jmax = tile.mesh_lengths[1]+3;
-    kmin = -3, kmax = tile.mesh_lengths[2]+3;
-  }
-
-  //-------------------------------------------------- 
-  // null sides to prevent periodic bc conditions
-  bool left  = false;
-  bool right = false;
-  bool top   = false;
-  bool bot   = false;
-  bool front = false;
-  bool back  = false;
-
-  Vec3<float> x1, x2, x3, x4, x5, x6, x7, x8;
-  if(D == 1){
-    if( mins[0] < 1 )    bot   = true; 
-    if( maxs[0] > Nx-1 ) top   = true; 
-
-    x1 = coord.mid().vec(mins[0], 0.0, 0.0, D); 
-    x2 = coord.mid().vec(maxs[0], 0.0, 0.0, D); 
-    x3 = coord.mid().vec(mins[0], 0.0, 0.0, D); 
-    x4 = coord.mid().vec(mins[0], 0.0, 0.0, D); 
-    x5 = coord.mid().vec(maxs[0], 0.0, 0.0, D); 
-    x6 = coord.mid().vec(maxs[0], 0.0, 0.0, D); 
-    x7 = coord.mid().vec(mins[0], 0.0, 0.0, D); 
-    x8 = coord.mid().vec(maxs[0], 0.0, 0.0, D); 
-  } else if(D == 2){
-    if( mins[1] < 1 )    bot   = true; 
-    if( mins[0] < 1 )    left  = true; 
-    if( maxs[1] > Ny-1 ) top   = true; 
-    if( maxs[0] > Nx-1 ) right = true; 
-
-    // all 8 of tile corners are compared to radius to find if we are inside the spherical region
-    x1 = coord.mid().vec(mins[0], mins[1], 0.0, D); 
-    x2 = coord.mid().vec(maxs[0], mins[1], 0.0, D); 
-    x3 = coord.mid().vec(mins[0], maxs[1], 0.0, D); 
-    x4 = coord.mid().vec(mins[0], mins[1], 0.0, D); 
-    x5 = coord.mid().vec(maxs[0], maxs[1], 0.0, D); 
-    x6 = coord.mid().vec(maxs[0], mins[1], 0.0, D); 
-    x7 = coord.mid().vec(mins[0], maxs[1], 0.0, D); 
-    x8 = coord.mid().vec(maxs[0], maxs[1], 0.0, D); 
-  } else if (D == 3) {
-    if( mins[0] < 1 )    left  = true; 
-    if( maxs[0] > Nx-1 ) right = true; 
-    if( mins[1] < 1 )    front = true; 
-    if( maxs[1] > Ny-1 ) back  = true; 
-    if( mins[2] < 1 )    bot   = true; 
-    if( maxs[2] > Nz-1 ) top   = true; 
-
-    // all 8 of tile corners are compared to radius to find if we are inside the spherical region
-    x1 = coord.mid().vec(mins[0], mins[1], mins[2], D); 
-    x2 = coord.mid().vec(maxs[0], mins[1], mins[2], D); 
-    x3 = coord.mid().vec(mins[0], maxs[1], mins[2], D); 
-    x4 = coord.mid().vec(mins[0], mins[1], maxs[2], D); 
-    x5 = coord.mid().vec(maxs[0], maxs[1], mins[2], D); 
-    x6 = coord.mid().vec(maxs[0], mins[1], maxs[2], D); 
-    x7 = coord.mid().vec(mins[0], maxs[1], maxs[2], D); 
-    x8 = coord.mid().vec(maxs[0], maxs[1], maxs[2], D); 
-  }
-
-  const int H = 2;
-    
-  float tile_len = 0.0;
-  if( D == 1 ) tile_len = tile.mesh_lengths[0];
-  if( D == 2 ) tile_len = tile.mesh_lengths[1];
-  if( D == 3 ) tile_len = tile.mesh_lengths[2];
+  auto rg = region(*this, tile);
 
   // tile lengths
   const int nx_tile = (D>=1) ? tile.mesh_lengths[0] : 1;
@@ -855,496 +625,231 @@ void emf::Conductor<D>::update_e(
   const int nz_tile = (D>=3) ? tile.mesh_lengths[2] : 1;
 
   //--------------------------------------------------
-  // inside star
-
-  //--------------------------------------------------
-  // additionally; null epar in the closed field line region
+  // smoothing of the epar removal in the closed field line region
 
   // for dipole fields r/Rbc = sin^2(theta) where r and theta are in spherical coordinates 
-  // tolerance of 0.95 here so that we start killing the epar earlier
   auto sint = radius_pc/radius; // sin\theta = R_pc/R_star
   auto Rbc  = radius/sint/sint;  
 
-
-    
-
-  // NOTE: do not use full tile boundaries w/ halos for epar removal
+  tb.s_epar.clear();
   if( D >= 2 ) { // epar removal only for D=2 and 3
+    tb.s_epar.resize(nx_tile*ny_tile*nz_tile);
 
-  #pragma omp parallel for
-  for(int k=0; k<nz_tile; k++) {
-    for(int j=0; j<ny_tile; j++) {
-      #pragma omp simd
-      for(int i=0; i<nx_tile; i++) {
+    // NOTE: do not use full tile boundaries w/ halos for epar removal
+    for(int k=0; k<nz_tile; k++) 
+    for(int j=0; j<ny_tile; j++) 
+    for(int i=0; i<nx_tile; i++) {
       
-        // global grid coordinates
-        const float iglob = (D>=1) ? i + mins[0] : 0;
-        const float jglob = (D>=2) ? j + mins[1] : 0;
-        const float kglob = (D>=3) ? k + mins[2] : 0;
-
-        //--------------------------------------------------
-        // spherical coordinates; TODO ignoring staggering
-        auto rvec = coord.mid().vec(iglob, jglob, kglob, D); //cartesian radius vector in star's coords
-        const auto rad = norm(rvec); // length of radius
-
-        const auto rcyl = (D==1) ? abs(rvec(0)) : (D==2) ? norm1d(rvec) : norm2d(rvec); // cylindrical radius
-                                                                                          
-        //auto sint = rcycl/rad; // \sin\theta
-        //auto eta = rad/Rbc; // dimensionless dipole coordinate radius
-
-        //bool inside_closed_field_region = eta < 1.0*sint*sint;
-
-        //--------------------------------------------------
-        // vector friendly application of boolean boundary
-        //auto s = static_cast<float>(inside_closed_field_region);
+      // global grid coordinates
+      const float iglob = (D>=1) ? i + mins[0] : 0;
+      const float jglob = (D>=2) ? j + mins[1] : 0;
+      const float kglob = (D>=3) ? k + mins[2] : 0;
 
-        //--------------------------------------------------
-        // smoothing function
-        //s = shape( rad, 1.0*Rbc*sint*sint, 50.0); // location of the open-closed field line bc
+      //--------------------------------------------------
+      // spherical coordinates; TODO ignoring staggering
+      auto rvec = coord.mid().vec(iglob, jglob, kglob, D); //cartesian radius vector in star's coords
+      const auto rad = norm(rvec); // length of radius
 
-        // condition for closed field line region is
-        //eta = sint*sint
-        //rad/Rbc = (rcycl/rad)^2 = rcyl^2/rad^2
-        //rcycl^2 = (rad^3/Rbc)
-        //rcycl > sqrt( rad^3/Rbc ) = rad*sqrt(rad/Rbc)
-        // Then, we can use a smoothing function similar to that in pcap radius:
-        auto s = 1.0f - shape(rcyl, rad*sqrt(rad/Rbc), delta_pc);  
+      const auto rcyl = (D==1) ? abs(rvec(0)) : (D==2) ? norm1d(rvec) : norm2d(rvec); // cylindrical radius
 
-        //--------------------------------------------------
-        // additional height dependent damping inside the atmosphere; overwrites other smoothing
-        //bool inside_atmos  = norm(rvec) < 1.0*radius + 2;
+      // condition for closed field line region is
+      //eta = sint*sint
+      //rad/Rbc = (rcycl/rad)^2 = rcyl^2/rad^2
+      //rcycl^2 = (rad^3/Rbc)
+      //rcycl > sqrt( rad^3/Rbc ) = rad*sqrt(rad/Rbc)
+      // Then, we can use a smoothing function similar to that in pcap radius:
+      auto s = 1.0f - shape(rcyl, rad*sqrt(rad/Rbc), delta_pc);  
 
-        const auto h = (D==1) ? iglob : (D==2) ? jglob : kglob; // cylindrical coordinate system height
-        bool inside_atmos  = h < 1.0*radius + 2;
+      //--------------------------------------------------
+      // additional height dependent damping inside the atmosphere; overwrites other smoothing
+      const auto h = (D==1) ? iglob : (D==2) ? jglob : kglob; // cylindrical coordinate system height
+      bool inside_atmos  = h < 1.0*radius + 2;
           
-        if( inside_atmos ) s = 1.0f - shape(rcyl, radius_pc, delta_pc);  
-                                                         
-        //if(inside_atmos) s = shape(h, radius, delta); // radial smoothing parameter
-        //if(inside_atmos) s = 1.0f - shape(norm(rvec), radius, delta); // radial smoothing parameter
+      if( inside_atmos ) s = 1.0f - shape(rcyl, radius_pc, delta_pc);  
 
+      tb.s_epar[i + nx_tile*(j + ny_tile*k)] = s;
+    }
+  }
 
-        //--------------------------------------------------
-        // epar; ver 1
-        auto exi = gs.ex(i,j,k);
-        auto eyi = gs.ey(i,j,k);
-        auto ezi = gs.ez(i,j,k);
-
-        auto bxi = gs.bx(i,j,k);
-        auto byi = gs.by(i,j,k);
-        auto bzi = gs.bz(i,j,k);
-        auto bn  = std::sqrt( bxi*bxi + byi*byi + bzi*bzi ) + EPS;
+  //--------------------------------------------------
+  // blends of E towards the co-rotating solution and vacuum
+  const bool box = rg.left || rg.right || rg.front || rg.back || rg.bot || rg.top;
 
-        // E_\parallel
-        auto epar = (exi*bxi + eyi*byi + ezi*bzi)/bn;
+  tb.active_e = rg.inside_star || ((D>=2) && rg.inside_cyl_bcs) || rg.top || ((D>=2) && rg.bot) || box;
 
-        //--------------------------------------------------
-        // take out eparallel component from electric field
-        auto exnew = exi - epar*bxi/bn;
-        auto eynew = eyi - epar*byi/bn;
-        auto eznew = ezi - epar*bzi/bn;
+  for(int c=0; c<3; c++) {
+    tb.ae[c].clear();
+    tb.be[c].clear();
+  }
+  if(!tb.active_e) return;
 
-        // blend solution in with a smoothing function
-        gs.ex(i,j,k) = s*exnew + (1.0f - s)*exi;
-        gs.ey(i,j,k) = s*eynew + (1.0f - s)*eyi;
-        gs.ez(i,j,k) = s*eznew + (1.0f - s)*ezi;
+  for(int c=0; c<3; c++) {
+    tb.ae[c].assign(rg.size(), 1.0f);
+    tb.be[c].assign(rg.size(), 0.0f);
+  }
 
-        //--------------------------------------------------
-        // epar; ver 2 with interpolation
-        //float exi, eyi, ezi, bxi, byi, bzi, b2, eparb;
-
-        //const size_t iy = D >= 2 ? gs.ex.indx(0,1,0) - gs.ex.indx(0,0,0) : 0;
-        //const size_t iz = D >= 3 ? gs.ex.indx(0,0,1) - gs.ex.indx(0,0,0) : 0;
-        //const size_t ind = gs.ex.indx(i,j,k);
-
-        //// ex
-        //exi = gs.ex(ind);
-        //eyi = 0.25 *(gs.ey(ind)    + gs.ey(ind+1)     + gs.ey(ind-iy)      + gs.ey(ind+1-iy));
-        //ezi = 0.25 *(gs.ez(ind)    + gs.ez(ind+1)     + gs.ez(ind-iz)      + gs.ez(ind+1-iz));
-
-        //bxi = 0.125*(gs.bx(ind)    + gs.bx(ind-iy)    + gs.bx(ind+1-iy)    + gs.bx(ind+1) +
-        //             gs.bx(ind-iz) + gs.bx(ind-iy-iz) + gs.bx(ind+1-iy-iz) + gs.bx(ind+1-iz));
-        //byi = 0.5 * (gs.by(ind)    + gs.by(ind-iz));
-        //bzi = 0.5 * (gs.bz(ind)    + gs.bz(ind-iy));
-
-        //b2  = bxi*bxi + byi*byi + bzi*bzi + EPS;
-        //eparb = exi*bxi + eyi*byi + ezi*bzi;
-        //auto exnew = exi-eparb*bxi/b2;
-
-        //gs.ex(i,j,k) = s*exnew + (1.0f - s)*exi;
-
-        ////--------------------------------------------------
-        //// ey
-        //exi = 0.25 * (gs.ex(ind)    + gs.ex(ind-1)    + gs.ex(ind+iy)      + gs.ex(ind-1+iy));
-        //eyi =         gs.ey(ind);
-        //ezi = 0.25 * (gs.ez(ind)    + gs.ez(ind+iy)   + gs.ez(ind-iz)      + gs.ez(ind+iy-iz));
-
-        //bxi = 0.5 * ( gs.bx(ind)    + gs.bx(ind-iz));
-        //byi = 0.125*( gs.by(ind)    + gs.by(ind-1)    + gs.by(ind-1+iy)    + gs.by(ind+iy) +
-        //              gs.by(ind-iz) + gs.by(ind-1-iz) + gs.by(ind-1+iy-iz) + gs.by(ind+iy-iz));
-        //bzi = 0.5 * ( gs.bz(ind)    + gs.bz(ind-1));
-
-        //b2  = bxi*bxi + byi*byi + bzi*bzi + EPS;
-        //eparb = exi*bxi + eyi*byi + ezi*bzi;
-        //auto eynew = eyi-eparb*byi/b2;
-        //gs.ey(i,j,k) = s*eynew + (1.0f - s)*eyi;
-
-        ////--------------------------------------------------
-        ////ez
-        //exi = 0.25 * (gs.ex(ind)    + gs.ex(ind-1)   +  gs.ex(ind+iz)      + gs.ex(ind-1+iz ));
-        //eyi = 0.25 * (gs.ey(ind)    + gs.ey(ind-iy)  +  gs.ey(ind+iz)      + gs.ey(ind-iy+iz));
-        //ezi =         gs.ez(ind);
-
-        //bxi = 0.5 * ( gs.bx(ind)    + gs.bx(ind-iy));
-        //byi = 0.5 * ( gs.by(ind)    + gs.by(ind-1));
-        //bzi = 0.125*( gs.bz(ind)    + gs.bz(ind-1)    + gs.bz(ind-1-iy)    + gs.bz(ind-iy) + 
-        //              gs.bz(ind+iz) + gs.bz(ind-1+iz) + gs.bz(ind-1-iy+iz) + gs.bz(ind-iy+iz));
-
-        //b2  = bxi*bxi + byi*byi + bzi*bzi + EPS;
-        //eparb = exi*bxi + eyi*byi + ezi*bzi;
-        //auto eznew = ezi - eparb*bzi/b2;
-        //gs.ez(i,j,k) = s*eznew + (1.0f - s)*ezi;
+  const float delta_ext = 0.25f*rg.tile_len; // 1/4 of tile size
+  const float radius_top = (D==1) ? Nx - 0.5*rg.tile_len : (D==2) ? Ny - 0.5*rg.tile_len : Nz - 0.5*rg.tile_len;
+  const float radius_bot = 0.5*rg.tile_len;
 
-  }}}
+  for(int k=rg.kmin; k<rg.kmax; k++) 
+  for(int j=rg.jmin; j<rg.jmax; j++) 
+  for(int i=rg.imin; i<rg.imax; i++) {
 
-  } // end of D>=2
+    // global grid coordinates
+    const float iglob = (D>=1) ? i + mins[0] : 0;
+    const float jglob = (D>=2) ? j + mins[1] : 0;
+    const float kglob = (D>=3) ? k + mins[2] : 0;
 
+    const auto h = (D==1) ? iglob : (D==2) ? jglob : kglob; // height
 
+    auto rvec = coord.mid().vec(iglob, jglob, kglob, D); // cartesian position vector in "star's coordinates"
+    const auto rcyl = (D==1) ? 0.0f : (D==2) ? norm1d(rvec) : norm2d(rvec); // cylindrical radius
 
-  //--------------------------------------------------
-  // TODO this is not a bulletproof method to find if the star is inside tile;
-  //      if a small star is in the middle of the tile it can be missed...
-  bool inside_star = 
-    norm(x1) < 1.1*radius ||
-    norm(x2) < 1.1*radius ||
-    norm(x3) < 1.1*radius ||
-    norm(x4) < 1.1*radius ||
-    norm(x5) < 1.1*radius ||
-    norm(x6) < 1.1*radius ||
-    norm(x7) < 1.1*radius ||
-    norm(x8) < 1.1*radius;
-
-  if( inside_star && (D == 1) ) {
+    const bool in_box = box && inside_box_bcs(*this, rg, iglob, jglob, kglob);
+    const size_t q = rg.index(i,j,k);
 
-    #pragma omp simd
-    for(int i=imin; i<imax; i++) {
+    for(int c=0; c<3; c++) {
 
-      // global grid coordinates
-      const float iglob = (D>=1) ? i + mins[0] : 0;
-                                   
-      // rotating electric field inside star
-      auto r  = coord.ex().vec(iglob, 0.0f, 0.0f, D); // cartesian position vector in "star's coordinates"
-      auto bd = B0*dipole(r); // dipole field
-      auto h  = abs(r(0)); // cylindrical coordinate system height
-                             
-      auto s  = shape( h, radius + 1.0f, delta); // height smoothing parameter
-      //auto s  = h < radius + 4 ? 1.0f : 0.0f; // step function; field inside star h < r_*
-      //auto s  = h > radius + 4 ? 1.0f : 0.0f; // step function; field outside star h > r_*
-                                   
+      // composition of blends f <- s*f0 + (1-s)*f
+      float a = 1.0f, b = 0.0f;
+      auto add_blend = [&](float s, float f0) { 
+        a = (1.0f - s)*a; 
+        b = (1.0f - s)*b + s*f0; 
+      };
 
       //--------------------------------------------------
-      // special mode to set constant background field in 1D
-      //if( (D == 1) && set_const_b ) { // get value of the dipole at r=R
-      //  auto r1_left = coord.bx().vec(0, 0, 0, D); // cartesian position vector in "star's coordinates"
-      //  bd = B0*dipole(r1_left); // dipole field at r=R
-      //}
-      //float vrot = Om(0)*radius_pc/c; //r1(0); // Omega x r_pc
-      //float erot = 1.0f*vrot*bd(0); //-v x B
-
-      const float erot1 = 0.0f; // erot; // B_\parallel direction
-      const float erot2 = 0.0f; 
-      const float erot3 = 0.0f;
+      // inside star
+      if( rg.inside_star && (D == 1) ) {
 
-      //--------------------------------------------------
-      // blending of old + new solution
-      gs.ex(i,0,0) = s*erot1 + (1.0f - s)*gs.ex(i,0,0); 
-      gs.ey(i,0,0) = s*erot2 + (1.0f - s)*gs.ey(i,0,0); 
-      gs.ez(i,0,0) = s*erot3 + (1.0f - s)*gs.ez(i,0,0); 
-    }
+        // TODO rotating electric field inside star; set to zero
+        auto r  = coord.ex().vec(iglob, 0.0f, 0.0f, D); // cartesian position vector in "star's coordinates"
+        auto hr = abs(r(0)); // cylindrical coordinate system height
+        add_blend( shape( hr, radius + 1.0f, delta), 0.0f ); // height smoothing parameter
 
+      } else if( rg.inside_star && (D >= 2) ) {
 
-  } else if( inside_star && (D>=2) ) {
+        const float offs = delta_pc; // expanded polar cap
 
-    #pragma omp parallel for
-    for(int k=kmin; k<kmax; k++) {
-      for(int j=jmin; j<jmax; j++) {
-        #pragma omp simd
-        for(int i=imin; i<imax; i++) {
-
-          // global grid coordinates
-          const float iglob = (D>=1) ? i + mins[0] : 0;
-          const float jglob = (D>=2) ? j + mins[1] : 0;
-          const float kglob = (D>=3) ? k + mins[2] : 0;
-
-          const float offs = delta_pc; // expanded polar cap
-
-          //--------------------------------------------------
-          // ex
-          auto r1  = coord.ex().vec(iglob, jglob, kglob, D); // cartesian position vector in "star's coordinates"
-          auto bxd = B0*dipole(r1); // dipole field
-          auto h1  = abs(r1(D-1)); // cylindrical coordinate system height
-          //auto sx  = shape( norm(r1), radius, delta); // radial smoothing parameter
-          auto sx  = shape( h1, radius, delta); // height smoothing parameter
-                                                             
-          auto rcyl1 = (D==1) ? 0.0f : (D==2) ? norm1d(r1) : norm2d(r1); // cylindrical radius
-          sx        *= shape(rcyl1, radius_pc + offs, delta_pc); // damp off edges of polar cap
-                                                             
-          auto vrot1 = cross(Om, r1); // Omega x r
-          auto erot1 = -1.0f*cross(vrot1, bxd); //-v x B
-
-
-          //--------------------------------------------------
-          // ey
-          auto r2  = coord.ey().vec(iglob, jglob, kglob, D); // cartesian position vector in "star's coordinates"
-          auto byd = B0*dipole(r2); // dipole field
-          auto h2  = abs(r2(D-1)); // cylindrical coordinate system height
-
-          auto sy  = shape( h2, radius, delta); // height smoothing parameter
-
-          auto rcyl2 = (D==1) ? 0.0f : (D==2) ? norm1d(r2) : norm2d(r2); // cylindrical radius
-          sy        *= shape(rcyl2, radius_pc + offs, delta_pc); // damp off edges of polar cap
-
-          auto vrot2 = cross(Om, r2); // Omega x r
-          auto erot2 = -1.0f*cross(vrot2, byd); //-v x B
-
-
-          //--------------------------------------------------
-          // ez
-          auto r3  = coord.ez().vec(iglob, jglob, kglob, D); // cartesian position vector in "star's coordinates"
-          auto bzd = B0*dipole(r3); // dipole field
-          auto h3  = abs(r3(D-1)); // cylindrical coordinate system height
-          //auto sz  = shape( norm(r3), radius, delta); // radial smoothing parameter
-          auto sz  = shape( h3, radius, delta); // height smoothing parameter
-                                                             
-          auto rcyl3 = (D==1) ? 0.0f : (D==2) ? norm1d(r3) : norm2d(r3); // cylindrical radius
-          sz        *= shape(rcyl3, radius_pc + offs, delta_pc); // damp off edges of polar cap
-                                                             
-          auto vrot3 = cross(Om, r3); // Omega x r
-          auto erot3 = -1.0f*cross(vrot3, bzd); //-v x B
-
-
-          //--------------------------------------------------
-          // blending of old + new solution
-          gs.ex(i,j,k) = sx*erot1(0) + (1.0f - sx)*gs.ex(i,j,k); 
-          gs.ey(i,j,k) = sy*erot2(1) + (1.0f - sy)*gs.ey(i,j,k); 
-          gs.ez(i,j,k) = sz*erot3(2) + (1.0f - sz)*gs.ez(i,j,k); 
-
-    }}}
-  }
-
-  //--------------------------------------------------
-  // damping on a cylindrical region around the pcap
-    
-  // norm2d gives the length of the vector x and y components (ignoring z)
-  // this gives us the cylindrical coordinate
-    
-                              
-  bool inside_cyl_bcs = false;
-  float rbox = 0.0;
-
-  if(D == 2) {
-    rbox = 0.5*Nx - 0.5*tile_len; // half of box - half tile
-                                        
-    inside_cyl_bcs = 
-      norm1d(x1) > rbox || norm1d(x2) > rbox || norm1d(x3) > rbox || norm1d(x4) > rbox ||
-      norm1d(x5) > rbox || norm1d(x6) > rbox || norm1d(x7) > rbox || norm1d(x8) > rbox;
-  } else if(D == 3) {
-    rbox = 0.5*Nx-H-1; // half of box size in x direction (not incl halos)
-
-    inside_cyl_bcs = 
-      norm2d(x1) > rbox || norm2d(x2) > rbox || norm2d(x3) > rbox || norm2d(x4) > rbox ||
-      norm2d(x5) > rbox || norm2d(x6) > rbox || norm2d(x7) > rbox || norm2d(x8) > rbox;
-  }
+        auto r  = c == 0 ? coord.ex().vec(iglob, jglob, kglob, D) :
+                  c == 1 ? coord.ey().vec(iglob, jglob, kglob, D) :
+                           coord.ez().vec(iglob, jglob, kglob, D);
+        auto bd = B0*dipole(r); // dipole field
+        auto hr = abs(r(D-1)); // cylindrical coordinate system height
+        auto s  = shape( hr, radius, delta); // height smoothing parameter
 
+        auto rcyl_c = (D==2) ? norm1d(r) : norm2d(r); // cylindrical radius
+        s *= shape(rcyl_c, radius_pc + offs, delta_pc); // damp off edges of polar cap
 
-  if( (D>=2) && inside_cyl_bcs ) {
-
-    #pragma omp parallel for
-    for(int k=kmin; k<kmax; k++) {
-      for(int j=jmin; j<jmax; j++) {
-        #pragma omp simd
-        for(int i=imin; i<imax; i++) {
-
-          // global grid coordinates
-          float iglob = (D>=1) ? i + mins[0] : 0;
-          float jglob = (D>=2) ? j + mins[1] : 0;
-          float kglob = (D>=3) ? k + mins[2] : 0;
-
-          //--------------------------------------------------
-          auto rvec = coord.mid().vec(iglob, jglob, kglob, D); // cartesian position vector in "star's coordinates"
-          auto rcyl = (D == 2) ? norm1d(rvec) : norm2d(rvec); // cylindrical radius
-
-          //--------------------------------------------------
-          // ver 1; tanh profile
-          auto delta_ext = 0.25f*tile_len; // 1/4 of tile size
-          auto s = shape(rcyl, rbox, delta_ext); 
-
-          // ver2 linear profile
-          //float radius_ext = (D == 2) ? Ny - tile_len : Nz - tile_len;
-          //float delta_ext = 1.0*tile_len; // full tile size
-          //s = 1.0f - std::max(0.0f, std::min(1.0f, (h-radius_ext)/delta_ext) ); //RELU
-
-          //ver 3; mimic lambda profile from PML
-          //float lam = pow( (h - radius_ext)/(1.0 - radius_ext), 3);
-          //s = min(1.0f, lam);
-
-          //ver 4; exp profile
-          //float radius_ext = rbox;
-          //s = 1.0f - min(1.0, exp( (rcyl-radius_ext)/(3.0*tile_len) ) );
-
-          //--------------------------------------------------
-          // damp to vacuum
-          gs.ex(i,j,k) = s*gs.ex(i,j,k) + (1.0f-s)*0.0f;
-          gs.ey(i,j,k) = s*gs.ey(i,j,k) + (1.0f-s)*0.0f;
-          gs.ez(i,j,k) = s*gs.ez(i,j,k) + (1.0f-s)*0.0f;
-    }}}
-  }
+        auto vrot = cross(Om, r); // Omega x r
+        auto erot = -1.0f*cross(vrot, bd); //-v x B
 
-  //--------------------------------------------------
-  // inside top
+        add_blend(s, erot(c));
+      }
 
-  if(top) {
+      //--------------------------------------------------
+      // damp to vacuum on a cylindrical region around the pcap
+      if( (D>=2) && rg.inside_cyl_bcs ) add_blend( 1.0f - shape(rcyl, rg.rbox, delta_ext), 0.0f );
 
-    #pragma omp parallel for
-    for(int k=kmin; k<kmax; k++) {
-      for(int j=jmin; j<jmax; j++) {
-        #pragma omp simd
-        for(int i=imin; i<imax; i++) {
+      // top absorbing layer
+      if(rg.top) add_blend( 1.0f - shape(h, radius_top, delta_ext), 0.0f );
 
-          // global grid coordinates
-          const float iglob = (D>=1) ? i + mins[0] : 0;
-          const float jglob = (D>=2) ? j + mins[1] : 0;
-          const float kglob = (D>=3) ? k + mins[2] : 0;
+      // bottom absorbing layer outside star
+      if( rg.bot && (D>=2) ) {
+        float s = 1.0 - shape(h, radius_bot, delta_ext); // tanh
+        if( rcyl < 1.5*radius_pc ) s = 1.0f; // act normal inside star
+        add_blend( 1.0f - s, 0.0f );
+      }
 
-          const auto h = (D==1) ? iglob : (D==2) ? jglob : kglob; // height
+      // box boundaries
+      if(in_box) add_blend(1.0f, 0.0f);
 
-          //--------------------------------------------------
-          // ver 1; tanh profile
-          const float radius_ext = (D==1) ? Nx - 0.5*tile_len : (D==2) ? Ny - 0.5*tile_len : Nz - 0.5*tile_len;
-          const float delta_ext = 0.25*tile_len; // 1/4 of tile size
-          const auto s = shape(h, radius_ext, delta_ext); // tanh
+      tb.ae[c][q] = a;
+      tb.be[c][q] = b;
+    }
+  }
+}
 
-          // ver2 linear profile
-          //float radius_ext = (D == 2) ? Ny - tile_len : Nz - tile_len;
-          //float delta_ext = 1.0*tile_len; // full tile size
-          //s = 1.0f - std::max(0.0f, std::min(1.0f, (h-radius_ext)/delta_ext) ); //RELU
 
-          //ver 3; mimic lambda profile from PML
-          //float lam = pow( (h - radius_ext)/(1.0 - radius_ext), 3);
-          //s = min(1.0f, lam);
+template<size_t D>
+void emf::Conductor<D>::update_b(
+    emf::Tile<D>& tile)
+{
+  auto& tb = get_tables(tile);
+  if(!tb.active_b) return;
 
-          //ver 4; exp profile
-          //float radius_ext = (D == 2) ? Ny - H : Nz - H;
-          //auto s = 1.0f - min(1.0, exp( (h-radius_ext)/(3.0*tile_len) ) );
+  auto rg = region(*this, tile);
+  auto& gs = tile.get_grids();
 
+  blend(gs.bx, tb.ab[0], tb.bb[0], rg);
+  blend(gs.by, tb.ab[1], tb.bb[1], rg);
+  blend(gs.bz, tb.ab[2], tb.bb[2], rg);
+}
 
-          //--------------------------------------------------
-          // damp to vacuum
-          gs.ex(i,j,k) = s*gs.ex(i,j,k) + (1.0f-s)*0.0f;
-          gs.ey(i,j,k) = s*gs.ey(i,j,k) + (1.0f-s)*0.0f;
-          gs.ez(i,j,k) = s*gs.ez(i,j,k) + (1.0f-s)*0.0f;
 
-    }}}
-  }
+template<size_t D>
+void emf::Conductor<D>::update_e(
+    emf::Tile<D>& tile)
+{
+  auto& tb = get_tables(tile);
+  auto& gs = tile.get_grids();
 
+  // tile lengths
+  const int nx_tile = (D>=1) ? tile.mesh_lengths[0] : 1;
+  const int ny_tile = (D>=2) ? tile.mesh_lengths[1] : 1;
+  const int nz_tile = (D>=3) ? tile.mesh_lengths[2] : 1;
 
   //--------------------------------------------------
-  // inside bottom / outside star
-  if( bot && (D>=2) ) { // only for D=2,3
+  // null epar in the closed field line region; only for D=2 and 3
+  if( D >= 2 ) { 
 
-    #pragma omp parallel for
-    for(int k=kmin; k<kmax; k++) {
-      for(int j=jmin; j<jmax; j++) {
-        #pragma omp simd
-        for(int i=imin; i<imax; i++) {
-
-          // global grid coordinates
-          const float iglob = (D>=1) ? i + mins[0] : 0;
-          const float jglob = (D>=2) ? j + mins[1] : 0;
-          const float kglob = (D>=3) ? k + mins[2] : 0;
+  #pragma omp parallel for
+  for(int k=0; k<nz_tile; k++) {
+    for(int j=0; j<ny_tile; j++) {
+      const float* sp = tb.s_epar.data() + nx_tile*(j + ny_tile*k);
 
-          auto rvec = coord.mid().vec(iglob, jglob, kglob, D); // cartesian position vector in "star's coordinates"
-          const auto h = (D==1) ? iglob : (D==2) ? jglob : kglob; // height
-          const auto rcyl = (D==1) ? 0.0f : (D==2) ? norm1d(rvec) : norm2d(rvec); // cylindrical radius
+      #pragma omp simd
+      for(int i=0; i<nx_tile; i++) {
+        const float s = sp[i];
 
-          //--------------------------------------------------
-          // ver 1; tanh profile
-          const float radius_ext = 0.5*tile_len;
-          const float delta_ext = 0.25*tile_len; // 1/4 of tile size
-          auto s = 1.0 - shape(h, radius_ext, delta_ext); // tanh
+        auto exi = gs.ex(i,j,k);
+        auto eyi = gs.ey(i,j,k);
+        auto ezi = gs.ez(i,j,k);
 
-          if( rcyl < 1.5*radius_pc ) s = 1.0f; // act normal inside star
+        auto bxi = gs.bx(i,j,k);
+        auto byi = gs.by(i,j,k);
+        auto bzi = gs.bz(i,j,k);
+        auto bn  = std::sqrt( bxi*bxi + byi*byi + bzi*bzi ) + EPS;
 
-          //--------------------------------------------------
-          // damp to vacuum
-          gs.ex(i,j,k) = s*gs.ex(i,j,k) + (1.0f-s)*0.0f;
-          gs.ey(i,j,k) = s*gs.ey(i,j,k) + (1.0f-s)*0.0f;
-          gs.ez(i,j,k) = s*gs.ez(i,j,k) + (1.0f-s)*0.0f;
-    }}}
+        // E_\parallel
+        auto epar = (exi*bxi + eyi*byi + ezi*bzi)/bn;
 
-  }
+        //--------------------------------------------------
+        // take out eparallel component from electric field
+        auto exnew = exi - epar*bxi/bn;
+        auto eynew = eyi - epar*byi/bn;
+        auto eznew = ezi - epar*bzi/bn;
 
+        // blend solution in with a smoothing function
+        gs.ex(i,j,k) = s*exnew + (1.0f - s)*exi;
+        gs.ey(i,j,k) = s*eynew + (1.0f - s)*eyi;
+        gs.ez(i,j,k) = s*eznew + (1.0f - s)*ezi;
+  }}}
 
+  } // end of D>=2
 
   //--------------------------------------------------
-  // box boundaries
-
-  // TODO optimize for 1D where -3,-2,-1 and nx-3,-2,-1 values can be set manually much faster
-
-  if( left  ||
-      right || 
-      front ||
-      back  ||
-      bot   ||
-      top
-    ){
+  // co-rotating field inside star and damping to vacuum at the boundaries
+  if(!tb.active_e) return;
 
-    #pragma omp parallel for
-    for(int k=kmin; k<kmax; k++) {
-      for(int j=jmin; j<jmax; j++) {
-        #pragma omp simd
-        for(int i=imin; i<imax; i++) {
-
-          // global grid coordinates
-          float iglob = (D>=1) ? i + mins[0] : 0;
-          float jglob = (D>=2) ? j + mins[1] : 0;
-          float kglob = (D>=3) ? k + mins[2] : 0;
-
-          //--------------------------------------------------
-          // sides
-          bool inside_bot   = (D==1) ? iglob < H    : (D==2) ? jglob < H    : kglob < H; // y or z direction flip 
-          bool inside_top   = (D==1) ? iglob > Nx-1 : (D==2) ? jglob > Ny-1 : kglob > Nz-1; // y or z direction flip 
-
-          bool inside_left  = left  && iglob < H; 
-          bool inside_right = right && iglob > Nx-H-1; 
-
-          bool inside_front = front && jglob < H; 
-          bool inside_back  = back  && jglob > Ny-H-1; 
-
-          // cartesian boundaries
-          bool inside_box_bcs = inside_left  ||
-                                inside_right ||
-                                inside_front ||
-                                inside_back  ||
-                                inside_top   ||
-                                inside_bot;
-
-          //--------------------------------------------------
-          // vector friendly application of boolean boundary
-          auto s = static_cast<float>(inside_box_bcs);
-
-          //--------------------------------------------------
-          // damp to vacuum
-          gs.ex(i,j,k) = s*0.0f + (1.0f - s)*gs.ex(i,j,k);
-          gs.ey(i,j,k) = s*0.0f + (1.0f - s)*gs.ey(i,j,k);
-          gs.ez(i,j,k) = s*0.0f + (1.0f - s)*gs.ez(i,j,k);
-
-    }}}
-  }
+  auto rg = region(*this, tile);
 
+  blend(gs.ex, tb.ae[0], tb.be[0], rg);
+  blend(gs.ey, tb.ae[1], tb.be[1], rg);
+  blend(gs.ez, tb.ae[2], tb.be[2], rg);
 }
 
 
-
 // current from moving frame
 template<size_t D>
 void emf::Conductor<D>::update_j(
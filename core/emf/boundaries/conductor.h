@@ -1,5 +1,9 @@
 #pragma once
 
+#include <array>
+#include <map>
+#include <vector>
+
 #include "core/emf/tile.h"
 #include "definitions.h"
 #include "tools/vector.h"
@@ -58,6 +62,44 @@ class Conductor
   void update_e(emf::Tile<D>&  tile);
 
   void update_j(emf::Tile<D>&  tile);
+
+  /// drop the cached boundary tables of all tiles
+  void clear_cache() { tables.clear(); }
+
+  private:
+
+  /*! \brief cached boundary update of one tile
+   *
+   * All blends of update_b (update_e after the E_par removal) towards the
+   * dipole (co-rotating) solution are of the form f <- s*f_0 + (1-s)*f with
+   * static s and f_0, so their composition is f <- a*f + b per cell and
+   * component. The tables are rebuilt only when one of the parameters or
+   * the tile changes (e.g. phase_mu or phase_om); otherwise an update is
+   * one multiply-add per cell. Tiles that are not on any boundary keep
+   * only the E_par smoothing weights.
+   */
+  struct Tables {
+    std::vector<float> params; // parameters the tables were built with
+
+    bool active_b = false;
+    bool active_e = false;
+
+    // a and b of each component over the tile incl. halos
+    std::array<std::vector<float>, 3> ab, bb, ae, be;
+
+    // smoothing weight of the E_par removal over the tile interior
+    std::vector<float> s_epar;
+  };
+
+  /// tables of each tile (by cid)
+  std::map<uint64_t, Tables> tables;
+
+  /// tables of the tile; rebuilt if needed
+  Tables& get_tables(emf::Tile<D>& tile);
+
+  void build_b(emf::Tile<D>& tile, Tables& tb);
+
+  void build_e(emf::Tile<D>& tile, Tables& tb);
 };
 
 
@@ -1,3 +1,5 @@
+#include <cmath>
+
 #include "core/emf/boundaries/damping_tile.h"
 
 
@@ -26,7 +28,7 @@ using std::exp;
 //}
 
 
-/// Damp EM field into the reference field
+/// Build the 1D damping profile of the tile
 //
 // Combined directions:
 //
@@ -42,114 +44,190 @@ template<
   std::size_t D, 
   int S
 >
-void emf::damping::Tile<D,S>::damp_fields()
+bool emf::damping::Tile<D,S>::prepare_profile()
 {
+  const int a = abs(S) - 1; // damping direction
+  const std::array<double, 4> key = {{fld1, fld2, ksupp, emf::Tile<D>::mins[a]}};
 
-  auto& gs = this->get_grids();
-
-  float lambda2;
+  if(key == prof_key) return (fhi > flo) || (phi > plo);
 
   bool left  = S < 0;
   bool right = S > 0;
-    
-  bool xdir  = abs(S) == 1;
-  bool ydir  = abs(S) == 2;
-  bool zdir  = abs(S) == 3;
 
   // fixed position
   const int halo = 3; 
+  const int n = emf::Tile<D>::mesh_lengths[a];
 
-  int istr = 0;
-  int ifin = emf::Tile<D>::mesh_lengths[0];
-
-  int jstr = 0;
-  int jfin = emf::Tile<D>::mesh_lengths[1];
+  prof_t1.assign(n + 2*halo, 1.0f);
+  prof_t2.assign(n + 2*halo, 0.0f);
 
-  int kstr = 0;
-  int kfin = emf::Tile<D>::mesh_lengths[2];
+  flo = fhi = plo = phi = 0;
 
-  // reset also halo regions
-  if(D >= 1) istr -= halo;
-  if(D >= 1) ifin += halo;
+  // extend [lo, hi) to cover q; zones are continuous along the axis
+  auto extend = [](int& lo, int& hi, int q) {
+    if(hi <= lo) lo = q;
+    hi = q + 1;
+  };
 
-  if(D >= 2) jstr -= halo;
-  if(D >= 2) jfin += halo;
-
-  if(D >= 3) kstr -= halo;
-  if(D >= 3) kfin += halo;
-
-
-  float iglob, jglob, kglob, glob_coord;
+  float lambda2, glob_coord;
   float t1, t2;
 
-  bool inside_damping_zone = false;
+  // profile over the cells incl. halo regions
+  for(int q=-halo; q<n+halo; q++) {
+    glob_coord = (float)q + emf::Tile<D>::mins[a];
 
-  // loop over all values in mesh
-  for(int k=kstr; k<kfin; k++) {
-    kglob = (float)k + emf::Tile<D>::mins[2];
+    bool inside_damping_zone = false;
 
-    for(int j=jstr; j<jfin; j++) {
-      jglob = (float)j + emf::Tile<D>::mins[1];
+    // left direction; 
+    // fld1 < x < fld2 | <- incoming wave
+    // <<< << <
+    if(left  && ((glob_coord >= fld1) && (glob_coord < fld2))) {
+      lambda2 = ksupp*pow(1.*(fld2-glob_coord)/(fld2-fld1), 3); 
+      //lambda  = (1.0 - 0.5*lambda1)/(1.0 + 0.5*lambda1); //second order
+      inside_damping_zone = true;
 
-      for(int i=istr; i<ifin; i++) {
-        iglob = (float)i + emf::Tile<D>::mins[0];
+      t1 = exp(-lambda2);
+      t2 = 1.0-exp(-lambda2);
+    }
 
-        inside_damping_zone = false;
+    // right direction; 
+    // incoming wave -> | fld2 < x < fld1 
+    // > >> >>>
+    if(right && ((glob_coord <= fld1) && (glob_coord > fld2))) {
+      lambda2 = ksupp*pow(1.*(fld1-glob_coord)/(fld1-fld2), 3);
+      //lambda  = (1.0 - 0.5*lambda1)/(1.0 + 0.5*lambda1); //second order
+      inside_damping_zone = true;
 
-        // select active coordinate to reference against
-        if(xdir) glob_coord = iglob;
-        if(ydir) glob_coord = jglob;
-        if(zdir) glob_coord = kglob;
+      t1 = 1.0-exp(-lambda2);
+      t2 = exp(-lambda2);
+    }
 
-        // left direction; 
-        // fld1 < x < fld2 | <- incoming wave
-        // <<< << <
-        if(left  && ((glob_coord >= fld1) && (glob_coord < fld2))) {
-          lambda2 = ksupp*pow(1.*(fld2-glob_coord)/(fld2-fld1), 3); 
-          //lambda  = (1.0 - 0.5*lambda1)/(1.0 + 0.5*lambda1); //second order
-          inside_damping_zone = true;
+    // fully damped to reference; behind the damping zone
+    if ( (left &&  (glob_coord <= fld1)) 
+      || (right && (glob_coord >  fld1)) ) {
+      extend(flo, fhi, q);
+      prof_t1[q+halo] = 0.0f;
+      prof_t2[q+halo] = 1.0f;
+    } else if(inside_damping_zone) {
+      extend(plo, phi, q);
+      prof_t1[q+halo] = t1;
+      prof_t2[q+halo] = t2;
+    }
+  }
 
-          t1 = exp(-lambda2);
-          t2 = 1.0-exp(-lambda2);
-        }
+  prof_key = key;
 
-        // right direction; 
-        // incoming wave -> | fld2 < x < fld1 
-        // > >> >>>
-        if(right && ((glob_coord <= fld1) && (glob_coord > fld2))) {
-          lambda2 = ksupp*pow(1.*(fld1-glob_coord)/(fld1-fld2), 3);
-          //lambda  = (1.0 - 0.5*lambda1)/(1.0 + 0.5*lambda1); //second order
-          inside_damping_zone = true;
+  return (fhi > flo) || (phi > plo);
+}
 
-          t1 = 1.0-exp(-lambda2);
-          t2 = exp(-lambda2);
-        }
 
-        if(inside_damping_zone){
-            gs.ex(i,j,k) = t1*gs.ex(i,j,k) + t2*ex_ref(i,j,k);
-            gs.ey(i,j,k) = t1*gs.ey(i,j,k) + t2*ey_ref(i,j,k);
-            gs.ez(i,j,k) = t1*gs.ez(i,j,k) + t2*ez_ref(i,j,k);
+/// f = t1*f + t2*f_ref in the partially damped zone and f = f_ref behind it;
+//  rows along x are contiguous so the inner loops vectorize
+template<
+  std::size_t D, 
+  int S
+>
+void emf::damping::Tile<D,S>::damp_box(
+    std::array<int,3> lo, 
+    std::array<int,3> hi, 
+    bool efield, 
+    bool bfield)
+{
+  auto& gs = this->get_grids();
 
-            gs.bx(i,j,k) = t1*gs.bx(i,j,k) + t2*bx_ref(i,j,k);
-            gs.by(i,j,k) = t1*gs.by(i,j,k) + t2*by_ref(i,j,k);
-            gs.bz(i,j,k) = t1*gs.bz(i,j,k) + t2*bz_ref(i,j,k);
-        }
+  const int a = abs(S) - 1; // damping direction
+  const int halo = 3; 
 
-        // fully damped to reference; behind the damping zone
-        if ( (left &&  (glob_coord <= fld1)) 
-          || (right && (glob_coord >  fld1)) ) {
-          gs.ex(i,j,k) = ex_ref(i,j,k);
-          gs.ey(i,j,k) = ey_ref(i,j,k);
-          gs.ez(i,j,k) = ez_ref(i,j,k);
+  std::array<toolbox::Mesh<float,3>*, 6> flds, refs;
+  int nf = 0;
+  if(efield) {
+    flds[nf] = &gs.ex; refs[nf++] = &ex_ref;
+    flds[nf] = &gs.ey; refs[nf++] = &ey_ref;
+    flds[nf] = &gs.ez; refs[nf++] = &ez_ref;
+  }
+  if(bfield) {
+    flds[nf] = &gs.bx; refs[nf++] = &bx_ref;
+    flds[nf] = &gs.by; refs[nf++] = &by_ref;
+    flds[nf] = &gs.bz; refs[nf++] = &bz_ref;
+  }
 
-          gs.bx(i,j,k) = bx_ref(i,j,k);
-          gs.by(i,j,k) = by_ref(i,j,k);
-          gs.bz(i,j,k) = bz_ref(i,j,k);
+  for(int zone=0; zone<2; zone++) {
+    const bool full = zone == 0;
+
+    // limit the box to the cells of the zone
+    std::array<int,3> l = lo, h = hi;
+    l[a] = std::max(lo[a], full ? flo : plo);
+    h[a] = std::min(hi[a], full ? fhi : phi);
+    if(h[a] <= l[a]) continue;
+
+    const int nx = h[0] - l[0];
+
+    for(int c=0; c<nf; c++) {
+      for(int k=l[2]; k<h[2]; k++) {
+        for(int j=l[1]; j<h[1]; j++) {
+          float* f = &(*flds[c])(l[0], j, k);
+          const float* r = &(*refs[c])(l[0], j, k);
+
+          if(full) {
+            #pragma omp simd
+            for(int i=0; i<nx; i++) f[i] = r[i];
+          } else if(a == 0) {
+            const float* t1 = prof_t1.data() + l[0] + halo;
+            const float* t2 = prof_t2.data() + l[0] + halo;
+
+            #pragma omp simd
+            for(int i=0; i<nx; i++) f[i] = t1[i]*f[i] + t2[i]*r[i];
+          } else {
+            const int q = (a == 1 ? j : k) + halo;
+            const float t1 = prof_t1[q];
+            const float t2 = prof_t2[q];
+
+            #pragma omp simd
+            for(int i=0; i<nx; i++) f[i] = t1*f[i] + t2*r[i];
+          }
         }
       }
     }
   }
+}
+
+
+/// Damp EM field into the reference field
+template<
+  std::size_t D, 
+  int S
+>
+void emf::damping::Tile<D,S>::damp_fields()
+{
+  if(!prepare_profile()) return;
+
+  // reset also halo regions
+  const int halo = 3; 
+  std::array<int,3> lo, hi;
+  for(size_t a=0; a<3; a++) {
+    lo[a] = a < D ? -halo : 0;
+    hi[a] = a < D ? emf::Tile<D>::mesh_lengths[a] + halo : 1;
+  }
+
+  damp_box(lo, hi, true, true);
+}
+
+
+/// Damp the interior of one plane of the last dimension; used by the fused
+//  E update of the propagators
+template<
+  std::size_t D, 
+  int S
+>
+void emf::damping::Tile<D,S>::damp_plane(int t, bool efield, bool bfield)
+{
+  std::array<int,3> lo = {0, 0, 0}, hi;
+  for(size_t a=0; a<3; a++) hi[a] = a < D ? emf::Tile<D>::mesh_lengths[a] : 1;
+
+  lo[D-1] = t;
+  hi[D-1] = t + 1;
 
+  damp_box(lo, hi, efield, bfield);
 }
 
 
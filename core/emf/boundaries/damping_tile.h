@@ -2,6 +2,9 @@
 
 #include <type_traits>
 #include <algorithm>
+#include <array>
+#include <limits>
+#include <vector>
 
 #include "core/emf/tile.h"
 
@@ -10,15 +13,40 @@ namespace emf {
   namespace damping {
 
 
+/// Direction independent interface of the damping tiles; used by the field 
+//  propagators to damp in the same sweep as the E update (push_e_damped)
+template<std::size_t D>
+class Layer
+{
+  public:
+
+  virtual ~Layer() = default;
+
+  /// damping is left to push_e_damped of the propagator instead of damp_fields
+  bool fused_damping = false;
+
+  /// (re)build the damping profile; returns false if no cell is damped
+  virtual bool prepare_profile() = 0;
+
+  /// damp the interior cells of plane t of the last dimension
+  virtual void damp_plane(int t, bool efield, bool bfield) = 0;
+};
+
+
 /* \brief Damping electro-magnetic tile
  *
+ * Fields are relaxed into the reference fields as f = t1*f + t2*f_ref with
+ * t1 and t2 depending only on the coordinate along the damping direction.
+ * The 1D profile of the tile is tabulated and rebuilt only when fld1, fld2,
+ * ksupp, or the tile location change.
  */
 template<
   std::size_t D,
   int S
 >
 class Tile : 
-  virtual public emf::Tile<D>
+  virtual public emf::Tile<D>,
+  public Layer<D>
 {
 
   public:
@@ -63,6 +91,10 @@ class Tile :
   // damp field 
   void damp_fields();
 
+  bool prepare_profile() override;
+
+  void damp_plane(int t, bool efield, bool bfield) override;
+
   /// start index of the slope
   float fld1;
     
@@ -73,6 +105,20 @@ class Tile :
   float ksupp = 10; 
 
 
+  private:
+
+  /// damping profile along the damping direction (incl. halos)
+  std::vector<float> prof_t1, prof_t2;
+
+  /// fully damped [flo, fhi) and partially damped [plo, phi) cells 
+  int flo = 0, fhi = 0, plo = 0, phi = 0;
+
+  /// fld1, fld2, ksupp, and tile location of the current profile; NaN never matches
+  std::array<double, 4> prof_key = {{
+    std::numeric_limits<double>::quiet_NaN(), 0.0, 0.0, 0.0}};
+
+  /// damp cells lo <= (i,j,k) < hi
+  void damp_box(std::array<int,3> lo, std::array<int,3> hi, bool efield, bool bfield);
 };
 
 
@@ -0,0 +1,220 @@
+#include <array>
+#include <cassert>
+#include <memory>
+
+#include "core/emf/filters/multipass_binomial.h"
+
+#ifdef GPU
+#include <nvtx3/nvToolsExt.h>
+#endif
+
+
+namespace {
+
+  /// 1D 3-point binomial coefficients; their products are exact so the
+  //  D-dimensional weights are the same as the tables of Binomial2
+  constexpr float C1[3] = {1.f/4.f, 2.f/4.f, 1.f/4.f};
+
+  /// neighbor tile (in,jn,kn); nullptr if it does not exist
+  template<size_t D>
+  emf::Tile<D>* neighbor(emf::Tile<D>& tile, corgi::Grid<D>& grid, int in, int jn, int kn)
+  {
+    if (in == 0 && jn == 0 && kn == 0) return &tile;
+
+    std::shared_ptr<corgi::Tile<D>> tpr;
+    if constexpr (D == 1) tpr = grid.get_tileptr( tile.neighs(in) );
+    if constexpr (D == 2) tpr = grid.get_tileptr( tile.neighs(in, jn) );
+    if constexpr (D == 3) tpr = grid.get_tileptr( tile.neighs(in, jn, kn) );
+
+    return dynamic_cast<emf::Tile<D>*>(tpr.get());
+  }
+
+  /// current component c of the tile
+  template<size_t D>
+  toolbox::Mesh<float,3>& current(emf::Tile<D>& tile, int c)
+  {
+    auto& gs = tile.get_grids();
+    return c == 0 ? gs.jx : c == 1 ? gs.jy : gs.jz;
+  }
+
+  inline int mod3(int x) { return ((x % 3) + 3) % 3; }
+}
+
+
+template<size_t D>
+void emf::MultiPassBinomial2<D>::compute(
+    emf::Tile<D>& tile,
+    corgi::Grid<D>& grid)
+{
+#ifdef GPU
+  nvtxRangePush(__PRETTY_FUNCTION__);
+#endif
+
+  const int P = npasses;
+  const auto& N = tile.mesh_lengths;
+  const int halo = 3; // halo region size of the meshes
+
+  // halo depth and block length along each dimension
+  std::array<int,3> H, E;
+  for(size_t a=0; a<3; a++) {
+    H[a] = a < D ? P : 0;
+    E[a] = N[a] + 2*H[a];
+    assert(a >= D || (P >= 1 && P <= N[a]));
+  }
+  const size_t ncells = N[0]*N[1]*N[2];
+
+  // neighborhood; stored at 9*(in+1) + 3*(jn+1) + (kn+1)
+  std::array<emf::Tile<D>*, 27> nbors;
+  nbors.fill(nullptr);
+  for(int in=-1; in<=1; in++)
+  for(int jn=(D>=2 ? -1 : 0); jn<=(D>=2 ? 1 : 0); jn++)
+  for(int kn=(D>=3 ? -1 : 0); kn<=(D>=3 ? 1 : 0); kn++)
+    nbors[9*(in+1) + 3*(jn+1) + (kn+1)] = neighbor(tile, grid, in, jn, kn);
+
+  // sweep along the last dimension w; planes span u (fastest) and v.
+  // Unused dimensions have length 1 so the block and the planes have the
+  // same strides along u and v.
+  const int w = D - 1;
+  const int u = D == 1 ? 1 : 0;
+  const int v = D == 3 ? 1 : 2;
+  const int Eu = E[u];
+  const int plane = E[u]*E[v];
+  const std::array<int,3> ost = {1, N[0], N[0]*N[1]}; // strides of the result
+
+  // stencil weights in the summation order of Binomial2 (last dimension fastest)
+  float C[3][3][3];
+  for(int du=0; du<3; du++)
+  for(int dv=0; dv<3; dv++)
+  for(int dw=0; dw<3; dw++)
+    C[du][dv][dw] = (u < (int)D ? C1[du] : 1.f) * (v < (int)D ? C1[dv] : 1.f) * C1[dw];
+
+  const int ru = u < (int)D ? 1 : 0; // stencil reach along u and v
+  const int rv = v < (int)D ? 1 : 0;
+
+  block.resize(E[0]*E[1]*E[2]);
+  planes.resize(3*(P-1)*plane);
+
+  auto& res = results[tile.cid];
+  res.resize(3*ncells);
+
+  // plane x of pass p; pointer to cell (0,0) of the plane
+  auto get_plane = [&](int p, int x) -> float* {
+    if(p == 0) return block.data() + H[u] + Eu*H[v] + plane*(x + H[w]);
+    return planes.data() + plane*(3*(p-1) + mod3(x)) + H[u] + Eu*H[v];
+  };
+
+  for(int c=0; c<3; c++) {
+
+    //--------------------------------------------------
+    // gather the block; region (in,jn,kn) comes from that neighbor
+    for(int in=-1; in<=1; in++)
+    for(int jn=(D>=2 ? -1 : 0); jn<=(D>=2 ? 1 : 0); jn++)
+    for(int kn=(D>=3 ? -1 : 0); kn<=(D>=3 ? 1 : 0); kn++) {
+      const std::array<int,3> dir = {in, jn, kn};
+      std::array<int,3> lo, hi;
+      for(size_t a=0; a<3; a++) {
+        lo[a] = dir[a] == -1 ? -H[a] : dir[a] == 0 ? 0    : N[a];
+        hi[a] = dir[a] == -1 ? 0     : dir[a] == 0 ? N[a] : N[a] + H[a];
+      }
+
+      auto* nb = nbors[9*(in+1) + 3*(jn+1) + (kn+1)];
+      auto& m = current(nb ? *nb : tile, c);
+
+      for(int k=lo[2]; k<hi[2]; k++)
+      for(int j=lo[1]; j<hi[1]; j++)
+      for(int i=lo[0]; i<hi[0]; i++) {
+        float val = 0.0f;
+        if(nb) {
+          val = m(i - in*N[0], j - jn*N[1], k - kn*N[2]);
+        } else if(i >= -halo && i < N[0] + halo &&
+                  j >= -halo && j < N[1] + halo &&
+                  k >= -halo && k < N[2] + halo) {
+          val = m(i, j, k); // own halo
+        }
+        block[(i + H[0]) + E[0]*((j + H[1]) + E[1]*(k + H[2]))] = val;
+      }
+    }
+
+    //--------------------------------------------------
+    // fused passes; plane x of pass p is computed as soon as the planes
+    // x-1, x, x+1 of pass p-1 are ready. Pass p is needed npasses-p cells
+    // beyond the tile.
+    float* out = res.data() + c*ncells;
+
+    for(int t=-H[w]; t<N[w]+H[w]; t++) {
+      for(int p=1; p<=P; p++) {
+        const int x = t - p;
+        const int hp = P - p;
+        if(x < -hp || x >= N[w] + hp) continue;
+
+        const float* in0 = get_plane(p-1, x-1);
+        const float* in1 = get_plane(p-1, x  );
+        const float* in2 = get_plane(p-1, x+1);
+        const float* pin[3] = {in0, in1, in2};
+
+        float* dst = p < P ? get_plane(p, x) : nullptr;
+
+        const int hu = ru*hp, hv = rv*hp;
+        for(int xv=-hv; xv<N[v]+hv; xv++) {
+          for(int xu=-hu; xu<N[u]+hu; xu++) {
+
+            float acc = 0.0f;
+            for(int du=-ru; du<=ru; du++) {
+            for(int dv=-rv; dv<=rv; dv++) {
+            for(int dw=-1; dw<=1; dw++) {
+              acc += pin[dw+1][(xu+du) + Eu*(xv+dv)]*C[du+1][dv+1][dw+1];
+            }}}
+
+            if(p == P) {
+              out[xu*ost[u] + xv*ost[v] + x*ost[w]] = acc;
+            } else {
+              dst[xu + Eu*xv] = acc;
+            }
+          }
+        }
+      }
+    }
+  }
+
+#ifdef GPU
+  nvtxRangePop();
+#endif
+}
+
+
+template<size_t D>
+void emf::MultiPassBinomial2<D>::solve(
+    emf::Tile<D>& tile)
+{
+#ifdef GPU
+  nvtxRangePush(__PRETTY_FUNCTION__);
+#endif
+
+  auto it = results.find(tile.cid);
+  assert(it != results.end());
+
+  const auto& N = tile.mesh_lengths;
+  const size_t ncells = N[0]*N[1]*N[2];
+
+  for(int c=0; c<3; c++) {
+    auto& m = current(tile, c);
+    const float* r = it->second.data() + c*ncells;
+
+    for(int k=0; k<N[2]; k++)
+    for(int j=0; j<N[1]; j++)
+    for(int i=0; i<N[0]; i++)
+      m(i, j, k) = r[i + N[0]*(j + N[1]*k)];
+  }
+
+#ifdef GPU
+  nvtxRangePop();
+#endif
+}
+
+
+//--------------------------------------------------
+// explicit template instantiation
+
+template class emf::MultiPassBinomial2<1>;
+template class emf::MultiPassBinomial2<2>;
+template class emf::MultiPassBinomial2<3>;
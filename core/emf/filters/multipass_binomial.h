@@ -0,0 +1,65 @@
+#pragma once
+
+#include <map>
+#include <vector>
+
+#include "external/corgi/corgi.h"
+#include "core/emf/filters/filter.h"
+
+namespace emf {
+
+/*! \brief npasses of the 2nd order binomial filter with one halo exchange
+ *
+ * Gives the same currents as calling Binomial2 npasses times with a current
+ * exchange + update_boundaries before every other pass, but needs only one
+ * exchange: compute() reads a block of depth npasses around the tile
+ * directly from the neighbor tiles and runs all passes on it; solve() then
+ * copies the filtered interior into the tile. compute() has to be called
+ * for all local tiles before solve() since the interiors of the neighbors
+ * are read.
+ *
+ * The passes are fused into one sweep per component along the last
+ * dimension: every pass keeps only three planes of its previous pass, so
+ * the working set stays in cache. The stencil is summed in the same order
+ * as in Binomial2 so the result is bit-identical.
+ *
+ * NOTE: npasses can not exceed the tile size. Virtual tiles need to carry
+ *       npasses deep interior strips of the currents (see
+ *       Tile::set_current_depth for packed halos).
+ * NOTE: where a neighbor tile does not exist the tile's own halo (and
+ *       zeros beyond it) is used; this differs from the repeated one-pass
+ *       filter near open boundaries.
+ */
+template<size_t D>
+class MultiPassBinomial2 :
+  public virtual Filter<D>
+{
+  public:
+
+  /// number of filter passes
+  int npasses = 1;
+
+  MultiPassBinomial2(int Nx, int Ny, int Nz, int npasses) :
+    Filter<D>(Nx, Ny, Nz),
+    npasses{npasses}
+  {}
+
+  /// filter the currents of the tile and its neighborhood; result is stored until solve
+  void compute(emf::Tile<D>& tile, corgi::Grid<D>& grid);
+
+  /// copy the filtered currents into the tile interior
+  void solve(emf::Tile<D>& tile) override;
+
+  private:
+
+  /// filtered interior jx, jy, jz of each tile (by cid)
+  std::map<uint64_t, std::vector<float>> results;
+
+  /// scratch: one component with npasses deep halos
+  std::vector<float> block;
+
+  /// scratch: three planes of every intermediate pass
+  std::vector<float> planes;
+};
+
+} // end of namespace emf
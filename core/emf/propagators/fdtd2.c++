@@ -1,13 +1,88 @@
 #include <cmath>
 
 #include "core/emf/propagators/fdtd2.h"
+#include "core/emf/propagators/fused_sweep.h"
+#include "core/emf/boundaries/damping_tile.h"
 #include "external/iter/iter.h"
+#include "external/iter/devcall.h"
 
 #ifdef GPU
 #include <nvtx3/nvToolsExt.h> 
 #endif
 
 
+namespace {
+
+/// E update of one cell; shared by push_e and push_half_b_e
+template<size_t D>
+DEVCALLABLE inline void fdtd2_e(emf::Grids& mesh, int i, int j, int k, const float C);
+
+/// B update of one cell; shared by push_half_b and push_half_b_e
+template<size_t D>
+DEVCALLABLE inline void fdtd2_b(emf::Grids& mesh, int i, int j, int k, const float C);
+
+template<>
+DEVCALLABLE inline void fdtd2_e<1>(emf::Grids& mesh, int i, int /*j*/, int /*k*/, const float C)
+{
+  // Ex NONE
+  mesh.ey(i,0,0) += + C*( mesh.bz(i-1,0,0) - mesh.bz(i,0,0));
+  mesh.ez(i,0,0) += + C*(-mesh.by(i-1,0,0) + mesh.by(i,0,0));
+}
+
+template<>
+DEVCALLABLE inline void fdtd2_e<2>(emf::Grids& mesh, int i, int j, int /*k*/, const float C)
+{
+  mesh.ex(i,j,0) += + C*(-mesh.bz(i,  j-1,0) + mesh.bz(i,j,0));
+  mesh.ey(i,j,0) += + C*( mesh.bz(i-1,j,  0) - mesh.bz(i,j,0));
+  mesh.ez(i,j,0) += + C*( mesh.bx(i,  j-1,0) - mesh.bx(i,j,0) 
+                         -mesh.by(i-1,j,  0) + mesh.by(i,j,0));
+}
+
+//SPHINX emf docs pusher example start
+// 3D E update
+template<>
+DEVCALLABLE inline void fdtd2_e<3>(emf::Grids& mesh, int i, int j, int k, const float C)
+{
+  mesh.ex(i,j,k) += + C*( mesh.by(i,  j,  k-1) - mesh.by(i,j,k))
+                    + C*(-mesh.bz(i,  j-1,k  ) + mesh.bz(i,j,k)); 
+  mesh.ey(i,j,k) += + C*( mesh.bz(i-1,j,  k  ) - mesh.bz(i,j,k))
+                    + C*(-mesh.bx(i,  j,  k-1) + mesh.bx(i,j,k));
+  mesh.ez(i,j,k) += + C*( mesh.bx(i,  j-1,k  ) - mesh.bx(i,j,k))
+                    + C*(-mesh.by(i-1,j,  k  ) + mesh.by(i,j,k));
+}
+//SPHINX emf docs pusher example stop
+
+template<>
+DEVCALLABLE inline void fdtd2_b<1>(emf::Grids& mesh, int i, int /*j*/, int /*k*/, const float C)
+{
+  // Bx NONE
+  mesh.by(i,0,0) += + C*( mesh.ez(i+1,0,0) - mesh.ez(i,0,0));
+  mesh.bz(i,0,0) += + C*(-mesh.ey(i+1,0,0) + mesh.ey(i,0,0));
+}
+
+template<>
+DEVCALLABLE inline void fdtd2_b<2>(emf::Grids& mesh, int i, int j, int /*k*/, const float C)
+{
+  mesh.bx(i,j,0) += + C*(-mesh.ez(i,  j+1,0) + mesh.ez(i,j,0));
+  mesh.by(i,j,0) += + C*( mesh.ez(i+1,j,  0) - mesh.ez(i,j,0));
+  mesh.bz(i,j,0) += + C*( mesh.ex(i,  j+1,0) - mesh.ex(i,j,0)
+                         -mesh.ey(i+1,j,  0) + mesh.ey(i,j,0));
+}
+
+template<>
+DEVCALLABLE inline void fdtd2_b<3>(emf::Grids& mesh, int i, int j, int k, const float C)
+{
+  mesh.bx(i,j,k) += + C*( mesh.ey(i,  j,  k+1) - mesh.ey(i,j,k))
+                    + C*(-mesh.ez(i,  j+1,k  ) + mesh.ez(i,j,k));
+  mesh.by(i,j,k) += + C*( mesh.ez(i+1,j,  k  ) - mesh.ez(i,j,k))
+                    + C*(-mesh.ex(i,  j,  k+1) + mesh.ex(i,j,k));
+  mesh.bz(i,j,k) += + C*( mesh.ex(i,  j+1,k  ) - mesh.ex(i,j,k))
+                    + C*(-mesh.ey(i+1,j,  k  ) + mesh.ey(i,j,k));
+}
+
+} // end of anonymous namespace
+
+
 /*! \brief Update E field with full step
  *
  * Contains a dimension switch for solvers depending on internal mesh dimensions
@@ -28,10 +103,7 @@ void emf::FDTD2<1>::push_e(emf::Tile<1>& tile)
   UniIter::iterate(
   [=] DEVCALLABLE (int i, Grids &mesh)
   {
-    // Ex NONE
-    mesh.ey(i,0,0) += + C*( mesh.bz(i-1,0,0) - mesh.bz(i,0,0));
-    mesh.ez(i,0,0) += + C*(-mesh.by(i-1,0,0) + mesh.by(i,0,0));
-
+    fdtd2_e<1>(mesh, i, 0, 0, C);
   }, 
     tile.mesh_lengths[0], 
     mesh);
@@ -58,12 +130,7 @@ void emf::FDTD2<2>::push_e(emf::Tile<2>& tile)
   UniIter::iterate2D(
   [=] DEVCALLABLE (int i, int j, Grids &mesh)
   {
-
-    mesh.ex(i,j,0) += + C*(-mesh.bz(i,  j-1,0) + mesh.bz(i,j,0));
-    mesh.ey(i,j,0) += + C*( mesh.bz(i-1,j,  0) - mesh.bz(i,j,0));
-    mesh.ez(i,j,0) += + C*( mesh.bx(i,  j-1,0) - mesh.bx(i,j,0) 
-                           -mesh.by(i-1,j,  0) + mesh.by(i,j,0));
-
+    fdtd2_e<2>(mesh, i, j, 0, C);
   }, 
     tile.mesh_lengths[0], 
     tile.mesh_lengths[1], 
@@ -77,7 +144,6 @@ void emf::FDTD2<2>::push_e(emf::Tile<2>& tile)
 }
 
 
-//SPHINX emf docs pusher example start
 // 3D E pusher
 template<>
 void emf::FDTD2<3>::push_e(emf::Tile<3>& tile)
@@ -93,12 +159,7 @@ void emf::FDTD2<3>::push_e(emf::Tile<3>& tile)
   UniIter::iterate3D(
   [=] DEVCALLABLE (int i, int j, int k, Grids &mesh)
   {
-    mesh.ex(i,j,k) += + C*( mesh.by(i,  j,  k-1) - mesh.by(i,j,k))
-                      + C*(-mesh.bz(i,  j-1,k  ) + mesh.bz(i,j,k)); 
-    mesh.ey(i,j,k) += + C*( mesh.bz(i-1,j,  k  ) - mesh.bz(i,j,k))
-                      + C*(-mesh.bx(i,  j,  k-1) + mesh.bx(i,j,k));
-    mesh.ez(i,j,k) += + C*( mesh.bx(i,  j-1,k  ) - mesh.bx(i,j,k))
-                      + C*(-mesh.by(i-1,j,  k  ) + mesh.by(i,j,k));
+    fdtd2_e<3>(mesh, i, j, k, C);
   }, 
     tile.mesh_lengths[0], 
     tile.mesh_lengths[1], 
@@ -111,7 +172,6 @@ void emf::FDTD2<3>::push_e(emf::Tile<3>& tile)
   nvtxRangePop();
 #endif
 }
-//SPHINX emf docs pusher example stop
 
 
 //--------------------------------------------------
@@ -132,9 +192,7 @@ void emf::FDTD2<1>::push_half_b(emf::Tile<1>& tile)
   UniIter::iterate(
   [=] DEVCALLABLE (int i, Grids &mesh)
   {
-    // Bx NONE
-    mesh.by(i,0,0) += + C*( mesh.ez(i+1,0,0) - mesh.ez(i,0,0));
-    mesh.bz(i,0,0) += + C*(-mesh.ey(i+1,0,0) + mesh.ey(i,0,0));
+    fdtd2_b<1>(mesh, i, 0, 0, C);
   }, 
     tile.mesh_lengths[0], 
     mesh);
@@ -161,11 +219,7 @@ void emf::FDTD2<2>::push_half_b(emf::Tile<2>& tile)
   UniIter::iterate2D(
   [=] DEVCALLABLE (int i, int j, Grids &mesh)
   {
-    mesh.bx(i,j,0) += + C*(-mesh.ez(i,  j+1,0) + mesh.ez(i,j,0));
-    mesh.by(i,j,0) += + C*( mesh.ez(i+1,j,  0) - mesh.ez(i,j,0));
-    mesh.bz(i,j,0) += + C*( mesh.ex(i,  j+1,0) - mesh.ex(i,j,0)
-                           -mesh.ey(i+1,j,  0) + mesh.ey(i,j,0));
-
+    fdtd2_b<2>(mesh, i, j, 0, C);
   }, 
     tile.mesh_lengths[0], 
     tile.mesh_lengths[1], 
@@ -194,12 +248,7 @@ void emf::FDTD2<3>::push_half_b(emf::Tile<3>& tile)
   UniIter::iterate3D(
   [=] DEVCALLABLE (int i, int j, int k, Grids &mesh)
   {
-    mesh.bx(i,j,k) += + C*( mesh.ey(i,  j,  k+1) - mesh.ey(i,j,k))
-                      + C*(-mesh.ez(i,  j+1,k  ) + mesh.ez(i,j,k));
-    mesh.by(i,j,k) += + C*( mesh.ez(i+1,j,  k  ) - mesh.ez(i,j,k))
-                      + C*(-mesh.ex(i,  j,  k+1) + mesh.ex(i,j,k));
-    mesh.bz(i,j,k) += + C*( mesh.ex(i,  j+1,k  ) - mesh.ex(i,j,k))
-                      + C*(-mesh.ey(i+1,j,  k  ) + mesh.ey(i,j,k));
+    fdtd2_b<3>(mesh, i, j, k, C);
   }, 
     tile.mesh_lengths[0], 
     tile.mesh_lengths[1], 
@@ -215,6 +264,58 @@ void emf::FDTD2<3>::push_half_b(emf::Tile<3>& tile)
 
 
 
+//--------------------------------------------------
+
+/// Half B step and full E step in one sweep; B is advanced also in the halos
+template<size_t D>
+void emf::FDTD2<D>::push_half_b_e(emf::Tile<D>& tile)
+{
+#ifdef GPU
+  nvtxRangePush(__PRETTY_FUNCTION__);
+#endif
+
+  Grids& mesh = tile.get_grids();
+  const float Cb = 0.5 * tile.cfl * this->dt * corr;
+  const float Ce = 1.0 * tile.cfl * this->dt * corr;
+
+  emf::sweep_half_b_e<D, 1>(tile.mesh_lengths,
+    [&](int i, int j, int k) { fdtd2_b<D>(mesh, i, j, k, Cb); },
+    [&](int i, int j, int k) { fdtd2_e<D>(mesh, i, j, k, Ce); });
+
+#ifdef GPU
+  nvtxRangePop();
+#endif
+}
+
+
+/// Full E step and damping of E and B in one sweep; falls back to push_e 
+//  for tiles that are not damping or have no damped cells
+template<size_t D>
+void emf::FDTD2<D>::push_e_damped(emf::Tile<D>& tile)
+{
+  auto* layer = dynamic_cast<emf::damping::Layer<D>*>(&tile);
+  if(!layer || !layer->fused_damping || !layer->prepare_profile()) {
+    push_e(tile);
+    return;
+  }
+
+#ifdef GPU
+  nvtxRangePush(__PRETTY_FUNCTION__);
+#endif
+
+  Grids& mesh = tile.get_grids();
+  const float C = 1.0 * tile.cfl * this->dt * corr;
+
+  emf::sweep_e_damp<D, 1>(tile.mesh_lengths,
+    [&](int i, int j, int k) { fdtd2_e<D>(mesh, i, j, k, C); },
+    [&](int t, bool efield, bool bfield) { layer->damp_plane(t, efield, bfield); });
+
+#ifdef GPU
+  nvtxRangePop();
+#endif
+}
+
+
 template class emf::FDTD2<1>;
 template class emf::FDTD2<2>;
 template class emf::FDTD2<3>;
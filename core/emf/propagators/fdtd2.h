@@ -18,6 +18,15 @@ class FDTD2 :
   void push_e(Tile<D>& tile) override;
 
   void push_half_b(Tile<D>& tile) override;
+
+  /// push_half_b and push_e in one cache-blocked sweep; B is advanced also in 
+  //  the halo regions, so no B exchange is needed between the two updates.
+  //  NOTE: halos of missing neighbor tiles are advanced too.
+  void push_half_b_e(Tile<D>& tile);
+
+  /// push_e and damping of E and B (damping::Tile with fused_damping) in one 
+  //  sweep; only the interior is damped. Other tiles get a plain push_e.
+  void push_e_damped(Tile<D>& tile);
 };
 
 
@@ -1,12 +1,115 @@
 #include <cmath>
 
 #include "core/emf/propagators/fdtd4.h"
+#include "core/emf/propagators/fused_sweep.h"
+#include "core/emf/boundaries/damping_tile.h"
 #include "external/iter/iter.h"
+#include "external/iter/devcall.h"
 
 #ifdef GPU
 #include <nvtx3/nvToolsExt.h> 
 #endif
 
+
+namespace {
+
+/// E update of one cell; shared by push_e and push_half_b_e
+template<size_t D>
+DEVCALLABLE inline void fdtd4_e(emf::Grids& mesh, int i, int j, int k, const float C1, const float C2);
+
+/// B update of one cell; shared by push_half_b and push_half_b_e
+template<size_t D>
+DEVCALLABLE inline void fdtd4_b(emf::Grids& mesh, int i, int j, int k, const float C1, const float C2);
+
+template<>
+DEVCALLABLE inline void fdtd4_e<1>(emf::Grids& mesh, int i, int /*j*/, int /*k*/, const float C1, const float C2)
+{
+  // Ex NONE
+  mesh.ey(i,0,0) += C1*( mesh.bz(i-1, 0, 0) - mesh.bz(i,   0, 0)) 
+                   +C2*( mesh.bz(i-2, 0, 0) - mesh.bz(i+1, 0, 0));
+
+  mesh.ez(i,0,0) += C1*(-mesh.by(i-1, 0, 0) + mesh.by(i,   0, 0))
+                   +C2*(-mesh.by(i-2, 0, 0) + mesh.by(i+1, 0, 0));
+}
+
+template<>
+DEVCALLABLE inline void fdtd4_e<2>(emf::Grids& mesh, int i, int j, int k, const float C1, const float C2)
+{
+  mesh.ex(i,j,k) += C1*(-mesh.bz(i,  j-1,k) + mesh.bz(i,  j,  k)) 
+                   +C2*(-mesh.bz(i,  j-2,k) + mesh.bz(i,  j+1,k));
+
+  mesh.ey(i,j,k) += C1*( mesh.bz(i-1,j,  k) - mesh.bz(i,  j,  k)) 
+                   +C2*( mesh.bz(i-2,j,  k) - mesh.bz(i+1,j,  k));
+
+  mesh.ez(i,j,k) += C1*( mesh.bx(i,  j-1,k) - mesh.bx(i,  j,  k) 
+                        -mesh.by(i-1,j,  k) + mesh.by(i,  j,  k))
+                   +C2*( mesh.bx(i,  j-2,k) - mesh.bx(i,  j+1,k)
+                        -mesh.by(i-2,j,  k) + mesh.by(i+1,j,  k));
+}
+
+template<>
+DEVCALLABLE inline void fdtd4_e<3>(emf::Grids& mesh, int i, int j, int k, const float C1, const float C2)
+{
+  mesh.ex(i,j,k)+= C1*(mesh.by(i,  j,  k-1) - mesh.by(i,  j,  k  )  
+                     - mesh.bz(i,  j-1,k  ) + mesh.bz(i,  j,  k  ))
+                  +C2*(mesh.by(i,  j,  k-2) - mesh.by(i,  j,  k+1)
+                     - mesh.bz(i,  j-2,k  ) + mesh.bz(i,  j+1,k  ));
+
+  mesh.ey(i,j,k)+= C1*(mesh.bz(i-1,j,  k  ) - mesh.bz(i,  j,  k  )  
+                     - mesh.bx(i,  j,  k-1) + mesh.bx(i,  j,  k  ))
+                  +C2*(mesh.bz(i-2,j,  k  ) - mesh.bz(i+1,j,  k  )
+                     - mesh.bx(i,  j,  k-2) + mesh.bx(i,  j,  k+1));
+
+  mesh.ez(i,j,k)+= C1*(mesh.bx(i,  j-1,k  ) - mesh.bx(i,  j,  k  )  
+                     - mesh.by(i-1,j,  k  ) + mesh.by(i,  j,  k  ))
+                  +C2*(mesh.bx(i,  j-2,k  ) - mesh.bx(i,  j+1,k  )
+                     - mesh.by(i-2,j,  k  ) + mesh.by(i+1,j,  k  ));
+}
+
+template<>
+DEVCALLABLE inline void fdtd4_b<1>(emf::Grids& mesh, int i, int /*j*/, int /*k*/, const float C1, const float C2)
+{
+  // Bx NONE
+  mesh.by(i,0,0) += C1*( mesh.ez(i+1, 0, 0) - mesh.ez(i,   0, 0))
+                   +C2*( mesh.ez(i+2, 0, 0) - mesh.ez(i-1, 0, 0));
+  mesh.bz(i,0,0) += C1*(-mesh.ey(i+1, 0, 0) + mesh.ey(i,   0, 0))
+                   +C2*(-mesh.ey(i+2, 0, 0) + mesh.ey(i-1, 0, 0));
+}
+
+template<>
+DEVCALLABLE inline void fdtd4_b<2>(emf::Grids& mesh, int i, int j, int k, const float C1, const float C2)
+{
+  mesh.bx(i,j,k) += C1*(-mesh.ez(i,  j+1,k) + mesh.ez(i,  j,  k))
+                   +C2*(-mesh.ez(i,  j+2,k) + mesh.ez(i,  j-1,k));
+  mesh.by(i,j,k) += C1*( mesh.ez(i+1,j,  k) - mesh.ez(i,  j,  k))
+                   +C2*( mesh.ez(i+2,j,  k) - mesh.ez(i-1,j,  k));
+  mesh.bz(i,j,k) += C1*( mesh.ex(i,  j+1,k) - mesh.ex(i,  j,  k)  
+                        -mesh.ey(i+1,j,  k) + mesh.ey(i,  j,  k))
+                   +C2*( mesh.ex(i,  j+2,k) - mesh.ex(i,  j-1,k)
+                        -mesh.ey(i+2,j,  k) + mesh.ey(i-1,j,  k));
+}
+
+template<>
+DEVCALLABLE inline void fdtd4_b<3>(emf::Grids& mesh, int i, int j, int k, const float C1, const float C2)
+{
+  mesh.bx(i,j,k)+= C1*(mesh.ey(i,  j,  k+1) - mesh.ey(i,  j,  k  )  
+                     - mesh.ez(i,  j+1,k  ) + mesh.ez(i,  j,  k  ))
+                  +C2*(mesh.ey(i,  j,  k+2) - mesh.ey(i,  j,  k-1)
+                     - mesh.ez(i,  j+2,k  ) + mesh.ez(i,  j-1,k  ));
+
+  mesh.by(i,j,k)+= C1*(mesh.ez(i+1,j,  k  ) - mesh.ez(i,  j,  k  )  
+                     - mesh.ex(i,  j,  k+1) + mesh.ex(i,  j,  k  ))
+                  +C2*(mesh.ez(i+2,j,  k  ) - mesh.ez(i-1,j,  k  )
+                      -mesh.ex(i,  j,  k+2) + mesh.ex(i,  j,  k-1));
+
+  mesh.bz(i,j,k)+= C1*(mesh.ex(i,  j+1,k  ) - mesh.ex(i,  j,  k  )  
+                     - mesh.ey(i+1,j,  k  ) + mesh.ey(i,  j,  k  ))
+                  +C2*(mesh.ex(i,  j+2,k  ) - mesh.ex(i,  j-1,k  )
+                     - mesh.ey(i+2,j,  k  ) + mesh.ey(i-1,j,  k  ));
+}
+
+} // end of anonymous namespace
+
 /*! \brief Update E field with full step
  *
  * Contains a dimension switch for solvers depending on internal mesh dimensions
@@ -30,12 +133,7 @@ void emf::FDTD4<1>::push_e(emf::Tile<1>& tile)
   UniIter::iterate(
   [=] DEVCALLABLE (int i, Grids &mesh)
   {
-  // Ex NONE
-	mesh.ey(i,0,0) +=   C1*( mesh.bz(i-1, 0, 0) - mesh.bz(i,   0, 0)) 
-		                 +C2*( mesh.bz(i-2, 0, 0) - mesh.bz(i+1, 0, 0));
-
-	mesh.ez(i,0,0) +=   C1*(-mesh.by(i-1, 0, 0) + mesh.by(i,   0, 0))
-                     +C2*(-mesh.by(i-2, 0, 0) + mesh.by(i+1, 0, 0));
+    fdtd4_e<1>(mesh, i, 0, 0, C1, C2);
   }, 
     tile.mesh_lengths[0], 
     mesh);
@@ -60,21 +158,11 @@ void emf::FDTD4<2>::push_e(emf::Tile<2>& tile)
 
   const float C1 = coeff1*corr*tile.cfl;
   const float C2 = coeff2*corr*tile.cfl;
-  const int k = 0;
 
   UniIter::iterate2D(
   [=] DEVCALLABLE (int i, int j, Grids &mesh)
   {
-	mesh.ex(i,j,k) += C1*(-mesh.bz(i,  j-1,k) + mesh.bz(i,  j,  k)) 
-		               +C2*(-mesh.bz(i,  j-2,k) + mesh.bz(i,  j+1,k));
-
-	mesh.ey(i,j,k) += C1*( mesh.bz(i-1,j,  k) - mesh.bz(i,  j,  k)) 
-		               +C2*( mesh.bz(i-2,j,  k) - mesh.bz(i+1,j,  k));
-
-	mesh.ez(i,j,k) += C1*( mesh.bx(i,  j-1,k) - mesh.bx(i,  j,  k) 
-                       - mesh.by(i-1,j,  k) + mesh.by(i,  j,  k))
-                   +C2*( mesh.bx(i,  j-2,k) - mesh.bx(i,  j+1,k)
-                        -mesh.by(i-2,j,  k) + mesh.by(i+1,j,  k));
+    fdtd4_e<2>(mesh, i, j, 0, C1, C2);
   }, 
     tile.mesh_lengths[0], 
     tile.mesh_lengths[1], 
@@ -103,20 +191,7 @@ void emf::FDTD4<3>::push_e(emf::Tile<3>& tile)
   UniIter::iterate3D(
   [=] DEVCALLABLE (int i, int j, int k, Grids &mesh)
   {
-    mesh.ex(i,j,k)+= C1*(mesh.by(i,  j,  k-1) - mesh.by(i,  j,  k  )  
-                       - mesh.bz(i,  j-1,k  ) + mesh.bz(i,  j,  k  ))
-                    +C2*(mesh.by(i,  j,  k-2) - mesh.by(i,  j,  k+1)
-                       - mesh.bz(i,  j-2,k  ) + mesh.bz(i,  j+1,k  ));
-
-    mesh.ey(i,j,k)+= C1*(mesh.bz(i-1,j,  k  ) - mesh.bz(i,  j,  k  )  
-                       - mesh.bx(i,  j,  k-1) + mesh.bx(i,  j,  k  ))
-                    +C2*(mesh.bz(i-2,j,  k  ) - mesh.bz(i+1,j,  k  )
-                       - mesh.bx(i,  j,  k-2) + mesh.bx(i,  j,  k+1));
-
-    mesh.ez(i,j,k)+= C1*(mesh.bx(i,  j-1,k  ) - mesh.bx(i,  j,  k  )  
-                       - mesh.by(i-1,j,  k  ) + mesh.by(i,  j,  k  ))
-                    +C2*(mesh.bx(i,  j-2,k  ) - mesh.bx(i,  j+1,k  )
-                       - mesh.by(i-2,j,  k  ) + mesh.by(i+1,j,  k  ));
+    fdtd4_e<3>(mesh, i, j, k, C1, C2);
   }, 
     tile.mesh_lengths[0], 
     tile.mesh_lengths[1], 
@@ -152,12 +227,7 @@ void emf::FDTD4<1>::push_half_b(emf::Tile<1>& tile)
   UniIter::iterate(
   [=] DEVCALLABLE (int i, Grids &mesh)
   {
-    // Bx NONE
-	   mesh.by(i,0,0) += C1*( mesh.ez(i+1, 0, 0) - mesh.ez(i,   0, 0))
-	                    +C2*( mesh.ez(i+2, 0, 0) - mesh.ez(i-1, 0, 0));
-	   mesh.bz(i,0,0) += C1*(-mesh.ey(i+1, 0, 0) + mesh.ey(i,   0, 0))
-                      +C2*(-mesh.ey(i+2, 0, 0) + mesh.ey(i-1, 0, 0));
-
+    fdtd4_b<1>(mesh, i, 0, 0, C1, C2);
   }, 
     tile.mesh_lengths[0], 
     mesh);
@@ -182,20 +252,11 @@ void emf::FDTD4<2>::push_half_b(emf::Tile<2>& tile)
   Grids& mesh = tile.get_grids();
   const float C1 = 0.5*coeff1*corr*tile.cfl;
   const float C2 = 0.5*coeff2*corr*tile.cfl;
-  const int k = 0;
 
   UniIter::iterate2D(
   [=] DEVCALLABLE (int i, int j, Grids &mesh)
   {
-     mesh.bx(i,j,k) += C1*(-mesh.ez(i,  j+1,k) + mesh.ez(i,  j,  k))
-	                  +C2*(-mesh.ez(i,  j+2,k) + mesh.ez(i,  j-1,k));
-	 mesh.by(i,j,k) += C1*( mesh.ez(i+1,j,  k) - mesh.ez(i,  j,  k))
-	                  +C2*( mesh.ez(i+2,j,  k) - mesh.ez(i-1,j,  k));
-	 mesh.bz(i,j,k) += C1*( mesh.ex(i,  j+1,k) - mesh.ex(i,  j,  k)  
-                           -mesh.ey(i+1,j,  k) + mesh.ey(i,  j,  k))
-                      +C2*( mesh.ex(i,  j+2,k) - mesh.ex(i,  j-1,k)
-                           -mesh.ey(i+2,j,  k) + mesh.ey(i-1,j,  k));
-
+    fdtd4_b<2>(mesh, i, j, 0, C1, C2);
   }, 
     tile.mesh_lengths[0], 
     tile.mesh_lengths[1], 
@@ -225,21 +286,7 @@ void emf::FDTD4<3>::push_half_b(emf::Tile<3>& tile)
   UniIter::iterate3D(
   [=] DEVCALLABLE (int i, int j, int k, Grids &mesh)
   {
-    mesh.bx(i,j,k)+= C1*(mesh.ey(i,  j,  k+1) - mesh.ey(i,  j,  k  )  
-                       - mesh.ez(i,  j+1,k  ) + mesh.ez(i,  j,  k  ))
-                    +C2*(mesh.ey(i,  j,  k+2) - mesh.ey(i,  j,  k-1)
-                       - mesh.ez(i,  j+2,k  ) + mesh.ez(i,  j-1,k  ));
-
-	mesh.by(i,j,k)+= C1*(mesh.ez(i+1,j,  k  ) - mesh.ez(i,  j,  k  )  
-                       - mesh.ex(i,  j,  k+1) + mesh.ex(i,  j,  k  ))
-                    +C2*(mesh.ez(i+2,j,  k  ) - mesh.ez(i-1,j,  k  )
-                        -mesh.ex(i,  j,  k+2) + mesh.ex(i,  j,  k-1));
-
-	mesh.bz(i,j,k)+= C1*(mesh.ex(i,  j+1,k  ) - mesh.ex(i,  j,  k  )  
-                       - mesh.ey(i+1,j,  k  ) + mesh.ey(i,  j,  k  ))
-                    +C2*(mesh.ex(i,  j+2,k  ) - mesh.ex(i,  j-1,k  )
-                       - mesh.ey(i+2,j,  k  ) + mesh.ey(i-1,j,  k  ));
-
+    fdtd4_b<3>(mesh, i, j, k, C1, C2);
   }, 
     tile.mesh_lengths[0], 
     tile.mesh_lengths[1], 
@@ -256,6 +303,61 @@ void emf::FDTD4<3>::push_half_b(emf::Tile<3>& tile)
 
 
 
+//--------------------------------------------------
+
+/// Half B step and full E step in one sweep; B is advanced also in the halos
+template<size_t D>
+void emf::FDTD4<D>::push_half_b_e(emf::Tile<D>& tile)
+{
+#ifdef GPU
+  nvtxRangePush(__PRETTY_FUNCTION__);
+#endif
+
+  Grids& mesh = tile.get_grids();
+  const float Cb1 = 0.5*coeff1*corr*tile.cfl;
+  const float Cb2 = 0.5*coeff2*corr*tile.cfl;
+  const float Ce1 = coeff1*corr*tile.cfl;
+  const float Ce2 = coeff2*corr*tile.cfl;
+
+  emf::sweep_half_b_e<D, 2>(tile.mesh_lengths,
+    [&](int i, int j, int k) { fdtd4_b<D>(mesh, i, j, k, Cb1, Cb2); },
+    [&](int i, int j, int k) { fdtd4_e<D>(mesh, i, j, k, Ce1, Ce2); });
+
+#ifdef GPU
+  nvtxRangePop();
+#endif
+}
+
+
+/// Full E step and damping of E and B in one sweep; falls back to push_e 
+//  for tiles that are not damping or have no damped cells
+template<size_t D>
+void emf::FDTD4<D>::push_e_damped(emf::Tile<D>& tile)
+{
+  auto* layer = dynamic_cast<emf::damping::Layer<D>*>(&tile);
+  if(!layer || !layer->fused_damping || !layer->prepare_profile()) {
+    push_e(tile);
+    return;
+  }
+
+#ifdef GPU
+  nvtxRangePush(__PRETTY_FUNCTION__);
+#endif
+
+  Grids& mesh = tile.get_grids();
+  const float C1 = coeff1*corr*tile.cfl;
+  const float C2 = coeff2*corr*tile.cfl;
+
+  emf::sweep_e_damp<D, 2>(tile.mesh_lengths,
+    [&](int i, int j, int k) { fdtd4_e<D>(mesh, i, j, k, C1, C2); },
+    [&](int t, bool efield, bool bfield) { layer->damp_plane(t, efield, bfield); });
+
+#ifdef GPU
+  nvtxRangePop();
+#endif
+}
+
+
 template class emf::FDTD4<1>;
 template class emf::FDTD4<2>;
 template class emf::FDTD4<3>;
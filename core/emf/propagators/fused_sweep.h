@@ -0,0 +1,84 @@
+#pragma once
+
+#include <array>
+
+namespace emf {
+
+/*! \brief Half B step followed by a full E step in one sweep over a tile
+ *
+ * push_b(i,j,k) and push_e(i,j,k) update one cell; their stencils reach R
+ * cells (B reads E from i-R+1 to i+R and E reads B from i-R to i+R-1).
+ *
+ * B is advanced in all cells whose stencil stays inside the halo region,
+ * including the halos, so E can be updated in the interior without a B
+ * exchange in between. Planes along the last dimension are processed as a
+ * wavefront: E plane k is updated right after B plane k+R-1, when the
+ * fields of both planes are still in cache. Both updates see the same
+ * values as in two separate sweeps.
+ *
+ * Needs R <= 2 with the halo width of 3.
+ */
+template<size_t D, int R, typename FB, typename FE>
+void sweep_half_b_e(const std::array<int,3>& N, FB&& push_b, FE&& push_e)
+{
+  static_assert(R >= 1 && R <= 2, "stencil does not fit into the halo region");
+  const int H = 3; // halo width
+
+  // cells of B (incl. halos) and E (interior) updates
+  std::array<int,3> blo, bhi;
+  for(size_t a=0; a<3; a++) {
+    blo[a] = a < D ? R-1-H      : 0;
+    bhi[a] = a < D ? N[a]+H-R   : 1;
+  }
+
+  // one plane of the last dimension; lo/hi limits of the other dimensions
+  auto plane = [&](int t, const std::array<int,3>& lo, const std::array<int,3>& hi, auto&& f) {
+    if constexpr (D == 1) f(t, 0, 0);
+    if constexpr (D == 2) for(int i=lo[0]; i<hi[0]; i++) f(i, t, 0);
+    if constexpr (D == 3) {
+      for(int j=lo[1]; j<hi[1]; j++)
+      for(int i=lo[0]; i<hi[0]; i++) f(i, j, t);
+    }
+  };
+
+  const std::array<int,3> elo = {0, 0, 0};
+  const int w = D-1;
+
+  for(int t=blo[w]; t<bhi[w]+R-1; t++) {
+    if(t < bhi[w]) plane(t, blo, bhi, push_b);
+
+    const int k = t - R + 1;
+    if(k >= 0 && k < N[w]) plane(k, elo, N, push_e);
+  }
+}
+
+
+/*! \brief Full E step followed by field damping in one sweep over a tile
+ *
+ * push_e(i,j,k) updates one cell and damp(t, efield, bfield) damps the
+ * interior of plane t of the last dimension. The E stencil reads B from
+ * planes k-R to k+R-1, so E of plane t is damped right after its update
+ * while B of plane t-R is damped only when no later E update reads it.
+ * Both see the same values as a push_e sweep followed by damping.
+ */
+template<size_t D, int R, typename FE, typename FD>
+void sweep_e_damp(const std::array<int,3>& N, FE&& push_e, FD&& damp)
+{
+  const int w = D-1;
+
+  for(int t=0; t<N[w]+R; t++) {
+    if(t < N[w]) {
+      if constexpr (D == 1) push_e(t, 0, 0);
+      if constexpr (D == 2) for(int i=0; i<N[0]; i++) push_e(i, t, 0);
+      if constexpr (D == 3) {
+        for(int j=0; j<N[1]; j++)
+        for(int i=0; i<N[0]; i++) push_e(i, j, t);
+      }
+      damp(t, true, false);
+    }
+
+    if(t-R >= 0) damp(t-R, false, true);
+  }
+}
+
+} // end of namespace emf
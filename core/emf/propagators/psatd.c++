@@ -0,0 +1,309 @@
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+#include "core/emf/propagators/psatd.h"
+
+#ifdef GPU
+#include <nvtx3/nvToolsExt.h>
+#endif
+
+
+namespace {
+
+  /// coefficients of the staggered derivative stencils (order 2, 4, 6)
+  const std::vector<double>& stencil(int order)
+  {
+    static const std::vector<double> c2 = {1.0};
+    static const std::vector<double> c4 = {9.0/8.0, -1.0/24.0};
+    static const std::vector<double> c6 = {75.0/64.0, -25.0/384.0, 3.0/640.0};
+
+    assert(order == 2 || order == 4 || order == 6);
+    return order == 2 ? c2 : order == 4 ? c4 : c6;
+  }
+
+  /// size of the reference box of the k-space operator (per dimension)
+  const int nref = 32;
+
+  inline std::complex<float>* as_complex(fftwf_complex* p)
+  {
+    return reinterpret_cast<std::complex<float>*>(p);
+  }
+}
+
+
+template<size_t D>
+emf::PSATD<D>::~PSATD()
+{
+  if(forward)  fftwf_destroy_plan(forward);
+  if(backward) fftwf_destroy_plan(backward);
+  if(rbuf) fftwf_free(rbuf);
+  for(auto* c : cbuf) if(c) fftwf_free(c);
+}
+
+
+template<size_t D>
+void emf::PSATD<D>::prepare(emf::Tile<D>& tile)
+{
+  const int H = 3; // halo width
+  const auto& N = tile.mesh_lengths;
+
+  std::array<int,3> M;
+  for(size_t a=0; a<3; a++) M[a] = a < D ? N[a] + 2*H : 1;
+
+  const double cdt_new = corr*tile.cfl;
+  if(M == box && cdt_new == cdt && order == korder) return;
+
+  const int Mc = M[0]/2 + 1; // r2c output length along the first axis
+
+  //--------------------------------------------------
+  // plans and buffers; fftw wants the slowest dimension first
+  if(M != box) {
+    if(forward)  fftwf_destroy_plan(forward);
+    if(backward) fftwf_destroy_plan(backward);
+    if(rbuf) fftwf_free(rbuf);
+    for(auto* c : cbuf) if(c) fftwf_free(c);
+
+    rbuf = fftwf_alloc_real(M[0]*M[1]*M[2]);
+    for(auto& c : cbuf) c = fftwf_alloc_complex(Mc*M[1]*M[2]);
+
+    int dims[D];
+    for(size_t a=0; a<D; a++) dims[a] = M[D-1-a];
+
+    forward  = fftwf_plan_dft_r2c(D, dims, rbuf, cbuf[0], FFTW_ESTIMATE);
+    backward = fftwf_plan_dft_c2r(D, dims, cbuf[0], rbuf, FFTW_ESTIMATE);
+    box = M;
+  }
+
+  //--------------------------------------------------
+  // k-space operator on a reference box that does not depend on the tile size
+  const double pi = 3.14159265358979323846;
+
+  std::array<int,3> R;
+  for(size_t a=0; a<3; a++) R[a] = a < D ? nref : 1;
+
+  std::array<std::vector<double>, 3> kk, K;                // wave numbers and stencil symbols
+  std::array<std::vector<std::complex<double>>, 3> deriv; // i K e^{ik/2}
+  for(size_t a=0; a<3; a++) {
+    kk[a].resize(R[a]);
+    K[a].resize(R[a]);
+    deriv[a].resize(R[a]);
+
+    for(int q=0; q<R[a]; q++) {
+      const double k = 2.0*pi*(2*q <= R[a] ? q : q - R[a])/R[a];
+
+      double s = k;
+      if(order > 0) {
+        const auto& c = stencil(order);
+        s = 0.0;
+        for(size_t m=0; m<c.size(); m++) s += 2.0*c[m]*std::sin((2*m+1)*0.5*k);
+      }
+
+      kk[a][q] = k;
+      K[a][q] = s;
+      deriv[a][q] = std::complex<double>(-s*std::sin(0.5*k), s*std::cos(0.5*k));
+    }
+  }
+
+  // time factor of each mode
+  std::vector<double> factor(R[0]*R[1]*R[2]);
+  for(int r=0; r<R[2]; r++)
+  for(int q=0; q<R[1]; q++)
+  for(int p=0; p<R[0]; p++) {
+    const double kabs = std::sqrt(K[0][p]*K[0][p] + K[1][q]*K[1][q] + K[2][r]*K[2][r]);
+    const double x = 0.5*kabs*cdt_new;
+    factor[p + R[0]*(q + R[1]*r)] = x > 0.0 ? std::sin(x)/x : 1.0;
+  }
+
+  //--------------------------------------------------
+  // real-space taps of the forward derivatives, truncated to the halo: 
+  // offsets -(H-1)...H along the derivative axis (the staggered point is at +1/2) 
+  // and -H...H along the other axes. An interior cell then reads only the
+  // padded box and nothing wraps around it.
+  std::array<int,3> w; // tap window width
+  for(size_t a=0; a<3; a++) w[a] = a < D ? 2*H + 1 : 1;
+  const int nw = w[0]*w[1]*w[2];
+
+  auto offset = [&](int n, size_t a) {
+    const int i = a == 0 ? n % w[0] : a == 1 ? (n/w[0]) % w[1] : n/(w[0]*w[1]);
+    return a < D ? i - H : 0;
+  };
+
+  std::array<std::vector<double>, 3> taps;
+  for(size_t a=0; a<3; a++) {
+    taps[a].assign(nw, 0.0);
+    if(a >= D) continue;
+
+    for(int n=0; n<nw; n++) {
+      if(offset(n, a) < -(H-1)) continue;
+
+      const int r0 = offset(n, 0), r1 = offset(n, 1), r2 = offset(n, 2);
+      std::complex<double> t = 0.0;
+      for(int r=0; r<R[2]; r++)
+      for(int q=0; q<R[1]; q++)
+      for(int p=0; p<R[0]; p++) {
+        const double ph = kk[0][p]*r0 + kk[1][q]*r1 + kk[2][r]*r2;
+        const auto& da = a == 0 ? deriv[0][p] : a == 1 ? deriv[1][q] : deriv[2][r];
+        t += da*factor[p + R[0]*(q + R[1]*r)]*std::polar(1.0, -ph);
+      }
+      taps[a][n] = t.real()/(R[0]*R[1]*R[2]);
+    }
+  }
+
+  //--------------------------------------------------
+  // truncation can lift |S| slightly above the PSATD value; scale the taps
+  // so that the leapfrog stays stable, (cdt/2)|S(k)| <= 1
+  double smax = 0.0;
+  for(int r=0; r<R[2]; r++)
+  for(int q=0; q<R[1]; q++)
+  for(int p=0; p<R[0]; p++) {
+    double s2 = 0.0;
+    for(size_t a=0; a<D; a++) {
+      std::complex<double> S = 0.0;
+      for(int n=0; n<nw; n++) {
+        if(taps[a][n] == 0.0) continue;
+        const double ph = kk[0][p]*offset(n, 0) + kk[1][q]*offset(n, 1) + kk[2][r]*offset(n, 2);
+        S += taps[a][n]*std::polar(1.0, ph);
+      }
+      s2 += std::norm(S);
+    }
+    smax = std::max(smax, 0.5*cdt_new*std::sqrt(s2));
+  }
+  const double scale = smax > 1.0 ? 1.0/smax : 1.0;
+
+  //--------------------------------------------------
+  // symbols on the padded box: taps at -r (mod M) transformed with the 
+  // forward plan give sum_r t(r) e^{ikr}; incl. the FFT normalization
+  const double norm = scale/(M[0]*M[1]*M[2]);
+  for(size_t a=0; a<3; a++) {
+    sym[a].assign(Mc*M[1]*M[2], 0.0f);
+    if(a >= D) continue;
+
+    std::fill(rbuf, rbuf + M[0]*M[1]*M[2], 0.0f);
+    for(int n=0; n<nw; n++) {
+      const int i = (M[0] - offset(n, 0)) % M[0];
+      const int j = (M[1] - offset(n, 1)) % M[1];
+      const int k = (M[2] - offset(n, 2)) % M[2];
+      rbuf[i + M[0]*(j + M[1]*k)] = taps[a][n]*norm;
+    }
+
+    fftwf_execute_dft_r2c(forward, rbuf, cbuf[0]);
+    auto* c = as_complex(cbuf[0]);
+    for(int n=0; n<Mc*M[1]*M[2]; n++) sym[a][n] = c[n];
+  }
+
+  cdt = cdt_new;
+  korder = order;
+}
+
+
+template<size_t D>
+void emf::PSATD<D>::add_curl(
+    emf::Tile<D>& tile,
+    std::array<toolbox::Mesh<float,3>*, 3> src,
+    std::array<toolbox::Mesh<float,3>*, 3> dst,
+    float C,
+    bool fwd)
+{
+  prepare(tile);
+
+  const int H = 3; // halo width
+  const auto& N = tile.mesh_lengths;
+  const auto& M = box;
+  const int Mc = M[0]/2 + 1;
+
+  std::array<int,3> h; // halo width of each dimension
+  for(size_t a=0; a<3; a++) h[a] = a < D ? H : 0;
+
+  //--------------------------------------------------
+  // padded source components to k-space
+  for(int c=0; c<3; c++) {
+    auto& m = *src[c];
+    for(int k=-h[2]; k<N[2]+h[2]; k++)
+    for(int j=-h[1]; j<N[1]+h[1]; j++)
+    for(int i=-h[0]; i<N[0]+h[0]; i++)
+      rbuf[(i+h[0]) + M[0]*((j+h[1]) + M[1]*(k+h[2]))] = m(i,j,k);
+
+    fftwf_execute_dft_r2c(forward, rbuf, cbuf[c]);
+  }
+
+  //--------------------------------------------------
+  // curl; backward differences have the symbol -conj(S)
+  auto* fx = as_complex(cbuf[0]);
+  auto* fy = as_complex(cbuf[1]);
+  auto* fz = as_complex(cbuf[2]);
+
+  const float sgn = fwd ? 1.0f : -1.0f;
+  for(int n=0; n<Mc*M[1]*M[2]; n++) {
+    auto dx = sym[0][n], dy = sym[1][n], dz = sym[2][n];
+    if(!fwd) {
+      dx = std::conj(dx);
+      dy = std::conj(dy);
+      dz = std::conj(dz);
+    }
+
+    const auto ex = fx[n], ey = fy[n], ez = fz[n];
+
+    fx[n] = sgn*(dy*ez - dz*ey);
+    fy[n] = sgn*(dz*ex - dx*ez);
+    fz[n] = sgn*(dx*ey - dy*ex);
+  }
+
+  //--------------------------------------------------
+  // back to real space; only the interior is updated
+  for(int c=0; c<3; c++) {
+    fftwf_execute_dft_c2r(backward, cbuf[c], rbuf);
+
+    auto& m = *dst[c];
+    for(int k=0; k<N[2]; k++)
+    for(int j=0; j<N[1]; j++)
+    for(int i=0; i<N[0]; i++)
+      m(i,j,k) += C*rbuf[(i+h[0]) + M[0]*((j+h[1]) + M[1]*(k+h[2]))];
+  }
+}
+
+
+/// Update E field with full step
+template<size_t D>
+void emf::PSATD<D>::push_e(emf::Tile<D>& tile)
+{
+#ifdef GPU
+  nvtxRangePush(__PRETTY_FUNCTION__);
+#endif
+
+  auto& gs = tile.get_grids();
+  const float C = corr*tile.cfl;
+
+  add_curl(tile, {&gs.bx, &gs.by, &gs.bz}, {&gs.ex, &gs.ey, &gs.ez}, C, false);
+
+#ifdef GPU
+  nvtxRangePop();
+#endif
+}
+
+
+/// Update B field with a half step
+template<size_t D>
+void emf::PSATD<D>::push_half_b(emf::Tile<D>& tile)
+{
+#ifdef GPU
+  nvtxRangePush(__PRETTY_FUNCTION__);
+#endif
+
+  auto& gs = tile.get_grids();
+  const float C = 0.5*corr*tile.cfl;
+
+  add_curl(tile, {&gs.ex, &gs.ey, &gs.ez}, {&gs.bx, &gs.by, &gs.bz}, -C, true);
+
+#ifdef GPU
+  nvtxRangePop();
+#endif
+}
+
+
+//--------------------------------------------------
+// explicit template instantiation
+
+template class emf::PSATD<1>;
+template class emf::PSATD<2>;
+template class emf::PSATD<3>;
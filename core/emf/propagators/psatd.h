@@ -0,0 +1,100 @@
+#pragma once
+
+#include <array>
+#include <complex>
+#include <vector>
+
+#include "fftw3.h"
+
+#include "core/emf/propagators/propagator.h"
+
+namespace emf {
+
+/*! \brief Local pseudo-spectral analytical time-domain Maxwell solver
+ *
+ * The curl is computed with FFTs of the tile padded with its halo regions
+ * (guard cells that overlap the neighbor tiles; filled by
+ * update_boundaries). Only the interior is updated, so the solver plugs
+ * into the usual push_half_b/push_e + exchange cycle of the lap.
+ *
+ * In k-space the staggered derivative along each axis has the symbol
+ * i K(k) e^{+-ik/2}, where K is the symbol of a staggered stencil of given
+ * order (order = 0 uses the exact K = k). The curl is further scaled with
+ * sin(|K| cdt/2)/(|K| cdt/2): the leapfrog of push_half_b + push_e then
+ * has the analytical dispersion w = c|K| and is stable for any cfl
+ * (Vay, Haber & Godfrey 2013, the PSATD solution for constant J).
+ *
+ * Every push transforms the three source components forward and the three
+ * updates back.
+ *
+ * The time factor widens the stencil beyond the halos. The operator is
+ * therefore computed on a fixed reference box, transformed to real space
+ * and truncated to the taps that fit into the halos (within 2.5 cells of
+ * the staggered point along the derivative and 3 cells across it). An
+ * interior cell then reads only the padded box, so the result does not
+ * depend on the tiling, and tile seams are exact. The truncated operator
+ * is rescaled if needed to keep (cdt/2)|S(k)| <= 1, i.e. the leapfrog
+ * stable. The dispersion is analytical up to the truncated tail.
+ *
+ * NOTE: the exact spectral derivative (order = 0) is not local and loses
+ *       most of its accuracy in the truncation.
+ * NOTE: order = 2 (4) without the time factor would be FDTD2 (FDTD4).
+ * NOTE: plans and buffers are shared; push tiles one at a time.
+ */
+template<size_t D>
+class PSATD :
+  public Propagator<D>
+{
+  public:
+
+  /// numerical correction factor to speed of light
+  double corr = 1.0;
+
+  /// order of the staggered derivative stencil; 0 for the exact spectral derivative
+  int order = 6;
+
+  PSATD() = default;
+
+  ~PSATD();
+
+  PSATD(const PSATD&) = delete;
+  PSATD& operator=(const PSATD&) = delete;
+
+  void push_e(Tile<D>& tile) override;
+
+  void push_half_b(Tile<D>& tile) override;
+
+  private:
+
+  /// padded box dimensions (tile + halos) of the current plans
+  std::array<int,3> box = {0, 0, 0};
+
+  /// c dt and order of the current k-space operator
+  double cdt = 0.0;
+  int korder = -1;
+
+  /// real-space box and three complex spectra
+  float* rbuf = nullptr;
+  std::array<fftwf_complex*, 3> cbuf = {nullptr, nullptr, nullptr};
+
+  fftwf_plan forward  = nullptr;
+  fftwf_plan backward = nullptr;
+
+  /// symbols of the truncated forward derivatives incl. the time factor and
+  //  the FFT normalization for each mode of the padded box; the backward 
+  //  ones are -conj
+  std::array<std::vector<std::complex<float>>, 3> sym;
+
+  /// (re)create the plans and the k-space operator if the tile or cfl changed
+  void prepare(Tile<D>& tile);
+
+  /// add sign*C*curl(src) into the interior of dst; forward differences for B
+  void add_curl(Tile<D>& tile,
+      std::array<toolbox::Mesh<float,3>*, 3> src,
+      std::array<toolbox::Mesh<float,3>*, 3> dst,
+      float C,
+      bool fwd);
+};
+
+
+} // end of namespace emf
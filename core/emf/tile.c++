@@ -1,9 +1,13 @@
 #include <iostream>
 #include <cmath>
+#include <set>
+#include <stdexcept>
+#include <string>
 
 #include "core/emf/tile.h"
 
 #include "tools/has_element.h"
+#include "tools/shm_window.h"
 #include "external/iter/iter.h"
 #include "external/iter/allocator.h"
 
@@ -1299,7 +1303,37 @@ std::vector<mpi::request> Tile<D>::send_data(
 
   UniIter::sync();
 
-  if (mode == 0) {
+  if (packed_halos && mode <= 2) {
+    // all three components of the halo regions read on dest go into one message
+    const auto& ind = get_halo_indices(dest, mode == 0);
+    const size_t N = ind.size();
+
+    auto& shm = toolbox::ShmWindow::get();
+    const bool on_node = shm.on_node(dest);
+
+    // ranks on the same node read the halos straight from our shared memory segment
+    float* buf = nullptr;
+    if(on_node) {
+      buf = shm.allocate(3*N, halo_shm_offsets[dest]);
+      if(buf == nullptr)
+        throw std::runtime_error("emf::Tile: shared memory window is full (" + 
+            std::to_string(shm.capacity_bytes()) + " bytes per rank); tile ownership changed "
+            "after the size check of Scheduler.set_shm_exchange");
+    } else {
+      auto& vbuf = halo_send_buffers[dest];
+      vbuf.resize(3*N);
+      buf = vbuf.data();
+    }
+
+    pack_halos(dest, mode, buf);
+
+    if(on_node) {
+      shm.sync(); // publish before announcing the offset
+      reqs.emplace_back( comm.isend(dest, get_tag(tag, 3*mode), &halo_shm_offsets[dest], 1) );
+    } else {
+      reqs.emplace_back( comm.isend(dest, get_tag(tag, 3*mode), buf, 3*N) );
+    }
+  } else if (mode == 0) {
     reqs.emplace_back( comm.isend(dest, get_tag(tag, 0), gs.jx.data(), gs.jx.size()) );
     reqs.emplace_back( comm.isend(dest, get_tag(tag, 1), gs.jy.data(), gs.jy.size()) );
     reqs.emplace_back( comm.isend(dest, get_tag(tag, 2), gs.jz.data(), gs.jz.size()) );
@@ -1339,7 +1373,22 @@ std::vector<mpi::request> Tile<D>::recv_data(
 
   UniIter::sync();
 
-  if (mode == 0) {
+  if (packed_halos && mode <= 2) {
+    // unpacked with unpack_halos after the message has arrived
+    const auto& ind = get_halo_indices(comm.rank(), mode == 0);
+    halo_recv_mode = mode;
+    halo_recv_rank = comm.rank();
+    halo_recv_orig = orig;
+
+    if(toolbox::ShmWindow::get().on_node(orig)) {
+      // location of the halos in the sender's shared memory segment
+      reqs.emplace_back( comm.irecv(orig, get_tag(tag, 3*mode), &halo_recv_shm_offset, 1) );
+    } else {
+      halo_recv_shm_offset = -1;
+      halo_recv_buffer.resize(3*ind.size());
+      reqs.emplace_back( comm.irecv(orig, get_tag(tag, 3*mode), halo_recv_buffer.data(), halo_recv_buffer.size()) );
+    }
+  } else if (mode == 0) {
     reqs.emplace_back( comm.irecv(orig, get_tag(tag, 0), gs.jx.data(), gs.jx.size()) );
     reqs.emplace_back( comm.irecv(orig, get_tag(tag, 1), gs.jy.data(), gs.jy.size()) );
     reqs.emplace_back( comm.irecv(orig, get_tag(tag, 2), gs.jz.data(), gs.jz.size()) );
@@ -1360,6 +1409,201 @@ std::vector<mpi::request> Tile<D>::recv_data(
   return reqs;
 }
 
+//--------------------------------------------------
+// packed halo communication
+
+template<>
+int Tile<1>::get_neighbor_owner(corgi::Grid<1>& grid, int in, int /*jn*/, int /*kn*/)
+{
+  auto tpr = grid.get_tileptr( neighs(in) );
+  return tpr ? tpr->communication.owner : -1;
+}
+
+template<>
+int Tile<2>::get_neighbor_owner(corgi::Grid<2>& grid, int in, int jn, int /*kn*/)
+{
+  auto tpr = grid.get_tileptr( neighs(in, jn) );
+  return tpr ? tpr->communication.owner : -1;
+}
+
+template<>
+int Tile<3>::get_neighbor_owner(corgi::Grid<3>& grid, int in, int jn, int kn)
+{
+  auto tpr = grid.get_tileptr( neighs(in, jn, kn) );
+  return tpr ? tpr->communication.owner : -1;
+}
+
+
+template<std::size_t D>
+void Tile<D>::set_halo_owners(corgi::Grid<D>& grid)
+{
+  halo_owners.fill(-1);
+
+  for(int in=-1; in<=1; in++) {
+    for(int jn=(D>=2 ? -1 : 0); jn<=(D>=2 ? 1 : 0); jn++) {
+      for(int kn=(D>=3 ? -1 : 0); kn<=(D>=3 ? 1 : 0); kn++) {
+        if (in == 0 && jn == 0 && kn == 0) continue;
+        halo_owners[9*(in+1) + 3*(jn+1) + (kn+1)] = get_neighbor_owner(grid, in, jn, kn);
+      }
+    }
+  }
+
+  // ownership changed; rebuild index lists on demand
+  halo_indices.clear();
+  packed_halos = true;
+}
+
+
+template<std::size_t D>
+void Tile<D>::set_current_depth(int depth)
+{
+  current_depth = depth;
+  halo_indices.clear();
+}
+
+
+template<std::size_t D>
+const std::vector<int>& Tile<D>::get_halo_indices(int rank, bool currents)
+{
+  auto key = std::make_pair(rank, currents);
+  auto it = halo_indices.find(key);
+  if(it != halo_indices.end()) return it->second;
+
+  auto& gs = get_grids();
+  const int halo = 3; // halo region size for fields
+  const std::array<int,3> N = {gs.Nx, gs.Ny, gs.Nz};
+
+  // tiles of rank in direction (in,jn,kn) read from this tile 
+  //  - fields: the interior strip of width halo facing them (update_boundaries)
+  //  - currents: additionally the halo strip facing them (exchange_currents);
+  //    the interior strip is current_depth wide for multi-pass filters
+  // overlapping regions of different neighbors are included only once
+  const int depth = currents ? std::max(halo, current_depth) : halo;
+  std::vector<char> mask(gs.jx.size(), 0);
+
+  for(int in=-1; in<=1; in++) {
+    for(int jn=-1; jn<=1; jn++) {
+      for(int kn=-1; kn<=1; kn++) {
+        if (in == 0 && jn == 0 && kn == 0) continue;
+        if (halo_owners[9*(in+1) + 3*(jn+1) + (kn+1)] != rank) continue;
+
+        const std::array<int,3> dir = {in, jn, kn};
+        std::array<int,3> lo, hi;
+        for(size_t a=0; a<3; a++) {
+          if(dir[a] == -1) { lo[a] = currents ? -halo : 0;  hi[a] = depth; }
+          if(dir[a] ==  0) { lo[a] = 0;                     hi[a] = N[a]; }
+          if(dir[a] == +1) { lo[a] = N[a] - depth;          hi[a] = currents ? N[a] + halo : N[a]; }
+
+          lo[a] = std::max(lo[a], -halo); // for tiles smaller than halo
+        }
+
+        for(int k=lo[2]; k<hi[2]; k++) 
+        for(int j=lo[1]; j<hi[1]; j++) 
+        for(int i=lo[0]; i<hi[0]; i++) 
+          mask[gs.jx.indx(i,j,k)] = 1;
+      }
+    }
+  }
+
+  // in memory order for a streaming gather
+  auto& ind = halo_indices[key];
+  for(size_t n=0; n<mask.size(); n++) if(mask[n]) ind.push_back(n);
+
+  // every message partner is a neighbor; an empty list means stale owners
+  if(ind.empty()) {
+    halo_indices.erase(key);
+    throw std::runtime_error("emf::Tile: no neighbor of rank " + std::to_string(rank) + 
+        " in halo_owners; call set_halo_owners after tile ownership changes");
+  }
+
+  return ind;
+}
+
+
+template<std::size_t D>
+size_t Tile<D>::shm_halo_words(int mode)
+{
+  auto& shm = toolbox::ShmWindow::get();
+  std::set<int> ranks;
+  for(int rank : halo_owners) 
+    if(rank >= 0 && rank != this->communication.owner && shm.on_node(rank)) ranks.insert(rank);
+
+  size_t words = 0;
+  for(int rank : ranks) words += 3*get_halo_indices(rank, mode == 0).size();
+  return words;
+}
+
+
+template<std::size_t D>
+void Tile<D>::pack_halos(int rank, int mode, float* buf)
+{
+  auto& gs = get_grids(); 
+  const auto& ind = get_halo_indices(rank, mode == 0);
+  const size_t N = ind.size();
+
+  auto& m1 = mode == 0 ? gs.jx : mode == 1 ? gs.ex : gs.bx;
+  auto& m2 = mode == 0 ? gs.jy : mode == 1 ? gs.ey : gs.by;
+  auto& m3 = mode == 0 ? gs.jz : mode == 1 ? gs.ez : gs.bz;
+
+  for(size_t n=0; n<N; n++) {
+    buf[n      ] = m1(ind[n]);
+    buf[n +   N] = m2(ind[n]);
+    buf[n + 2*N] = m3(ind[n]);
+  }
+}
+
+
+template<std::size_t D>
+void Tile<D>::scatter_halos(int rank, int mode, const float* buf)
+{
+  auto& gs = get_grids(); 
+  const auto& ind = get_halo_indices(rank, mode == 0);
+  const size_t N = ind.size();
+
+  auto& m1 = mode == 0 ? gs.jx : mode == 1 ? gs.ex : gs.bx;
+  auto& m2 = mode == 0 ? gs.jy : mode == 1 ? gs.ey : gs.by;
+  auto& m3 = mode == 0 ? gs.jz : mode == 1 ? gs.ez : gs.bz;
+
+  for(size_t n=0; n<N; n++) {
+    m1(ind[n]) = buf[n      ];
+    m2(ind[n]) = buf[n +   N];
+    m3(ind[n]) = buf[n + 2*N];
+  }
+}
+
+
+template<std::size_t D>
+void Tile<D>::unpack_halos(int mode)
+{
+  if(halo_recv_mode != mode) return;
+
+  const float* buf = halo_recv_buffer.data();
+  if(halo_recv_shm_offset >= 0) {
+    auto& shm = toolbox::ShmWindow::get();
+    shm.sync(); // see the sender's writes
+    buf = shm.remote(halo_recv_orig, halo_recv_shm_offset);
+  }
+
+  scatter_halos(halo_recv_rank, mode, buf);
+
+  halo_recv_mode = -1;
+  halo_recv_shm_offset = -1;
+}
+
+
+template<std::size_t D>
+void Tile<D>::copy_halos(Tile<D>& src, int rank, int mode)
+{
+  const size_t N = get_halo_indices(rank, mode == 0).size();
+  if(src.get_halo_indices(rank, mode == 0).size() != N) 
+    throw std::runtime_error("emf::Tile::copy_halos: halo regions of src and this tile differ");
+
+  std::vector<float> buf(3*N);
+  src.pack_halos(rank, mode, buf.data());
+  scatter_halos(rank, mode, buf.data());
+}
+
+
 //--------------------------------------------------
 // explicit template instantiation
 
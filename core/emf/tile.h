@@ -1,6 +1,7 @@
 #pragma once
 
 #include <vector>
+#include <map>
 #include <mpi4cpp/mpi.h>
 
 #include "external/corgi/tile.h"
@@ -149,6 +150,7 @@ class Tile :
     if (D == 1) assert(ny == 1 && nz == 1);
     if (D == 2) assert(nz == 1);
 
+    halo_owners.fill(-1);
   }
 
   ~Tile() override = default;
@@ -188,6 +190,68 @@ class Tile :
   std::vector<mpi::request> 
   recv_data( mpi::communicator& /*comm*/, int orig, int mode, int tag) override;
 
+  //--------------------------------------------------
+  // packed halo communication
+
+  /// owner rank of neighbor tile (in,jn,kn) stored at 9*(in+1) + 3*(jn+1) + (kn+1); -1 if not known
+  std::array<int, 27> halo_owners;
+
+  /// MPI modes 0-2 (j, e, b) send only the mesh regions that the receiving rank reads 
+  bool packed_halos = false;
+
+  /// record neighbor tile owners and switch to packed halo messages.
+  // NOTE: both ends need the same ownership information so this needs to be called for 
+  //       local and virtual tiles of every rank, and again when tile ownership changes
+  void set_halo_owners(corgi::Grid<D>& grid);
+
+  /// interior depth of the current strips in packed messages (at least the halo width);
+  // multi-pass filters read npasses deep into the neighbors. Same note as above applies.
+  void set_current_depth(int depth);
+
+  /// copy the last packed halo message of mode into the meshes
+  // NOTE: halos of ranks on the same node are read from the sender's shared
+  //       memory segment (toolbox::ShmWindow) and have to be unpacked before
+  //       the next exchange phase starts
+  void unpack_halos(int mode);
+
+  /// words of the shared memory window that send_data of mode uses for this tile
+  // (packed halos to other ranks on the node); fixed by halo_owners, so the
+  // window can be sized at setup
+  size_t shm_halo_words(int mode);
+
+  /// copy the halo regions of mode that tiles of rank read from src (another copy of 
+  // this tile) through the packed message layout; tests packed halos on a single rank
+  void copy_halos(Tile<D>& src, int rank, int mode);
+
+  private:
+
+  /// owner rank of neighbor tile (in,jn,kn); -1 if it is not known
+  int get_neighbor_owner(corgi::Grid<D>& grid, int in, int jn, int kn);
+
+  /// mesh indices packed into messages between this tile and tiles of rank; 
+  // currents include the halo regions added up in exchange_currents
+  const std::vector<int>& get_halo_indices(int rank, bool currents);
+
+  /// gather the halo regions of mode read by tiles of rank into buf (3 components)
+  void pack_halos(int rank, int mode, float* buf);
+
+  /// scatter halo regions of mode packed for rank from buf into the meshes
+  void scatter_halos(int rank, int mode, const float* buf);
+
+  int current_depth = 3;
+
+  std::map< std::pair<int,bool>, std::vector<int> > halo_indices;
+  std::map< int, std::vector<float> > halo_send_buffers; // one per destination rank
+  std::vector<float> halo_recv_buffer;
+  int halo_recv_mode = -1;
+  int halo_recv_rank = -1;
+
+  // shared memory exchange with ranks on the same node: only the offset of the
+  // packed halos in the sender's segment goes through MPI
+  std::map< int, int > halo_shm_offsets; // one per destination rank
+  int halo_recv_shm_offset = -1;
+  int halo_recv_orig = -1;
+
 };
 
 
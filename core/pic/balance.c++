@@ -0,0 +1,178 @@
+#include <deque>
+#include <stdexcept>
+
+#include "core/pic/balance.h"
+#include "core/pic/communicate.h"
+
+#ifdef GPU
+#include <nvtx3/nvToolsExt.h>
+#endif
+
+namespace pic {
+
+namespace {
+  /// message tags of migrated tiles; messages of one rank pair are matched in cid order
+  constexpr int tag_counts = 40;
+  constexpr int tag_fields = 41;
+  constexpr int tag_prtcls = 42;
+
+  /// field meshes of a tile that are migrated
+  template<size_t D>
+  std::vector<toolbox::Mesh<float,3>*> migrated_meshes(Tile<D>& tile)
+  {
+    auto& gs = tile.get_grids();
+    return { &gs.ex, &gs.ey, &gs.ez,
+             &gs.bx, &gs.by, &gs.bz,
+             &gs.jx, &gs.jy, &gs.jz,
+             &gs.rho };
+  }
+
+  /// number of tiles in the grid
+  template<size_t D>
+  size_t ntiles_of(corgi::Grid<D>& grid)
+  {
+    auto lens = grid.lens();
+    size_t n = 1;
+    for(size_t d=0; d<D; d++) n *= lens[d];
+    return n;
+  }
+}
+
+
+template<size_t D>
+std::vector<double> tile_particle_counts(corgi::Grid<D>& grid)
+{
+  std::vector<double> counts(ntiles_of(grid), 0.0);
+
+  for(auto cid : grid.get_local_tiles()) {
+    auto& tile = dynamic_cast<Tile<D>&>(grid.get_tile( cid ));
+    for(int ispc=0; ispc<tile.Nspecies(); ispc++) counts[cid] += tile.get_container(ispc).size();
+  }
+
+  // every tile is local to one rank only
+  MPI_Allreduce(MPI_IN_PLACE, counts.data(), counts.size(), MPI_DOUBLE, MPI_SUM, grid.comm);
+
+  return counts;
+}
+
+
+template<size_t D>
+void migrate_tiles(
+    corgi::Grid<D>& grid,
+    const std::vector<int>& old_owner,
+    const std::vector<int>& new_owner)
+{
+#ifdef GPU
+  nvtxRangePush(__PRETTY_FUNCTION__);
+#endif
+
+  const size_t ntiles = ntiles_of(grid);
+  if(old_owner.size() != ntiles || new_owner.size() != ntiles)
+    throw std::invalid_argument("migrate_tiles: owner arrays do not match the grid");
+
+  const int rank = grid.comm.rank();
+
+  // send buffers stay alive until all messages are done
+  struct Outgoing {
+    std::vector<int> counts;
+    std::vector<float> fields;
+    std::vector<ManVec<Particle>> prtcls;
+  };
+  std::deque<Outgoing> outgoing;
+  std::vector<uint64_t> given;
+
+  std::vector<mpi4cpp::mpi::request> reqs;
+
+  //--------------------------------------------------
+  // pack and send tiles that leave
+  for(uint64_t cid=0; cid<ntiles; cid++) {
+    if(old_owner[cid] != rank || new_owner[cid] == rank) continue;
+    const int dest = new_owner[cid];
+
+    auto& tile = dynamic_cast<Tile<D>&>(grid.get_tile( cid ));
+    outgoing.emplace_back();
+    auto& msg = outgoing.back();
+
+    for(auto* m : migrated_meshes(tile)) msg.fields.insert(msg.fields.end(), m->data(), m->data() + m->size());
+
+    msg.prtcls.resize(tile.Nspecies());
+    for(int ispc=0; ispc<tile.Nspecies(); ispc++) {
+      tile.get_container(ispc).pack_all_particles(msg.prtcls[ispc]);
+      msg.counts.push_back(msg.prtcls[ispc].size());
+    }
+
+    reqs.push_back( grid.comm.isend(dest, tag_counts, msg.counts.data(), msg.counts.size()) );
+    reqs.push_back( grid.comm.isend(dest, tag_fields, msg.fields.data(), msg.fields.size()) );
+    for(auto& buf : msg.prtcls) {
+      if(buf.size() > 0) reqs.push_back( grid.comm.isend(dest, tag_prtcls, buf.data(), buf.size()) );
+    }
+
+    given.push_back(cid);
+  }
+
+  //--------------------------------------------------
+  // receive and unpack tiles that arrive; sends above are non-blocking
+  std::vector<int> counts;
+  std::vector<float> fields;
+  ManVec<Particle> prtcls;
+
+  for(uint64_t cid=0; cid<ntiles; cid++) {
+    if(new_owner[cid] != rank || old_owner[cid] == rank) continue;
+    const int orig = old_owner[cid];
+
+    auto& tile = dynamic_cast<Tile<D>&>(grid.get_tile( cid ));
+    auto meshes = migrated_meshes(tile);
+
+    counts.assign(tile.Nspecies(), 0);
+    grid.comm.recv(orig, tag_counts, counts.data(), counts.size());
+
+    size_t nf = 0;
+    for(auto* m : meshes) nf += m->size();
+    fields.resize(nf);
+    grid.comm.recv(orig, tag_fields, fields.data(), fields.size());
+
+    size_t i = 0;
+    for(auto* m : meshes) {
+      std::copy(fields.begin() + i, fields.begin() + i + m->size(), m->data());
+      i += m->size();
+    }
+
+    tile.delete_all_particles();
+    for(int ispc=0; ispc<tile.Nspecies(); ispc++) {
+      if(counts[ispc] == 0) continue;
+      prtcls.resize(counts[ispc]);
+      grid.comm.recv(orig, tag_prtcls, prtcls.data(), prtcls.size());
+      tile.get_container(ispc).append_particles(prtcls.data(), prtcls.size());
+    }
+  }
+
+  mpi4cpp::mpi::wait_all(reqs.begin(), reqs.end());
+
+  //--------------------------------------------------
+  // given away tiles are virtual from now on
+  for(auto cid : given) {
+    auto& tile = dynamic_cast<Tile<D>&>(grid.get_tile( cid ));
+    tile.communication.local = false;
+    tile.communication.owner = new_owner[cid];
+    tile.delete_all_particles();
+    tile.shrink_to_fit_all_particles();
+  }
+
+#ifdef GPU
+  nvtxRangePop();
+#endif
+}
+
+
+//--------------------------------------------------
+// explicit template instantiation
+
+template std::vector<double> tile_particle_counts<1>(corgi::Grid<1>&);
+template std::vector<double> tile_particle_counts<2>(corgi::Grid<2>&);
+template std::vector<double> tile_particle_counts<3>(corgi::Grid<3>&);
+
+template void migrate_tiles<1>(corgi::Grid<1>&, const std::vector<int>&, const std::vector<int>&);
+template void migrate_tiles<2>(corgi::Grid<2>&, const std::vector<int>&, const std::vector<int>&);
+template void migrate_tiles<3>(corgi::Grid<3>&, const std::vector<int>&, const std::vector<int>&);
+
+} // end of namespace pic
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <vector>
+
+#include "external/corgi/corgi.h"
+#include "core/pic/tile.h"
+
+namespace pic {
+
+/// number of particles of every tile (all species) indexed by cid; same on all ranks
+template<size_t D>
+std::vector<double> tile_particle_counts(corgi::Grid<D>& grid);
+
+
+/*! \brief Move tiles between ranks
+ *
+ * Tile cid goes from rank old_owner[cid] to new_owner[cid]; both are given
+ * for every tile of the grid and have to be the same on all ranks. The new
+ * owner has to have the tile initialized (empty containers, same number of
+ * species) before the call; its fields (with halos) and particles are
+ * overwritten with the ones of the old owner.
+ *
+ * Tiles that are given away are marked as non-local and their particles
+ * are released; they are replaced in the next virtual tile update.
+ */
+template<size_t D>
+void migrate_tiles(
+    corgi::Grid<D>& grid,
+    const std::vector<int>& old_owner,
+    const std::vector<int>& new_owner);
+
+} // end of namespace pic
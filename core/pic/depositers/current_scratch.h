@@ -0,0 +1,120 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+#include <omp.h>
+
+#include "core/emf/tile.h"
+#include "external/iter/iter.h"
+#include "tools/mesh.h"
+
+namespace pic {
+
+
+/// add to deposited current; atomics are only needed when threads share the array
+template<bool Atomic, typename T, typename S>
+DEVCALLABLE inline void deposit_add(T& lhs, S rhs)
+{
+  if constexpr (Atomic) {
+    atomic_add(lhs, rhs);
+  } else {
+    lhs += rhs;
+  }
+}
+
+
+/// current arrays of one thread; same shape (incl. halos) as the tile currents
+struct Currents {
+  toolbox::Mesh<float, 3> jx;
+  toolbox::Mesh<float, 3> jy;
+  toolbox::Mesh<float, 3> jz;
+
+  Currents(int Nx, int Ny, int Nz) :
+    jx{Nx, Ny, Nz},
+    jy{Nx, Ny, Nz},
+    jz{Nx, Ny, Nz}
+  { }
+};
+
+
+/*! \brief Thread-private scratch copies of jx/jy/jz
+ *
+ * Every OpenMP thread deposits into its own copy without atomics and the
+ * copies are summed into the tile currents once at the end. The copies are
+ * kept between calls and re-allocated only if the tile size changes.
+ *
+ * NOTE: the reduction costs (threads x cells) additions; it pays off when
+ *       there are many particles per cell.
+ */
+class CurrentScratch {
+
+  std::vector< std::unique_ptr<Currents> > buffers;
+
+  public:
+
+  /// one zeroed copy per thread with the shape of the tile currents
+  void init(const emf::Grids& gs)
+  {
+    const int nthreads = omp_get_max_threads();
+
+    bool same_shape = !buffers.empty() &&
+      buffers[0]->jx.Nx == gs.jx.Nx &&
+      buffers[0]->jx.Ny == gs.jx.Ny &&
+      buffers[0]->jx.Nz == gs.jx.Nz;
+
+    if(!same_shape) buffers.clear();
+    buffers.resize(nthreads);
+
+    // each thread allocates and clears its own copy (first touch)
+    #pragma omp parallel num_threads(nthreads)
+    {
+      auto& buf = buffers[omp_get_thread_num()];
+      if(!buf) {
+        buf = std::make_unique<Currents>(gs.jx.Nx, gs.jx.Ny, gs.jx.Nz);
+      } else {
+        buf->jx.clear();
+        buf->jy.clear();
+        buf->jz.clear();
+      }
+    }
+  }
+
+  /// copy of thread tid
+  Currents& get(int tid) { return *buffers[tid]; }
+
+  /// add all copies to the tile currents
+  void reduce(emf::Grids& gs)
+  {
+    const int nthreads = buffers.size();
+    const long N = gs.jx.size();
+
+    float* jx = gs.jx.data();
+    float* jy = gs.jy.data();
+    float* jz = gs.jz.data();
+
+    std::vector<const float*> bx(nthreads), by(nthreads), bz(nthreads);
+    for(int t=0; t<nthreads; t++) {
+      bx[t] = buffers[t]->jx.data();
+      by[t] = buffers[t]->jy.data();
+      bz[t] = buffers[t]->jz.data();
+    }
+
+    // copies are summed in the same order for every cell; result does not 
+    // depend on the thread count of the reduction
+    #pragma omp parallel for schedule(static)
+    for(long ind=0; ind<N; ind++) {
+      float sx = 0.0f, sy = 0.0f, sz = 0.0f;
+      for(int t=0; t<nthreads; t++) {
+        sx += bx[t][ind];
+        sy += by[t][ind];
+        sz += bz[t][ind];
+      }
+      jx[ind] += sx;
+      jy[ind] += sy;
+      jz[ind] += sz;
+    }
+  }
+};
+
+
+} // end of namespace pic
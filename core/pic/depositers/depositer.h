@@ -1,6 +1,7 @@
 #pragma once
 
 #include "core/pic/tile.h"
+#include "core/pic/depositers/current_scratch.h"
 #include "definitions.h"
 
 
@@ -17,9 +18,18 @@ class Depositer
 
   virtual ~Depositer() = default;
 
+  /// deposit into thread-private copies of the currents instead of atomic 
+  // adds to the tile; CPU only, ignored on GPU
+  bool private_currents = false;
+
   /// \brief deposit current to grid
   virtual void solve(pic::Tile<D>& ) = 0;
 
+  protected:
+
+  /// thread-private currents used when private_currents is set
+  CurrentScratch scratch;
+
 };
 
 } // end of namespace pic
@@ -12,6 +12,107 @@
 using std::min;
 using std::max;
 
+using pic::ZigZagSegments;
+using pic::zigzag_segments;
+using pic::zigzag_deposit;
+
+
+#ifndef GPU
+/// deposit all particles of one cell of a cell-ordered container;
+// end points x_{n+1} of all particles in a cell share the same stencil so 
+// their second-segment contributions are summed locally and written once 
+// per cell; the first segments can start in any neighbor cell and are 
+// deposited per particle as usual
+template<size_t D, bool Atomic, class J>
+inline void zigzag_deposit_cell(
+    const int cell,
+    const pic::ParticleContainer<D>& con,
+    J& js, 
+    const std::array<int,3>& lens,
+    const std::array<double,D>& mins,
+    const float c,
+    const float q,
+    const size_t iy, 
+    const size_t iz)
+{
+  using pic::deposit_add;
+
+  const int n1 = con.cell_offsets[cell];
+  const int n2 = con.cell_offsets[cell+1];
+  if(n1 == n2) return;
+
+  const int Nx = lens[0];
+  const int Ny = lens[1];
+  const int i2 = cell % Nx;
+  const int j2 = (cell / Nx) % Ny;
+  const int k2 = cell / (Nx*Ny);
+  const size_t ind2 = js.jx.indx(i2,j2,k2);
+
+  float jx00 = 0.0f, jx10 = 0.0f, jx01 = 0.0f, jx11 = 0.0f;
+  float jy00 = 0.0f, jy10 = 0.0f, jy01 = 0.0f, jy11 = 0.0f;
+  float jz00 = 0.0f, jz10 = 0.0f, jz01 = 0.0f, jz11 = 0.0f;
+
+  for(int n=n1; n<n2; n++) {
+    float x2 = D >= 1 ? con.loc(0,n) - mins[0] : 0.0f;
+    float y2 = D >= 2 ? con.loc(1,n) - mins[1] : 0.0f;
+    float z2 = D >= 3 ? con.loc(2,n) - mins[2] : 0.0f;
+
+    auto s = zigzag_segments<D>(x2, y2, z2, 
+        con.vel(0,n), con.vel(1,n), con.vel(2,n), c, q*con.wgt(n));
+
+    // first segment
+    const size_t ind1 = js.jx.indx(s.i1,s.j1,s.k1);
+
+    if(D>=1) deposit_add<Atomic>( js.jx(ind1            ), s.Fx1*(1.0-s.Wy1)*(1.0-s.Wz1) );
+    if(D>=2) deposit_add<Atomic>( js.jx(ind1    +iy     ), s.Fx1*s.Wy1      *(1.0-s.Wz1) );
+    if(D>=3) deposit_add<Atomic>( js.jx(ind1        +iz ), s.Fx1*(1.0-s.Wy1)*s.Wz1       );
+    if(D>=3) deposit_add<Atomic>( js.jx(ind1    +iy +iz ), s.Fx1*s.Wy1      *s.Wz1       );
+
+    if(D>=1) deposit_add<Atomic>( js.jy(ind1            ), s.Fy1*(1.0-s.Wx1)*(1.0-s.Wz1) );
+    if(D>=1) deposit_add<Atomic>( js.jy(ind1 +1         ), s.Fy1*s.Wx1      *(1.0-s.Wz1) );
+    if(D>=3) deposit_add<Atomic>( js.jy(ind1        +iz ), s.Fy1*(1.0-s.Wx1)*s.Wz1       );
+    if(D>=3) deposit_add<Atomic>( js.jy(ind1 +1     +iz ), s.Fy1*s.Wx1      *s.Wz1       );
+
+    if(D>=1) deposit_add<Atomic>( js.jz(ind1            ), s.Fz1*(1.0-s.Wx1)*(1.0-s.Wy1) );
+    if(D>=1) deposit_add<Atomic>( js.jz(ind1 +1         ), s.Fz1*s.Wx1      *(1.0-s.Wy1) );
+    if(D>=2) deposit_add<Atomic>( js.jz(ind1    +iy     ), s.Fz1*(1.0-s.Wx1)*s.Wy1       );
+    if(D>=2) deposit_add<Atomic>( js.jz(ind1 +1 +iy     ), s.Fz1*s.Wx1      *s.Wy1       );
+
+    // second segment; accumulated in registers
+    jx00 += s.Fx2*(1.0f-s.Wy2)*(1.0f-s.Wz2);
+    jx10 += s.Fx2*s.Wy2       *(1.0f-s.Wz2);
+    jx01 += s.Fx2*(1.0f-s.Wy2)*s.Wz2;
+    jx11 += s.Fx2*s.Wy2       *s.Wz2;
+
+    jy00 += s.Fy2*(1.0f-s.Wx2)*(1.0f-s.Wz2);
+    jy10 += s.Fy2*s.Wx2       *(1.0f-s.Wz2);
+    jy01 += s.Fy2*(1.0f-s.Wx2)*s.Wz2;
+    jy11 += s.Fy2*s.Wx2       *s.Wz2;
+
+    jz00 += s.Fz2*(1.0f-s.Wx2)*(1.0f-s.Wy2);
+    jz10 += s.Fz2*s.Wx2       *(1.0f-s.Wy2);
+    jz01 += s.Fz2*(1.0f-s.Wx2)*s.Wy2;
+    jz11 += s.Fz2*s.Wx2       *s.Wy2;
+  }
+
+  if(D>=1) deposit_add<Atomic>( js.jx(ind2            ), jx00 );
+  if(D>=2) deposit_add<Atomic>( js.jx(ind2    +iy     ), jx10 );
+  if(D>=3) deposit_add<Atomic>( js.jx(ind2        +iz ), jx01 );
+  if(D>=3) deposit_add<Atomic>( js.jx(ind2    +iy +iz ), jx11 );
+
+  if(D>=1) deposit_add<Atomic>( js.jy(ind2            ), jy00 );
+  if(D>=1) deposit_add<Atomic>( js.jy(ind2 +1         ), jy10 );
+  if(D>=3) deposit_add<Atomic>( js.jy(ind2        +iz ), jy01 );
+  if(D>=3) deposit_add<Atomic>( js.jy(ind2 +1     +iz ), jy11 );
+
+  if(D>=1) deposit_add<Atomic>( js.jz(ind2            ), jz00 );
+  if(D>=1) deposit_add<Atomic>( js.jz(ind2 +1         ), jz10 );
+  if(D>=2) deposit_add<Atomic>( js.jz(ind2    +iy     ), jz01 );
+  if(D>=2) deposit_add<Atomic>( js.jz(ind2 +1 +iy     ), jz11 );
+}
+#endif
+
+
 template<size_t D, size_t V>
 void pic::ZigZag<D,V>::solve( pic::Tile<D>& tile )
 {
@@ -29,6 +130,66 @@ void pic::ZigZag<D,V>::solve( pic::Tile<D>& tile )
   gs.jy.clear();
   gs.jz.clear();
 
+  const size_t iy = D >= 2 ? gs.jx.indx(0,1,0) - gs.jx.indx(0,0,0) : 0;
+  const size_t iz = D >= 3 ? gs.jx.indx(0,0,1) - gs.jx.indx(0,0,0) : 0;
+
+#ifndef GPU
+  // thread-private currents; no atomics in the particle loop
+  if(this->private_currents) {
+    this->scratch.init(gs);
+
+    #pragma omp parallel
+    {
+      auto& js = this->scratch.get(omp_get_thread_num());
+
+      for(auto&& con: tile.containers) {
+        const float c = tile.cfl;    // speed of light
+        const float q = con.q; // charge
+
+        // skip particle species if zero charge
+        if (q == 0.0) continue;
+
+        if(con.cells_sorted) {
+          const int Ncells = con.cell_offsets.size() - 1;
+
+          #pragma omp for schedule(dynamic, 64) nowait
+          for(int cell=0; cell<Ncells; cell++) {
+            zigzag_deposit_cell<D,false>(cell, con, js, tile.mesh_lengths, mins, c, q, iy, iz);
+          }
+          continue;
+        }
+
+        // particles are processed in blocks; segments of a block are 
+        // computed in a vectorizable loop and then scattered to js
+        constexpr int B = 32;
+        const int N = con.size();
+
+        #pragma omp for schedule(static) nowait
+        for(int n0=0; n0<N; n0+=B) {
+          const int nb = min(B, N-n0);
+          ZigZagSegments seg[B];
+
+          #pragma omp simd
+          for(int b=0; b<nb; b++) {
+            const int n = n0 + b;
+            float x2 = D >= 1 ? con.loc(0,n) - mins[0] : 0.0f;
+            float y2 = D >= 2 ? con.loc(1,n) - mins[1] : 0.0f;
+            float z2 = D >= 3 ? con.loc(2,n) - mins[2] : 0.0f;
+
+            seg[b] = zigzag_segments<D>(x2, y2, z2, 
+                con.vel(0,n), con.vel(1,n), con.vel(2,n), c, q*con.wgt(n));
+          }
+
+          for(int b=0; b<nb; b++) zigzag_deposit<D,false>(seg[b], js, iy, iz);
+        }
+      }
+    }
+
+    this->scratch.reduce(gs);
+    return;
+  }
+#endif
+
   for(auto&& con: tile.containers) {
 
     const float c = tile.cfl;    // speed of light
@@ -37,8 +198,19 @@ void pic::ZigZag<D,V>::solve( pic::Tile<D>& tile )
     // skip particle species if zero charge
     if (q == 0.0) continue;
     
-    const size_t iy = D >= 2 ? gs.jx.indx(0,1,0) - gs.ex.indx(0,0,0) : 0;
-    const size_t iz = D >= 3 ? gs.jx.indx(0,0,1) - gs.ex.indx(0,0,0) : 0;
+#ifndef GPU
+    // cell-ordered particles
+    if(con.cells_sorted) {
+      const int Ncells = con.cell_offsets.size() - 1;
+
+      #pragma omp parallel for schedule(dynamic, 64)
+      for(int cell=0; cell<Ncells; cell++) {
+        zigzag_deposit_cell<D,true>(cell, con, gs, tile.mesh_lengths, mins, c, q, iy, iz);
+      }
+
+      continue;
+    }
+#endif
 
     // no vectorization here since we dont use the general iterator
     //for(size_t n=0; n<con.size(); n++) {
@@ -53,7 +225,6 @@ void pic::ZigZag<D,V>::solve( pic::Tile<D>& tile )
       float u = con.vel(0,n);
       float v = con.vel(1,n);
       float w = con.vel(2,n);
-      float invgam = 1.0/sqrt(1.0 + u*u + v*v + w*w);
 
       //--------------------------------------------------
       // new (normalized) location, x_{n+1}
@@ -61,147 +232,40 @@ void pic::ZigZag<D,V>::solve( pic::Tile<D>& tile )
       float y2 = D >= 2 ? con.loc(1,n) - mins[1] : 0.0f;
       float z2 = D >= 3 ? con.loc(2,n) - mins[2] : 0.0f;
 
-      // previos location, x_n
-      float x1 = x2 - u*invgam*c;
-      float y1 = y2 - v*invgam*c;
-      float z1 = z2 - w*invgam*c; 
-
-      //--------------------------------------------------
-      int i1  = D >= 1 ? floor(x1) : 0;
-      int i2  = D >= 1 ? floor(x2) : 0;
-      int j1  = D >= 2 ? floor(y1) : 0;
-      int j2  = D >= 2 ? floor(y2) : 0;
-      int k1  = D >= 3 ? floor(z1) : 0;
-      int k2  = D >= 3 ? floor(z2) : 0;
-
-      // relay point; +1 is equal to +\Delta x
-      float xr = min( float(min(i1,i2)+1), max( float(max(i1,i2)), float(0.5f*(x1+x2)) ) );
-      float yr = min( float(min(j1,j2)+1), max( float(max(j1,j2)), float(0.5f*(y1+y2)) ) );
-      float zr = min( float(min(k1,k2)+1), max( float(max(k1,k2)), float(0.5f*(z1+z2)) ) );
-
-      ////--------------------------------------------------
-      //// +q since - sign is already included in the Ampere's equation
-      ////q = weight*qe;
-      float Fx1 = +q*con.wgt(n)*(xr - x1);
-      float Fy1 = +q*con.wgt(n)*(yr - y1);
-      float Fz1 = +q*con.wgt(n)*(zr - z1);
-
-      float Fx2 = +q*con.wgt(n)*(x2 - xr);
-      float Fy2 = +q*con.wgt(n)*(y2 - yr);
-      float Fz2 = +q*con.wgt(n)*(z2 - zr);
-
-      float Wx1 = D >= 1 ? 0.5f*(x1 + xr) - i1 : 0.0f;
-      float Wy1 = D >= 2 ? 0.5f*(y1 + yr) - j1 : 0.0f;
-      float Wz1 = D >= 3 ? 0.5f*(z1 + zr) - k1 : 0.0f;
-
-      float Wx2 = D >= 1 ? 0.5f*(x2 + xr) - i2 : 0.0f;
-      float Wy2 = D >= 2 ? 0.5f*(y2 + yr) - j2 : 0.0f;
-      float Wz2 = D >= 3 ? 0.5f*(z2 + zr) - k2 : 0.0f;
+      auto s = zigzag_segments<D>(x2, y2, z2, u, v, w, c, q*con.wgt(n));
 
      //-------------------------------------------------- 
      // check outflow
 #if DEBUG
        
       const int H = 3;
-      if((i1 < -H || i1 >= maxs[0] + H-1 ||
-          i2 < -H || i2 >= maxs[0] + H-1 ||
-          j1 < -H || j1 >= maxs[1] + H-1 ||
-          j2 < -H || j2 >= maxs[1] + H-1 ||
-          k1 < -H || k1 >= maxs[2] + H-1 ||
-          k2 < -H || k2 >= maxs[2] + H-1 ) ){
+      if((s.i1 < -H || s.i1 >= maxs[0] + H-1 ||
+          s.i2 < -H || s.i2 >= maxs[0] + H-1 ||
+          s.j1 < -H || s.j1 >= maxs[1] + H-1 ||
+          s.j2 < -H || s.j2 >= maxs[1] + H-1 ||
+          s.k1 < -H || s.k1 >= maxs[2] + H-1 ||
+          s.k2 < -H || s.k2 >= maxs[2] + H-1 ) ){
           //&& con.wgt(n) > 0.0) {
 
         std::cerr << "ERROR ZIGZAG:" 
-                  << " i1 " << i1 << " i2 " << i2
-                  << " j1 " << j1 << " j2 " << j2
-                  << " k1 " << k1 << " k2 " << k2
-                  << " x1 " << x1 << " x2 " << x2
-                  << " y1 " << y1 << " y2 " << y2
-                  << " z1 " << z1 << " z2 " << z2
+                  << " i1 " << s.i1 << " i2 " << s.i2
+                  << " j1 " << s.j1 << " j2 " << s.j2
+                  << " k1 " << s.k1 << " k2 " << s.k2
+                  << " x1 " << s.x1 << " x2 " << x2
+                  << " y1 " << s.y1 << " y2 " << y2
+                  << " z1 " << s.z1 << " z2 " << z2
                   << " v " << u << " " << v << " " << w 
                   << " wgt " << con.wgt(n) << " info " << con.info(n) 
                   << std::endl;
 
         // do not deposit anything
-        Fx1 = 0.0, Fx2 = 0.0, Fy1 = 0.0, Fy2 = 0.0, Fz1 = 0.0, Fz2 = 0.0;
-        i1=0, i2=0, j1=0, j2=0, k1=0, k2=0;
+        s.Fx1 = 0.0, s.Fx2 = 0.0, s.Fy1 = 0.0, s.Fy2 = 0.0, s.Fz1 = 0.0, s.Fz2 = 0.0;
+        s.i1=0, s.i2=0, s.j1=0, s.j2=0, s.k1=0, s.k2=0;
         //assert(false);
       }
 #endif
 
-      //--------------------------------------------------
-      // one-dimensional indices
-        
-      const size_t ind1 = gs.jx.indx(i1,j1,k1);
-      const size_t ind2 = gs.jx.indx(i2,j2,k2);
-        
-      if(D>=1) atomic_add( gs.jx(ind1            ), Fx1*(1.0-Wy1)*(1.0-Wz1) );
-      if(D>=2) atomic_add( gs.jx(ind1    +iy     ), Fx1*Wy1      *(1.0-Wz1) );
-      if(D>=3) atomic_add( gs.jx(ind1        +iz ), Fx1*(1.0-Wy1)*Wz1       );
-      if(D>=3) atomic_add( gs.jx(ind1    +iy +iz ), Fx1*Wy1      *Wz1       );
-
-      if(D>=1) atomic_add( gs.jx(ind2            ), Fx2*(1.0-Wy2)*(1.0-Wz2) );
-      if(D>=2) atomic_add( gs.jx(ind2    +iy     ), Fx2*Wy2      *(1.0-Wz2) );
-      if(D>=3) atomic_add( gs.jx(ind2        +iz ), Fx2*(1.0-Wy2)*Wz2       );
-      if(D>=3) atomic_add( gs.jx(ind2    +iy +iz ), Fx2*Wy2      *Wz2       );
-
-      // jy
-      if(D>=1) atomic_add( gs.jy(ind1            ), Fy1*(1.0-Wx1)*(1.0-Wz1) );
-      if(D>=1) atomic_add( gs.jy(ind1 +1         ), Fy1*Wx1      *(1.0-Wz1) );
-      if(D>=3) atomic_add( gs.jy(ind1        +iz ), Fy1*(1.0-Wx1)*Wz1       );
-      if(D>=3) atomic_add( gs.jy(ind1 +1     +iz ), Fy1*Wx1      *Wz1       );
-
-      if(D>=1) atomic_add( gs.jy(ind2            ), Fy2*(1.0-Wx2)*(1.0-Wz2) );
-      if(D>=1) atomic_add( gs.jy(ind2 +1         ), Fy2*Wx2      *(1.0-Wz2) );
-      if(D>=3) atomic_add( gs.jy(ind2        +iz ), Fy2*(1.0-Wx2)*Wz2       );
-      if(D>=3) atomic_add( gs.jy(ind2 +1     +iz ), Fy2*Wx2      *Wz2       );
-
-      // jz
-      if(D>=1) atomic_add( gs.jz(ind1            ), Fz1*(1.0-Wx1)*(1.0-Wy1) );
-      if(D>=1) atomic_add( gs.jz(ind1 +1         ), Fz1*Wx1      *(1.0-Wy1) );
-      if(D>=2) atomic_add( gs.jz(ind1    +iy     ), Fz1*(1.0-Wx1)*Wy1       );
-      if(D>=2) atomic_add( gs.jz(ind1 +1 +iy     ), Fz1*Wx1      *Wy1       );
-
-      if(D>=1) atomic_add( gs.jz(ind2            ), Fz2*(1.0-Wx2)*(1.0-Wy2) );
-      if(D>=1) atomic_add( gs.jz(ind2 +1         ), Fz2*Wx2      *(1.0-Wy2) );
-      if(D>=2) atomic_add( gs.jz(ind2    +iy     ), Fz2*(1.0-Wx2)*Wy2       );
-      if(D>=2) atomic_add( gs.jz(ind2 +1 +iy     ), Fz2*Wx2      *Wy2       );
-
-
-      // multid indexing version
-      //--------------------------------------------------
-      // jx
-      //if(D>=1) atomic_add( gs.jx(i1  , j1  , k1  ), Fx1*(1.0-Wy1)*(1.0-Wz1) );
-      //if(D>=2) atomic_add( gs.jx(i1  , j1+1, k1  ), Fx1*Wy1      *(1.0-Wz1) );
-      //if(D>=3) atomic_add( gs.jx(i1  , j1  , k1+1), Fx1*(1.0-Wy1)*Wz1       );
-      //if(D>=3) atomic_add( gs.jx(i1  , j1+1, k1+1), Fx1*Wy1      *Wz1       );
-
-      //if(D>=1) atomic_add( gs.jx(i2  , j2  , k2  ), Fx2*(1.0-Wy2)*(1.0-Wz2) );
-      //if(D>=2) atomic_add( gs.jx(i2  , j2+1, k2  ), Fx2*Wy2      *(1.0-Wz2) );
-      //if(D>=3) atomic_add( gs.jx(i2  , j2  , k2+1), Fx2*(1.0-Wy2)*Wz2       );
-      //if(D>=3) atomic_add( gs.jx(i2  , j2+1, k2+1), Fx2*Wy2      *Wz2       );
-
-      //// jy
-      //if(D>=1) atomic_add( gs.jy(i1  , j1  , k1  ), Fy1*(1.0-Wx1)*(1.0-Wz1) );
-      //if(D>=1) atomic_add( gs.jy(i1+1, j1  , k1  ), Fy1*Wx1      *(1.0-Wz1) );
-      //if(D>=3) atomic_add( gs.jy(i1  , j1  , k1+1), Fy1*(1.0-Wx1)*Wz1       );
-      //if(D>=3) atomic_add( gs.jy(i1+1, j1  , k1+1), Fy1*Wx1      *Wz1       );
-
-      //if(D>=1) atomic_add( gs.jy(i2  , j2  , k2  ), Fy2*(1.0-Wx2)*(1.0-Wz2) );
-      //if(D>=1) atomic_add( gs.jy(i2+1, j2  , k2  ), Fy2*Wx2      *(1.0-Wz2) );
-      //if(D>=3) atomic_add( gs.jy(i2  , j2  , k2+1), Fy2*(1.0-Wx2)*Wz2       );
-      //if(D>=3) atomic_add( gs.jy(i2+1, j2  , k2+1), Fy2*Wx2      *Wz2       );
-
-      //// jz
-      //if(D>=1) atomic_add( gs.jz(i1  , j1  , k1  ), Fz1*(1.0-Wx1)*(1.0-Wy1) );
-      //if(D>=1) atomic_add( gs.jz(i1+1, j1  , k1  ), Fz1*Wx1      *(1.0-Wy1) );
-      //if(D>=2) atomic_add( gs.jz(i1  , j1+1, k1  ), Fz1*(1.0-Wx1)*Wy1       );
-      //if(D>=2) atomic_add( gs.jz(i1+1, j1+1, k1  ), Fz1*Wx1      *Wy1       );
-
-      //if(D>=1) atomic_add( gs.jz(i2  , j2  , k2  ), Fz2*(1.0-Wx2)*(1.0-Wy2) );
-      //if(D>=1) atomic_add( gs.jz(i2+1, j2  , k2  ), Fz2*Wx2      *(1.0-Wy2) );
-      //if(D>=2) atomic_add( gs.jz(i2  , j2+1, k2  ), Fz2*(1.0-Wx2)*Wy2       );
-      //if(D>=2) atomic_add( gs.jz(i2+1, j2+1, k2  ), Fz2*Wx2      *Wy2       );
+      zigzag_deposit<D,true>(s, gs, iy, iz);
       
     }, con.size(), gs, con);
 
@@ -1,9 +1,126 @@
 #pragma once
 
+#include <algorithm>
+#include <cmath>
+
 #include "core/pic/depositers/depositer.h"
 
 namespace pic {
 
+/// zigzag split of a particle trajectory x_n -> x_{n+1} into two segments 
+// that each stay inside one cell; F are the current fluxes and W the 
+// mid-point weights of the segments
+struct ZigZagSegments {
+  float x1, y1, z1;
+  int i1, i2, j1, j2, k1, k2;
+  float Fx1, Fy1, Fz1, Fx2, Fy2, Fz2;
+  float Wx1, Wy1, Wz1, Wx2, Wy2, Wz2;
+};
+
+
+template<size_t D>
+DEVCALLABLE inline ZigZagSegments zigzag_segments(
+    float x2, float y2, float z2,
+    float u, float v, float w,
+    float c, float qw)
+{
+  ZigZagSegments s;
+  float invgam = 1.0/sqrt(1.0 + u*u + v*v + w*w);
+
+  // previos location, x_n
+  const float x1 = s.x1 = x2 - u*invgam*c;
+  const float y1 = s.y1 = y2 - v*invgam*c;
+  const float z1 = s.z1 = z2 - w*invgam*c; 
+
+  //--------------------------------------------------
+  s.i1  = D >= 1 ? floor(x1) : 0;
+  s.i2  = D >= 1 ? floor(x2) : 0;
+  s.j1  = D >= 2 ? floor(y1) : 0;
+  s.j2  = D >= 2 ? floor(y2) : 0;
+  s.k1  = D >= 3 ? floor(z1) : 0;
+  s.k2  = D >= 3 ? floor(z2) : 0;
+
+  // relay point; +1 is equal to +\Delta x
+  float xr = std::min( float(std::min(s.i1,s.i2)+1), std::max( float(std::max(s.i1,s.i2)), float(0.5f*(x1+x2)) ) );
+  float yr = std::min( float(std::min(s.j1,s.j2)+1), std::max( float(std::max(s.j1,s.j2)), float(0.5f*(y1+y2)) ) );
+  float zr = std::min( float(std::min(s.k1,s.k2)+1), std::max( float(std::max(s.k1,s.k2)), float(0.5f*(z1+z2)) ) );
+
+  ////--------------------------------------------------
+  //// +q since - sign is already included in the Ampere's equation
+  ////q = weight*qe;
+  s.Fx1 = +qw*(xr - x1);
+  s.Fy1 = +qw*(yr - y1);
+  s.Fz1 = +qw*(zr - z1);
+
+  s.Fx2 = +qw*(x2 - xr);
+  s.Fy2 = +qw*(y2 - yr);
+  s.Fz2 = +qw*(z2 - zr);
+
+  s.Wx1 = D >= 1 ? 0.5f*(x1 + xr) - s.i1 : 0.0f;
+  s.Wy1 = D >= 2 ? 0.5f*(y1 + yr) - s.j1 : 0.0f;
+  s.Wz1 = D >= 3 ? 0.5f*(z1 + zr) - s.k1 : 0.0f;
+
+  s.Wx2 = D >= 1 ? 0.5f*(x2 + xr) - s.i2 : 0.0f;
+  s.Wy2 = D >= 2 ? 0.5f*(y2 + yr) - s.j2 : 0.0f;
+  s.Wz2 = D >= 3 ? 0.5f*(z2 + zr) - s.k2 : 0.0f;
+
+  return s;
+}
+
+
+/// deposit both segments of one particle; 
+// J is the tile (emf::Grids) or a thread-private copy (pic::Currents)
+template<size_t D, bool Atomic, class J>
+DEVCALLABLE inline void zigzag_deposit(
+    const ZigZagSegments& s, 
+    J& js, 
+    const size_t iy, 
+    const size_t iz)
+{
+  const float Fx1 = s.Fx1, Fy1 = s.Fy1, Fz1 = s.Fz1;
+  const float Fx2 = s.Fx2, Fy2 = s.Fy2, Fz2 = s.Fz2;
+  const float Wx1 = s.Wx1, Wy1 = s.Wy1, Wz1 = s.Wz1;
+  const float Wx2 = s.Wx2, Wy2 = s.Wy2, Wz2 = s.Wz2;
+
+  //--------------------------------------------------
+  // one-dimensional indices
+  const size_t ind1 = js.jx.indx(s.i1,s.j1,s.k1);
+  const size_t ind2 = js.jx.indx(s.i2,s.j2,s.k2);
+    
+  if(D>=1) deposit_add<Atomic>( js.jx(ind1            ), Fx1*(1.0-Wy1)*(1.0-Wz1) );
+  if(D>=2) deposit_add<Atomic>( js.jx(ind1    +iy     ), Fx1*Wy1      *(1.0-Wz1) );
+  if(D>=3) deposit_add<Atomic>( js.jx(ind1        +iz ), Fx1*(1.0-Wy1)*Wz1       );
+  if(D>=3) deposit_add<Atomic>( js.jx(ind1    +iy +iz ), Fx1*Wy1      *Wz1       );
+
+  if(D>=1) deposit_add<Atomic>( js.jx(ind2            ), Fx2*(1.0-Wy2)*(1.0-Wz2) );
+  if(D>=2) deposit_add<Atomic>( js.jx(ind2    +iy     ), Fx2*Wy2      *(1.0-Wz2) );
+  if(D>=3) deposit_add<Atomic>( js.jx(ind2        +iz ), Fx2*(1.0-Wy2)*Wz2       );
+  if(D>=3) deposit_add<Atomic>( js.jx(ind2    +iy +iz ), Fx2*Wy2      *Wz2       );
+
+  // jy
+  if(D>=1) deposit_add<Atomic>( js.jy(ind1            ), Fy1*(1.0-Wx1)*(1.0-Wz1) );
+  if(D>=1) deposit_add<Atomic>( js.jy(ind1 +1         ), Fy1*Wx1      *(1.0-Wz1) );
+  if(D>=3) deposit_add<Atomic>( js.jy(ind1        +iz ), Fy1*(1.0-Wx1)*Wz1       );
+  if(D>=3) deposit_add<Atomic>( js.jy(ind1 +1     +iz ), Fy1*Wx1      *Wz1       );
+
+  if(D>=1) deposit_add<Atomic>( js.jy(ind2            ), Fy2*(1.0-Wx2)*(1.0-Wz2) );
+  if(D>=1) deposit_add<Atomic>( js.jy(ind2 +1         ), Fy2*Wx2      *(1.0-Wz2) );
+  if(D>=3) deposit_add<Atomic>( js.jy(ind2        +iz ), Fy2*(1.0-Wx2)*Wz2       );
+  if(D>=3) deposit_add<Atomic>( js.jy(ind2 +1     +iz ), Fy2*Wx2      *Wz2       );
+
+  // jz
+  if(D>=1) deposit_add<Atomic>( js.jz(ind1            ), Fz1*(1.0-Wx1)*(1.0-Wy1) );
+  if(D>=1) deposit_add<Atomic>( js.jz(ind1 +1         ), Fz1*Wx1      *(1.0-Wy1) );
+  if(D>=2) deposit_add<Atomic>( js.jz(ind1    +iy     ), Fz1*(1.0-Wx1)*Wy1       );
+  if(D>=2) deposit_add<Atomic>( js.jz(ind1 +1 +iy     ), Fz1*Wx1      *Wy1       );
+
+  if(D>=1) deposit_add<Atomic>( js.jz(ind2            ), Fz2*(1.0-Wx2)*(1.0-Wy2) );
+  if(D>=1) deposit_add<Atomic>( js.jz(ind2 +1         ), Fz2*Wx2      *(1.0-Wy2) );
+  if(D>=2) deposit_add<Atomic>( js.jz(ind2    +iy     ), Fz2*(1.0-Wx2)*Wy2       );
+  if(D>=2) deposit_add<Atomic>( js.jz(ind2 +1 +iy     ), Fz2*Wx2      *Wy2       );
+}
+
+
 /// Linear (1st order) current depositer applying the ZigZag method
 // Uses Cloud-in-cell shape (CIC)
 template<size_t D, size_t V>
@@ -13,6 +130,19 @@ class ZigZag :
 public:
   void solve(pic::Tile<D>& tile) override;
 
+  /// deposit one particle with tile-local location (x2,y2,z2) and 
+  // 4-velocity (u,v,w) after the push; qw is charge times weight
+  template<bool Atomic, class J>
+  DEVCALLABLE static inline void deposit_particle(
+      J& js,
+      const float x2, const float y2, const float z2,
+      const float u, const float v, const float w,
+      const float c, const float qw,
+      const size_t iy, const size_t iz)
+  {
+    zigzag_deposit<D,Atomic>( zigzag_segments<D>(x2, y2, z2, u, v, w, c, qw), js, iy, iz );
+  }
+
 };
 
 } // end of namespace pic
@@ -0,0 +1,205 @@
+#include <cmath> 
+
+#include "core/pic/fused.h"
+#include "tools/signum.h"
+#include "external/iter/iter.h"
+
+#ifdef GPU
+#include <nvtx3/nvToolsExt.h> 
+#endif
+
+using toolbox::sign;
+
+
+/// per-species constants of the fused update
+template<size_t D, class Ext>
+struct FusedParams {
+  std::array<double,D> mins;
+  Ext ext;   // external field policy
+  double c;  // speed of light
+  double qm; // q_s/m_s (sign only because fields are in units of q)
+  float q;   // charge
+  int iy, iz;
+};
+
+
+/// interpolate, push, and deposit particle n; 
+// J is the tile (atomic adds) or a thread-private current copy
+template<size_t D, class Interp, class Push, class Dep, bool Atomic, class J, class Ext>
+DEVCALLABLE inline void fused_update(
+    const size_t n,
+    pic::ParticleContainer<D>& con,
+    const emf::Grids& gs,
+    J& js,
+    const FusedParams<D,Ext>& p)
+{
+  // fields at the old location
+  float x = D >= 1 ? con.loc(0,n) - p.mins[0] : 0.0f;
+  float y = D >= 2 ? con.loc(1,n) - p.mins[1] : 0.0f;
+  float z = D >= 3 ? con.loc(2,n) - p.mins[2] : 0.0f;
+
+  float E[3], B[3];
+  Interp::gather(gs, p.iy, p.iz, x, y, z, E, B);
+
+  // push
+  double e[3] = { E[0], E[1], E[2] };
+  double b[3] = { B[0], B[1], B[2] };
+  p.ext.add(con.loc(0,n), con.loc(1,n), con.loc(2,n), e, b);
+
+  float u[3] = {con.vel(0,n), con.vel(1,n), con.vel(2,n)};
+  const auto ginv = Push::push_particle(u, e, b, p.c, p.qm);
+  const decltype(ginv) c = p.c;
+
+  con.vel(0,n) = u[0];
+  con.vel(1,n) = u[1];
+  con.vel(2,n) = u[2];
+
+  // NOTE: same (mixed-precision) position advance as in the pushers
+  for(size_t i=0; i<D; i++) con.loc(i,n) += con.vel(i,n)*ginv*c;
+
+  // deposit; zero charge species are only pushed
+  if(p.q == 0.0f) return;
+
+  x = D >= 1 ? con.loc(0,n) - p.mins[0] : 0.0f;
+  y = D >= 2 ? con.loc(1,n) - p.mins[1] : 0.0f;
+  z = D >= 3 ? con.loc(2,n) - p.mins[2] : 0.0f;
+
+  Dep::template deposit_particle<Atomic>(js, x, y, z, u[0], u[1], u[2], 
+      float(p.c), p.q*con.wgt(n), p.iy, p.iz);
+}
+
+
+/// store the interpolated fields of the tracked particles into Epart/Bpart; 
+// same gather as in fused_update. Other particles are left without fields.
+template<size_t D, class Interp>
+inline void store_tracked_fields(
+    pic::ParticleContainer<D>& con,
+    const emf::Grids& gs,
+    const std::array<double,D>& mins,
+    const int iy, 
+    const int iz)
+{
+  if(con.tracked.size() == 0) return;
+
+  con.Epart.resize(3*con.size());
+  con.Bpart.resize(3*con.size());
+
+  for(size_t s=0; s<con.tracked.size(); s++) {
+    const int n = con.tracked[s];
+
+    float x = D >= 1 ? con.loc(0,n) - mins[0] : 0.0f;
+    float y = D >= 2 ? con.loc(1,n) - mins[1] : 0.0f;
+    float z = D >= 3 ? con.loc(2,n) - mins[2] : 0.0f;
+
+    float E[3], B[3];
+    Interp::gather(gs, iy, iz, x, y, z, E, B);
+
+    con.ex(n) = E[0];
+    con.ey(n) = E[1];
+    con.ez(n) = E[2];
+
+    con.bx(n) = B[0];
+    con.by(n) = B[1];
+    con.bz(n) = B[2];
+  }
+}
+
+
+template<size_t D, size_t V, class Interp, class Push, class Dep>
+void pic::FusedKernel<D,V,Interp,Push,Dep>::solve( pic::Tile<D>& tile )
+{
+
+#ifdef GPU
+  nvtxRangePush(__PRETTY_FUNCTION__);
+#endif
+
+  auto& gs = tile.get_grids();
+
+  //clear arrays before new update
+  gs.jx.clear();
+  gs.jy.clear();
+  gs.jz.clear();
+
+  const int iy = D >= 2 ? gs.ex.indx(0,1,0) - gs.ex.indx(0,0,0) : 0;
+  const int iz = D >= 3 ? gs.ex.indx(0,0,1) - gs.ex.indx(0,0,0) : 0;
+
+  // fields of the test particles before they move
+  for(auto&& con : tile.containers) store_tracked_fields<D,Interp>(con, gs, tile.mins, iy, iz);
+
+  this->with_ext_field([&](auto ext){
+    FusedParams<D, decltype(ext)> p{tile.mins, ext};
+    p.c  = tile.cfl;
+    p.iy = iy;
+    p.iz = iz;
+
+#ifndef GPU
+    // thread-private currents; no atomics in the particle loop
+    if(this->private_currents) {
+      this->scratch.init(gs);
+
+      #pragma omp parallel firstprivate(p)
+      {
+        auto& js = this->scratch.get(omp_get_thread_num());
+
+        for(auto&& con : tile.containers) {
+          p.qm = sign(con.q)/con.m;
+          p.q  = con.q;
+
+          #pragma omp for schedule(static) nowait
+          for(size_t n=0; n<con.size(); n++) {
+            fused_update<D,Interp,Push,Dep,false>(n, con, gs, js, p);
+          }
+        }
+      }
+
+      this->scratch.reduce(gs);
+      return;
+    }
+#endif
+
+    for(auto&& con : tile.containers) {
+      p.qm = sign(con.q)/con.m;
+      p.q  = con.q;
+
+      UniIter::iterate([=] DEVCALLABLE (
+                  size_t n, 
+                  emf::Grids &gs,
+                  pic::ParticleContainer<D>& con
+                  ){
+        fused_update<D,Interp,Push,Dep,true>(n, con, gs, gs, p);
+      }, con.size(), gs, con);
+
+      UniIter::sync();
+    }
+  });
+
+  for(auto&& con : tile.containers) con.cells_sorted = false; // particles have moved
+
+
+#ifdef GPU
+  nvtxRangePop();
+#endif
+
+}
+
+
+//--------------------------------------------------
+// explicit template instantiation
+
+#define FUSED_INSTANTIATE(D, PUSHER) \
+  template class pic::FusedKernel<D,3, \
+    pic::LinearInterpolator<D,3>, pic::PUSHER<D,3>, pic::ZigZag<D,3>>;
+
+FUSED_INSTANTIATE(1, BorisPusher)       // 1D3V
+FUSED_INSTANTIATE(2, BorisPusher)       // 2D3V
+FUSED_INSTANTIATE(3, BorisPusher)       // 3D3V
+
+FUSED_INSTANTIATE(1, VayPusher)
+FUSED_INSTANTIATE(2, VayPusher)
+FUSED_INSTANTIATE(3, VayPusher)
+
+FUSED_INSTANTIATE(1, HigueraCaryPusher)
+FUSED_INSTANTIATE(2, HigueraCaryPusher)
+FUSED_INSTANTIATE(3, HigueraCaryPusher)
+
+#undef FUSED_INSTANTIATE
@@ -0,0 +1,38 @@
+#pragma once
+
+#include "core/pic/tile.h"
+#include "core/pic/interpolators/linear_1st.h"
+#include "core/pic/pushers/boris.h"
+#include "core/pic/pushers/vay.h"
+#include "core/pic/pushers/higuera_cary.h"
+#include "core/pic/depositers/zigzag.h"
+
+namespace pic {
+
+/*! \brief Fused interpolate-push-deposit particle update
+ *
+ * Combines the per-particle kernels of an interpolator (Interp::gather), a 
+ * pusher (Push::push_particle), and a current depositer 
+ * (Dep::deposit_particle) into one pass over the particles. Fields are kept in 
+ * registers so the Epart/Bpart arrays are not used; only the tracked (test) 
+ * particles get their interpolated fields stored there for the test particle 
+ * output.
+ *
+ * The object is a pusher (external fields) and a depositer (private_currents) 
+ * at the same time. A call to solve() replaces the fintp, pusher, and currint 
+ * calls of the lap loop. The current is deposited before the particle 
+ * communication; this gives the same currents after exchange_currents since 
+ * the deposit only depends on the new particle location and velocity.
+ */
+template<size_t D, size_t V, class Interp, class Push, class Dep>
+class FusedKernel :
+  public Push,
+  public Dep
+{
+  public:
+
+  /// interpolate, push, and deposit all particles of the tile
+  void solve(pic::Tile<D>& tile) override;
+};
+
+} // end of namespace pic
@@ -0,0 +1,192 @@
+#include <cmath>
+#include <stdexcept>
+
+#include "core/pic/injector.h"
+#include "core/pic/samplers.h"
+#include "tools/philox.h"
+
+#ifdef GPU
+#include <nvtx3/nvToolsExt.h>
+#endif
+
+namespace pic {
+
+using toolbox::Philox;
+
+// random number streams; the last byte of the counter is the draw index of the samplers
+namespace {
+  inline uint32_t count_stream(int ispc, bool aligned) { return aligned ? 0 : 64  + ispc; }
+  inline uint32_t loc_stream(  int ispc, bool aligned) { return aligned ? 1 : 128 + ispc; }
+  inline uint32_t vel_stream(  int ispc)               { return 2 + ispc; }
+
+  inline Philox::Key key_of(uint32_t seed, uint64_t cid)
+  {
+    return {{ seed, static_cast<uint32_t>(cid >> 32) }};
+  }
+
+  inline Philox::Counter counter_of(uint64_t cid, uint32_t cell, uint32_t prtcl, uint32_t stream, uint32_t draw)
+  {
+    return {{ static_cast<uint32_t>(cid), cell, prtcl, (stream << 24) | draw }};
+  }
+}
+
+
+template<size_t D>
+void BulkInjector<D>::add_species(int ispc, double ppc, double theta,
+    double gamma, int direction, int dims, float weight, bool aligned)
+{
+  if(ispc < 0 || ispc > 60) throw std::invalid_argument("BulkInjector: species index out of range");
+  if(dims != 2 && dims != 3) throw std::invalid_argument("BulkInjector: dims must be 2 or 3");
+  if(std::abs(direction) < 1 || std::abs(direction) > 3) throw std::invalid_argument("BulkInjector: invalid direction");
+
+  species.push_back({ispc, ppc, theta, gamma, direction, dims, weight, aligned});
+}
+
+
+template<size_t D>
+void BulkInjector<D>::count_particles(
+    pic::Tile<D>& tile, const Species& s, std::vector<int>& counts) const
+{
+  const auto& lens = tile.mesh_lengths;
+  const auto key = key_of(seed, tile.cid);
+  const uint32_t stream = count_stream(s.ispc, s.aligned);
+
+  counts.assign(lens[0]*lens[1]*lens[2], 0);
+
+  for(int k=0; k<lens[2]; k++)
+  for(int j=0; j<lens[1]; j++)
+  for(int i=0; i<lens[0]; i++) {
+    const uint32_t c = i + lens[0]*(j + lens[1]*k);
+
+    // cell corner in global coordinates
+    const double x =            tile.mins[0] + i;
+    const double y = D >= 2 ? tile.mins[1] + j : 0.0;
+    const double z = D >= 3 ? tile.mins[2] + k : 0.0;
+
+    const double np = s.ppc*( density ? density(x, y, z, s.ispc) : 1.0 );
+    if(np <= 0.0) continue;
+
+    int n = static_cast<int>(np);
+    const double frac = np - n;
+    if(frac > 0.0 && Philox::uniform( Philox::generate(counter_of(tile.cid, c, 0, stream, 0), key)[0] ) < frac) n++;
+
+    counts[c] = n;
+  }
+}
+
+
+template<size_t D>
+void BulkInjector<D>::fill_tile(
+    pic::Tile<D>& tile, const Species& s, const std::vector<int>& counts) const
+{
+  const auto& lens = tile.mesh_lengths;
+  const auto key = key_of(seed, tile.cid);
+  const uint64_t cid = tile.cid;
+
+  size_t N = 0;
+  for(auto n : counts) N += n;
+  if(N == 0) return;
+
+  // (cell, particle) of every particle
+  std::vector<uint32_t> cell(N), prtcl(N);
+  size_t q = 0;
+  for(size_t c=0; c<counts.size(); c++) {
+    for(int p=0; p<counts[c]; p++) {
+      cell[q]  = c;
+      prtcl[q] = p;
+      q++;
+    }
+  }
+
+  std::vector<float> x(N), y(N), z(N), ux(N), uy(N), uz(N), w(N, s.weight);
+
+  // uniform locations inside the cells
+  const uint32_t lstream = loc_stream(s.ispc, s.aligned);
+  const double x0 =          tile.mins[0];
+  const double y0 = D >= 2 ? tile.mins[1] : 0.0;
+  const double z0 = D >= 3 ? tile.mins[2] : 0.0;
+
+  #pragma omp simd
+  for(size_t n=0; n<N; n++) {
+    const uint32_t c = cell[n];
+    const int i = c % lens[0];
+    const int j = (c / lens[0]) % lens[1];
+    const int k = c / (lens[0]*lens[1]);
+
+    const auto r = Philox::generate(counter_of(cid, c, prtcl[n], lstream, 0), key);
+    x[n] = x0 + i + Philox::uniform(r[0]);
+    y[n] = y0 + j + Philox::uniform(r[1]);
+    z[n] = z0 + k + Philox::uniform(r[2]);
+  }
+
+  // velocities
+  const uint32_t vstream = vel_stream(s.ispc);
+  auto rng = [&](uint32_t n, uint32_t draw) {
+    return Philox::generate(counter_of(cid, cell[n], prtcl[n], vstream, draw), key);
+  };
+
+  sampling::sample_boosted_juttner(N, rng, s.theta, s.gamma, s.direction, s.dims,
+      ux.data(), uy.data(), uz.data());
+
+  tile.get_container(s.ispc).append_particles(N,
+      x.data(), y.data(), z.data(), ux.data(), uy.data(), uz.data(), w.data());
+}
+
+
+template<size_t D>
+std::vector<int64_t> BulkInjector<D>::inject(corgi::Grid<D>& grid)
+{
+#ifdef GPU
+  nvtxRangePush(__PRETTY_FUNCTION__);
+#endif
+
+  const auto cids = grid.get_local_tiles();
+  const size_t nt = cids.size();
+  const size_t ns = species.size();
+  const int rank = grid.rank();
+
+  std::vector<pic::Tile<D>*> tiles(nt);
+  for(size_t t=0; t<nt; t++) tiles[t] = &dynamic_cast<pic::Tile<D>&>( grid.get_tile(cids[t]) );
+
+  // particle numbers and id ranges first; density may be a python function and is called from this thread only
+  std::vector<std::vector<int>> counts(nt*ns);
+  std::vector<int64_t> id_start(nt*ns);
+  std::vector<int64_t> added(ns, 0);
+
+  for(size_t t=0; t<nt; t++) {
+    for(size_t s=0; s<ns; s++) {
+      count_particles(*tiles[t], species[s], counts[t*ns + s]);
+
+      int64_t n = 0;
+      for(auto c : counts[t*ns + s]) n += c;
+
+      id_start[t*ns + s] = injected[species[s].ispc];
+      injected[species[s].ispc] += n;
+      added[s] += n;
+    }
+  }
+
+  #pragma omp parallel for schedule(dynamic,1)
+  for(size_t t=0; t<nt; t++) {
+    for(size_t s=0; s<ns; s++) {
+      tiles[t]->get_container(species[s].ispc).set_keygen_state(id_start[t*ns + s], rank);
+      fill_tile(*tiles[t], species[s], counts[t*ns + s]);
+    }
+  }
+
+#ifdef GPU
+  nvtxRangePop();
+#endif
+
+  return added;
+}
+
+
+//--------------------------------------------------
+// explicit template instantiation
+
+template class BulkInjector<1>;
+template class BulkInjector<2>;
+template class BulkInjector<3>;
+
+} // end of namespace pic
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <vector>
+#include <map>
+#include <functional>
+#include <cstdint>
+
+#include "external/corgi/corgi.h"
+#include "core/pic/tile.h"
+
+namespace pic {
+
+/*! \brief Bulk plasma injector
+ *
+ * C++ counterpart of pytools.pic.inject: fills all local tiles of a grid
+ * with particles, tiles in parallel threads, and adds them to the
+ * containers with one bulk append per tile and species.
+ *
+ * Random numbers come from a counter-based generator (toolbox::Philox)
+ * keyed on (seed, tile, cell, particle), so the injected plasma is the same
+ * for any number of ranks and threads. Species with aligned=true share the
+ * location stream: species with the same number of particles in a cell are
+ * injected on top of each other (as with align_species in pytools).
+ *
+ * The number of particles of a cell is ppc*density(x,y,z,ispc) at the cell
+ * corner (x,y,z), rounded up or down at random; density is 1 if not given.
+ */
+template<size_t D>
+class BulkInjector
+{
+  public:
+
+  /// relative number density of species ispc at location x,y,z
+  using DensityFn = std::function<double(double, double, double, int)>;
+
+  struct Species {
+    int ispc;              // container index in the tiles
+    double ppc;            // particles per cell at density 1
+    double theta;          // temperature kT/mc^2
+    double gamma = 0.0;    // drift Lorentz factor (beta if < 1)
+    int direction = 1;     // drift direction +-1, +-2, +-3
+    int dims = 3;          // velocity dimensions (2 = xy-plane)
+    float weight = 1.0f;   // particle weight
+    bool aligned = true;   // share locations with other aligned species
+  };
+
+  uint32_t seed = 0;
+
+  std::vector<Species> species;
+
+  DensityFn density;
+
+  explicit BulkInjector(uint32_t seed = 0) : seed{seed} {}
+
+  /// add species with a (drifting) Maxwell-Juttner distribution
+  void add_species(int ispc, double ppc, double theta,
+      double gamma = 0.0, int direction = 1, int dims = 3,
+      float weight = 1.0f, bool aligned = true);
+
+  /// inject all species into the local tiles; returns the number of particles added per species
+  std::vector<int64_t> inject(corgi::Grid<D>& grid);
+
+  private:
+
+  /// particles injected so far per container; running id of the key generator
+  std::map<int, int64_t> injected;
+
+  /// particles per cell of species s in tile
+  void count_particles(pic::Tile<D>& tile, const Species& s, std::vector<int>& counts) const;
+
+  /// sample and append the particles of species s with given counts per cell
+  void fill_tile(pic::Tile<D>& tile, const Species& s, const std::vector<int>& counts) const;
+};
+
+} // end of namespace pic
@@ -1,10 +1,106 @@
 #pragma once
 
+#include <cmath>
+
 #include "core/pic/interpolators/interpolator.h"
 
 
 namespace pic {
 
+DEVCALLABLE inline float _lerp(
+      float c000, float c100, float c010, float c110,
+      float c001, float c101, float c011, float c111,
+      float dx, float dy, float dz) 
+{
+      float c00 = c000 * (1.0-dx) + c100 * dx;
+      float c10 = c010 * (1.0-dx) + c110 * dx;
+      float c0  = c00  * (1.0-dy) + c10  * dy;
+      float c01 = c001 * (1.0-dx) + c101 * dx;
+      float c11 = c011 * (1.0-dx) + c111 * dx;
+      float c1  = c01  * (1.0-dy) + c11  * dy;
+      float c   = c0   * (1.0-dz) + c1   * dz;
+      return c;
+}
+
+
+/// staggered field values at the 8 corners of the cell starting at ind;
+// corners are stored in the argument order of _lerp
+DEVCALLABLE inline void _corners(
+      const emf::Grids& gs, 
+      const int ind, const int iy, const int iz,
+      float (&c)[6][8])
+{
+  //ex
+  c[0][0] = 0.5*(gs.ex(ind       ) +gs.ex(ind-1      ));
+  c[0][1] = 0.5*(gs.ex(ind       ) +gs.ex(ind+1      ));
+  c[0][2] = 0.5*(gs.ex(ind+iy    ) +gs.ex(ind-1+iy   ));
+  c[0][3] = 0.5*(gs.ex(ind+iy    ) +gs.ex(ind+1+iy   ));
+  c[0][4] = 0.5*(gs.ex(ind+iz    ) +gs.ex(ind-1+iz   ));
+  c[0][5] = 0.5*(gs.ex(ind+iz    ) +gs.ex(ind+1+iz   ));
+  c[0][6] = 0.5*(gs.ex(ind+iy+iz ) +gs.ex(ind-1+iy+iz));
+  c[0][7] = 0.5*(gs.ex(ind+iy+iz ) +gs.ex(ind+1+iy+iz));
+
+  //ey
+  c[1][0] = 0.5*(gs.ey(ind       ) +gs.ey(ind-iy     ));
+  c[1][1] = 0.5*(gs.ey(ind+1     ) +gs.ey(ind+1-iy   ));
+  c[1][2] = 0.5*(gs.ey(ind       ) +gs.ey(ind+iy     ));
+  c[1][3] = 0.5*(gs.ey(ind+1     ) +gs.ey(ind+1+iy   ));
+  c[1][4] = 0.5*(gs.ey(ind+iz    ) +gs.ey(ind-iy+iz  ));
+  c[1][5] = 0.5*(gs.ey(ind+1+iz  ) +gs.ey(ind+1-iy+iz));
+  c[1][6] = 0.5*(gs.ey(ind+iz    ) +gs.ey(ind+iy+iz  ));
+  c[1][7] = 0.5*(gs.ey(ind+1+iz  ) +gs.ey(ind+1+iy+iz));
+
+  //ez
+  c[2][0] = 0.5*(gs.ez(ind       ) + gs.ez(ind-iz     ));
+  c[2][1] = 0.5*(gs.ez(ind+1     ) + gs.ez(ind+1-iz   ));
+  c[2][2] = 0.5*(gs.ez(ind+iy    ) + gs.ez(ind+iy-iz  ));
+  c[2][3] = 0.5*(gs.ez(ind+1+iy  ) + gs.ez(ind+1+iy-iz));
+  c[2][4] = 0.5*(gs.ez(ind       ) + gs.ez(ind+iz     ));
+  c[2][5] = 0.5*(gs.ez(ind+1     ) + gs.ez(ind+1+iz   ));
+  c[2][6] = 0.5*(gs.ez(ind+iy    ) + gs.ez(ind+iy+iz  ));
+  c[2][7] = 0.5*(gs.ez(ind+1+iy  ) + gs.ez(ind+1+iy+iz));
+
+  //--------------------------------------------------
+  // bx
+  c[3][0] = 0.25*( gs.bx(ind)+   gs.bx(ind-iy)+   gs.bx(ind-iz)+      gs.bx(ind-iy-iz));
+  c[3][1] = 0.25*( gs.bx(ind+1)+ gs.bx(ind+1-iy)+ gs.bx(ind+1-iz)+    gs.bx(ind+1-iy-iz));
+  c[3][4] = 0.25*( gs.bx(ind)+   gs.bx(ind+iz)+   gs.bx(ind-iy)+      gs.bx(ind-iy+iz));
+  c[3][5] = 0.25*( gs.bx(ind+1)+ gs.bx(ind+1+iz)+ gs.bx(ind+1-iy)+    gs.bx(ind+1-iy+iz));
+  c[3][2] = 0.25*( gs.bx(ind)+   gs.bx(ind+iy)+   gs.bx(ind-iz)+      gs.bx(ind+iy-iz));
+  c[3][3] = 0.25*( gs.bx(ind+1)+ gs.bx(ind+1-iz)+ gs.bx(ind+1+iy-iz)+ gs.bx(ind+1+iy));
+  c[3][6] = 0.25*( gs.bx(ind)+   gs.bx(ind+iy)+   gs.bx(ind+iy+iz)+   gs.bx(ind+iz));
+  c[3][7] = 0.25*( gs.bx(ind+1)+ gs.bx(ind+1+iy)+ gs.bx(ind+1+iy+iz)+ gs.bx(ind+1+iz));
+
+  // by
+  c[4][0] = 0.25*( gs.by(ind-1-iz)+    gs.by(ind-1)+       gs.by(ind-iz)+      gs.by(ind));
+  c[4][1] = 0.25*( gs.by(ind-iz)+      gs.by(ind)+         gs.by(ind+1-iz)+    gs.by(ind+1));
+  c[4][4] = 0.25*( gs.by(ind-1)+       gs.by(ind-1+iz)+    gs.by(ind)+         gs.by(ind+iz));
+  c[4][5] = 0.25*( gs.by(ind)+         gs.by(ind+iz)+      gs.by(ind+1)+       gs.by(ind+1+iz));
+  c[4][2] = 0.25*( gs.by(ind-1+iy-iz)+ gs.by(ind-1+iy)+    gs.by(ind+iy-iz)+   gs.by(ind+iy));
+  c[4][3] = 0.25*( gs.by(ind+iy-iz)+   gs.by(ind+iy)+      gs.by(ind+1+iy-iz)+ gs.by(ind+1+iy));
+  c[4][6] = 0.25*( gs.by(ind-1+iy)+    gs.by(ind-1+iy+iz)+ gs.by(ind+iy)+      gs.by(ind+iy+iz));
+  c[4][7] = 0.25*( gs.by(ind+iy)+      gs.by(ind+iy+iz)+   gs.by(ind+1+iy)+    gs.by(ind+1+iy+iz));
+
+  // bz
+  c[5][0] = 0.25*( gs.bz(ind-1-iy)+    gs.bz(ind-1)+       gs.bz(ind-iy)+      gs.bz(ind));
+  c[5][1] = 0.25*( gs.bz(ind-iy)+      gs.bz(ind)+         gs.bz(ind+1-iy)+    gs.bz(ind+1));
+  c[5][4] = 0.25*( gs.bz(ind-1-iy+iz)+ gs.bz(ind-1+iz)+    gs.bz(ind-iy+iz)+   gs.bz(ind+iz));
+  c[5][5] = 0.25*( gs.bz(ind-iy+iz)+   gs.bz(ind+iz)+      gs.bz(ind+1-iy+iz)+ gs.bz(ind+1+iz));
+  c[5][2] = 0.25*( gs.bz(ind-1)+       gs.bz(ind-1+iy)+    gs.bz(ind)+         gs.bz(ind+iy));
+  c[5][3] = 0.25*( gs.bz(ind)+         gs.bz(ind+iy)+      gs.bz(ind+1)+       gs.bz(ind+1+iy));
+  c[5][6] = 0.25*( gs.bz(ind-1+iz)+    gs.bz(ind-1+iy+iz)+ gs.bz(ind+iz)+      gs.bz(ind+iy+iz));
+  c[5][7] = 0.25*( gs.bz(ind+iz)+      gs.bz(ind+iy+iz)+   gs.bz(ind+1+iz)+    gs.bz(ind+1+iy+iz));
+}
+
+
+DEVCALLABLE inline float _lerp(
+      const float (&c)[8],
+      float dx, float dy, float dz) 
+{
+  return _lerp(c[0], c[1], c[2], c[3], c[4], c[5], c[6], c[7], dx, dy, dz);
+}
+
+
 /// Linear (1st order) particle shape interpolator
 template<size_t D, size_t V>
 class LinearInterpolator :
@@ -13,6 +109,36 @@ class LinearInterpolator :
 public: // needs to be public, why is it not public to begin with ?
   void solve(pic::Tile<D>& tile) override;
 
+  /// fields at tile-local location (x,y,z) of one particle; 
+  // iy and iz are the 1D index strides of the mesh
+  DEVCALLABLE static inline void gather(
+      const emf::Grids& gs, 
+      const int iy, const int iz,
+      const float x, const float y, const float z,
+      float (&E)[3], float (&B)[3])
+  {
+    // particle location in the grid
+    int i = (D >= 1) ? floor(x) : 0;
+    int j = (D >= 2) ? floor(y) : 0;
+    int k = (D >= 3) ? floor(z) : 0;
+
+    float dx = (D >= 1) ? x - i : 0.0f;
+    float dy = (D >= 2) ? y - j : 0.0f;
+    float dz = (D >= 3) ? z - k : 0.0f;
+
+    // staggered field values around the cell
+    float c[6][8];
+    _corners(gs, gs.ex.indx(i,j,k), iy, iz, c);
+
+    E[0] = _lerp(c[0], dx, dy, dz);
+    E[1] = _lerp(c[1], dx, dy, dz);
+    E[2] = _lerp(c[2], dx, dy, dz);
+
+    B[0] = _lerp(c[3], dx, dy, dz);
+    B[1] = _lerp(c[4], dx, dy, dz);
+    B[2] = _lerp(c[5], dx, dy, dz);
+  }
+
 };
 
 } // end of namespace pic
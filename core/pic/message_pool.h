@@ -0,0 +1,80 @@
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "core/pic/particle.h"
+#include "external/iter/dynArray.h"
+
+namespace pic {
+
+/*! \brief Per-rank pool of particle MPI message buffers
+ *
+ * Tiles borrow a buffer when they pack or receive particles and return it
+ * when the message has been consumed. Buffers keep their capacity so that
+ * after the first laps the particle exchange does not allocate anymore and
+ * memory is only held for messages that are in flight.
+ *
+ * T is the message element; Particle for plain and char for compact messages.
+ * Tiles may be packed and unpacked from several threads (TaskScheduler) so 
+ * acquire and release are serialized with a mutex.
+ */
+template<typename T = Particle>
+class MessagePool
+{
+  /// all buffers ever created; owned by the pool
+  std::vector< std::unique_ptr<ManVec<T>> > buffers;
+
+  /// buffers that are not in use
+  std::vector< ManVec<T>* > free_buffers;
+
+  std::mutex lock;
+
+  MessagePool() = default;
+
+  public:
+
+  MessagePool(const MessagePool&) = delete;
+  MessagePool& operator=(const MessagePool&) = delete;
+
+  /// pool of this rank
+  static MessagePool& get()
+  {
+    static MessagePool pool;
+    return pool;
+  }
+
+  /// borrow an empty buffer
+  ManVec<T>* acquire()
+  {
+    std::lock_guard<std::mutex> guard(lock);
+
+    if(free_buffers.empty()) {
+      buffers.emplace_back( std::make_unique<ManVec<T>>() );
+      return buffers.back().get();
+    }
+
+    auto buf = free_buffers.back();
+    free_buffers.pop_back();
+    buf->clear();
+    return buf;
+  }
+
+  /// return a buffer back to the pool; nullptr is ignored
+  void release(ManVec<T>* buf)
+  {
+    if(buf == nullptr) return;
+
+    std::lock_guard<std::mutex> guard(lock);
+    free_buffers.push_back(buf);
+  }
+
+  /// number of buffers created so far
+  size_t size() const { return buffers.size(); }
+
+  /// number of buffers currently in use
+  size_t in_use() const { return buffers.size() - free_buffers.size(); }
+};
+
+} // end of namespace pic
@@ -0,0 +1,423 @@
+#include <cmath>
+#include <algorithm>
+#include <stdexcept>
+
+#include "core/pic/moments.h"
+#include "tools/limit.h"
+
+#ifdef GPU
+#include <nvtx3/nvToolsExt.h>
+#endif
+
+namespace pic {
+
+namespace {
+  /// particles per chunk; quantities of a chunk stay in L1
+  constexpr int chunk = 64;
+
+  inline size_t ncells_of(const std::array<int,3>& len)
+  {
+    return static_cast<size_t>(len[0])*len[1]*len[2];
+  }
+}
+
+
+template<size_t D>
+void MomentsKernel<D>::add_moment(const std::string& name, const std::string& kind, int ispc)
+{
+  static const std::vector<std::pair<std::string, Kind>> kinds = {
+    {"dens", dens}, {"absu", absu}, {"ekin", ekin},
+    {"vx", vx}, {"vy", vy}, {"vz", vz},
+    {"pxx", pxx}, {"pyy", pyy}, {"pzz", pzz},
+    {"pxy", pxy}, {"pxz", pxz}, {"pyz", pyz} };
+
+  auto it = std::find_if(kinds.begin(), kinds.end(), [&](const auto& k){ return k.first == kind; });
+  if(it == kinds.end()) throw std::invalid_argument("MomentsKernel: unknown moment " + kind);
+  if(name.empty())      throw std::invalid_argument("MomentsKernel: empty moment name");
+
+  // named channels come first; shift the internal ones
+  const int pos = size();
+  for(auto& ch : channels) if(ch.norm >= pos) ch.norm++;
+  channels.insert(channels.begin() + pos, {name, it->second, ispc});
+
+  // density of the same species for the bulk velocities
+  for(size_t a=0; a<channels.size(); a++) {
+    const Kind k = channels[a].kind;
+    if((k != vx && k != vy && k != vz) || channels[a].norm >= 0) continue;
+
+    int norm = -1;
+    for(size_t c=0; c<channels.size(); c++) {
+      if(channels[c].kind == dens && channels[c].ispc == channels[a].ispc) norm = c;
+    }
+
+    if(norm < 0) {
+      channels.push_back({"", dens, channels[a].ispc});
+      norm = channels.size() - 1;
+    }
+    channels[a].norm = norm;
+  }
+}
+
+
+template<size_t D>
+size_t MomentsKernel<D>::size() const
+{
+  size_t n = 0;
+  while(n < channels.size() && !channels[n].name.empty()) n++;
+  return n;
+}
+
+
+template<size_t D>
+template<int ORDER>
+void MomentsKernel<D>::deposit(
+    Tile<D>& tile,
+    std::array<int,3> lo,
+    std::array<int,3> lenh,
+    float* buf) const
+{
+  constexpr int NP = ORDER == 0 ? 1 : (ORDER == 1 ? 2 : 3); // stencil width
+
+  const int nch = channels.size();
+  const size_t ncells = ncells_of(lenh);
+  const int h = halo();
+  const float istride = 1.0f/stride;
+
+  // chunk scratch
+  std::vector<float> qv(nch*chunk);
+  int   ind[3][NP][chunk];
+  float wts[3][NP][chunk];
+  float gam[chunk], absv[chunk];
+
+  auto& gs = tile.get_grids();
+  if(deposit_rho) gs.rho.clear();
+
+  auto mins = tile.mins;
+  auto maxs = tile.maxs;
+
+  std::vector<int> act;
+
+  for(int ispc=0; ispc<tile.Nspecies(); ispc++) {
+    auto& container = tile.get_container(ispc);
+    const int N = container.size();
+    if(N <= 0) continue;
+
+    act.clear();
+    for(int c=0; c<nch; c++) if(channels[c].ispc < 0 || channels[c].ispc == ispc) act.push_back(c);
+    if(act.empty() && !deposit_rho) continue;
+
+    const float mass = container.m;
+
+    const float* loc[3];
+    const float* vel[3];
+    for(int i=0; i<3; i++) loc[i] = container.loc_data(i);
+    for(int i=0; i<3; i++) vel[i] = container.vel_data(i);
+    const float* wgt = container.wgt_data();
+
+    for(int n0=0; n0<N; n0+=chunk) {
+      const int nb = std::min(chunk, N-n0);
+
+      //--------------------------------------------------
+      // shape weights and (clamped) block indices per dimension
+      for(int d=0; d<3; d++) {
+        if(d >= static_cast<int>(D)) {
+          for(int q=0; q<nb; q++) { ind[d][0][q] = 0; wts[d][0][q] = 1.0f; }
+          for(int p=1; p<NP; p++) for(int q=0; q<nb; q++) { ind[d][p][q] = 0; wts[d][p][q] = 0.0f; }
+          continue;
+        }
+
+        const float shift = static_cast<float>(h - lo[d]);
+        const int imax = lenh[d]-1;
+
+        #pragma omp simd
+        for(int q=0; q<nb; q++) {
+          const float xc = loc[d][n0+q]*istride + shift; // block coordinate
+
+          if constexpr (ORDER == 0) {
+            const int i = static_cast<int>( std::floor(xc) );
+            ind[d][0][q] = std::min(std::max(i, 0), imax);
+            wts[d][0][q] = 1.0f;
+          } else if constexpr (ORDER == 1) {
+            const float xs = xc - 0.5f;
+            const int i = static_cast<int>( std::floor(xs) );
+            const float dd = xs - i;
+            ind[d][0][q] = std::min(std::max(i,   0), imax);
+            ind[d][1][q] = std::min(std::max(i+1, 0), imax);
+            wts[d][0][q] = 1.0f - dd;
+            wts[d][1][q] = dd;
+          } else {
+            const int i = static_cast<int>( std::floor(xc) );
+            const float dd = xc - i - 0.5f;
+            ind[d][0][q] = std::min(std::max(i-1, 0), imax);
+            ind[d][1][q] = std::min(std::max(i,   0), imax);
+            ind[d][2][q] = std::min(std::max(i+1, 0), imax);
+            wts[d][0][q] = 0.5f*(0.5f - dd)*(0.5f - dd);
+            wts[d][1][q] = 0.75f - dd*dd;
+            wts[d][2][q] = 0.5f*(0.5f + dd)*(0.5f + dd);
+          }
+        }
+      }
+
+      //--------------------------------------------------
+      // particle quantities
+      #pragma omp simd
+      for(int q=0; q<nb; q++) {
+        const float u = vel[0][n0+q], v = vel[1][n0+q], w = vel[2][n0+q];
+        const float u2 = u*u + v*v + w*w;
+        gam[q]  = std::sqrt(1.0f + u2);
+        absv[q] = std::sqrt(u2);
+      }
+
+      for(int c : act) {
+        float* qc = &qv[c*chunk];
+        const float* w = wgt + n0;
+        const float* u = vel[0] + n0;
+        const float* v = vel[1] + n0;
+        const float* z = vel[2] + n0;
+
+        switch(channels[c].kind) {
+          case dens:
+            #pragma omp simd
+            for(int q=0; q<nb; q++) qc[q] = w[q];
+            break;
+          case absu:
+            #pragma omp simd
+            for(int q=0; q<nb; q++) qc[q] = w[q]*absv[q];
+            break;
+          case ekin:
+            #pragma omp simd
+            for(int q=0; q<nb; q++) qc[q] = w[q]*mass*(gam[q] - 1.0f);
+            break;
+          case vx:
+            #pragma omp simd
+            for(int q=0; q<nb; q++) qc[q] = w[q]*u[q]/gam[q];
+            break;
+          case vy:
+            #pragma omp simd
+            for(int q=0; q<nb; q++) qc[q] = w[q]*v[q]/gam[q];
+            break;
+          case vz:
+            #pragma omp simd
+            for(int q=0; q<nb; q++) qc[q] = w[q]*z[q]/gam[q];
+            break;
+          case pxx:
+            #pragma omp simd
+            for(int q=0; q<nb; q++) qc[q] = w[q]*mass*u[q]*u[q]/gam[q];
+            break;
+          case pyy:
+            #pragma omp simd
+            for(int q=0; q<nb; q++) qc[q] = w[q]*mass*v[q]*v[q]/gam[q];
+            break;
+          case pzz:
+            #pragma omp simd
+            for(int q=0; q<nb; q++) qc[q] = w[q]*mass*z[q]*z[q]/gam[q];
+            break;
+          case pxy:
+            #pragma omp simd
+            for(int q=0; q<nb; q++) qc[q] = w[q]*mass*u[q]*v[q]/gam[q];
+            break;
+          case pxz:
+            #pragma omp simd
+            for(int q=0; q<nb; q++) qc[q] = w[q]*mass*u[q]*z[q]/gam[q];
+            break;
+          case pyz:
+            #pragma omp simd
+            for(int q=0; q<nb; q++) qc[q] = w[q]*mass*v[q]*z[q]/gam[q];
+            break;
+        }
+      }
+
+      //--------------------------------------------------
+      // scatter into the block
+      for(int q=0; q<nb; q++) {
+        for(int pk=0; pk<NP; pk++)
+        for(int pj=0; pj<NP; pj++) {
+          const float wjk = wts[1][pj][q]*wts[2][pk][q];
+          if(wjk == 0.0f) continue;
+          const size_t off = lenh[0]*( ind[1][pj][q] + static_cast<size_t>(lenh[1])*ind[2][pk][q] );
+
+          for(int pi=0; pi<NP; pi++) {
+            const float wt = wts[0][pi][q]*wjk;
+            const size_t idx = off + ind[0][pi][q];
+            for(int c : act) buf[c*ncells + idx] += qv[c*chunk + q]*wt;
+          }
+        }
+      }
+
+      //--------------------------------------------------
+      // mass density in tile cells
+      if(deposit_rho) {
+        for(int q=0; q<nb; q++) {
+          const int iff = D >= 1 ? limit( floor(loc[0][n0+q]-mins[0]), -3., maxs[0]-mins[0] +2.) : 0;
+          const int jff = D >= 2 ? limit( floor(loc[1][n0+q]-mins[1]), -3., maxs[1]-mins[1] +2.) : 0;
+          const int kff = D >= 3 ? limit( floor(loc[2][n0+q]-mins[2]), -3., maxs[2]-mins[2] +2.) : 0;
+          gs.rho(iff,jff,kff) += mass*wgt[n0+q];
+        }
+      }
+    } // end of chunks
+  } // end of species
+}
+
+
+template<size_t D>
+void MomentsKernel<D>::extent(
+    const corgi::Tile<D>& tile,
+    std::array<int,3>& lo,
+    std::array<int,3>& len) const
+{
+  const int h = halo();
+
+  lo  = {0,0,0};
+  len = {1,1,1};
+  for(size_t d=0; d<D; d++) {
+    lo[d]  = static_cast<int>( std::floor(tile.mins[d]/stride) );
+    len[d] = static_cast<int>( std::ceil( tile.maxs[d]/stride) ) - lo[d] + 2*h;
+  }
+}
+
+
+template<size_t D>
+void MomentsKernel<D>::accumulate(
+    Tile<D>& tile,
+    std::vector<float>& out) const
+{
+  std::array<int,3> lo, len;
+  extent(tile, lo, len);
+
+  out.assign(channels.size()*ncells_of(len), 0.0f);
+  switch(shape) {
+    case 0: deposit<0>(tile, lo, len, out.data()); break;
+    case 1: deposit<1>(tile, lo, len, out.data()); break;
+    case 2: deposit<2>(tile, lo, len, out.data()); break;
+    default: throw std::invalid_argument("MomentsKernel: shape order must be 0, 1, or 2");
+  }
+}
+
+
+template<size_t D>
+void MomentsKernel<D>::add_block(
+    const std::vector<float>& blk,
+    std::array<int,3> lo,
+    std::array<int,3> len,
+    std::array<int,3> n,
+    std::array<int,3> olo,
+    std::array<int,3> olen,
+    float* out) const
+{
+  const int h = halo();
+  const int nch = channels.size();
+  const size_t nb = ncells_of(len);
+  const size_t no = ncells_of(olen);
+
+  for(int k=0; k<len[2]; k++) {
+    const int gk = D >= 3 ? std::min(std::max(lo[2]+k-h, 0), n[2]-1) - olo[2] : 0;
+    if(gk < 0 || gk >= olen[2]) continue;
+
+    for(int j=0; j<len[1]; j++) {
+      const int gj = D >= 2 ? std::min(std::max(lo[1]+j-h, 0), n[1]-1) - olo[1] : 0;
+      if(gj < 0 || gj >= olen[1]) continue;
+
+      for(int i=0; i<len[0]; i++) {
+        const int gi = std::min(std::max(lo[0]+i-h, 0), n[0]-1) - olo[0];
+        if(gi < 0 || gi >= olen[0]) continue;
+
+        const size_t ib = i + len[0]*(j + static_cast<size_t>(len[1])*k);
+        const size_t io = gi + olen[0]*(gj + static_cast<size_t>(olen[1])*gk);
+        for(int c=0; c<nch; c++) out[c*no + io] += blk[c*nb + ib];
+      }
+    }
+  }
+}
+
+
+template<size_t D>
+void MomentsKernel<D>::accumulate(
+    corgi::Grid<D>& grid,
+    std::array<int,3> n,
+    std::vector<toolbox::Mesh<float,0>>& out) const
+{
+#ifdef GPU
+  nvtxRangePush(__PRETTY_FUNCTION__);
+#endif
+
+  const int h = halo();
+  const int nch = channels.size();
+  if(out.size() < channels.size()) throw std::invalid_argument("MomentsKernel: too few output meshes");
+
+  const auto cids = grid.get_local_tiles();
+  const size_t nt = cids.size();
+
+  std::vector<Tile<D>*> tiles(nt);
+  for(size_t t=0; t<nt; t++) tiles[t] = &dynamic_cast<Tile<D>&>(grid.get_tile( cids[t] ));
+
+  // strided cells covered by each tile (with ghosts)
+  std::vector<std::array<int,3>> los(nt), lens(nt);
+  for(size_t t=0; t<nt; t++) extent(*tiles[t], los[t], lens[t]);
+
+  // tile blocks in parallel
+  std::vector<std::vector<float>> blocks(nt);
+
+  if(shape < 0 || shape > 2) throw std::invalid_argument("MomentsKernel: shape order must be 0, 1, or 2");
+
+  #pragma omp parallel for schedule(dynamic,1)
+  for(size_t t=0; t<nt; t++) accumulate(*tiles[t], blocks[t]);
+
+  // add blocks to the global meshes; ghosts overlap with the neighbors
+  for(size_t t=0; t<nt; t++) {
+    const auto& lo  = los[t];
+    const auto& len = lens[t];
+    const size_t nb = ncells_of(len);
+
+    for(int c=0; c<nch; c++)
+    for(int k=0; k<len[2]; k++)
+    for(int j=0; j<len[1]; j++)
+    for(int i=0; i<len[0]; i++) {
+      const int gi = D >= 1 ? std::min(std::max(lo[0]+i-h, 0), n[0]-1) : 0;
+      const int gj = D >= 2 ? std::min(std::max(lo[1]+j-h, 0), n[1]-1) : 0;
+      const int gk = D >= 3 ? std::min(std::max(lo[2]+k-h, 0), n[2]-1) : 0;
+      out[c](gi,gj,gk) += blocks[t][c*nb + i + len[0]*(j + len[1]*k)];
+    }
+  }
+
+#ifdef GPU
+  nvtxRangePop();
+#endif
+}
+
+
+template<size_t D>
+void MomentsKernel<D>::finalize(float* out, size_t ncells) const
+{
+  for(size_t c=0; c<channels.size(); c++) {
+    const int nc = channels[c].norm;
+    if(nc < 0) continue;
+
+    float* v = out + c*ncells;
+    const float* dn = out + nc*ncells;
+    for(size_t i=0; i<ncells; i++) if(dn[i] > 0.0f) v[i] /= dn[i];
+  }
+}
+
+
+template<size_t D>
+void MomentsKernel<D>::finalize(std::vector<toolbox::Mesh<float,0>>& out) const
+{
+  for(size_t c=0; c<channels.size(); c++) {
+    const int nc = channels[c].norm;
+    if(nc < 0) continue;
+
+    float* v = out[c].data();
+    const float* dn = out[nc].data();
+    for(size_t i=0; i<out[c].size(); i++) if(dn[i] > 0.0f) v[i] /= dn[i];
+  }
+}
+
+
+//--------------------------------------------------
+// explicit template instantiation
+
+template class MomentsKernel<1>;
+template class MomentsKernel<2>;
+template class MomentsKernel<3>;
+
+} // end of namespace pic
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <array>
+#include <string>
+#include <vector>
+
+#include "external/corgi/corgi.h"
+#include "core/pic/tile.h"
+#include "tools/mesh.h"
+
+namespace pic {
+
+/*! \brief Particle moments on a (strided) mesh
+ *
+ * Computes a selected set of moments of any species with one pass over the
+ * particles of each container. Particles are processed in short chunks:
+ * the per-particle quantities and shape weights are computed in
+ * vectorized loops and then scattered into a tile-local block that stays
+ * in cache. Tiles are processed in parallel threads.
+ *
+ * The moments are binned on a mesh that is coarser by a factor of stride
+ * with a shape function of given order (0 = nearest grid point, 1 = cloud
+ * in cell, 2 = triangular shaped cloud). Deposits beyond the global mesh
+ * are folded into its edge cells.
+ *
+ * Bulk velocities are divided by the number density of the same species
+ * selection in finalize(); the needed densities are added as extra
+ * (unnamed) channels if they are not selected.
+ */
+template<size_t D>
+class MomentsKernel
+{
+  public:
+
+  /// per-particle quantity with weight w, mass m, four-velocity u, and Lorentz factor g
+  enum Kind {
+    dens,                         // w
+    absu,                         // w |u| (energy density of photons)
+    ekin,                         // w m (g-1)
+    vx, vy, vz,                   // w u_i/g; normalized by dens
+    pxx, pyy, pzz, pxy, pxz, pyz, // w m u_i u_j/g
+  };
+
+  struct Channel {
+    std::string name; // empty for internal normalization channels
+    Kind kind;
+    int ispc;         // species; -1 for all
+    int norm = -1;    // density channel of bulk velocities
+  };
+
+  /// selected moments followed by internal channels
+  std::vector<Channel> channels;
+
+  /// mesh reduction factor
+  int stride = 1;
+
+  /// shape function order; 0, 1, or 2
+  int shape = 0;
+
+  /// deposit also mass density into the rho mesh of the tiles (nearest cell)
+  bool deposit_rho = false;
+
+  /// select moment kind (dens, absu, ekin, vx, vy, vz, pxx, pyy, pzz, pxy, pxz, pyz) of species ispc
+  void add_moment(const std::string& name, const std::string& kind, int ispc = -1);
+
+  /// number of selected (named) moments; they are the first channels
+  size_t size() const;
+
+  /// first global (strided) cell lo of the tile and size len of its block including the ghost cells
+  void extent(const corgi::Tile<D>& tile, std::array<int,3>& lo, std::array<int,3>& len) const;
+
+  /// tile moments into a block with ghost cells around the tile (see extent); out has
+  //  channels.size() blocks (x fastest). The ghost cells overlap the neighbor tiles.
+  void accumulate(Tile<D>& tile, std::vector<float>& out) const;
+
+  /// add a block of a tile with first cell lo and size len (see extent) to the region 
+  //  [olo, olo+olen) of a global mesh of size n; out has channels.size() regions (x fastest).
+  //  Cells beyond the global mesh are folded into its edge cells.
+  void add_block(const std::vector<float>& blk, std::array<int,3> lo, std::array<int,3> len, 
+      std::array<int,3> n, std::array<int,3> olo, std::array<int,3> olen, float* out) const;
+
+  /// moments of all local tiles into meshes of global (strided) size n; one mesh per channel
+  void accumulate(corgi::Grid<D>& grid, std::array<int,3> n, std::vector<toolbox::Mesh<float,0>>& out) const;
+
+  /// divide bulk velocities by their densities; block of ncells per channel
+  void finalize(float* out, size_t ncells) const;
+
+  /// same for meshes
+  void finalize(std::vector<toolbox::Mesh<float,0>>& out) const;
+
+  /// ghost cells of the blocks around the tile (in strided cells)
+  int halo() const { return shape > 0 ? 1 : 0; }
+
+  private:
+
+  /// tile moments into a block of (len + 2 halo) cells around lo
+  template<int ORDER>
+  void deposit(Tile<D>& tile, std::array<int,3> lo, std::array<int,3> lenh, float* buf) const;
+};
+
+} // end of namespace pic
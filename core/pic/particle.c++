@@ -47,12 +47,6 @@ ParticleContainer<D>::ParticleContainer()
   static_assert( std::is_standard_layout_v<Particle>    == true );
 #endif
 
-  //incoming_particles.resize(first_message_size);
-  incoming_extra_particles.reserve(first_message_size); // pre-allocating 
-
-  //outgoing_particles.resize(first_message_size);
-  outgoing_extra_particles.reserve(first_message_size); // pre-allocating
-
 #ifdef GPU
   //DEV_REGISTER
   temp_storage_bytes = 10000;
@@ -82,6 +76,7 @@ void ParticleContainer<D>::reserve(size_t N) {
   for(size_t i=0; i<2; i++) indArr[i].reserve(N);
   wgtArr.reserve(N);
   infoArr.reserve(N);
+  if(track_stride > 0) trkArr.reserve(N);
     
   // reserve 1d N x D array for particle-specific emf
   Epart.reserve(N*3);
@@ -111,6 +106,23 @@ void ParticleContainer<D>::resize(size_t N)
   Epart.resize(N*3);
   Bpart.resize(N*3);
 
+  if(track_stride > 0) {
+    // forget tracked particles that are cut away; new ones are untracked
+    for(size_t s=0; s<tracked.size(); ) {
+      if(tracked[s] >= static_cast<int>(N)) {
+        untrack(tracked[s]); // last slot moves to s
+      } else {
+        s++;
+      }
+    }
+
+    const size_t N0 = trkArr.size();
+    trkArr.resize(N);
+    for(size_t n=N0; n<N; n++) trkArr[n] = -1;
+  }
+
+  cells_sorted = false;
+
   //std::cout << " INFO: " << cid << " resizing container from " << Nprtcls << " to  " << N << std::endl;
 
 #ifdef GPU
@@ -131,6 +143,7 @@ void ParticleContainer<D>::shrink_to_fit()
   for(size_t i=0; i<2; i++) indArr[i].shrink_to_fit();
   wgtArr.shrink_to_fit();
   infoArr.shrink_to_fit();
+  trkArr.shrink_to_fit();
 
 #ifdef GPU
   nvtxRangePop();
@@ -184,6 +197,12 @@ void ParticleContainer<D>::add_particle (
   infoArr.push_back(0); // extra
 
   Nprtcls++;
+  cells_sorted = false;
+
+  if(track_stride > 0) {
+    trkArr.push_back(-1);
+    track_new_particles(Nprtcls-1);
+  }
 }
 
 
@@ -227,6 +246,111 @@ void ParticleContainer<D>::add_identified_particle (
   infoArr.push_back(0); // extra
 
   Nprtcls++;
+  cells_sorted = false;
+
+  if(track_stride > 0) {
+    trkArr.push_back(-1);
+    track_new_particles(Nprtcls-1);
+  }
+
+#ifdef GPU
+  nvtxRangePop();
+#endif
+}
+
+
+template<std::size_t D>
+size_t ParticleContainer<D>::extend(size_t n)
+{
+  const size_t n0 = size();
+
+  // same growth factor as ManVec::push_back; resize alone would allocate exactly n0+n
+  const size_t cap = locArr[0].capacity();
+  if(n0 + n > cap) reserve( std::max(n0 + n, static_cast<size_t>(1.2*cap)) );
+
+  resize(n0 + n);
+  Nprtcls += n;
+
+  return n0;
+}
+
+
+template<std::size_t D>
+void ParticleContainer<D>::append_particles(
+    size_t n,
+    const float* x,  const float* y,  const float* z,
+    const float* ux, const float* uy, const float* uz,
+    const float* w,
+    const int* id, const int* proc)
+{
+  if(n == 0) return;
+
+#ifdef GPU
+  nvtxRangePush(__PRETTY_FUNCTION__);
+#endif
+
+  const size_t n0 = extend(n);
+
+  std::copy(x,  x  + n, &loc(0, n0));
+  std::copy(y,  y  + n, &loc(1, n0));
+  std::copy(z,  z  + n, &loc(2, n0));
+
+  std::copy(ux, ux + n, &vel(0, n0));
+  std::copy(uy, uy + n, &vel(1, n0));
+  std::copy(uz, uz + n, &vel(2, n0));
+
+  std::copy(w,  w  + n, &wgt(n0));
+
+  if(id != nullptr && proc != nullptr) {
+    std::copy(id,   id   + n, &this->id(0, n0));
+    std::copy(proc, proc + n, &this->id(1, n0));
+  } else {
+    for(size_t i=0; i<n; i++) {
+      auto [key, rank] = keygen();
+      this->id(0, n0+i) = key;
+      this->id(1, n0+i) = rank;
+    }
+  }
+
+  std::fill(&infoArr[n0], &infoArr[n0] + n, 0);
+
+  if(track_stride > 0) track_new_particles(n0);
+
+#ifdef GPU
+  nvtxRangePop();
+#endif
+}
+
+
+template<std::size_t D>
+void ParticleContainer<D>::append_particles(const Particle* prtcls, size_t n)
+{
+  if(n == 0) return;
+
+#ifdef GPU
+  nvtxRangePush(__PRETTY_FUNCTION__);
+#endif
+
+  const size_t n0 = extend(n);
+
+  // column-wise gather from the structs
+  float* lx = &loc(0, n0); float* ly = &loc(1, n0); float* lz = &loc(2, n0);
+  float* vx = &vel(0, n0); float* vy = &vel(1, n0); float* vz = &vel(2, n0);
+  float* ws = &wgt(n0);
+  int* ids  = &id(0, n0);
+  int* proc = &id(1, n0);
+
+  for(size_t i=0; i<n; i++) {
+    lx[i] = prtcls[i].x;  ly[i] = prtcls[i].y;  lz[i] = prtcls[i].z;
+    vx[i] = prtcls[i].ux; vy[i] = prtcls[i].uy; vz[i] = prtcls[i].uz;
+    ws[i] = prtcls[i].w;
+    ids[i]  = prtcls[i].id;
+    proc[i] = prtcls[i].proc;
+  }
+
+  std::fill(&infoArr[n0], &infoArr[n0] + n, 0);
+
+  if(track_stride > 0) track_new_particles(n0);
 
 #ifdef GPU
   nvtxRangePop();
@@ -234,6 +358,16 @@ void ParticleContainer<D>::add_identified_particle (
 }
 
 
+template<std::size_t D>
+void ParticleContainer<D>::append_particles(const ParticleBuffer& buf)
+{
+  append_particles(buf.size(),
+      buf.x.data(),  buf.y.data(),  buf.z.data(),
+      buf.ux.data(), buf.uy.data(), buf.uz.data(),
+      buf.w.data());
+}
+
+
 template<std::size_t D>
 void ParticleContainer<D>::insert_identified_particle (
     std::vector<float> prtcl_loc,
@@ -280,8 +414,15 @@ void ParticleContainer<D>::insert_identified_particle (
   indArr[1][ind] = _proc;
 
   infoArr[ind] = 0; // extra
+
+  // NOTE: slot is assumed to be free (not tracked) 
+  if(track_stride > 0 && ind < static_cast<int>(trkArr.size()) && trkArr[ind] < 0 && is_tracked_id(_id)) {
+    trkArr[ind] = tracked.size();
+    tracked.push_back(ind);
+  }
                           
   //Nprtcls++; // NOTE: insertion needs to be added manually 
+  cells_sorted = false;
 
 #ifdef GPU
   nvtxRangePop();
@@ -477,6 +618,29 @@ std::array<double,3>& maxs)
   } //, size(), *this);
 
   //std::cout << "INFO " << cid << " outgoing count:" << outgoing_count << "\n";
+
+  //--------------------------------------------------
+  // bucket outgoing particles by direction so that neighbors only visit their own share
+
+  std::array<int, 28> counts = {};
+  if(outgoing_count > 0) {
+    for(int n=0; n<size(); n++) counts[infoArr[n]]++;
+  }
+  counts[0] = counts[dir2info(0,0,0)] = 0; // staying particles
+
+  outgoing_offsets[0] = 0;
+  for(int b=0; b<28; b++) outgoing_offsets[b+1] = outgoing_offsets[b] + counts[b];
+
+  outgoing_indices.resize(outgoing_count);
+  if(outgoing_count > 0) {
+    std::array<int, 28> pos;
+    std::copy(outgoing_offsets.begin(), outgoing_offsets.end()-1, pos.begin());
+
+    for(int n=0; n<size(); n++){
+      const int info = infoArr[n];
+      if( !is_prtcl_inside(info) ) outgoing_indices[ pos[info]++ ] = n;
+    }
+  }
 #endif
 
 
@@ -553,6 +717,8 @@ void ParticleContainer<D>::delete_transferred_particles()
   int last = size();
   int iter = first;
 
+  const bool tracking = track_stride > 0;
+
   while( first != last ) {
     
     // check if outside tile 
@@ -576,8 +742,12 @@ void ParticleContainer<D>::delete_transferred_particles()
 
         wgtArr[ iter] =  wgtArr[first];
         infoArr[iter] = infoArr[first];
+
+        if(tracking) move_tracked(trkArr[first], iter);
       }
       iter++;
+    } else if(tracking) {
+      untrack(first);
     }
     first++;
   }
@@ -593,6 +763,14 @@ void ParticleContainer<D>::delete_transferred_particles()
 }
 
 
+template<std::size_t D>
+int ParticleContainer<D>::outgoing_to(int i, int j, int k) const
+{
+  const int info = dir2info(i,j,k);
+  return outgoing_offsets[info+1] - outgoing_offsets[info];
+}
+
+
 template<std::size_t D>
 void ParticleContainer<D>::transfer_and_wrap_particles( 
     ParticleContainer&    neigh,
@@ -606,44 +784,49 @@ void ParticleContainer<D>::transfer_and_wrap_particles(
   nvtxRangePush(__PRETTY_FUNCTION__);
 #endif
 
-  // global grid limits
-  const float minx = global_mins[0];
-  const float miny = global_mins[1];
-  const float minz = global_mins[2];
+  // bucket of neigh flowing to us; directions are flipped (- sign) 
+  // so that they are in respect to the current tile
+  const int info = dir2info(-dirs[0], -dirs[1], -dirs[2]);
+  const int m = is_prtcl_inside(info) ? 0 : neigh.outgoing_offsets[info+1] - neigh.outgoing_offsets[info];
 
-  const float maxx = global_maxs[0];
-  const float maxy = global_maxs[1];
-  const float maxz = global_maxs[2];
+  if(m > 0) {
+    const int* ind = neigh.outgoing_indices.data() + neigh.outgoing_offsets[info];
 
-  //--------------------------------------------------
-  // v2: loop w/o external to_other_tiles storage
-
-  for(int n=0; n<neigh.size(); n++){
-    auto [i,j,k] = info2dir( neigh.infoArr[n] );
-
-    // these need to be skipped 
-    if( (D==1) && (i== 0) )                     continue;
-    if( (D==2) && (i== 0) && (j==0) )           continue;
-    if( (D==3) && (i== 0) && (j==0) && (k==0) ) continue;
-
-    // NOTE: directions are flipped (- sign) so that they are
-    // in directions in respect to the current tile
-    bool add=false;
-    if( (D==1) && (i== -dirs[0]) )                                   add = true;
-    if( (D==2) && (i== -dirs[0]) && (j==-dirs[1]) )                  add = true;
-    if( (D==3) && (i== -dirs[0]) && (j==-dirs[1]) && (k==-dirs[2]) ) add = true;
-    
-    if(add) {
-      float locx = D >= 1 ? wrap( neigh.loc(0, n), minx, maxx ) : neigh.loc(0, n);
-      float locy = D >= 2 ? wrap( neigh.loc(1, n), miny, maxy ) : neigh.loc(1, n);
-      float locz = D >= 3 ? wrap( neigh.loc(2, n), minz, maxz ) : neigh.loc(2, n);
-
-      add_identified_particle(
-          {locx, locy, locz}, 
-          {neigh.vel(0, n), neigh.vel(1, n), neigh.vel(2, n)},
-          neigh.wgt(n),
-          neigh.id(0,n), neigh.id(1,n));
+    const size_t n0 = extend(m);
+
+    // column-wise gather from the neighbor; locations wrapped into the global limits
+    for(size_t i=0; i<3; i++) {
+      const float* src = &neigh.loc(i,0);
+      float* dst = &loc(i,n0);
+
+      if(i < D) {
+        const float gmin = global_mins[i];
+        const float gmax = global_maxs[i];
+        for(int q=0; q<m; q++) dst[q] = wrap(src[ind[q]], gmin, gmax);
+      } else {
+        for(int q=0; q<m; q++) dst[q] = src[ind[q]];
+      }
     }
+
+    for(size_t i=0; i<3; i++) {
+      const float* src = &neigh.vel(i,0);
+      float* dst = &vel(i,n0);
+      for(int q=0; q<m; q++) dst[q] = src[ind[q]];
+    }
+
+    for(size_t i=0; i<2; i++) {
+      const int* src = &neigh.id(i,0);
+      int* dst = &id(i,n0);
+      for(int q=0; q<m; q++) dst[q] = src[ind[q]];
+    }
+
+    const float* wsrc = &neigh.wgt(0);
+    float* wdst = &wgt(n0);
+    for(int q=0; q<m; q++) wdst[q] = wsrc[ind[q]];
+
+    for(int q=0; q<m; q++) infoArr[n0+q] = 0;
+
+    if(track_stride > 0) track_new_particles(n0);
   }
 
 #ifdef GPU
@@ -654,46 +837,22 @@ void ParticleContainer<D>::transfer_and_wrap_particles(
 //--------------------------------------------------
 
 template<std::size_t D>
-void ParticleContainer<D>::pack_all_particles()
+void ParticleContainer<D>::pack_all_particles(ManVec<Particle>& buf)
 {
 
 #ifdef GPU
   nvtxRangePush(__PRETTY_FUNCTION__);
 #endif
 
-  // clear extra array (for appending)
-  outgoing_extra_particles.clear();
-    
-  // +1 for info particle
-  int np = size() + 1;
-
-  if(np-first_message_size > 0) {
-    // reserve is needed here; if size is less than capacity, we do nothing
-    outgoing_extra_particles.reserve( np-first_message_size );
-  }
-
-  // first particle is always the message info
-  outgoing_particles[0] = {0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, np, 0}; // store prtcl number in id slot
+  size_t i = buf.size();
+  buf.resize( i + size() ); // NOTE: grows only if capacity is exceeded
 
-  // next, pack all other particles
-  int i=1;
   for(size_t ind=0; ind < size(); ind++) {
-    if(i < first_message_size) {
-      //outgoing_particles.push_back({ 
-      outgoing_particles[i] = {
-        loc(0, ind), loc(1, ind), loc(2, ind), 
-        vel(0, ind), vel(1, ind), vel(2, ind), 
-        wgt(ind), 
-        id(0, ind), id(1, ind) };
-    } else {
-      //outgoing_extra_particles.push_back({ 
-      outgoing_extra_particles.push_back({ 
-        loc(0, ind), loc(1, ind), loc(2, ind), 
-        vel(0, ind), vel(1, ind), vel(2, ind), 
-        wgt(ind), 
-        id(0, ind), id(1, ind) });
-    }
-    i++;
+    buf[i++] = {
+      loc(0, ind), loc(1, ind), loc(2, ind), 
+      vel(0, ind), vel(1, ind), vel(2, ind), 
+      wgt(ind), 
+      id(0, ind), id(1, ind) };
   }
 
 #ifdef GPU
@@ -703,49 +862,28 @@ void ParticleContainer<D>::pack_all_particles()
 
 
 template<std::size_t D>
-void ParticleContainer<D>::pack_outgoing_particles()
+void ParticleContainer<D>::pack_outgoing_particles(ManVec<Particle>& buf)
 {
 
 #ifdef GPU
   nvtxRangePush(__PRETTY_FUNCTION__);
 #endif
 
-  // initialize msg arrays 
-  outgoing_extra_particles.clear(); 
-
-  //add info prtcl that describes how many total particles are coming (and therefore are in the variable extra msg)
-  outgoing_particles[0] = {0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0, 0}; // store prtcl number in id slot
-
-                                                                              
   // -------------------------------------------------- 
   // on-the-fly calculation of escape condition
-
-  // next, pack all other particles
-  int count=1;
   for(int n=0; n<size(); n++){
 
     // check if moving out
     bool to_be_packed = !is_prtcl_inside(infoArr[n]);
 
-    // pack if true; split between fixed primary and adaptive extra message containers
     if(to_be_packed) {
-      if(count < first_message_size) {
-        outgoing_particles[count] = {
-          loc(0, n), loc(1, n), loc(2, n), 
-          vel(0, n), vel(1, n), vel(2, n), 
-          wgt(n), 
-          id(0, n), id(1, n) };
-      } else {
-        outgoing_extra_particles.push_back({ 
-          loc(0, n), loc(1, n), loc(2, n), 
-          vel(0, n), vel(1, n), vel(2, n), 
-          wgt(n), 
-          id(0, n), id(1, n) });
-      }
-      count++;
+      buf.push_back({ 
+        loc(0, n), loc(1, n), loc(2, n), 
+        vel(0, n), vel(1, n), vel(2, n), 
+        wgt(n), 
+        id(0, n), id(1, n) });
     }
   }
-  outgoing_particles[0].id = count; // update info
     
 #ifdef GPU
   nvtxRangePop();
@@ -754,55 +892,16 @@ void ParticleContainer<D>::pack_outgoing_particles()
 
 
 template<std::size_t D>
-void ParticleContainer<D>::unpack_incoming_particles()
+void ParticleContainer<D>::unpack_incoming_particles(
+    const Particle* prtcls, 
+    size_t np)
 {
 
 #ifdef GPU
   nvtxRangePush(__PRETTY_FUNCTION__);
 #endif
 
-  // get real number of incoming particles
-  int np_tot = incoming_particles[0].id; // number stored in id slot
-
-  // first and extra msg sizes
-  int np_first  = np_tot > first_message_size ? first_message_size : np_tot;
-  int np_extra = np_tot > first_message_size ? np_tot - first_message_size : 0;
-  int N = size(); 
-
-  reserve( N + np_tot - 1);  //reserve for addition
-
-  // skipping 1st info particle
-  for(int i=1; i<np_first; i++){
-    float locx = incoming_particles[i].x;
-    float locy = incoming_particles[i].y;
-    float locz = incoming_particles[i].z;
-
-    float velx = incoming_particles[i].ux;
-    float vely = incoming_particles[i].uy;
-    float velz = incoming_particles[i].uz;
-    float wgts = incoming_particles[i].w;
-
-    int ids  = incoming_particles[i].id;
-    int proc = incoming_particles[i].proc;
-
-    add_identified_particle({locx,locy,locz}, {velx,vely,velz}, wgts, ids, proc);
-  }
-
-  for(int i=0; i<np_extra; i++){
-    float locx = incoming_extra_particles[i].x;
-    float locy = incoming_extra_particles[i].y;
-    float locz = incoming_extra_particles[i].z;
-
-    float velx = incoming_extra_particles[i].ux;
-    float vely = incoming_extra_particles[i].uy;
-    float velz = incoming_extra_particles[i].uz;
-    float wgts = incoming_extra_particles[i].w;
-
-    int ids  = incoming_extra_particles[i].id;
-    int proc = incoming_extra_particles[i].proc;
-      
-    add_identified_particle({locx,locy,locz}, {velx,vely,velz}, wgts, ids, proc);
-  }
+  append_particles(prtcls, np);
 
 #ifdef GPU
   nvtxRangePop();
@@ -818,6 +917,36 @@ void ParticleContainer<D>::set_keygen_state(int __key, int __rank)
 }
 
 
+template<std::size_t D>
+void ParticleContainer<D>::enable_tracking(long stride, long cutoff)
+{
+  track_stride = stride > 0 ? stride : 0;
+  track_cutoff = cutoff;
+
+  tracked.clear();
+  trkArr.clear();
+  if(track_stride == 0) return;
+
+  trkArr.resize(size());
+  for(size_t n=0; n<size(); n++) trkArr[n] = -1;
+  track_new_particles(0);
+}
+
+
+template<std::size_t D>
+void ParticleContainer<D>::track_new_particles(size_t n0)
+{
+  // only the new particles are checked
+  const int* ids = indArr[0].cbegin();
+  for(size_t n=n0; n<size(); n++) {
+    if( is_tracked_id(ids[n]) ) {
+      trkArr[n] = tracked.size();
+      tracked.push_back(n);
+    }
+  }
+}
+
+
 
 template<size_t D>
 void ParticleContainer<D>::apply_permutation( ManVec<size_t>& indices )
@@ -855,6 +984,12 @@ void ParticleContainer<D>::apply_permutation( ManVec<size_t>& indices )
 
       std::swap( infoArr[current], infoArr[next] );  // TODO might be possible to skip this swap
 
+      if(track_stride > 0) {
+        const int sc = trkArr[current];
+        move_tracked(trkArr[next], current);
+        move_tracked(sc, next);
+      }
+
       // NOTE: these can be omitted if interpolator is called *after* sort
       //std::swap( ex[current], ex[next] ); 
       //std::swap( ey[current], ey[next] ); 
@@ -871,10 +1006,173 @@ void ParticleContainer<D>::apply_permutation( ManVec<size_t>& indices )
   indices[current] = current;
   }
 
+  cells_sorted = false;
+
   return;
 }
 
 
+template<size_t D>
+void ParticleContainer<D>::swap_particles(size_t i, size_t j)
+{
+  std::swap( locArr[0][i], locArr[0][j] ); 
+  std::swap( locArr[1][i], locArr[1][j] ); 
+  std::swap( locArr[2][i], locArr[2][j] ); 
+
+  std::swap( velArr[0][i], velArr[0][j] ); 
+  std::swap( velArr[1][i], velArr[1][j] ); 
+  std::swap( velArr[2][i], velArr[2][j] ); 
+
+  std::swap( indArr[0][i], indArr[0][j] ); 
+  std::swap( indArr[1][i], indArr[1][j] ); 
+
+  std::swap( wgtArr[i],  wgtArr[j] ); 
+  std::swap( infoArr[i], infoArr[j] ); 
+
+  if(track_stride > 0) {
+    const int si = trkArr[i];
+    move_tracked(trkArr[j], i);
+    move_tracked(si, j);
+  }
+}
+
+
+template<size_t D>
+void ParticleContainer<D>::sort_in_cells(
+    const std::array<int,3>& lens,
+    bool full)
+{
+
+#ifdef GPU
+  nvtxRangePush(__PRETTY_FUNCTION__);
+#endif
+
+  const int Nx = D >= 1 ? lens[0] : 1;
+  const int Ny = D >= 2 ? lens[1] : 1;
+  const int Nz = D >= 3 ? lens[2] : 1;
+  const int Ncells = Nx*Ny*Nz;
+  const int N = size();
+
+  cellArr.resize(N);
+  cell_offsets.resize(Ncells+1);
+  for(int c=0; c<=Ncells; c++) cell_offsets[c] = 0;
+
+  //--------------------------------------------------
+  // cell index of each particle; 
+  // NOTE: tile-relative location is computed exactly as in the interpolators
+  //       so that floor() gives the same cell there
+  int outside = 0;
+
+  #pragma omp simd reduction(+:outside)
+  for(int n=0; n<N; n++) {
+    float loc0n = D >= 1 ? loc(0,n) - mins[0] : 0.0f;
+    float loc1n = D >= 2 ? loc(1,n) - mins[1] : 0.0f;
+    float loc2n = D >= 3 ? loc(2,n) - mins[2] : 0.0f;
+
+    int i = D >= 1 ? floor(loc0n) : 0;
+    int j = D >= 2 ? floor(loc1n) : 0;
+    int k = D >= 3 ? floor(loc2n) : 0;
+
+    // particles outside the tile are sorted into the closest cell 
+    outside += (i < 0) || (i >= Nx) || (j < 0) || (j >= Ny) || (k < 0) || (k >= Nz);
+
+    i = std::min(std::max(i, 0), Nx-1);
+    j = std::min(std::max(j, 0), Ny-1);
+    k = std::min(std::max(k, 0), Nz-1);
+
+    cellArr[n] = i + Nx*(j + Ny*k);
+  }
+
+  // particles per cell and their cumulative sum
+  for(int n=0; n<N; n++) cell_offsets[cellArr[n]+1]++;
+  for(int c=0; c<Ncells; c++) cell_offsets[c+1] += cell_offsets[c];
+
+  // running insertion point of each cell
+  std::vector<int> cursor(Ncells);
+  for(int c=0; c<Ncells; c++) cursor[c] = cell_offsets[c];
+
+  if(full) {
+    //--------------------------------------------------
+    // stable counting sort; each array is streamed once into a scratch 
+    // buffer and then swapped with it
+
+    // cell index -> destination index
+    for(int n=0; n<N; n++) cellArr[n] = cursor[cellArr[n]]++;
+
+    ManVec<float> tmpf;
+    ManVec<int>   tmpi;
+    tmpf.resize(N);
+    tmpi.resize(N);
+
+    for(size_t idim=0; idim<3; idim++) {
+      #pragma omp simd
+      for(int n=0; n<N; n++) tmpf[cellArr[n]] = locArr[idim][n];
+      swap(locArr[idim], tmpf);
+    }
+
+    for(size_t idim=0; idim<3; idim++) {
+      #pragma omp simd
+      for(int n=0; n<N; n++) tmpf[cellArr[n]] = velArr[idim][n];
+      swap(velArr[idim], tmpf);
+    }
+
+    #pragma omp simd
+    for(int n=0; n<N; n++) tmpf[cellArr[n]] = wgtArr[n];
+    swap(wgtArr, tmpf);
+
+    for(size_t idim=0; idim<2; idim++) {
+      #pragma omp simd
+      for(int n=0; n<N; n++) tmpi[cellArr[n]] = indArr[idim][n];
+      swap(indArr[idim], tmpi);
+    }
+
+    #pragma omp simd
+    for(int n=0; n<N; n++) tmpi[cellArr[n]] = infoArr[n];
+    swap(infoArr, tmpi);
+
+    if(track_stride > 0) {
+      for(int n=0; n<N; n++) tmpi[cellArr[n]] = trkArr[n];
+      swap(trkArr, tmpi);
+      for(size_t s=0; s<tracked.size(); s++) tracked[s] = cellArr[tracked[s]];
+    }
+
+  } else {
+    //--------------------------------------------------
+    // in-place (American flag) sort; only particles that are not in their 
+    // cell range are swapped. The cell indices and counts above and this walk 
+    // over all cells still make the pass O(N + Ncells); what it saves over 
+    // the full sort is the scatter of every array when few particles moved
+    for(int c=0; c<Ncells; c++) {
+      const int end = cell_offsets[c+1];
+
+      while(cursor[c] < end) {
+        const int n = cursor[c];
+        const int c2 = cellArr[n];
+
+        if(c2 == c) { 
+          cursor[c]++; 
+          continue;
+        }
+
+        // skip particles that are already in the target cell
+        while(cellArr[cursor[c2]] == c2) cursor[c2]++;
+
+        const int m = cursor[c2]++;
+        swap_particles(n, m);
+        std::swap(cellArr[n], cellArr[m]);
+      }
+    }
+  }
+
+  // offsets are exact only if all particles were inside the tile
+  cells_sorted = (outside == 0);
+
+#ifdef GPU
+  nvtxRangePop();
+#endif
+}
+
+
 template<size_t D>
 void ParticleContainer<D>::update_cumulative_arrays()
 {
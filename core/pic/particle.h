@@ -44,6 +44,30 @@ struct Particle {
 };
 
 
+/// staging area for particles created inside a loop over containers;
+// added in one go with ParticleContainer::append_particles after the loop.
+// NOTE: clear() keeps the capacity so that a persistent buffer does not allocate
+struct ParticleBuffer {
+  std::vector<float> x, y, z, ux, uy, uz, w;
+
+  inline void add(float lx, float ly, float lz, float vx, float vy, float vz, float wgt)
+  {
+    x.push_back(lx);  y.push_back(ly);  z.push_back(lz);
+    ux.push_back(vx); uy.push_back(vy); uz.push_back(vz);
+    w.push_back(wgt);
+  }
+
+  inline size_t size() const { return w.size(); }
+
+  inline void clear()
+  {
+    x.clear();  y.clear();  z.clear();
+    ux.clear(); uy.clear(); uz.clear();
+    w.clear();
+  }
+};
+
+
 // data struct for coupling tile send/recv directions together 
 struct to_other_tiles_struct{
   int i;
@@ -79,6 +103,33 @@ class ParticleContainer{
   std::array<ManVec<int>, 2 >   indArr; // cpu,id index
   ManVec<float> wgtArr;                 // weight
   ManVec<int>   infoArr;                // prtcl info (stores outflow information)
+  ManVec<int>   cellArr;                // cell index of prtcl; scratch space for sorting
+  ManVec<int>   trkArr;                 // slot in tracked or -1; empty if tracking is off
+
+  /// swap all internal data of particles i and j
+  void swap_particles(size_t i, size_t j);
+
+  /// add particles n0...size()-1 to tracked if their id matches the rule
+  void track_new_particles(size_t n0);
+
+  /// particle with tracking slot s (or -1) is now at index n
+  inline void move_tracked(int s, int n)
+  {
+    trkArr[n] = s;
+    if(s >= 0) tracked[s] = n;
+  }
+
+  /// remove particle n from tracked; last slot fills the hole
+  inline void untrack(int n)
+  {
+    const int s = trkArr[n];
+    if(s < 0) return;
+
+    const int last = tracked.size() - 1;
+    if(s != last) move_tracked(s, tracked[last]);
+    tracked.resize(last);
+    trkArr[n] = -1;
+  }
 
 
   public:
@@ -96,25 +147,11 @@ class ParticleContainer{
   ManVec<float> wgtCumArr;              // cumulative weights; kept 0 if not needed
   ManVec<float> eneArr;                 // particle energies
 
-  // size of MPI particle buffers
-  static const int first_message_size = 16384; //4096; 
-  // NOTE maximum prtcl size during first iteration is 2*first_msg; then resized
-    
-  /// packed outgoing particles
-  //ManVec<Particle> outgoing_particles;
-  std::array<Particle, first_message_size> outgoing_particles;
-  ManVec<Particle> outgoing_extra_particles;
-
-  /// pack all particles in the container
-  void pack_all_particles();
+  /// append all particles in the container to an MPI message buffer
+  void pack_all_particles(ManVec<Particle>& buf);
 
-  /// pack particles that are marked as outflowing
-  void pack_outgoing_particles();
-
-  /// packed incoming particles
-  //ManVec<Particle> incoming_particles;
-  std::array<Particle, first_message_size> incoming_particles;
-  ManVec<Particle> incoming_extra_particles;
+  /// append particles that are marked as outflowing to an MPI message buffer
+  void pack_outgoing_particles(ManVec<Particle>& buf);
 
 #ifdef GPU
   // incoming indexes, to optimize transfer_and_wrap_particles for GPUs
@@ -134,8 +171,17 @@ class ParticleContainer{
   /// number of particles flowing out from the tile
   int outgoing_count;
 
-  /// unpack incoming particles into internal vectors
-  void unpack_incoming_particles();
+  /// outgoing particles bucketed by direction (infoArr value) by check_outgoing_particles; 
+  // indices of particles going to direction info are 
+  // outgoing_indices[ outgoing_offsets[info] ... outgoing_offsets[info+1] ) in container order
+  std::array<int, 29> outgoing_offsets = {};
+  ManVec<int> outgoing_indices;
+
+  /// number of outgoing particles in direction (i,j,k)
+  int outgoing_to(int i, int j, int k) const;
+
+  /// unpack np incoming MPI message particles into internal vectors
+  void unpack_incoming_particles(const Particle* prtcls, size_t np);
 
 
   //! particle specific electric field components
@@ -148,6 +194,48 @@ class ParticleContainer{
   using mapType = ManVec<to_other_tiles_struct>;
   mapType to_other_tiles;
 
+  //--------------------------------------------------
+  // cell-ordered particle storage
+
+  /// particles are stored in (i,j,k) cell order of the tile and cell_offsets is valid.
+  // NOTE: flag is cleared by every container method that adds, removes, or
+  //       reorders particles and by the pushers; routines that move particles 
+  //       directly need to reset it themselves.
+  bool cells_sorted = false;
+
+  /// index of the first particle in each cell; cell c spans [cell_offsets[c], cell_offsets[c+1])
+  ManVec<int> cell_offsets;
+
+  /// sort particles into cell order of a tile with mesh lengths lens; 
+  // full=true applies a counting sort with an out-of-place scatter of all arrays,
+  // full=false swaps in place only the particles outside of their cell range.
+  // Both are O(N + Ncells); full=false moves less data when few particles changed cell.
+  // NOTE: interpolated fields (Epart/Bpart) are not permuted
+  void sort_in_cells(const std::array<int,3>& lens, bool full=true);
+
+  //--------------------------------------------------
+  // tracked (test) particles
+
+  /// tracking rule: particle with id < track_cutoff and id % track_stride == 0 is tracked;
+  // 0 if tracking is off
+  long track_stride = 0;
+  long track_cutoff = 0;
+
+  /// indices of the tracked particles (in no particular order).
+  // NOTE: kept valid by every container method that adds, removes, or
+  //       reorders particles, so readers visit only these particles
+  ManVec<int> tracked;
+
+  /// start tracking with the given rule; finds the current particles with one full pass
+  void enable_tracking(long stride, long cutoff);
+
+  /// true if id matches the tracking rule
+  inline bool is_tracked_id(int _id) const
+  {
+    const long idl = static_cast<long>(_id);
+    return (track_stride > 0) && (idl >= 0) && (idl < track_cutoff) && (idl % track_stride == 0);
+  }
+
   // particle charge 
   double q = 1.0; 
 
@@ -241,12 +329,10 @@ class ParticleContainer{
     return locArr[idim][iprtcl];
   }
 
+  /// copy of the locations; see the python bindings for views without a copy
   inline std::vector<float> loc(size_t idim) 
   {
-    std::vector<float> ret;
-    for(const auto& e: locArr[idim])
-      ret.push_back(e);
-    return ret;//locArr[idim];
+    return std::vector<float>(locArr[idim].begin(), locArr[idim].end());
   }
 
   //--------------------------------------------------
@@ -265,11 +351,7 @@ class ParticleContainer{
 
   inline std::vector<float> vel(size_t idim) 
   {
-    //return velArr[idim];
-    std::vector<float> ret;
-    for(const auto& e: velArr[idim])
-      ret.push_back(e);
-    return ret;
+    return std::vector<float>(velArr[idim].begin(), velArr[idim].end());
   }
 /*
   virtual inline std::vector<float>& vel(size_t idim)
@@ -293,11 +375,7 @@ class ParticleContainer{
 
   inline std::vector<float> wgt()
   {
-    //return wgtArr;
-    std::vector<float> ret;
-    for(const auto& e: wgtArr)
-      ret.push_back(e);
-    return ret;
+    return std::vector<float>(wgtArr.begin(), wgtArr.end());
   }
 
 /*
@@ -322,13 +400,17 @@ class ParticleContainer{
 
   inline std::vector<int> id(size_t idim) 
   {
-    //return indArr[idim];
-    std::vector<int> ret;
-    for(const auto& e: indArr[idim])
-      ret.push_back(e);
-    return ret;
+    return std::vector<int>(indArr[idim].begin(), indArr[idim].end());
   }
 
+  //--------------------------------------------------
+  // read-only pointers to the particle storage (no copies); 
+  // valid until the container is resized
+  inline const float* loc_data(size_t idim) const { return locArr[idim].cbegin(); }
+  inline const float* vel_data(size_t idim) const { return velArr[idim].cbegin(); }
+  inline const float* wgt_data()            const { return wgtArr.cbegin(); }
+  inline const int*   id_data(size_t idim)  const { return indArr[idim].cbegin(); }
+
   //--------------------------------------------------
   // info
   DEVCALLABLE
@@ -345,11 +427,7 @@ class ParticleContainer{
 
   inline std::vector<int> infos()
   {
-    //return wgtArr;
-    std::vector<int> ret;
-    for(const auto& e: infoArr)
-      ret.push_back(e);
-    return ret;
+    return std::vector<int>(infoArr.begin(), infoArr.end());
   }
 
 /*
@@ -404,6 +482,27 @@ class ParticleContainer{
       float prtcl_wgt, 
       int _id, int _proc, int ind);
 
+  // --------------------------------------------------
+  // bulk particle creation; one capacity check and column copies for n particles
+
+  /// add n particles with unset values to the end; returns the index of the first one.
+  // NOTE: capacity grows geometrically so that repeated appends reallocate rarely
+  size_t extend(size_t n);
+
+  /// add n particles from column arrays; new ids are minted if id/proc are not given
+  void append_particles(
+      size_t n,
+      const float* x,  const float* y,  const float* z,
+      const float* ux, const float* uy, const float* uz,
+      const float* w,
+      const int* id = nullptr, const int* proc = nullptr);
+
+  /// add n particles from an array of Particle structs; ids are kept
+  void append_particles(const Particle* prtcls, size_t n);
+
+  /// add all particles of a staging buffer; new ids are minted
+  void append_particles(const ParticleBuffer& buf);
+
   // --------------------------------------------------
   // particle boundary checks
 
@@ -421,7 +520,8 @@ class ParticleContainer{
   /// process through an index list and delete particles in it
   //void delete_particles(std::vector<int> to_be_deleted);
 
-  /// transfer particles between blocks
+  /// transfer particles flowing from neigh in direction dirs (as seen from this container) 
+  // and wrap their locations into the global limits; copies whole bucket of neigh at once
   void transfer_and_wrap_particles(
       ParticleContainer&, 
       std::array<int,3>,
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cmath>
+
 #include "core/pic/pushers/pusher.h"
 
 namespace pic {
@@ -14,6 +16,59 @@ class BorisPusher :
           pic::ParticleContainer<D>& container, 
           pic::Tile<D>& tile) override;
 
+  /// Boris step of one particle; 
+  // u is the normalized 4-velocity (updated), e and b the total fields at the particle.
+  // Returns the inverse Lorentz factor of the new velocity for the position advance.
+  DEVCALLABLE static inline float push_particle(
+      float (&u)[3], 
+      const double (&e)[3], const double (&b)[3], 
+      const float c, const float qm)
+  {
+    float vel0n = u[0]*c;
+    float vel1n = u[1]*c;
+    float vel2n = u[2]*c;
+
+    float ex0 = e[0]*0.5*qm;
+    float ey0 = e[1]*0.5*qm;
+    float ez0 = e[2]*0.5*qm;
+
+    float bx0 = b[0]*0.5*qm/c;
+    float by0 = b[1]*0.5*qm/c;
+    float bz0 = b[2]*0.5*qm/c;
+
+    //--------------------------------------------------
+    // Boris algorithm
+
+    // first half electric acceleration
+    float u0 = vel0n + ex0;
+    float v0 = vel1n + ey0;
+    float w0 = vel2n + ez0;
+
+    // first half magnetic rotation
+    float ginv = c/sqrt(c*c + u0*u0 + v0*v0 + w0*w0);
+    bx0 *= ginv;
+    by0 *= ginv;
+    bz0 *= ginv;
+
+    float f = 2.0/(1.0 + bx0*bx0 + by0*by0 + bz0*bz0);
+    float u1 = (u0 + v0*bz0 - w0*by0)*f;
+    float v1 = (v0 + w0*bx0 - u0*bz0)*f;
+    float w1 = (w0 + u0*by0 - v0*bx0)*f;
+
+    // second half of magnetic rotation & electric acceleration
+    u0 = u0 + v1*bz0 - w1*by0 + ex0;
+    v0 = v0 + w1*bx0 - u1*bz0 + ey0;
+    w0 = w0 + u1*by0 - v1*bx0 + ez0;
+
+    //--------------------------------------------------
+    // normalized 4-velocity advance
+    u[0] = u0/c;
+    u[1] = v0/c;
+    u[2] = w0/c;
+
+    return c / sqrt(c*c + u0*u0 + v0*v0 + w0*w0);
+  }
+
 };
 
 } // end of namespace pic
@@ -0,0 +1,131 @@
+#pragma once
+
+#include <cmath>
+
+#include "definitions.h"
+#include "external/iter/devcall.h"
+
+namespace pic {
+namespace ext {
+
+/*! \brief External field policies of the particle pushers
+ *
+ * A policy adds the external E and B at the particle location (global
+ * coordinates) to the interpolated fields. Pushers are compiled for each
+ * policy and Pusher::with_ext_field picks the policy once per container,
+ * so the particle loop has no virtual calls and a missing external field
+ * costs nothing.
+ */
+
+
+/// no external field
+struct None {
+  DEVCALLABLE inline void add(
+      float /*x*/, float /*y*/, float /*z*/,
+      double (&/*e*/)[3], double (&/*b*/)[3]) const
+  { }
+};
+
+
+/// spatially uniform field (Pusher::ex_ext ... bz_ext)
+struct Uniform {
+  double e[3];
+  double b[3];
+
+  DEVCALLABLE inline void add(
+      float /*x*/, float /*y*/, float /*z*/,
+      double (&ee)[3], double (&bb)[3]) const
+  {
+    for(int i=0; i<3; i++) {
+      ee[i] += e[i];
+      bb[i] += b[i];
+    }
+  }
+};
+
+
+/// static magnetic dipole B0*mu(r) centered at cen plus the uniform field;
+// same orientation conventions as the dipole of emf::Conductor:
+// 1D decaying 2/x^3 along x, 2D moment in xy plane tilted chi from y,
+// 3D moment tilted chi from z and rotated by phase around z.
+template<size_t D>
+struct Dipole {
+  Uniform uni;
+  float B0;
+  float cen[3];
+  float mu[3]; // magnetic moment unit vector
+
+  Dipole(const Uniform& uni, float B0, float chi, float phase, const float (&c)[3]) :
+    uni{uni}, B0{B0}
+  {
+    for(int i=0; i<3; i++) cen[i] = c[i];
+
+    mu[0] = D == 2 ? std::sin(chi) : std::sin(chi)*std::cos(phase);
+    mu[1] = D == 2 ? std::cos(chi) : std::sin(chi)*std::sin(phase);
+    mu[2] = D == 2 ? 0.0f          : std::cos(chi);
+  }
+
+  DEVCALLABLE inline void add(
+      float x, float y, float z,
+      double (&e)[3], double (&b)[3]) const
+  {
+    uni.add(x, y, z, e, b);
+
+    const float rx = x - cen[0];
+    const float ry = D >= 2 ? y - cen[1] : 0.0f;
+    const float rz = D >= 3 ? z - cen[2] : 0.0f;
+
+    if(D == 1) {
+      b[0] += B0*2.0f/(rx*rx*rx + EPS);
+      return;
+    }
+
+    const float r2 = rx*rx + ry*ry + rz*rz;
+    const float r  = std::sqrt(r2);
+    const float ir3 = 1.0f/(r2*r + EPS);
+    const float ir5 = 1.0f/(r2*r2*r + EPS);
+
+    const float mudotr = mu[0]*rx + mu[1]*ry + mu[2]*rz;
+
+    b[0] += B0*(3.0f*rx*mudotr*ir5 - mu[0]*ir3);
+    b[1] += B0*(3.0f*ry*mudotr*ir5 - mu[1]*ir3);
+    if(D == 3) b[2] += B0*(3.0f*rz*mudotr*ir5 - mu[2]*ir3);
+  }
+};
+
+
+/// user-given field profile along one axis plus the uniform field;
+// table has 6 values (ex,ey,ez,bx,by,bz) per point x0 + i*dx,
+// is interpolated linearly and held constant beyond the end points
+struct Table {
+  Uniform uni;
+  const float* data; // not owned
+  int n;             // number of points
+  int axis;          // 0,1,2 for x,y,z
+  float x0, dx;
+
+  DEVCALLABLE inline void add(
+      float x, float y, float z,
+      double (&e)[3], double (&b)[3]) const
+  {
+    uni.add(x, y, z, e, b);
+
+    const float s = ( (axis == 0 ? x : axis == 1 ? y : z) - x0 )/dx;
+    const float sc = s < 0.0f ? 0.0f : s > n-1.0f ? n-1.0f : s;
+
+    const int i0 = sc >= n-1.0f ? n-2 : static_cast<int>(sc);
+    const float w = sc - i0;
+
+    const float* p0 = data + 6*i0;
+    const float* p1 = p0 + 6;
+
+    for(int i=0; i<3; i++) {
+      e[i] += (1.0f-w)*p0[i]   + w*p1[i];
+      b[i] += (1.0f-w)*p0[i+3] + w*p1[i+3];
+    }
+  }
+};
+
+
+} // end of namespace ext
+} // end of namespace pic
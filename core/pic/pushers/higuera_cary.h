@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cmath>
+
 #include "core/pic/pushers/pusher.h"
 
 namespace pic {
@@ -12,9 +14,68 @@ template<size_t D, size_t V>
 class HigueraCaryPusher :
   public Pusher<D,V>
 {
+  public:
   void push_container(
           pic::ParticleContainer<D>& container, 
           pic::Tile<D>& tile) override;
+
+  /// Higuera-Cary step of one particle; 
+  // u is the normalized 4-velocity (updated), e and b the total fields at the particle.
+  // Returns the inverse Lorentz factor of the new velocity for the position advance.
+  DEVCALLABLE static inline double push_particle(
+      float (&u)[3], 
+      const double (&e)[3], const double (&b)[3], 
+      const double c, const double qm)
+  {
+    double vel0n = u[0];
+    double vel1n = u[1];
+    double vel2n = u[2];
+
+    double ex0 = e[0]*0.5*qm;
+    double ey0 = e[1]*0.5*qm;
+    double ez0 = e[2]*0.5*qm;
+
+    double bx0 = b[0]*0.5*qm;
+    double by0 = b[1]*0.5*qm;
+    double bz0 = b[2]*0.5*qm;
+
+    //-------------------------------------------------- 
+    // first half electric acceleration
+    double u0 = c*vel0n + ex0;
+    double v0 = c*vel1n + ey0;
+    double w0 = c*vel2n + ez0;
+
+    //-------------------------------------------------- 
+    // intermediate gamma
+    double g2 = (c*c + u0*u0 + v0*v0 + w0*w0)/(c*c);
+    double b2 = bx0*bx0 + by0*by0 + bz0*bz0;
+    double ginv = 1./sqrt( 0.5*(g2-b2 + sqrt( (g2-b2)*(g2-b2) + 4.0*(b2 + (bx0*u0 + by0*v0 + bz0*w0)*(bx0*u0 + by0*v0 + bz0*w0)))));
+
+    //-------------------------------------------------- 
+    // first half magnetic rotation; cinv is multiplied to B field only here
+    bx0 *= ginv/c;
+    by0 *= ginv/c;
+    bz0 *= ginv/c;
+
+    double f = 2.0/(1.0 + bx0*bx0 + by0*by0 + bz0*bz0);
+    double u1 = (u0 + v0*bz0 - w0*by0)*f;
+    double v1 = (v0 + w0*bx0 - u0*bz0)*f;
+    double w1 = (w0 + u0*by0 - v0*bx0)*f;
+
+    //-------------------------------------------------- 
+    // second half of magnetic rotation & electric acceleration
+    u0 = u0 + v1*bz0 - w1*by0 + ex0;
+    v0 = v0 + w1*bx0 - u1*bz0 + ey0;
+    w0 = w0 + u1*by0 - v1*bx0 + ez0;
+
+    //-------------------------------------------------- 
+    // normalized 4-velocity advance
+    u[0] = u0/c;
+    u[1] = v0/c;
+    u[2] = w0/c;
+
+    return c / sqrt(c*c + u0*u0 + v0*v0 + w0*w0);
+  }
 };
 
 } // end of namespace pic
@@ -1,7 +1,12 @@
 #pragma once
 
+#include <stdexcept>
+#include <vector>
+
 #include "core/pic/tile.h"
+#include "core/pic/pushers/external_fields.h"
 #include "definitions.h"
+#include "external/iter/dynArray.h"
 
 
 namespace pic {
@@ -26,15 +31,68 @@ class Pusher
   double ey_ext = 0.0;
   double ez_ext = 0.0;
 
-  // external field getter functions; can be overridden in derived pusher classes to depend on position
-  DEVCALLABLE virtual double get_bx_ext(double /*x*/, double /*y*/, double /*z*/) { return bx_ext; };
-  DEVCALLABLE virtual double get_by_ext(double /*x*/, double /*y*/, double /*z*/) { return by_ext; };
-  DEVCALLABLE virtual double get_bz_ext(double /*x*/, double /*y*/, double /*z*/) { return bz_ext; };
-
-  DEVCALLABLE virtual double get_ex_ext(double /*x*/, double /*y*/, double /*z*/) { return ex_ext; };
-  DEVCALLABLE virtual double get_ey_ext(double /*x*/, double /*y*/, double /*z*/) { return ey_ext; };
-  DEVCALLABLE virtual double get_ez_ext(double /*x*/, double /*y*/, double /*z*/) { return ez_ext; };
+  // uniform external field getters; position-dependent fields go through with_ext_field
+  DEVCALLABLE double get_bx_ext(double /*x*/, double /*y*/, double /*z*/) const { return bx_ext; };
+  DEVCALLABLE double get_by_ext(double /*x*/, double /*y*/, double /*z*/) const { return by_ext; };
+  DEVCALLABLE double get_bz_ext(double /*x*/, double /*y*/, double /*z*/) const { return bz_ext; };
+
+  DEVCALLABLE double get_ex_ext(double /*x*/, double /*y*/, double /*z*/) const { return ex_ext; };
+  DEVCALLABLE double get_ey_ext(double /*x*/, double /*y*/, double /*z*/) const { return ey_ext; };
+  DEVCALLABLE double get_ez_ext(double /*x*/, double /*y*/, double /*z*/) const { return ez_ext; };
+
+  /// use the explicitly vectorized kernel (Boris, Vay, and Higuera-Cary pushers)
+  bool use_simd = false;
+
+  // analytic dipole added to the external field; off when dipole_B0 = 0
+  float dipole_B0 = 0.0;
+  float dipole_chi = 0.0;
+  float dipole_phase = 0.0;
+  float dipole_cenx = 0.0, dipole_ceny = 0.0, dipole_cenz = 0.0;
+
+  // tabulated external field profile; see set_ext_table
+  ManVec<float> ext_table;
+  int ext_table_axis = 0;
+  float ext_table_x0 = 0.0;
+  float ext_table_dx = 1.0;
+
+  /// set tabulated external field; values has 6 entries (ex,ey,ez,bx,by,bz) 
+  // per point x0 + i*dx along axis. An empty table switches it off.
+  void set_ext_table(int axis, float x0, float dx, const std::vector<float>& values)
+  {
+    if(axis < 0 || axis >= int(D)) throw std::invalid_argument("ext table axis out of range");
+    if(!values.empty() && (values.size() % 6 != 0 || values.size() < 12))
+      throw std::invalid_argument("ext table needs 6 values per point and at least 2 points");
+    if(dx <= 0.0f) throw std::invalid_argument("ext table spacing must be positive");
+
+    ext_table_axis = axis;
+    ext_table_x0 = x0;
+    ext_table_dx = dx;
+
+    ext_table.clear();
+    ext_table.reserve(values.size());
+    for(auto v : values) ext_table.push_back(v);
+  }
 
+  /// call f with the external field policy of the current settings;
+  // picked once per call so that the particle loops are compiled per policy
+  template<typename F>
+  void with_ext_field(F&& f) 
+  {
+    ext::Uniform uni{ {ex_ext, ey_ext, ez_ext}, {bx_ext, by_ext, bz_ext} };
+
+    if(dipole_B0 != 0.0f) {
+      const float cen[3] = {dipole_cenx, dipole_ceny, dipole_cenz};
+      f( ext::Dipole<D>(uni, dipole_B0, dipole_chi, dipole_phase, cen) );
+    } else if(ext_table.size() > 0) {
+      f( ext::Table{uni, ext_table.data(), int(ext_table.size()/6), 
+                    ext_table_axis, ext_table_x0, ext_table_dx} );
+    } else if(ex_ext != 0.0 || ey_ext != 0.0 || ez_ext != 0.0 ||
+              bx_ext != 0.0 || by_ext != 0.0 || bz_ext != 0.0) {
+      f( uni );
+    } else {
+      f( ext::None{} );
+    }
+  }
 
   virtual void push_container(
           pic::ParticleContainer<D>& container, 
@@ -61,8 +119,10 @@ class Pusher
   /// push all containers in tile
   void solve(pic::Tile<D>& tile)
   {
-    for(auto&& container : tile.containers)
+    for(auto&& container : tile.containers) {
       push_container(container, tile);
+      container.cells_sorted = false; // particles have moved
+    }
   }
 
 
@@ -70,6 +130,7 @@ class Pusher
   void solve(pic::Tile<D>& tile, int ispc)
   {
     push_container(tile.containers[ispc], tile);
+    tile.containers[ispc].cells_sorted = false; // particles have moved
   }
 
 };
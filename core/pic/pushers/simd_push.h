@@ -0,0 +1,120 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+
+#include "core/pic/particle.h"
+#include "tools/simd.h"
+
+namespace pic {
+
+using toolbox::simd::Lanes;
+
+
+/// raw particle arrays of a container
+template<size_t D>
+struct SimdPushArrays {
+  size_t N;
+  float* loc[3];
+  float* vel[3];
+  const float* e[3];
+  const float* b[3];
+
+  SimdPushArrays(pic::ParticleContainer<D>& con) : N{con.size()}
+  {
+    for(size_t i=0; i<3; i++) {
+      loc[i] = &con.loc(i,0);
+      vel[i] = &con.vel(i,0);
+    }
+
+    e[0] = &con.ex(0); e[1] = &con.ey(0); e[2] = &con.ez(0);
+    b[0] = &con.bx(0); b[1] = &con.by(0); b[2] = &con.bz(0);
+  }
+};
+
+
+/// push block ib of W particles with Push::push_particle; last block is masked
+template<size_t W, size_t D, class Push, class Ext>
+inline void simd_push_block(
+    const SimdPushArrays<D>& a,
+    const size_t ib,
+    const Ext& ext,
+    const double c, const double qm)
+{
+  const size_t n0 = ib*W;
+  const size_t nv = std::min(W, a.N - n0); // active lanes
+
+  Lanes<float,W> x[3], u[3], e[3], b[3];
+  for(size_t i=0; i<3; i++) {
+    x[i].load(a.loc[i] + n0, nv);
+    u[i].load(a.vel[i] + n0, nv);
+    e[i].load(a.e[i] + n0, nv);
+    b[i].load(a.b[i] + n0, nv);
+  }
+
+  #pragma omp simd simdlen(W)
+  for(size_t l=0; l<W; l++) {
+    float ul[3] = { u[0][l], u[1][l], u[2][l] };
+
+    double el[3] = { e[0][l], e[1][l], e[2][l] };
+    double bl[3] = { b[0][l], b[1][l], b[2][l] };
+    ext.add(x[0][l], x[1][l], x[2][l], el, bl);
+
+    const auto ginv = Push::push_particle(ul, el, bl, c, qm);
+    const decltype(ginv) cc = c;
+
+    for(size_t i=0; i<3; i++) u[i][l] = ul[i];
+
+    // NOTE: same (mixed-precision) position advance as in the scalar pushers
+    for(size_t i=0; i<D; i++) x[i][l] += u[i][l]*ginv*cc;
+  }
+
+  for(size_t i=0; i<3; i++) {
+    u[i].store(a.vel[i] + n0, nv);
+    if(i < D) x[i].store(a.loc[i] + n0, nv);
+  }
+}
+
+
+// kernel versions for each instruction set; W fills one register with floats.
+// NOTE: the thread loop has to be in the target function itself so that the 
+//       outlined OpenMP region is compiled for the same instruction set.
+
+#define SIMD_PUSH_KERNEL(NAME, W, TARGET)                                            \
+template<size_t D, class Push, class Ext>                                           \
+TARGET void NAME(pic::ParticleContainer<D>& con, const Ext& ext, double c, double qm) \
+{                                                                                   \
+  const SimdPushArrays<D> a(con);                                                   \
+  const size_t Nblocks = (a.N + W - 1)/W;                                           \
+                                                                                    \
+  _Pragma("omp parallel for schedule(static)")                                      \
+  for(size_t ib=0; ib<Nblocks; ib++) simd_push_block<W, D, Push>(a, ib, ext, c, qm); \
+}
+
+SIMD_PUSH_KERNEL(simd_push_avx512,  16, TOOLBOX_TARGET_AVX512)
+SIMD_PUSH_KERNEL(simd_push_avx2,     8, TOOLBOX_TARGET_AVX2)
+SIMD_PUSH_KERNEL(simd_push_generic,  4, )
+
+#undef SIMD_PUSH_KERNEL
+
+
+/*! \brief Explicitly vectorized push of a whole container
+ *
+ * Uses the per-particle step Push::push_particle of the Boris, Vay, and
+ * Higuera-Cary pushers and the external field policy ext; the kernel
+ * version is picked at run time for the instruction set of the cpu.
+ */
+template<size_t D, class Push, class Ext>
+void simd_push(pic::ParticleContainer<D>& con, const Ext& ext, double c, double qm)
+{
+  if(con.size() == 0) return;
+
+  switch(toolbox::simd::isa()) {
+    case toolbox::simd::Isa::avx512: simd_push_avx512<D,Push>(con, ext, c, qm); break;
+    case toolbox::simd::Isa::avx2:   simd_push_avx2<D,Push>(  con, ext, c, qm); break;
+    default:                         simd_push_generic<D,Push>(con, ext, c, qm); break;
+  }
+}
+
+
+} // end of namespace pic
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cmath>
+
 #include "core/pic/pushers/pusher.h"
 
 namespace pic {
@@ -9,9 +11,70 @@ template<size_t D, size_t V>
 class VayPusher :
   public Pusher<D,V>
 {
+  public:
   void push_container(
           pic::ParticleContainer<D>& container, 
           pic::Tile<D>& tile) override;
+
+  /// Vay step of one particle; 
+  // u is the normalized 4-velocity (updated), e and b the total fields at the particle.
+  // Returns the inverse Lorentz factor of the new velocity for the position advance.
+  DEVCALLABLE static inline double push_particle(
+      float (&u)[3], 
+      const double (&e)[3], const double (&b)[3], 
+      const double c, const double qm)
+  {
+    const double cinv = 1.0/c;
+
+    double vel0n = u[0];
+    double vel1n = u[1];
+    double vel2n = u[2];
+
+    double ex0 = e[0]*0.5*qm;
+    double ey0 = e[1]*0.5*qm;
+    double ez0 = e[2]*0.5*qm;
+
+    double bx0 = b[0]*0.5*qm/c;
+    double by0 = b[1]*0.5*qm/c;
+    double bz0 = b[2]*0.5*qm/c;
+
+    //--------------------------------------------------
+    // Vay algorithm
+      
+    // gamma^-1
+    double g = 1.0/sqrt(1.0 + vel0n*vel0n + vel1n*vel1n + vel2n*vel2n);
+    double vx0 = c*vel0n*g;
+    double vy0 = c*vel1n*g;
+    double vz0 = c*vel2n*g;
+
+    // u' (cinv is already multiplied into B)
+    double u1 = c*vel0n + 2.0*ex0 + vy0*bz0 - vz0*by0;
+    double v1 = c*vel1n + 2.0*ey0 + vz0*bx0 - vx0*bz0;
+    double w1 = c*vel2n + 2.0*ez0 + vx0*by0 - vy0*bx0;
+    
+    // gamma(u')
+    double ustar = cinv*(u1*bx0+v1*by0+w1*bz0);
+    double sig = cinv*cinv*( c*c + u1*u1+ v1*v1+ w1*w1) - (bx0*bx0+ by0*by0+ bz0*bz0);
+    g = 1.0/sqrt( 0.5*(sig + sqrt(sig*sig + 4.0*(bx0*bx0 + by0*by0 + bz0*bz0 + ustar*ustar))));
+
+    double tx = bx0*g;
+    double ty = by0*g;
+    double tz = bz0*g;
+    double f = 1.0/(1.0+ tx*tx+ ty*ty+ tz*tz);
+	  
+    // final step 
+    double u0 = f*(u1 + (u1*tx + v1*ty + w1*tz)*tx + v1*tz - w1*ty);
+    double v0 = f*(v1 + (u1*tx + v1*ty + w1*tz)*ty + w1*tx - u1*tz);
+    double w0 = f*(w1 + (u1*tx + v1*ty + w1*tz)*tz + u1*ty - v1*tx);
+
+    //--------------------------------------------------
+    // normalized 4-velocity advance
+    u[0] = u0/c;
+    u[1] = v0/c;
+    u[2] = w0/c;
+
+    return c / sqrt(c*c + u0*u0 + v0*v0 + w0*w0);
+  }
 };
 
 } // end of namespace pic
@@ -0,0 +1,146 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <numeric>
+#include <vector>
+#include <stdexcept>
+
+#include "tools/philox.h"
+
+namespace pic {
+namespace sampling {
+
+using toolbox::Philox;
+
+/// draw index of the particle direction and boost flip; rejection passes use 0,1,2...
+constexpr uint32_t dir_draw = 0xFFFFFF;
+
+
+/*! \brief Boosted Maxwell-Juttner four-velocities of n particles
+ *
+ * Same conventions as pytools.sample_boosted_maxwellian:
+ * - theta = kT/mc^2 of the plasma rest frame; relativistic temperatures
+ *   (theta > 0.2) are sampled with the Sobol method and cold plasmas with
+ *   a Gaussian per velocity component,
+ * - gamma is the bulk Lorentz factor of the drift (interpreted as beta if
+ *   < 1; no drift if 0) along direction = +-1, +-2, +-3 for +-x, +-y, +-z
+ *   (Zenitani 2015),
+ * - dims = 2 samples the velocities in the xy-plane.
+ *
+ * rng(i, draw) returns the four random numbers of the draw:th draw of
+ * particle i; the samplers are thus independent of the processing order.
+ * Rejections are handled in passes over the particles still pending so that
+ * each pass is a flat loop over the batch.
+ */
+template<class Rng>
+void sample_boosted_juttner(
+    size_t n, const Rng& rng,
+    double theta, double gamma, int direction, int dims,
+    float* ux, float* uy, float* uz)
+{
+  if(dims != 2 && dims != 3) throw std::invalid_argument("sampler dims must be 2 or 3");
+  if(std::abs(direction) < 1 || std::abs(direction) > 3) throw std::invalid_argument("invalid direction; give |d| <= 3");
+
+  std::vector<float> u(n); // magnitude in the plasma frame
+
+  if(theta > 0.2) {
+
+    // Sobol method; accepted if n^2 - u^2 >= 1
+    std::vector<uint32_t> pending(n);
+    std::iota(pending.begin(), pending.end(), 0);
+
+    for(uint32_t pass=0; !pending.empty(); pass++) {
+      size_t m = 0;
+      for(size_t q=0; q<pending.size(); q++) {
+        const uint32_t i = pending[q];
+        const auto r = rng(i, pass);
+
+        const double x456 = double(Philox::uniform_pos(r[0]))*Philox::uniform_pos(r[1])*Philox::uniform_pos(r[2]);
+        const double uu = -theta*std::log(x456);
+        const double nn = -theta*std::log(x456*Philox::uniform_pos(r[3]));
+
+        if(nn*nn - uu*uu < 1.0) {
+          pending[m++] = i;
+        } else {
+          u[i] = uu;
+        }
+      }
+      pending.resize(m);
+    }
+
+    // isotropic direction
+    for(size_t i=0; i<n; i++) {
+      const auto r = rng(i, dir_draw);
+      const double x1 = Philox::uniform(r[0]);
+      const double x2 = Philox::uniform(r[1]);
+
+      if(dims == 3) {
+        ux[i] = u[i]*(2.0*x1 - 1.0);
+        uy[i] = 2.0*u[i]*std::sqrt(x1*(1.0 - x1))*std::cos(2.0*M_PI*x2);
+        uz[i] = 2.0*u[i]*std::sqrt(x1*(1.0 - x1))*std::sin(2.0*M_PI*x2);
+      } else {
+        ux[i] = u[i]*std::cos(2.0*M_PI*x2);
+        uy[i] = u[i]*std::sin(2.0*M_PI*x2);
+        uz[i] = 0.0f;
+      }
+    }
+
+  } else {
+
+    // cold plasma; Box-Muller pairs per component
+    const double sig = std::sqrt(theta);
+
+    #pragma omp simd
+    for(size_t i=0; i<n; i++) {
+      const auto r = rng(i, 0);
+      const double r1 = std::sqrt(-2.0*std::log(Philox::uniform_pos(r[0])));
+      const double r2 = std::sqrt(-2.0*std::log(Philox::uniform_pos(r[2])));
+      const double a1 = 2.0*M_PI*Philox::uniform(r[1]);
+      const double a2 = 2.0*M_PI*Philox::uniform(r[3]);
+
+      ux[i] = sig*r1*std::cos(a1);
+      uy[i] = sig*r1*std::sin(a1);
+      uz[i] = dims == 3 ? sig*r2*std::cos(a2) : 0.0;
+
+      u[i] = std::sqrt(ux[i]*ux[i] + uy[i]*uy[i] + uz[i]*uz[i]);
+    }
+  }
+
+  if(gamma == 0.0) return; // no drift
+
+  //--------------------------------------------------
+  // boost along x with the flipping method of Zenitani 2015
+  double beta, Gamma;
+  if(gamma < 1.0) {
+    beta  = gamma;
+    Gamma = 1.0/std::sqrt(1.0 - beta*beta);
+  } else {
+    Gamma = gamma;
+    beta  = std::sqrt(1.0 - 1.0/(Gamma*Gamma));
+  }
+
+  for(size_t i=0; i<n; i++) {
+    const double x8 = Philox::uniform(rng(i, dir_draw)[2]);
+    const double g  = std::sqrt(1.0 + double(u[i])*u[i]);
+
+    double vx = ux[i]/g;
+    double uxb = (-beta*vx > x8) ? -ux[i] : ux[i];
+    uxb = Gamma*(uxb + beta*g);
+
+    // rotate the drift direction from +x
+    const float a = uxb, b = uy[i], c = uz[i];
+    switch(direction) {
+      case +1: ux[i] =  a; break;
+      case -1: ux[i] = -a; break;
+      case +2: ux[i] =  b; uy[i] =  a; break;
+      case -2: ux[i] =  b; uy[i] = -a; break;
+      case +3: ux[i] =  c; uz[i] =  a; break;
+      case -3: ux[i] =  c; uz[i] = -a; break;
+    }
+  }
+}
+
+
+} // end of namespace sampling
+} // end of namespace pic
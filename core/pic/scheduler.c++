@@ -0,0 +1,466 @@
+#include <chrono>
+#include <stdexcept>
+#include <algorithm>
+
+#include "core/pic/scheduler.h"
+#include "core/emf/propagators/fdtd2.h"
+#include "core/emf/propagators/fdtd4.h"
+#ifdef FFTW
+#include "core/emf/propagators/psatd.h"
+#endif
+#include "tools/shm_window.h"
+
+#ifdef GPU
+#include <nvtx3/nvToolsExt.h>
+#endif
+
+namespace pic {
+
+
+template<size_t D>
+typename TaskScheduler<D>::Nhood TaskScheduler<D>::parse_nhood(const std::string& nhood) const
+{
+  if(nhood == "all")      return Nhood::all;
+  if(nhood == "local")    return Nhood::local;
+  if(nhood == "virtual")  return Nhood::virtuals;
+  if(nhood == "boundary") return Nhood::boundary;
+
+  throw std::invalid_argument("TaskScheduler: unknown nhood " + nhood);
+}
+
+
+template<size_t D>
+void TaskScheduler<D>::add_mpi(const std::string& name, const std::string& method)
+{
+  Op op;
+  op.name = name;
+
+  if(method == "j")  op.mpid = 0;
+  if(method == "e")  op.mpid = 1;
+  if(method == "b")  op.mpid = 2;
+  if(method == "p1") op.mpid = 3;
+  if(method == "p2") op.mpid = 4;
+
+  if(op.mpid < 0) throw std::invalid_argument("TaskScheduler: unknown mpi method " + method);
+
+  ops.push_back(op);
+}
+
+
+template<size_t D>
+void TaskScheduler<D>::add_tile_op(
+    const std::string& name,
+    const std::string& method,
+    const std::string& nhood,
+    std::vector<int> args)
+{
+  Op op;
+  op.name  = name;
+  op.nhood = parse_nhood(nhood);
+
+  auto& g = grid;
+  auto emf_tile = [](corgi::Tile<D>& t) -> emf::Tile<D>& { return dynamic_cast<emf::Tile<D>&>(t); };
+  auto pic_tile = [](corgi::Tile<D>& t) -> pic::Tile<D>& { return dynamic_cast<pic::Tile<D>&>(t); };
+
+  // fields
+  if(method == "clear_current") {
+    op.f = [=](corgi::Tile<D>& t){ emf_tile(t).clear_current(); };
+  } else if(method == "deposit_current") {
+    op.f = [=](corgi::Tile<D>& t){ emf_tile(t).deposit_current(); };
+  } else if(method == "update_boundaries") {
+    if(args.empty()) args = {0,1,2};
+    op.f = [=,&g](corgi::Tile<D>& t){ emf_tile(t).update_boundaries(g, args); };
+  } else if(method == "exchange_currents") {
+    op.f = [=,&g](corgi::Tile<D>& t){ emf_tile(t).exchange_currents(g); };
+
+  // particles
+  } else if(method == "check_outgoing_particles") {
+    op.f = [=](corgi::Tile<D>& t){ pic_tile(t).check_outgoing_particles(); };
+  } else if(method == "pack_outgoing_particles") {
+    op.f = [=](corgi::Tile<D>& t){ pic_tile(t).pack_outgoing_particles(); };
+  } else if(method == "pack_all_particles") {
+    op.f = [=](corgi::Tile<D>& t){ pic_tile(t).pack_all_particles(); };
+  } else if(method == "unpack_incoming_particles") {
+    op.f = [=](corgi::Tile<D>& t){ pic_tile(t).unpack_incoming_particles(); };
+  } else if(method == "get_incoming_particles") {
+    op.f = [=,&g](corgi::Tile<D>& t){ pic_tile(t).get_incoming_particles(g); };
+    op.tile_parallel = false; // appending may reallocate arrays that the neighbors are reading
+  } else if(method == "delete_transferred_particles") {
+    op.f = [=](corgi::Tile<D>& t){ pic_tile(t).delete_transferred_particles(); };
+  } else if(method == "delete_all_particles") {
+    op.f = [=](corgi::Tile<D>& t){ pic_tile(t).delete_all_particles(); };
+  } else if(method == "shrink_to_fit_all_particles") {
+    op.f = [=](corgi::Tile<D>& t){ pic_tile(t).shrink_to_fit_all_particles(); };
+  } else if(method == "sort_particles_in_cells") {
+    const bool full = !args.empty() && args[0] != 0;
+    op.f = [=](corgi::Tile<D>& t){ pic_tile(t).sort_particles_in_cells(full); };
+  } else {
+    throw std::invalid_argument("TaskScheduler: unknown tile method " + method);
+  }
+
+  ops.push_back(op);
+}
+
+
+template<size_t D>
+void TaskScheduler<D>::add_solver(
+    const std::string& name,
+    pic::Pusher<D,3>& solver,
+    const std::string& nhood,
+    int ispc)
+{
+  Op op;
+  op.name  = name;
+  op.nhood = parse_nhood(nhood);
+
+  if(ispc >= 0) {
+    op.f = [&solver, ispc](corgi::Tile<D>& t){ solver.solve(dynamic_cast<pic::Tile<D>&>(t), ispc); };
+  } else {
+    op.f = [&solver](corgi::Tile<D>& t){ solver.solve(dynamic_cast<pic::Tile<D>&>(t)); };
+  }
+
+  ops.push_back(op);
+}
+
+
+template<size_t D>
+void TaskScheduler<D>::add_solver(
+    const std::string& name,
+    pic::Interpolator<D,3>& solver,
+    const std::string& nhood)
+{
+  Op op;
+  op.name  = name;
+  op.nhood = parse_nhood(nhood);
+  op.f = [&solver](corgi::Tile<D>& t){ solver.solve(dynamic_cast<pic::Tile<D>&>(t)); };
+
+  ops.push_back(op);
+}
+
+
+template<size_t D>
+void TaskScheduler<D>::add_solver(
+    const std::string& name,
+    pic::Depositer<D,3>& solver,
+    const std::string& nhood)
+{
+  Op op;
+  op.name  = name;
+  op.nhood = parse_nhood(nhood);
+  op.f = [&solver](corgi::Tile<D>& t){ solver.solve(dynamic_cast<pic::Tile<D>&>(t)); };
+
+  // thread-private currents live in the solver; threads are used inside the tile instead
+  op.tile_parallel = !solver.private_currents;
+
+  ops.push_back(op);
+}
+
+
+template<size_t D>
+void TaskScheduler<D>::add_solver(
+    const std::string& name,
+    emf::Filter<D>& solver,
+    const std::string& nhood)
+{
+  Op op;
+  op.name  = name;
+  op.nhood = parse_nhood(nhood);
+  op.f = [&solver](corgi::Tile<D>& t){ solver.solve(dynamic_cast<emf::Tile<D>&>(t)); };
+  op.tile_parallel = false;
+
+  ops.push_back(op);
+}
+
+
+template<size_t D>
+void TaskScheduler<D>::add_solver(
+    const std::string& name,
+    emf::Propagator<D>& solver,
+    const std::string& method,
+    const std::string& nhood)
+{
+  Op op;
+  op.name  = name;
+  op.nhood = parse_nhood(nhood);
+
+  if(method == "push_e") {
+    op.f = [&solver](corgi::Tile<D>& t){ solver.push_e(dynamic_cast<emf::Tile<D>&>(t)); };
+  } else if(method == "push_half_b") {
+    op.f = [&solver](corgi::Tile<D>& t){ solver.push_half_b(dynamic_cast<emf::Tile<D>&>(t)); };
+  } else if(method == "push_half_b_e") {
+    // fused sweep of the finite difference solvers
+    if(auto* f2 = dynamic_cast<emf::FDTD2<D>*>(&solver)) {
+      op.f = [f2](corgi::Tile<D>& t){ f2->push_half_b_e(dynamic_cast<emf::Tile<D>&>(t)); };
+    } else if(auto* f4 = dynamic_cast<emf::FDTD4<D>*>(&solver)) {
+      op.f = [f4](corgi::Tile<D>& t){ f4->push_half_b_e(dynamic_cast<emf::Tile<D>&>(t)); };
+    } else {
+      throw std::invalid_argument("TaskScheduler: push_half_b_e needs FDTD2 or FDTD4");
+    }
+  } else {
+    throw std::invalid_argument("TaskScheduler: unknown propagator method " + method);
+  }
+
+#ifdef FFTW
+  // fft plans and buffers are shared; tile after tile
+  if(dynamic_cast<emf::PSATD<D>*>(&solver)) op.tile_parallel = false;
+#endif
+
+  ops.push_back(op);
+}
+
+
+template<size_t D>
+void TaskScheduler<D>::add_solver(
+    const std::string& name,
+    emf::MultiPassBinomial2<D>& solver,
+    const std::string& method,
+    const std::string& nhood)
+{
+  Op op;
+  op.name  = name;
+  op.nhood = parse_nhood(nhood);
+
+  auto& g = grid;
+  if(method == "compute") {
+    // shared scratch and result map; tile after tile
+    op.f = [&solver,&g](corgi::Tile<D>& t){ solver.compute(dynamic_cast<emf::Tile<D>&>(t), g); };
+    op.tile_parallel = false;
+  } else if(method == "solve") {
+    // only reads the stored results
+    op.f = [&solver](corgi::Tile<D>& t){ solver.solve(dynamic_cast<emf::Tile<D>&>(t)); };
+  } else {
+    throw std::invalid_argument("TaskScheduler: unknown filter method " + method);
+  }
+
+  ops.push_back(op);
+}
+
+
+template<size_t D>
+void TaskScheduler<D>::add_op(
+    const std::string& name,
+    TileFn f,
+    const std::string& nhood,
+    bool tile_parallel)
+{
+  Op op;
+  op.name  = name;
+  op.nhood = parse_nhood(nhood);
+  op.f = f;
+  op.tile_parallel = tile_parallel;
+  op.overlap = false; // unknown data dependencies
+
+  ops.push_back(op);
+}
+
+
+//--------------------------------------------------
+
+template<size_t D>
+const std::vector<corgi::Tile<D>*>& TaskScheduler<D>::tiles(Nhood nhood) const
+{
+  if(nhood == Nhood::local)    return tiles_local;
+  if(nhood == Nhood::virtuals) return tiles_virtual;
+  if(nhood == Nhood::boundary) return tiles_boundary;
+  return tiles_all;
+}
+
+
+template<size_t D>
+std::vector<uint64_t> TaskScheduler<D>::neighbor_ids(corgi::Tile<D>& tile)
+{
+  std::vector<uint64_t> ids;
+
+  for(int in=-1; in<=1; in++) {
+    for(int jn=(D>=2 ? -1 : 0); jn<=(D>=2 ? 1 : 0); jn++) {
+      for(int kn=(D>=3 ? -1 : 0); kn<=(D>=3 ? 1 : 0); kn++) {
+        if (in == 0 && jn == 0 && kn == 0) continue;
+
+        std::shared_ptr<corgi::Tile<D>> tpr;
+        if constexpr (D == 1) tpr = grid.get_tileptr( tile.neighs(in) );
+        if constexpr (D == 2) tpr = grid.get_tileptr( tile.neighs(in, jn) );
+        if constexpr (D == 3) tpr = grid.get_tileptr( tile.neighs(in, jn, kn) );
+
+        if(tpr) ids.push_back(tpr->cid);
+      }
+    }
+  }
+
+  return ids;
+}
+
+
+template<size_t D>
+void TaskScheduler<D>::update_tiles(int max_level)
+{
+  auto collect = [&](const std::vector<uint64_t>& cids, std::vector<corgi::Tile<D>*>& out) {
+    out.clear();
+    for(auto cid : cids) out.push_back( &grid.get_tile(cid) );
+  };
+
+  collect(grid.get_tile_ids(),       tiles_all);
+  collect(grid.get_local_tiles(),    tiles_local);
+  collect(grid.get_virtual_tiles(),  tiles_virtual);
+  collect(grid.get_boundary_tiles(), tiles_boundary);
+
+  if(!overlap) return;
+
+  // distance from virtual tiles; local tiles next to a virtual tile get 1.
+  // missing tiles (open boundaries) do not limit the level
+  std::map<uint64_t, std::vector<uint64_t>> neighbors;
+  level.clear();
+  for(auto t : tiles_virtual) level[t->cid] = 0;
+  for(auto t : tiles_local) {
+    level[t->cid] = max_level;
+    neighbors[t->cid] = neighbor_ids(*t);
+  }
+
+  for(int sweep=0; sweep<max_level; sweep++) {
+    bool changed = false;
+    for(auto t : tiles_local) {
+      int lvl = level[t->cid];
+      for(auto nid : neighbors[t->cid]) {
+        auto it = level.find(nid);
+        if(it != level.end()) lvl = std::min(lvl, it->second + 1);
+      }
+
+      if(lvl != level[t->cid]) {
+        level[t->cid] = lvl;
+        changed = true;
+      }
+    }
+    if(!changed) break;
+  }
+}
+
+
+template<size_t D>
+void TaskScheduler<D>::run_tiles(
+    const Op& op,
+    const std::vector<corgi::Tile<D>*>& ts)
+{
+  if(ts.empty()) return;
+
+  auto t0 = std::chrono::steady_clock::now();
+
+#ifndef GPU
+  if(threads && op.tile_parallel) {
+    #pragma omp parallel for schedule(dynamic,1)
+    for(size_t n=0; n<ts.size(); n++) op.f(*ts[n]);
+  } else {
+    for(auto t : ts) op.f(*t);
+  }
+#else
+  for(auto t : ts) op.f(*t);
+#endif
+
+  auto t1 = std::chrono::steady_clock::now();
+  timings[op.name] += std::chrono::duration<double>(t1 - t0).count();
+}
+
+
+template<size_t D>
+void TaskScheduler<D>::start_mpi(int mpid)
+{
+  // previous messages in the shared memory window have been consumed on the node
+  if(shm_exchange) toolbox::ShmWindow::get().begin_phase();
+
+  grid.recv_data(mpid);
+  grid.send_data(mpid);
+}
+
+
+template<size_t D>
+void TaskScheduler<D>::finish_mpi(int mpid)
+{
+  grid.wait_data(mpid);
+
+  // copy received halo regions into virtual tiles
+  if(mpid <= 2) {
+    for(auto t : tiles_virtual) {
+      auto& tile = dynamic_cast<emf::Tile<D>&>(*t);
+      if(tile.packed_halos) tile.unpack_halos(mpid);
+    }
+  }
+}
+
+
+template<size_t D>
+void TaskScheduler<D>::run()
+{
+
+#ifdef GPU
+  nvtxRangePush(__PRETTY_FUNCTION__);
+#endif
+
+  // longest run of tile ops after an mpi op fixes the needed tile levels
+  int max_level = 1;
+  for(size_t i=0, k=0; i<ops.size(); i++) {
+    k = ops[i].mpid >= 0 ? 0 : k+1;
+    max_level = std::max(max_level, int(k) + 2);
+  }
+
+  update_tiles(max_level);
+
+  size_t i = 0;
+  while(i < ops.size()) {
+    const Op& op = ops[i];
+
+    if(op.mpid < 0) {
+      run_tiles(op, tiles(op.nhood));
+      i++;
+      continue;
+    }
+
+    // post messages
+    auto t0 = std::chrono::steady_clock::now();
+    start_mpi(op.mpid);
+    auto t1 = std::chrono::steady_clock::now();
+
+    // tile ops up to the next mpi op
+    size_t end = i+1;
+    while(end < ops.size() && ops[end].mpid < 0) end++;
+
+    // tiles that do not depend on the messages go first
+    std::vector< std::vector<corgi::Tile<D>*> > late(end - i - 1);
+    bool early = overlap;
+    for(size_t k=0; k<late.size(); k++) {
+      const Op& wop = ops[i+1+k];
+      early = early && wop.overlap;
+
+      std::vector<corgi::Tile<D>*> now;
+      for(auto t : tiles(wop.nhood)) {
+        auto it = level.find(t->cid);
+        bool ready = early && t->communication.local && it != level.end() && it->second >= int(k)+2;
+        (ready ? now : late[k]).push_back(t);
+      }
+
+      run_tiles(wop, now);
+    }
+
+    auto t2 = std::chrono::steady_clock::now();
+    finish_mpi(op.mpid);
+    auto t3 = std::chrono::steady_clock::now();
+
+    timings[op.name] += std::chrono::duration<double>((t1 - t0) + (t3 - t2)).count();
+
+    for(size_t k=0; k<late.size(); k++) run_tiles(ops[i+1+k], late[k]);
+
+    i = end;
+  }
+
+#ifdef GPU
+  nvtxRangePop();
+#endif
+
+}
+
+
+//--------------------------------------------------
+// explicit template instantiation
+
+template class TaskScheduler<1>;
+template class TaskScheduler<2>;
+template class TaskScheduler<3>;
+
+} // end of namespace pic
@@ -0,0 +1,139 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <map>
+#include <functional>
+
+#include "external/corgi/corgi.h"
+#include "core/emf/tile.h"
+#include "core/emf/propagators/propagator.h"
+#include "core/emf/filters/filter.h"
+#include "core/emf/filters/multipass_binomial.h"
+#include "core/pic/tile.h"
+#include "core/pic/pushers/pusher.h"
+#include "core/pic/interpolators/interpolator.h"
+#include "core/pic/depositers/depositer.h"
+
+namespace pic {
+
+/*! \brief Hybrid MPI + OpenMP lap scheduler
+ *
+ * C++ counterpart of pytools.Scheduler: takes the same list of operations
+ * (solver, method, nhood), and runs one lap of them with run().
+ *
+ * - Tiles of an op are processed by OpenMP threads (one tile per thread);
+ *   solvers with shared scratch memory run tile after tile.
+ * - mpi ops only post the messages. The tile ops up to the next mpi op are
+ *   executed for tiles that do not depend on the messages while they are in
+ *   flight, and for the rest after the messages have arrived.
+ *
+ * A tile at distance L from the nearest virtual tile (boundary tiles have L=1)
+ * can run the k-th op after an mpi op (k=0,1,...) early if L >= k+2: then it and
+ * its neighbors have done the previous op, and none of them reads the messages.
+ * This assumes that ops only read the neighboring tiles, as all tile methods
+ * and solvers do; python ops end the early execution of a window.
+ */
+template<size_t D>
+class TaskScheduler
+{
+  public:
+
+  enum class Nhood { all, local, virtuals, boundary };
+
+  using TileFn = std::function<void(corgi::Tile<D>&)>;
+
+  /// one operation of the lap
+  struct Op {
+    std::string name;
+    Nhood nhood = Nhood::all;
+    int mpid = -1;            // mpi message mode if >= 0
+    TileFn f;                 // work per tile
+    bool tile_parallel = true; // tiles can be processed concurrently
+    bool overlap = true;       // can run early (only neighbor tiles are read)
+  };
+
+  corgi::Grid<D>& grid;
+
+  std::vector<Op> ops;
+
+  /// process tiles of an op in parallel threads
+  bool threads = true;
+
+  /// run interior tile work while mpi messages are in flight
+  bool overlap = true;
+
+  /// start a shared memory exchange phase (toolbox::ShmWindow) before every mpi op
+  bool shm_exchange = false;
+
+  /// wall-clock time per op name in seconds; accumulated over run calls
+  std::map<std::string, double> timings;
+
+  explicit TaskScheduler(corgi::Grid<D>& grid) : grid{grid} {}
+
+  //--------------------------------------------------
+  // building the lap
+
+  /// mpi message exchange; method is one of j, e, b, p1, p2
+  void add_mpi(const std::string& name, const std::string& method);
+
+  /// tile method (clear_current, update_boundaries, ...); args are its integer arguments
+  void add_tile_op(const std::string& name, const std::string& method,
+      const std::string& nhood, std::vector<int> args = {});
+
+  /// solver.solve(tile) or solver.solve(tile, ispc) if ispc >= 0
+  void add_solver(const std::string& name, pic::Pusher<D,3>& solver,
+      const std::string& nhood, int ispc = -1);
+
+  /// solver.solve(tile)
+  void add_solver(const std::string& name, pic::Interpolator<D,3>& solver, const std::string& nhood);
+
+  /// solver.solve(tile); private_currents depositers run tile after tile
+  void add_solver(const std::string& name, pic::Depositer<D,3>& solver, const std::string& nhood);
+
+  /// solver.solve(tile); filters have a shared scratch mesh and run tile after tile
+  void add_solver(const std::string& name, emf::Filter<D>& solver, const std::string& nhood);
+
+  /// solver.push_e(tile), solver.push_half_b(tile), or solver.push_half_b_e(tile) (FDTD2/FDTD4);
+  //  PSATD has shared fft buffers and runs tile after tile
+  void add_solver(const std::string& name, emf::Propagator<D>& solver,
+      const std::string& method, const std::string& nhood);
+
+  /// solver.compute(tile, grid) (tile after tile) or solver.solve(tile)
+  void add_solver(const std::string& name, emf::MultiPassBinomial2<D>& solver,
+      const std::string& method, const std::string& nhood);
+
+  /// any other per tile work; not overlapped with mpi
+  void add_op(const std::string& name, TileFn f, const std::string& nhood, bool tile_parallel);
+
+  void clear() { ops.clear(); }
+
+  //--------------------------------------------------
+
+  /// execute all ops once
+  void run();
+
+  private:
+
+  /// tiles of each neighborhood; refreshed every run
+  std::vector<corgi::Tile<D>*> tiles_all, tiles_local, tiles_virtual, tiles_boundary;
+
+  /// distance of local tiles from the nearest virtual tile; capped
+  std::map<uint64_t, int> level;
+
+  Nhood parse_nhood(const std::string& nhood) const;
+
+  const std::vector<corgi::Tile<D>*>& tiles(Nhood nhood) const;
+
+  void update_tiles(int max_level);
+
+  std::vector<uint64_t> neighbor_ids(corgi::Tile<D>& tile);
+
+  void run_tiles(const Op& op, const std::vector<corgi::Tile<D>*>& tiles);
+
+  void start_mpi(int mpid);
+
+  void finish_mpi(int mpid);
+};
+
+} // end of namespace pic
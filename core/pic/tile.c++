@@ -1,7 +1,10 @@
 #include <cmath>
+#include <cstring>
 
 #include "core/pic/tile.h"
 #include "core/pic/communicate.h"
+#include "core/pic/wire_format.h"
+#include "tools/shm_window.h"
 
 #ifdef GPU
 #include <nvtx3/nvToolsExt.h> 
@@ -56,10 +59,38 @@ void Tile<D>::delete_transferred_particles()
 {
   for(auto&& container : containers) 
     container.delete_transferred_particles();
+
+  // outgoing MPI message has been delivered by now; give the buffers back to the pool
+  release_outgoing_buffers();
 }
 
 //--------------------------------------------------
 
+template<std::size_t D>
+void Tile<D>::transfer_from_neighbors(
+    std::vector< std::pair<Tile<D>*, std::array<int,3>> >& neighbors,
+    std::array<double,3>& global_mins,
+    std::array<double,3>& global_maxs)
+{
+  for(int ispc=0; ispc<Nspecies(); ispc++) {
+    auto& container = get_container(ispc);
+
+    // one allocation for everything that comes in; neighbors keep their particles 
+    // bucketed by direction (check_outgoing_particles) so only the incoming ones are visited
+    size_t incoming = 0;
+    for(auto& [tile, dirs] : neighbors)
+      incoming += tile->get_container(ispc).outgoing_to(-dirs[0], -dirs[1], -dirs[2]);
+
+    if(incoming == 0) continue;
+    container.reserve( container.size() + incoming );
+
+    for(auto& [tile, dirs] : neighbors)
+      container.transfer_and_wrap_particles(
+          tile->get_container(ispc), dirs, global_mins, global_maxs);
+  }
+}
+
+
 template<>
 void Tile<1>::get_incoming_particles(
     corgi::Grid<1>& grid)
@@ -81,26 +112,18 @@ void Tile<1>::get_incoming_particles(
     static_cast<double>( 1.0 )
   };
 
-  // fetch incoming particles from neighbors around me
-  int j = 0;
-  int k = 0;
+  // neighbors around me
+  std::vector< std::pair<Tile*, std::array<int,3>> > neighbors;
   for(int i=-1; i<=1; i++) {
-        // get neighboring tile
-        auto ind = this->neighs(i); 
-        uint64_t cid = grid.id( std::get<0>(ind));
-        Tile& external_tile = dynamic_cast<Tile&>( grid.get_tile(cid) );
-
-        // loop over all containers
-        for(int ispc=0; ispc<Nspecies(); ispc++) {
-          auto& container = get_container(ispc);
-          auto& neigh = external_tile.get_container(ispc);
-
-          container.transfer_and_wrap_particles(
-              neigh, {i,j,k}, global_mins, global_maxs);
-        }
+    if( i==0 ) continue;
 
+    auto ind = this->neighs(i); 
+    uint64_t cid = grid.id( std::get<0>(ind));
+    neighbors.push_back({ &dynamic_cast<Tile&>( grid.get_tile(cid) ), {i,0,0} });
   }
 
+  transfer_from_neighbors(neighbors, global_mins, global_maxs);
+
 #ifdef GPU
   nvtxRangePop();
 #endif
@@ -124,28 +147,19 @@ void Tile<2>::get_incoming_particles(
     static_cast<double>( 1.0             )
   };
 
-  // fetch incoming particles from neighbors around me
-  int k = 0;
+  // neighbors around me
+  std::vector< std::pair<Tile*, std::array<int,3>> > neighbors;
   for(int i=-1; i<=1; i++) {
     for(int j=-1; j<=1; j++) {
+      if( i==0 && j==0 ) continue;
 
-      // get neighboring tile
       auto ind = this->neighs(i, j); 
       uint64_t cid = grid.id( std::get<0>(ind), std::get<1>(ind) );
-      Tile& external_tile = 
-        dynamic_cast<Tile&>( grid.get_tile(cid) );
-
-      // loop over all containers
-        
-      for(int ispc=0; ispc<Nspecies(); ispc++) {
-        auto& container = get_container(ispc);
-        auto& neigh = external_tile.get_container(ispc);
-
-        container.transfer_and_wrap_particles(
-            neigh, {i,j,k}, global_mins, global_maxs);
-      }
+      neighbors.push_back({ &dynamic_cast<Tile&>( grid.get_tile(cid) ), {i,j,0} });
     }
   }
+
+  transfer_from_neighbors(neighbors, global_mins, global_maxs);
 }
 
 
@@ -170,31 +184,22 @@ void Tile<3>::get_incoming_particles(
     static_cast<double>( grid.get_zmax() )
   };
 
-  // fetch incoming particles from neighbors around me
+  // neighbors around me
+  std::vector< std::pair<Tile*, std::array<int,3>> > neighbors;
   for(int i=-1; i<=1; i++) {
     for(int j=-1; j<=1; j++) {
       for(int k=-1; k<=1; k++) {
-
         if( i==0 && j==0 && k==0 ) continue;
           
-        // get neighboring tile
         auto ind = this->neighs(i, j, k); 
         uint64_t cid = grid.id( std::get<0>(ind), std::get<1>(ind), std::get<2>(ind) );
-        Tile& external_tile = dynamic_cast<Tile&>( grid.get_tile(cid) );
-
-        // loop over all containers
-        for(int ispc=0; ispc<Nspecies(); ispc++) {
-          auto& container = get_container(ispc);
-          auto& neigh = external_tile.get_container(ispc);
-
-          container.transfer_and_wrap_particles(
-              neigh, {i,j,k}, global_mins, global_maxs);
-        }
-
-        }
+        neighbors.push_back({ &dynamic_cast<Tile&>( grid.get_tile(cid) ), {i,j,k} });
+      }
     }
   }
 
+  transfer_from_neighbors(neighbors, global_mins, global_maxs);
+
 #ifdef GPU
   nvtxRangePop();
 #endif
@@ -212,15 +217,15 @@ std::vector<mpi::request> Tile<D>::send_data(
   if(mode == 1) return emf::Tile<D>::send_data(comm, dest, mode, tag);
   if(mode == 2) return emf::Tile<D>::send_data(comm, dest, mode, tag);
 
-  if(mode == 3) return send_particle_data(comm,dest,tag);
-  if(mode == 4) return send_particle_extra_data(comm,dest,tag);
+  if(mode == 3) return send_particle_counts(comm,dest,tag);
+  if(mode == 4) return send_particle_data(comm,dest,tag);
 
   assert(false);
 }
 
 
 template<std::size_t D>
-std::vector<mpi::request> Tile<D>::send_particle_data( 
+std::vector<mpi::request> Tile<D>::send_particle_counts( 
     mpi::communicator& comm, 
     int dest,
     int tag)
@@ -230,14 +235,24 @@ std::vector<mpi::request> Tile<D>::send_particle_data(
   nvtxRangePush(__PRETTY_FUNCTION__);
 #endif
 
-  std::vector<mpi::request> reqs;
-  for(int ispc=0; ispc<Nspecies(); ispc++) {
-    auto& container = get_container(ispc);
+  // nothing packed; announce an empty message
+  if((int)outgoing_headers.size() != wire::header_len*Nspecies()) 
+    outgoing_headers.assign(wire::header_len*Nspecies(), 0);
+
+  // encode once; same message goes to all destinations
+  if(compact_particle_messages && !outgoing_encoded) encode_outgoing_particles(comm.rank());
 
+  std::vector<mpi::request> reqs;
+  reqs.emplace_back(
+      comm.isend(dest, get_tag(tag, 0), outgoing_headers.data(), outgoing_headers.size())
+      );
+
+  // ranks on the same node also get the location of the message in our shared 
+  // memory segment; -1 if there is none and p2 goes through MPI
+  if(toolbox::ShmWindow::get().on_node(dest)) {
+    share_outgoing_particles();
     reqs.emplace_back(
-        comm.isend(dest, get_tag(tag, ispc), 
-          container.outgoing_particles.data(), 
-          container.first_message_size)
+        comm.isend(dest, get_tag(tag, 1), &outgoing_shm_offset, 1)
         );
   }
 
@@ -250,7 +265,7 @@ std::vector<mpi::request> Tile<D>::send_particle_data(
 
 
 template<std::size_t D>
-std::vector<mpi::request> Tile<D>::send_particle_extra_data( 
+std::vector<mpi::request> Tile<D>::send_particle_data( 
     mpi::communicator& comm, 
     int dest,
     int tag)
@@ -261,23 +276,28 @@ std::vector<mpi::request> Tile<D>::send_particle_extra_data(
 #endif
 
   std::vector<mpi::request> reqs;
-  for(int ispc=0; ispc<Nspecies(); ispc++) {
-    auto& container = get_container(ispc);
 
-    if(!container.outgoing_extra_particles.empty()) {
+  const bool empty = outgoing_encoded ? outgoing_wire->empty() : 
+    (outgoing_buffer == nullptr || outgoing_buffer->empty());
+
+  // receiver knows the size from p1; empty messages are skipped on both sides
+  // and messages shared in p1 are read from our segment
+  if(empty || (outgoing_shm_offset >= 0 && toolbox::ShmWindow::get().on_node(dest))) {
+    // nothing to send
+  } else if(outgoing_encoded) {
+    if(!outgoing_wire->empty()) {
       reqs.emplace_back(
-          comm.isend(dest, get_extra_tag(tag, ispc), 
-            container.outgoing_extra_particles.data(), 
-            container.outgoing_extra_particles.size())
+          comm.isend(dest, get_extra_tag(tag, 0), 
+            outgoing_wire->data(), 
+            outgoing_wire->size())
           );
     }
-
-    //std::cout << this->communication.cid 
-    //  << " send " << container.outgoing_particles.size() 
-    //  << " / " << container.outgoing_particles[0].id
-    //  << " + " << container.outgoing_extra_particles.size() 
-    //  << " / " << container.outgoing_extra_particles[0].id
-    //  << " particles\n";
+  } else if(outgoing_buffer != nullptr && !outgoing_buffer->empty()) {
+    reqs.emplace_back(
+        comm.isend(dest, get_extra_tag(tag, 0), 
+          outgoing_buffer->data(), 
+          outgoing_buffer->size())
+        );
   }
 
 #ifdef GPU
@@ -299,15 +319,15 @@ std::vector<mpi::request> Tile<D>::recv_data(
   if(mode == 1) return emf::Tile<D>::recv_data(comm, orig, mode, tag);
   if(mode == 2) return emf::Tile<D>::recv_data(comm, orig, mode, tag);
 
-  if(mode == 3) return recv_particle_data(comm,orig,tag);
-  if(mode == 4) return recv_particle_extra_data(comm,orig,tag);
+  if(mode == 3) return recv_particle_counts(comm,orig,tag);
+  if(mode == 4) return recv_particle_data(comm,orig,tag);
 
   assert(false);
 }
 
 
 template<std::size_t D>
-std::vector<mpi::request> Tile<D>::recv_particle_data( 
+std::vector<mpi::request> Tile<D>::recv_particle_counts( 
     mpi::communicator& comm, 
     int orig,
     int tag)
@@ -317,17 +337,18 @@ std::vector<mpi::request> Tile<D>::recv_particle_data(
   nvtxRangePush(__PRETTY_FUNCTION__);
 #endif
 
-  std::vector<mpi::request> reqs;
-  for (int ispc=0; ispc<Nspecies(); ispc++) {
-    auto& container = get_container(ispc);
+  incoming_headers.assign(wire::header_len*Nspecies(), 0);
+  incoming_rank = orig;
+  incoming_shm_offset = -1;
 
-    // static array
-    //container.incoming_particles.resize( container.first_message_size );
+  std::vector<mpi::request> reqs;
+  reqs.emplace_back(
+      comm.irecv(orig, get_tag(tag, 0), incoming_headers.data(), incoming_headers.size())
+      );
 
+  if(toolbox::ShmWindow::get().on_node(orig)) {
     reqs.emplace_back(
-        comm.irecv(orig, get_tag(tag, ispc),
-          container.incoming_particles.data(),
-          container.first_message_size)
+        comm.irecv(orig, get_tag(tag, 1), &incoming_shm_offset, 1)
         );
   }
 
@@ -340,7 +361,7 @@ std::vector<mpi::request> Tile<D>::recv_particle_data(
 
 
 template<std::size_t D>
-std::vector<mpi::request> Tile<D>::recv_particle_extra_data( 
+std::vector<mpi::request> Tile<D>::recv_particle_data( 
     mpi::communicator& comm, 
     int orig,
     int tag)
@@ -353,30 +374,49 @@ std::vector<mpi::request> Tile<D>::recv_particle_extra_data(
   std::vector<mpi::request> reqs;
 
   // this assumes that wait for the first message is already called and passed.
+  int np_tot = 0;
+  size_t nbytes = 0;
+  bool compact = false;
+  for(int ispc=0; ispc<Nspecies(); ispc++) {
+    wire::Header h;
+    h.from_ints( &incoming_headers[wire::header_len*ispc] );
 
-  // normal particles
-  for (int ispc=0; ispc<Nspecies(); ispc++) {
-    auto& container = get_container(ispc);
+    np_tot += h.count;
+    nbytes += wire::block_size<D>(h);
+    compact |= (h.flags & wire::compact) != 0;
+  }
 
-    //std::cout << "recv_prtcl1: got " << container.incoming_particles[0].id << " by mpi\n";
+  // offset from p1; -1 if the sender's window was full and the message comes through MPI
+  if(np_tot == 0 || !toolbox::ShmWindow::get().on_node(orig)) incoming_shm_offset = -1;
 
-    int first_message_size = container.first_message_size;
-    int np_tot = container.incoming_particles[0].id;
-    int np_extra = np_tot > first_message_size ? np_tot - first_message_size : 0;
+  if(np_tot > 0 && incoming_shm_offset >= 0) {
+    // message is in the sender's shared memory segment (location from p1); plain 
+    // particles are read from there directly, compact ones decoded into incoming_buffer
+    if(compact) {
+      if(incoming_buffer == nullptr) incoming_buffer = MessagePool<>::get().acquire();
+      incoming_buffer->resize(np_tot);
+    }
+  } else if(np_tot > 0) {
+    if(incoming_buffer == nullptr) incoming_buffer = MessagePool<>::get().acquire();
+    incoming_buffer->resize(np_tot);
 
-    if(np_extra > 0) {
-      container.incoming_extra_particles.resize(np_extra);
+    if(compact) {
+      // decoded into incoming_buffer in unpack_incoming_particles
+      if(incoming_wire == nullptr) incoming_wire = MessagePool<char>::get().acquire();
+      incoming_wire->resize(nbytes);
 
       reqs.emplace_back(
-          comm.irecv(orig, get_extra_tag(tag, ispc),
-            container.incoming_extra_particles.data(),
-            np_extra)
+          comm.irecv(orig, get_extra_tag(tag, 0),
+            incoming_wire->data(),
+            nbytes)
           );
     } else {
-      container.incoming_extra_particles.clear();
+      reqs.emplace_back(
+          comm.irecv(orig, get_extra_tag(tag, 0),
+            incoming_buffer->data(),
+            np_tot)
+          );
     }
-
-    //std::cout << this->communication.cid << " recv " << container.incoming_particles.size() << " + " << container.incoming_extra_particles.size() << " particles\n";
   }
 
 #ifdef GPU
@@ -386,11 +426,97 @@ std::vector<mpi::request> Tile<D>::recv_particle_extra_data(
   return reqs;
 }
 
+
+template<std::size_t D>
+std::array<float,3> Tile<D>::wire_base() const
+{
+  std::array<float,3> base = {0.0f, 0.0f, 0.0f};
+  for(size_t d=0; d<D; d++) base[d] = float(mins[d]) - wire::margin;
+  return base;
+}
+
+
+template<std::size_t D>
+void Tile<D>::encode_outgoing_particles(int rank)
+{
+
+#ifdef GPU
+  nvtxRangePush(__PRETTY_FUNCTION__);
+#endif
+
+  const auto base = wire_base();
+  const Particle* prtcls = outgoing_buffer != nullptr ? outgoing_buffer->data() : nullptr;
+
+  // headers first; they fix the message size
+  size_t nbytes = 0;
+  size_t offset = 0;
+  std::vector<wire::Header> headers(Nspecies());
+  for(int ispc=0; ispc<Nspecies(); ispc++) {
+    const int N = outgoing_headers[wire::header_len*ispc];
+    headers[ispc] = wire::make_header<D>(prtcls + offset, N, rank, base, mesh_lengths);
+    headers[ispc].to_ints( &outgoing_headers[wire::header_len*ispc] );
+
+    nbytes += wire::block_size<D>(headers[ispc]);
+    offset += N;
+  }
+
+  if(outgoing_wire == nullptr) outgoing_wire = MessagePool<char>::get().acquire();
+  outgoing_wire->resize(nbytes);
+
+  // species blocks back to back
+  char* out = outgoing_wire->data();
+  offset = 0;
+  for(int ispc=0; ispc<Nspecies(); ispc++) {
+    const auto& h = headers[ispc];
+    size_t bytes = wire::encode<D>(prtcls + offset, h, rank, base, mesh_lengths, out);
+
+    // decode right away and compare
+    if(check_particle_messages) {
+      std::vector<Particle> dec(h.count);
+      wire::decode<D>(out, h, rank, base, mesh_lengths, dec.data());
+      wire::check(prtcls + offset, dec.data(), h);
+    }
+
+    out += bytes;
+    offset += h.count;
+  }
+
+  outgoing_encoded = true;
+
+#ifdef GPU
+  nvtxRangePop();
+#endif
+}
+
+
+template<std::size_t D>
+void Tile<D>::release_outgoing_buffers()
+{
+  MessagePool<>::get().release(outgoing_buffer);
+  MessagePool<char>::get().release(outgoing_wire);
+  outgoing_buffer = nullptr;
+  outgoing_wire = nullptr;
+  outgoing_encoded = false;
+  outgoing_headers.clear();
+}
+
+
 template<std::size_t D>
 void Tile<D>::pack_all_particles()
 {
-  for(auto&& container : containers) 
-    container.pack_all_particles();
+  // previous message has been sent by now
+  if(outgoing_buffer == nullptr) outgoing_buffer = MessagePool<>::get().acquire();
+  outgoing_buffer->clear();
+  outgoing_headers.assign(wire::header_len*Nspecies(), 0);
+  outgoing_encoded = false;
+  outgoing_shm_offset = -1;
+  outgoing_shm_phase = -1;
+
+  for(int ispc=0; ispc<Nspecies(); ispc++) {
+    size_t n0 = outgoing_buffer->size();
+    containers[ispc].pack_all_particles(*outgoing_buffer);
+    outgoing_headers[wire::header_len*ispc] = outgoing_buffer->size() - n0;
+  }
 }
 
 
@@ -398,18 +524,118 @@ void Tile<D>::pack_all_particles()
 template<std::size_t D>
 void Tile<D>::pack_outgoing_particles()
 {
-  for(auto&& container : containers) 
-    container.pack_outgoing_particles();
+  // previous message has been sent by now
+  if(outgoing_buffer == nullptr) outgoing_buffer = MessagePool<>::get().acquire();
+  outgoing_buffer->clear();
+  outgoing_headers.assign(wire::header_len*Nspecies(), 0);
+  outgoing_encoded = false;
+  outgoing_shm_offset = -1;
+  outgoing_shm_phase = -1;
+
+  for(int ispc=0; ispc<Nspecies(); ispc++) {
+    size_t n0 = outgoing_buffer->size();
+    containers[ispc].pack_outgoing_particles(*outgoing_buffer);
+    outgoing_headers[wire::header_len*ispc] = outgoing_buffer->size() - n0;
+  }
+}
+
+
+template<std::size_t D>
+void Tile<D>::share_outgoing_particles()
+{
+  auto& shm = toolbox::ShmWindow::get();
+  if(outgoing_shm_phase == (long)shm.phase()) return;
+  outgoing_shm_phase = shm.phase();
+
+  const bool empty = outgoing_encoded ? outgoing_wire->empty() : 
+    (outgoing_buffer == nullptr || outgoing_buffer->empty());
+  if(empty) {
+    outgoing_shm_offset = -1;
+    return;
+  }
 
+  const char* src = nullptr;
+  size_t nbytes = 0;
+  if(outgoing_encoded) {
+    src = outgoing_wire->data();
+    nbytes = outgoing_wire->size();
+  } else {
+    src = reinterpret_cast<const char*>(outgoing_buffer->data());
+    nbytes = outgoing_buffer->size()*sizeof(Particle);
+  }
+
+  // full window leaves outgoing_shm_offset at -1; the message then goes through MPI in p2
+  float* dst = shm.allocate( (nbytes + sizeof(float) - 1)/sizeof(float), outgoing_shm_offset);
+  if(dst == nullptr) return;
+
+  std::memcpy(dst, src, nbytes);
+  shm.sync(); // publish before announcing the offset
+}
+
+
+template<std::size_t D>
+void Tile<D>::decode_incoming_particles(const char* in)
+{
+  const auto base = wire_base();
+  size_t offset = 0;
+
+  for(int ispc=0; ispc<Nspecies(); ispc++) {
+    wire::Header h;
+    h.from_ints( &incoming_headers[wire::header_len*ispc] );
+
+    in += wire::decode<D>(in, h, incoming_rank, base, mesh_lengths, incoming_buffer->data() + offset);
+    offset += h.count;
+  }
 }
 
 
 template<std::size_t D>
 void Tile<D>::unpack_incoming_particles()
 {
-  for(auto&& container : containers) 
-    container.unpack_incoming_particles();
+  const Particle* prtcls = nullptr;
+
+  if(incoming_shm_offset >= 0) {
+    // message is in the sender's shared memory segment
+    auto& shm = toolbox::ShmWindow::get();
+    shm.sync(); // see the sender's writes
+    const char* in = reinterpret_cast<const char*>( shm.remote(incoming_rank, incoming_shm_offset) );
+
+    if(incoming_buffer != nullptr) {
+      decode_incoming_particles(in);
+      prtcls = incoming_buffer->data();
+    } else {
+      prtcls = reinterpret_cast<const Particle*>(in);
+    }
 
+    incoming_shm_offset = -1;
+  } else if(incoming_buffer != nullptr) {
+
+    // compact message; decode species blocks into the particle buffer first
+    if(incoming_wire != nullptr) {
+      decode_incoming_particles(incoming_wire->data());
+      MessagePool<char>::get().release(incoming_wire);
+      incoming_wire = nullptr;
+    }
+
+    prtcls = incoming_buffer->data();
+  }
+
+  if(prtcls != nullptr) {
+    size_t offset = 0;
+    for(int ispc=0; ispc<Nspecies() && ispc*wire::header_len < (int)incoming_headers.size(); ispc++) {
+      const int N = incoming_headers[wire::header_len*ispc];
+      containers[ispc].unpack_incoming_particles(prtcls + offset, N);
+      offset += N;
+    }
+  }
+
+  // message consumed; buffer can be reused by any tile
+  if(incoming_buffer != nullptr) {
+    MessagePool<>::get().release(incoming_buffer);
+    incoming_buffer = nullptr;
+  }
+
+  incoming_headers.clear();
 }
 
 
@@ -428,15 +654,18 @@ void Tile<D>::delete_all_particles()
 template<std::size_t D>
 void Tile<D>::shrink_to_fit_all_particles()
 {
-  for(auto&& container : containers) {
+  for(auto&& container : containers) container.shrink_to_fit();
 
-    // mpi extra message containers
-    container.incoming_extra_particles.shrink_to_fit();
-    container.outgoing_extra_particles.shrink_to_fit();
+  // mpi message buffers; a new one is borrowed when needed
+  release_outgoing_buffers();
+}
 
-    // internal main particle containers
-    container.shrink_to_fit();
-  }
+
+template<std::size_t D>
+void Tile<D>::sort_particles_in_cells(bool full)
+{
+  for(auto&& container : containers) 
+    container.sort_in_cells(mesh_lengths, full);
 }
 
 
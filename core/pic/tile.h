@@ -8,6 +8,7 @@
 #include "external/corgi/corgi.h"
 #include "core/emf/tile.h"
 #include "core/pic/particle.h"
+#include "core/pic/message_pool.h"
 #include "external/iter/allocator.h"
 
 
@@ -75,18 +76,44 @@ public:
   { }
 
 
+  /// return borrowed message buffers to the pool
+  ~Tile() override
+  {
+    release_outgoing_buffers();
+    MessagePool<>::get().release(incoming_buffer);
+    MessagePool<char>::get().release(incoming_wire);
+  }
+
+
+  //--------------------------------------------------
+  // MPI particle messages; 
+  // mode 3 (p1) sends a wire::Header (particle count and encoding) per species and 
+  // mode 4 (p2) all packed particles of all species in one message of exactly that size
+
+  /// wire::Header of outgoing species blocks, wire::header_len ints per species
+  std::vector<int> outgoing_headers;
+
+  /// wire::Header of incoming species blocks; set by p1
+  std::vector<int> incoming_headers;
+
+  /// send particles with the compact wire::encode format
+  bool compact_particle_messages = false;
+
+  /// decode every compact message after encoding and compare to the original particles
+  bool check_particle_messages = false;
+
   //--------------------------------------------------
   // MPI send
   std::vector<mpi::request> 
   send_data( mpi::communicator& /*comm*/, int dest, int mode, int tag) override;
 
-  /// actual tag=0 send
+  /// p1 send
   std::vector<mpi::request> 
-  send_particle_data( mpi::communicator& /*comm*/, int dest, int tag);
+  send_particle_counts( mpi::communicator& /*comm*/, int dest, int tag);
 
-  /// actual tag=1 send
+  /// p2 send
   std::vector<mpi::request> 
-  send_particle_extra_data( mpi::communicator& /*comm*/, int dest, int tag);
+  send_particle_data( mpi::communicator& /*comm*/, int dest, int tag);
 
 
   //--------------------------------------------------
@@ -94,13 +121,13 @@ public:
   std::vector<mpi::request> 
   recv_data(mpi::communicator& /*comm*/, int orig, int mode, int tag) override;
 
-  /// actual tag=0 recv
+  /// p1 recv
   std::vector<mpi::request> 
-  recv_particle_data(mpi::communicator& /*comm*/, int orig, int tag);
+  recv_particle_counts(mpi::communicator& /*comm*/, int orig, int tag);
 
-  /// actual tag=1 recv
+  /// p2 recv; assumes that p1 has been waited for
   std::vector<mpi::request> 
-  recv_particle_extra_data(mpi::communicator& /*comm*/, int orig, int tag);
+  recv_particle_data(mpi::communicator& /*comm*/, int orig, int tag);
   //--------------------------------------------------
 
 
@@ -122,6 +149,9 @@ public:
   void pack_outgoing_particles();
 
   /// unpack received MPI message particles
+  // NOTE: messages from ranks on the same node are read from the sender's 
+  //       shared memory segment and have to be unpacked before the next 
+  //       exchange phase starts
   void unpack_incoming_particles();
 
   /// delete all particles from each container
@@ -130,9 +160,58 @@ public:
   /// shrink to fit all internal containers
   void shrink_to_fit_all_particles();
 
+  /// sort particles of each container into cell order; see ParticleContainer::sort_in_cells
+  // NOTE: interpolated fields (Epart/Bpart) are not permuted
+  void sort_particles_in_cells(bool full=true);
+
 
 private:
   std::size_t dim = D;
+
+  /// packed particles of all species; borrowed from the MessagePool
+  ManVec<Particle>* outgoing_buffer = nullptr;
+
+  /// received particles of all species; borrowed from the MessagePool
+  ManVec<Particle>* incoming_buffer = nullptr;
+
+  /// compact encoded messages; borrowed from the MessagePool
+  ManVec<char>* outgoing_wire = nullptr;
+  ManVec<char>* incoming_wire = nullptr;
+
+  /// outgoing_wire holds the encoded outgoing_buffer 
+  bool outgoing_encoded = false;
+
+  /// rank that sent the incoming message
+  int incoming_rank = -1;
+
+  // shared memory exchange with ranks on the same node (toolbox::ShmWindow): 
+  // the outgoing message is copied once into our segment in p1, receivers get 
+  // only its offset and read it from there in unpack_incoming_particles.
+  // Offset -1 (empty message or full window) sends the p2 message through MPI.
+  int outgoing_shm_offset = -1;
+  long outgoing_shm_phase = -1; // window phase of outgoing_shm_offset
+  int incoming_shm_offset = -1;
+
+  /// copy the outgoing message into the shared memory window; once per phase
+  void share_outgoing_particles();
+
+  /// decode compact species blocks in into incoming_buffer
+  void decode_incoming_particles(const char* in);
+
+  /// tile corner used as the origin of the fixed-point locations
+  std::array<float,3> wire_base() const;
+
+  /// encode outgoing_buffer into outgoing_wire; rank is the sender
+  void encode_outgoing_particles(int rank);
+
+  /// give outgoing message buffers back to the pool
+  void release_outgoing_buffers();
+
+  /// pull the particles flowing into this tile from neighbors (tile, direction)
+  void transfer_from_neighbors(
+      std::vector< std::pair<Tile<D>*, std::array<int,3>> >& neighbors,
+      std::array<double,3>& global_mins,
+      std::array<double,3>& global_maxs);
 };
 
 
@@ -0,0 +1,294 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <array>
+#include <iostream>
+#include <stdexcept>
+
+#include "core/pic/particle.h"
+
+namespace pic {
+namespace wire {
+
+/*! \brief Compact transfer encoding of MPI particle messages
+ *
+ * Each species is sent as one block; the block layout is described by a
+ * Header that travels in the first (p1) message:
+ *
+ *  - locations of the first D dimensions as 16-bit fixed point offsets
+ *    from the sender tile corner (with a margin of `margin` cells) if
+ *    every location of the block is exactly on the fixed-point grid
+ *    (e.g. particles loaded on a lattice); otherwise as floats.
+ *    Unused dimensions (D<3) are sent as floats.
+ *  - velocities and id as is
+ *  - proc only for particles whose proc differs from the sender rank;
+ *    a bit mask marks these particles
+ *  - weight only if it is not uniform within the species
+ *
+ * The encoding is lossless: decode gives back the particles bit by bit.
+ */
+
+/// header flags
+constexpr int compact     = 1; // block uses the compact encoding
+constexpr int uniform_wgt = 2; // all weights equal Header::wgt; omitted
+constexpr int float_loc   = 4; // some locations not exact in fixed point; sent as floats
+
+/// cells outside the tile that are covered by the fixed-point range
+constexpr int margin = 2;
+
+/// ints per species in the p1 message
+constexpr int header_len = 4;
+
+
+/// description of one species block
+struct Header {
+  int count = 0;  // number of particles
+  int flags = 0;  // see above
+  float wgt = 0;  // uniform weight
+  int nproc = 0;  // number of particles with explicitly stored proc
+
+  void to_ints(int* h) const
+  {
+    h[0] = count; h[1] = flags; std::memcpy(&h[2], &wgt, sizeof(float)); h[3] = nproc;
+  }
+
+  void from_ints(const int* h)
+  {
+    count = h[0]; flags = h[1]; std::memcpy(&wgt, &h[2], sizeof(float)); nproc = h[3];
+  }
+};
+
+
+/// fractional bits of the fixed-point location in a tile of N cells
+inline int frac_bits(int N)
+{
+  int ib = 0;
+  while( (1 << ib) < N + 2*margin ) ib++;
+  return 16 - ib;
+}
+
+
+/// location member of dimension d
+inline float Particle::* loc_member(size_t d)
+{
+  return d == 0 ? &Particle::x : d == 1 ? &Particle::y : &Particle::z;
+}
+
+
+/// round up to 4-byte words so that every block starts aligned
+inline size_t pad4(size_t n) { return (n + 3) & ~size_t(3); }
+
+
+/// size of an encoded block in bytes
+template<size_t D>
+inline size_t block_size(const Header& h)
+{
+  const size_t N = h.count;
+  size_t bytes = 0;
+
+  bytes += 3*N*sizeof(float);                         // velocities
+  bytes += N*sizeof(int);                             // ids
+  bytes += h.nproc*sizeof(int);                       // explicit procs
+  if(!(h.flags & uniform_wgt)) bytes += N*sizeof(float); // weights
+
+  if(h.flags & float_loc) {
+    bytes += 3*N*sizeof(float);
+  } else {
+    bytes += (3-D)*N*sizeof(float);
+    bytes += D*N*sizeof(uint16_t);
+  }
+
+  bytes += (N + 7)/8;                                 // proc mask
+
+  return pad4(bytes);
+}
+
+
+/// analyze particles and fill the block header
+template<size_t D>
+inline Header make_header(
+    const Particle* p, int N, int rank,
+    const std::array<float,3>& base, const std::array<int,3>& lens)
+{
+  Header h;
+  h.count = N;
+  h.flags = compact | uniform_wgt;
+  h.wgt = N > 0 ? p[0].w : 0.0f;
+
+  std::array<double,3> scale;
+  for(size_t d=0; d<D; d++) scale[d] = std::ldexp(1.0, frac_bits(lens[d]));
+
+  for(int n=0; n<N; n++) {
+    if(p[n].w != h.wgt) h.flags &= ~uniform_wgt;
+    if(p[n].proc != rank) h.nproc++;
+
+    // fixed point only if it holds the location exactly; the offset from
+    // the corner is exact in double
+    const float loc[3] = {p[n].x, p[n].y, p[n].z};
+    for(size_t d=0; d<D; d++) {
+      const double q = (static_cast<double>(loc[d]) - base[d])*scale[d];
+      if( !(q >= 0.0 && q < 65536.0 && q == std::floor(q)) ) h.flags |= float_loc;
+    }
+  }
+
+  return h;
+}
+
+
+/// encode block of N particles into out; returns bytes written
+template<size_t D>
+inline size_t encode(
+    const Particle* p, const Header& h, int rank,
+    const std::array<float,3>& base, const std::array<int,3>& lens,
+    char* out)
+{
+  const int N = h.count;
+  char* ptr = out;
+
+  // 4-byte arrays first
+  float* ux = reinterpret_cast<float*>(ptr); ptr += N*sizeof(float);
+  float* uy = reinterpret_cast<float*>(ptr); ptr += N*sizeof(float);
+  float* uz = reinterpret_cast<float*>(ptr); ptr += N*sizeof(float);
+  int* id   = reinterpret_cast<int*>(ptr);   ptr += N*sizeof(int);
+
+  #pragma omp simd
+  for(int n=0; n<N; n++) {
+    ux[n] = p[n].ux;
+    uy[n] = p[n].uy;
+    uz[n] = p[n].uz;
+    id[n] = p[n].id;
+  }
+
+  int* proc = reinterpret_cast<int*>(ptr); ptr += h.nproc*sizeof(int);
+
+  if(!(h.flags & uniform_wgt)) {
+    float* w = reinterpret_cast<float*>(ptr); ptr += N*sizeof(float);
+
+    #pragma omp simd
+    for(int n=0; n<N; n++) w[n] = p[n].w;
+  }
+
+  const size_t Dq = (h.flags & float_loc) ? 0 : D; // quantized dimensions
+  for(size_t d=Dq; d<3; d++) {
+    float* x = reinterpret_cast<float*>(ptr); ptr += N*sizeof(float);
+    const auto loc = loc_member(d);
+
+    #pragma omp simd
+    for(int n=0; n<N; n++) x[n] = p[n].*loc;
+  }
+
+  // 2-byte arrays
+  for(size_t d=0; d<Dq; d++) {
+    uint16_t* q = reinterpret_cast<uint16_t*>(ptr); ptr += N*sizeof(uint16_t);
+
+    const double scale = std::ldexp(1.0, frac_bits(lens[d]));
+    const double b = base[d];
+    const auto loc = loc_member(d);
+
+    // exact; checked by make_header
+    #pragma omp simd
+    for(int n=0; n<N; n++) q[n] = static_cast<uint16_t>( (static_cast<double>(p[n].*loc) - b)*scale );
+  }
+
+  // proc mask and explicit procs
+  uint8_t* mask = reinterpret_cast<uint8_t*>(ptr); ptr += (N + 7)/8;
+  std::memset(mask, 0, (N + 7)/8);
+
+  int np = 0;
+  for(int n=0; n<N; n++) {
+    if(p[n].proc != rank) {
+      mask[n/8] |= uint8_t(1u << (n % 8));
+      proc[np++] = p[n].proc;
+    }
+  }
+
+  return pad4(ptr - out);
+}
+
+
+/// decode block into N particles; returns bytes read
+template<size_t D>
+inline size_t decode(
+    const char* in, const Header& h, int rank,
+    const std::array<float,3>& base, const std::array<int,3>& lens,
+    Particle* p)
+{
+  const int N = h.count;
+  const char* ptr = in;
+
+  const float* ux = reinterpret_cast<const float*>(ptr); ptr += N*sizeof(float);
+  const float* uy = reinterpret_cast<const float*>(ptr); ptr += N*sizeof(float);
+  const float* uz = reinterpret_cast<const float*>(ptr); ptr += N*sizeof(float);
+  const int* id   = reinterpret_cast<const int*>(ptr);   ptr += N*sizeof(int);
+
+  #pragma omp simd
+  for(int n=0; n<N; n++) {
+    p[n].ux = ux[n];
+    p[n].uy = uy[n];
+    p[n].uz = uz[n];
+    p[n].id = id[n];
+    p[n].w  = h.wgt;
+  }
+
+  const int* proc = reinterpret_cast<const int*>(ptr); ptr += h.nproc*sizeof(int);
+
+  if(!(h.flags & uniform_wgt)) {
+    const float* w = reinterpret_cast<const float*>(ptr); ptr += N*sizeof(float);
+
+    #pragma omp simd
+    for(int n=0; n<N; n++) p[n].w = w[n];
+  }
+
+  const size_t Dq = (h.flags & float_loc) ? 0 : D;
+  for(size_t d=Dq; d<3; d++) {
+    const float* x = reinterpret_cast<const float*>(ptr); ptr += N*sizeof(float);
+    const auto loc = loc_member(d);
+
+    #pragma omp simd
+    for(int n=0; n<N; n++) p[n].*loc = x[n];
+  }
+
+  for(size_t d=0; d<Dq; d++) {
+    const uint16_t* q = reinterpret_cast<const uint16_t*>(ptr); ptr += N*sizeof(uint16_t);
+
+    // offsets from the tile corner are exact in double and give back the float
+    const double iscale = std::ldexp(1.0, -frac_bits(lens[d]));
+    const double b = base[d];
+    const auto loc = loc_member(d);
+
+    #pragma omp simd
+    for(int n=0; n<N; n++) p[n].*loc = static_cast<float>( b + q[n]*iscale );
+  }
+
+  const uint8_t* mask = reinterpret_cast<const uint8_t*>(ptr); ptr += (N + 7)/8;
+
+  int np = 0;
+  for(int n=0; n<N; n++) {
+    p[n].proc = (mask[n/8] >> (n % 8)) & 1u ? proc[np++] : rank;
+  }
+
+  return pad4(ptr - in);
+}
+
+
+/// cross-check that decoded particles match the originals bit by bit
+inline void check(const Particle* orig, const Particle* dec, const Header& h)
+{
+  for(int n=0; n<h.count; n++) {
+    if(std::memcmp(&orig[n], &dec[n], sizeof(Particle)) != 0) {
+      std::cerr << "ERROR WIRE FORMAT: particle " << n
+                << " x " << orig[n].x << " " << orig[n].y << " " << orig[n].z
+                << " -> " << dec[n].x << " " << dec[n].y << " " << dec[n].z
+                << " id " << orig[n].id << " " << orig[n].proc
+                << " -> " << dec[n].id << " " << dec[n].proc
+                << std::endl;
+      throw std::runtime_error("compact particle message does not decode to the original particles");
+    }
+  }
+}
+
+
+} // end of namespace wire
+} // end of namespace pic
@@ -148,6 +148,19 @@ public:
   ManVec<double> hist;
   ManVec<double> hist_ene_edges;
 
+  /// particles created in the interaction loops; kept out of the containers until the loops are done
+  std::map<std::string, pic::ParticleBuffer> new_prtcls;
+
+  /// add the created particles to their containers in one go per type
+  void append_new_prtcls(std::map<std::string, ConPtr>& cons)
+  {
+    for(auto& [t, buf] : new_prtcls) {
+      if(buf.size() == 0) continue;
+      cons[t]->append_particles(buf);
+      buf.clear();
+    }
+  }
+
   void update_hist_lims(double emin, double emax, int nbin)
   {
     hist_emin = emin;
@@ -1127,9 +1140,9 @@ public:
                   }
                 } else {
                   if( rand() < prob_upd3 ) {
-                    cons[t1]->add_particle( {{lx1, ly1, lz1}}, {{ux3, uy3, uz3}}, w3*facc3); // new ene & w
+                    new_prtcls[t1].add( lx1, ly1, lz1, ux3, uy3, uz3, w3*facc3 ); // new ene & w
                   } else {
-                    cons[t1]->add_particle( {{lx1, ly1, lz1}}, {{ux1, uy1, uz1}}, w3); // new w
+                    new_prtcls[t1].add( lx1, ly1, lz1, ux1, uy1, uz1, w3 ); // new w
                   }
                 }
 
@@ -1188,7 +1201,7 @@ public:
                 double z1 = rand();
                 while( n3 > z1 + ncop ){
                   // TODO NOTE lx3 here not lx1
-                  cons[t3]->add_particle( {{lx3, ly3, lz3}}, {{ux3, uy3, uz3}}, w3); // new ene & w
+                  new_prtcls[t3].add( lx3, ly3, lz3, ux3, uy3, uz3, w3 ); // new ene & w
                   ncop += 1.0;
                 }
                 timer.stop_comp("add_prtcl1");
@@ -1233,9 +1246,9 @@ public:
                   }
                 } else {
                   if( rand() < prob_upd4 ) {
-                    cons[t2]->add_particle( {{lx2, ly2, lz2}}, {{ux4, uy4, uz4}}, w4*facc4); // new ene & w
+                    new_prtcls[t2].add( lx2, ly2, lz2, ux4, uy4, uz4, w4*facc4 ); // new ene & w
                   } else {
-                    cons[t2]->add_particle( {{lx2, ly2, lz2}}, {{ux2, uy2, uz2}}, w4); // new w
+                    new_prtcls[t2].add( lx2, ly2, lz2, ux2, uy2, uz2, w4 ); // new w
                   }
                 }
 
@@ -1268,7 +1281,7 @@ public:
                 while( n4 > z1 + ncop ){
                   //cons[t4]->add_particle( {{lx2, ly2, lz2}}, {{ux4, uy4, uz4}}, w4); // new ene & w
                   // TODO note lx4 here
-                  cons[t4]->add_particle( {{lx4, ly4, lz4}}, {{ux4, uy4, uz4}}, w4); // new ene & w
+                  new_prtcls[t4].add( lx4, ly4, lz4, ux4, uy4, uz4, w4 ); // new ene & w
                   ncop += 1.0;
                 }
                 timer.stop_comp("add_prtcl2");
@@ -1293,6 +1306,9 @@ public:
       //UniIter::sync();
     }// end con1
 
+    // new particles were not visible to the loops above (they use fixed particle numbers and cumulative arrays)
+    append_new_prtcls(cons);
+
 
     //--------------------------------------------------
     // info for bookkeeping
@@ -1605,7 +1621,7 @@ public:
               //if(use_vir_curvature && lx1 > r_gap) z1 = n4 + 0.5; // prevent emission beyond gap size
 
               while(n4 > z1 + ncop) {
-                cons[t4]->add_particle( {{lx1, ly1vir, lz1}}, {{ux4, uy4, uz4}}, w4);
+                new_prtcls[t4].add( lx1, ly1vir, lz1, ux4, uy4, uz4, w4 );
                 ncop += 1.0;
               }
               timer.stop_comp("add_ems_prtcls");
@@ -1638,8 +1654,8 @@ public:
                 float ncop = 0.0;
                 float z1 = rand();
                 while(n4 > z1 + ncop) {
-                  cons[t3]->add_particle( {{lx1, ly1, lz1}}, {{ux3, uy3, uz3}}, w3); 
-                  cons[t4]->add_particle( {{lx1, ly1, lz1}}, {{ux4, uy4, uz4}}, w4); 
+                  new_prtcls[t3].add( lx1, ly1, lz1, ux3, uy3, uz3, w3 ); 
+                  new_prtcls[t4].add( lx1, ly1, lz1, ux4, uy4, uz4, w4 ); 
                   ncop += 1.0;
                 }
                 timer.stop_comp("add_ann_prtcls");
@@ -1656,6 +1672,8 @@ public:
       } // end over n1 prtcl loop
     } // end of con1 loop
 
+    append_new_prtcls(cons);
+
 
     //--------------------------------------------------
       
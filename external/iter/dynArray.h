@@ -10,6 +10,7 @@
 #define DEFAULTSIZE 4096
 
 #include <cstring>
+#include <utility>
 #include <iostream>
 
 #ifdef GPU
@@ -136,6 +137,16 @@
             std::swap(allocated, other.allocated);
         }
 
+        // public swap; exchanges internal buffers without copying
+        friend void swap(ManVec& first, ManVec& second)
+        {
+            std::swap(first.ptr,   second.ptr);
+            std::swap(first.count, second.count);
+            std::swap(first.cap,   second.cap);
+            std::swap(first.allocated, second.allocated);
+            std::swap(first.overAllocFactor, second.overAllocFactor);
+        }
+
 
         // v0
         inline void push_back(T val)
@@ -0,0 +1,235 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <iostream>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "external/ezh5/src/ezh5.hpp"
+
+
+namespace h5io {
+
+
+/*! \brief Background thread for file output
+ *
+ * Jobs (closures that own all the data they write) are run one at a time in
+ * submission order by a single worker thread, so that the lap loop continues
+ * while the previous snapshots are written. HDF5 is not thread-safe by
+ * default: while jobs may be in flight, any other HDF5 access has to call
+ * wait() first (see wait_io).
+ *
+ * The thread is started with the first submitted job.
+ */
+class IOThread {
+
+  public:
+
+  using clock = std::chrono::steady_clock;
+
+  /// statistics since the last pop_stats call
+  struct Stats {
+    double busy   = 0.0; // seconds spent in jobs (background)
+    double waited = 0.0; // seconds the caller was blocked in wait()
+    int    jobs   = 0;   // number of finished jobs
+  };
+
+  static IOThread& get()
+  {
+    static IOThread instance;
+    return instance;
+  }
+
+  IOThread(const IOThread&) = delete;
+  IOThread& operator=(const IOThread&) = delete;
+
+  ~IOThread()
+  {
+    {
+      std::lock_guard<std::mutex> lock(mtx);
+      stop = true;
+    }
+    cv.notify_all();
+    if(worker.joinable()) worker.join(); // remaining jobs are finished first
+  }
+
+  /// queue a job; the returned future becomes ready when the job is done
+  std::shared_future<void> submit(std::function<void()> job)
+  {
+    // errors are reported here too since nobody may wait for the future
+    auto task = std::make_shared< std::packaged_task<void()> >(
+        [job = std::move(job)] {
+          try { job(); }
+          catch(const std::exception& e) {
+            std::cerr << "IOThread: job failed: " << e.what() << std::endl;
+            throw;
+          }
+        });
+    std::shared_future<void> fut = task->get_future().share();
+
+    {
+      std::lock_guard<std::mutex> lock(mtx);
+      if(!worker.joinable()) worker = std::thread(&IOThread::run, this);
+      jobs.push_back(std::move(task));
+      pending++;
+    }
+    cv.notify_all();
+
+    return fut;
+  }
+
+  /// block until all queued jobs are done
+  void wait()
+  {
+    auto t0 = clock::now();
+
+    std::unique_lock<std::mutex> lock(mtx);
+    done_cv.wait(lock, [this]{ return pending == 0; });
+
+    stats.waited += std::chrono::duration<double>(clock::now() - t0).count();
+  }
+
+  /// block until one job is done; rethrows its exceptions
+  void wait(const std::shared_future<void>& fut)
+  {
+    if(!fut.valid()) return;
+
+    auto t0 = clock::now();
+    fut.wait();
+    {
+      std::lock_guard<std::mutex> lock(mtx);
+      stats.waited += std::chrono::duration<double>(clock::now() - t0).count();
+    }
+    fut.get();
+  }
+
+  /// return and reset the timing statistics
+  Stats pop_stats()
+  {
+    std::lock_guard<std::mutex> lock(mtx);
+    Stats ret = stats;
+    stats = Stats();
+    return ret;
+  }
+
+  private:
+
+  IOThread() = default;
+
+  std::thread worker;
+  std::mutex mtx;
+  std::condition_variable cv;      // new jobs or stop
+  std::condition_variable done_cv; // a job finished
+
+  std::deque< std::shared_ptr< std::packaged_task<void()> > > jobs;
+  size_t pending = 0;
+  bool stop = false;
+
+  Stats stats;
+
+  void run()
+  {
+    while(true) {
+      std::shared_ptr< std::packaged_task<void()> > task;
+      {
+        std::unique_lock<std::mutex> lock(mtx);
+        cv.wait(lock, [this]{ return stop || !jobs.empty(); });
+        if(jobs.empty()) return; // stop requested and nothing left
+
+        task = std::move(jobs.front());
+        jobs.pop_front();
+      }
+
+      auto t0 = clock::now();
+      (*task)(); // exceptions are stored in the future
+      double dt = std::chrono::duration<double>(clock::now() - t0).count();
+
+      {
+        std::lock_guard<std::mutex> lock(mtx);
+        stats.busy += dt;
+        stats.jobs++;
+        pending--;
+      }
+      done_cv.notify_all();
+    }
+  }
+};
+
+
+/// wait for background file output; call before any synchronous HDF5 access
+inline void wait_io() { IOThread::get().wait(); }
+
+
+/// Datasets of one hdf5 file copied out of the simulation for writing later
+//
+// Datasets are collected into groups; the group with an empty name is the
+// file root.
+class StagedFile {
+
+  public:
+
+  struct Group {
+    std::string name;
+    std::vector< std::pair<std::string, int> >                scalars;
+    std::vector< std::pair<std::string, std::vector<float>> > floats;
+    std::vector< std::pair<std::string, std::vector<int>> >   ints;
+
+    void add(const std::string& dset, int val)                   { scalars.emplace_back(dset, val); }
+    void add(const std::string& dset, std::vector<float>&& vec)  { floats.emplace_back(dset, std::move(vec)); }
+    void add(const std::string& dset, std::vector<int>&& vec)    { ints.emplace_back(dset, std::move(vec)); }
+
+    template<typename N>
+    void write_to(N& node) const
+    {
+      for(auto& it : scalars) node[it.first] = it.second;
+      for(auto& it : floats)  node[it.first] = it.second;
+      for(auto& it : ints)    node[it.first] = it.second;
+    }
+  };
+
+  std::string name;
+
+  std::deque<Group> groups; // deque; references to groups stay valid
+
+  StagedFile() = default;
+  explicit StagedFile(std::string name) : name{std::move(name)} {}
+
+  /// add new group (or the root if gname is empty)
+  Group& group(const std::string& gname = "")
+  {
+    groups.push_back({gname, {}, {}, {}});
+    return groups.back();
+  }
+
+  /// write groups into an open file
+  void write_to(ezh5::File& file) const
+  {
+    for(auto& gr : groups) {
+      if(gr.name.empty()) {
+        gr.write_to(file);
+      } else {
+        auto node = file[gr.name];
+        gr.write_to(node);
+      }
+    }
+  }
+
+  /// create (truncate) the file and write
+  void write() const
+  {
+    ezh5::File file(name, H5F_ACC_TRUNC);
+    write_to(file);
+  }
+};
+
+
+} // end of namespace h5io
@@ -79,6 +79,9 @@ h5io::Reader::read(
     assert(iarr1.size() == nparts);
     assert(iarr2.size() == nparts);
 
+    // good particles are compacted to the front of the arrays and added in one go
+    size_t ngood = 0;
+
     float xloc, yloc, zloc;
     float ux, uy, uz, w;
     for(size_t n=0; n<nparts; n++) {
@@ -132,11 +135,16 @@ h5io::Reader::read(
       if(good_prtcl) {
 
         // assumes old key
-        container.add_identified_particle(
-          {arr1[n], arr2[n], arr3[n]}, 
-          {arr4[n], arr5[n], arr6[n]}, arr7[n],
-          iarr1[n], iarr2[n]
-          );
+        arr1[ngood]  = arr1[n];
+        arr2[ngood]  = arr2[n];
+        arr3[ngood]  = arr3[n];
+        arr4[ngood]  = arr4[n];
+        arr5[ngood]  = arr5[n];
+        arr6[ngood]  = arr6[n];
+        arr7[ngood]  = arr7[n];
+        iarr1[ngood] = iarr1[n];
+        iarr2[ngood] = iarr2[n];
+        ngood++;
 
       } else {
 
@@ -185,6 +193,12 @@ h5io::Reader::read(
       }
 
     }
+
+    container.append_particles(ngood, 
+        arr1.data(), arr2.data(), arr3.data(),
+        arr4.data(), arr5.data(), arr6.data(),
+        arr7.data(),
+        iarr1.data(), iarr2.data());
   }
 
   return true;
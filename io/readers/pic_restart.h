@@ -0,0 +1,167 @@
+#pragma once
+
+#include <cmath>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <stdexcept>
+#include <iostream>
+#include <cstdint>
+
+#include <hdf5.h>
+
+#include "io/writers/pic_restart.h"
+#include "core/pic/tile.h"
+#include "external/corgi/corgi.h"
+
+
+namespace h5io {
+
+/// true if fname is written by write_particle_restart (and not by the per-tile group writer)
+inline bool is_particle_restart(const std::string& fname)
+{
+  hid_t file = H5Fopen(fname.c_str(), H5F_ACC_RDONLY, H5P_DEFAULT);
+  if(file < 0) throw std::runtime_error("is_particle_restart: can not open " + fname);
+
+  bool ret = H5Lexists(file, "format", H5P_DEFAULT) > 0;
+
+  H5Fclose(file);
+  return ret;
+}
+
+
+/// read a whole (small) dataset
+template<typename T>
+std::vector<T> h5_read_array(hid_t loc, const std::string& name, hid_t type)
+{
+  hid_t dset = H5Dopen2(loc, name.c_str(), H5P_DEFAULT);
+  if(dset < 0) throw std::runtime_error("h5_read_array: no dataset " + name);
+
+  hid_t space = H5Dget_space(dset);
+  std::vector<T> ret( H5Sget_simple_extent_npoints(space) );
+  if(!ret.empty()) H5Dread(dset, type, H5S_ALL, H5S_ALL, H5P_DEFAULT, ret.data());
+
+  H5Sclose(space);
+  H5Dclose(dset);
+  return ret;
+}
+
+
+/// read n elements starting from element i0 of dset into buf
+inline void h5_read_range(
+    hid_t dset, hid_t type, hsize_t i0, hsize_t n, void* buf)
+{
+  if(n == 0) return;
+
+  hid_t fspace = H5Dget_space(dset);
+  H5Sselect_hyperslab(fspace, H5S_SELECT_SET, &i0, nullptr, &n, nullptr);
+  hid_t mspace = H5Screate_simple(1, &n, nullptr);
+
+  herr_t status = H5Dread(dset, type, mspace, fspace, H5P_DEFAULT, buf);
+
+  H5Sclose(mspace);
+  H5Sclose(fspace);
+
+  if(status < 0) throw std::runtime_error("h5_read_range: read failed");
+}
+
+
+/// read particles of the grid tiles from a file written by write_particle_restart
+//
+// Each tile and species is read with one hyperslab per quantity into reused
+// buffers and added with one append_particles call. Particles with NaNs,
+// unphysical velocities, or locations far outside the tile are skipped.
+template<size_t D>
+void read_particle_restart(
+    corgi::Grid<D>& grid,
+    const std::string& fname)
+{
+  //maximum acceptable prtcl 4-velocity
+  const float max_vel = 1.0e8;
+
+  hid_t file = H5Fopen(fname.c_str(), H5F_ACC_RDONLY, H5P_DEFAULT);
+  if(file < 0) throw std::runtime_error("read_particle_restart: can not open " + fname);
+
+  auto format = h5_read_array<int>(file, "format", H5T_NATIVE_INT);
+  if(format[0] != prtcl_restart_format)
+    throw std::runtime_error("read_particle_restart: unknown format in " + fname);
+
+  const int Nspecies = h5_read_array<int>(file, "Nspecies", H5T_NATIVE_INT)[0];
+
+  // row of each tile in the index
+  auto tile_cid = h5_read_array<uint64_t>(file, "tiles/cid", H5T_NATIVE_UINT64);
+  std::unordered_map<uint64_t, size_t> rows;
+  for(size_t t=0; t<tile_cid.size(); t++) rows[tile_cid[t]] = t;
+
+  std::array<std::vector<float>, 7> farr;
+  std::array<std::vector<int>, 2>   iarr;
+
+  for(int ispc=0; ispc<Nspecies; ispc++) {
+    hid_t gr = H5Gopen2(file, ("sp-" + std::to_string(ispc)).c_str(), H5P_DEFAULT);
+    auto offset = h5_read_array<int64_t>(gr, "offset", H5T_NATIVE_INT64);
+
+    std::array<hid_t, 7> fdsets;
+    std::array<hid_t, 2> idsets;
+    for(size_t v=0; v<7; v++) fdsets[v] = H5Dopen2(gr, prtcl_restart_fvars[v].c_str(), H5P_DEFAULT);
+    for(size_t v=0; v<2; v++) idsets[v] = H5Dopen2(gr, prtcl_restart_ivars[v].c_str(), H5P_DEFAULT);
+
+    for(auto cid : grid.get_tile_ids() ){
+      auto& tile = dynamic_cast<pic::Tile<D>&>(grid.get_tile( cid ));
+      if(ispc >= tile.Nspecies()) continue;
+
+      auto it = rows.find(cid);
+      if(it == rows.end())
+        throw std::runtime_error("read_particle_restart: tile " + std::to_string(cid) + " not in " + fname);
+
+      const size_t t = it->second;
+      const hsize_t i0 = offset[t];
+      const hsize_t n  = offset[t+1] - offset[t];
+
+      for(size_t v=0; v<7; v++) {
+        farr[v].resize(n);
+        h5_read_range(fdsets[v], H5T_NATIVE_FLOAT, i0, n, farr[v].data());
+      }
+      for(size_t v=0; v<2; v++) {
+        iarr[v].resize(n);
+        h5_read_range(idsets[v], H5T_NATIVE_INT, i0, n, iarr[v].data());
+      }
+
+      // compact good particles to the front
+      auto mins = tile.mins;
+      auto maxs = tile.maxs;
+      size_t ngood = 0;
+      for(size_t m=0; m<n; m++) {
+        bool good = true;
+        for(size_t v=0; v<7; v++) good = good && !std::isnan(farr[v][m]);
+        for(size_t d=0; d<D; d++)  good = good && mins[d]-2 <= farr[d][m] && farr[d][m] <= maxs[d]+2;
+        for(size_t v=3; v<6; v++) good = good && -max_vel < farr[v][m] && farr[v][m] < max_vel;
+
+        if(!good) continue;
+
+        for(size_t v=0; v<7; v++) farr[v][ngood] = farr[v][m];
+        for(size_t v=0; v<2; v++) iarr[v][ngood] = iarr[v][m];
+        ngood++;
+      }
+
+      if(ngood < n) {
+        std::cerr << "read_particle_restart: skipping " << n - ngood
+                  << " bad prtcls of sp " << ispc << " in tile " << cid << std::endl;
+      }
+
+      tile.get_container(ispc).append_particles(ngood,
+          farr[0].data(), farr[1].data(), farr[2].data(),
+          farr[3].data(), farr[4].data(), farr[5].data(),
+          farr[6].data(),
+          iarr[0].data(), iarr[1].data());
+    }
+
+    for(auto dset : fdsets) H5Dclose(dset);
+    for(auto dset : idsets) H5Dclose(dset);
+    H5Gclose(gr);
+  }
+
+  H5Fclose(file);
+}
+
+
+} // end of namespace h5io
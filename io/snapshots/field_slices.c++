@@ -6,7 +6,6 @@
 
 
 using namespace mpi4cpp;
-using ezh5::File;
 
 
 void h5io::FieldSliceWriter::read_tiles(
@@ -182,29 +181,31 @@ bool h5io::FieldSliceWriter::write(
       extension;
     //std::cout << "QW: " << full_filename << std::endl;
 
-    // open file and write
-    File file(full_filename, H5F_ACC_TRUNC);
-    file["Nx"] = arrs[0].Nx;
-    file["Ny"] = arrs[0].Ny;
-    file["Nz"] = arrs[0].Nz;
+    // stage datasets; written now or in the io thread
+    StagedFile out(full_filename);
+    auto& file = out.group();
+    file.add("Nx", arrs[0].Nx);
+    file.add("Ny", arrs[0].Ny);
+    file.add("Nz", arrs[0].Nz);
 
     // avoid extra copy by using internal container reference;
     // this works because writer meshes don't have halos
     
-    file["ex"] = arrs[0].serialize();
-    file["ey"] = arrs[1].serialize();
-    file["ez"] = arrs[2].serialize();
+    file.add("ex", arrs[0].serialize());
+    file.add("ey", arrs[1].serialize());
+    file.add("ez", arrs[2].serialize());
 
-    file["bx"] = arrs[3].serialize();
-    file["by"] = arrs[4].serialize();
-    file["bz"] = arrs[5].serialize();
+    file.add("bx", arrs[3].serialize());
+    file.add("by", arrs[4].serialize());
+    file.add("bz", arrs[5].serialize());
 
-    file["jx"] = arrs[6].serialize();
-    file["jy"] = arrs[7].serialize();
-    file["jz"] = arrs[8].serialize();
+    file.add("jx", arrs[6].serialize());
+    file.add("jy", arrs[7].serialize());
+    file.add("jz", arrs[8].serialize());
 
-    file["rho"]= arrs[9].serialize();
-    
+    file.add("rho", arrs[9].serialize());
+
+    this->dispatch(std::move(out));
   }
 
   return true;
@@ -6,17 +6,13 @@
 
 
 using namespace mpi4cpp;
-using ezh5::File;
 
 
 template<>
-inline void h5io::FieldsWriter<1>::read_tiles(
-    corgi::Grid<1>& grid)
+inline void h5io::FieldsWriter<1>::copy_tile(
+    emf::Tile<1>& tile, int i0, int j0, int k0)
 {
 
-  // clear target arrays
-  for(auto& arr : arrs) arr.clear();
-
   // target arrays
   auto& ex = arrs[0];
   auto& ey = arrs[1];
@@ -29,64 +25,47 @@ inline void h5io::FieldsWriter<1>::read_tiles(
   auto& jz = arrs[8];
   auto& rh = arrs[9];
 
+  auto& gs = tile.get_grids();
 
-  // read my local tiles
-  for(auto cid : grid.get_local_tiles() ){
-    auto& tile = dynamic_cast<emf::Tile<1>&>(grid.get_tile( cid ));
-    auto& gs = tile.get_grids();
-
-    // get arrays
-    auto index = expand_indices( &tile );
-
-    // starting location
-    int i0 = (gs.Nx/stride)*std::get<0>(index);
-    int j0 = 0; // (gs.Ny/stride)*std::get<1>(index);
-    int k0 = 0; // (gs.Nz/stride)*std::get<2>(index);
-
-    // tile limits taking into account 0 collapsing dimensions
-    int nxt;
-    nxt = (int)gs.Nx/stride;
-
-    nxt = nxt == 0 ? 1 : nxt;
-
-    // copy tile patch by stride hopping; either downsample or average
-    int js = 0;
-    int jstride = 0;
-    int ks = 0;
-    int kstride = 0;
-
-    // field quantities; just downsample by hopping with stride
-    for(int is=0; is<nxt; is++) {
-      ex(i0+is, j0+js, k0+ks) = gs.ex( is*stride, js*stride, ks*stride);
-      ey(i0+is, j0+js, k0+ks) = gs.ey( is*stride, js*stride, ks*stride);
-      ez(i0+is, j0+js, k0+ks) = gs.ez( is*stride, js*stride, ks*stride);
-
-      bx(i0+is, j0+js, k0+ks) = gs.bx( is*stride, js*stride, ks*stride);
-      by(i0+is, j0+js, k0+ks) = gs.by( is*stride, js*stride, ks*stride);
-      bz(i0+is, j0+js, k0+ks) = gs.bz( is*stride, js*stride, ks*stride);
-    }
+  // tile limits taking into account 0 collapsing dimensions
+  int nxt;
+  nxt = (int)gs.Nx/stride;
 
-    // densities; these quantities we average over the volume
-    for(int is=0; is<nxt; is++) 
-    for(int istride=0; istride < stride; istride++) {
-      jx(i0+is, j0+js, k0+ks) += gs.jx( is*stride+istride, js*stride+jstride, ks*stride+kstride);
-      jy(i0+is, j0+js, k0+ks) += gs.jy( is*stride+istride, js*stride+jstride, ks*stride+kstride);
-      jz(i0+is, j0+js, k0+ks) += gs.jz( is*stride+istride, js*stride+jstride, ks*stride+kstride);
-      rh(i0+is, j0+js, k0+ks) += gs.rho(is*stride+istride, js*stride+jstride, ks*stride+kstride);
-    }
+  nxt = nxt == 0 ? 1 : nxt;
+
+  // copy tile patch by stride hopping; either downsample or average
+  int js = 0;
+  int jstride = 0;
+  int ks = 0;
+  int kstride = 0;
 
-  } // tiles
+  // field quantities; just downsample by hopping with stride
+  for(int is=0; is<nxt; is++) {
+    ex(i0+is, j0+js, k0+ks) = gs.ex( is*stride, js*stride, ks*stride);
+    ey(i0+is, j0+js, k0+ks) = gs.ey( is*stride, js*stride, ks*stride);
+    ez(i0+is, j0+js, k0+ks) = gs.ez( is*stride, js*stride, ks*stride);
+
+    bx(i0+is, j0+js, k0+ks) = gs.bx( is*stride, js*stride, ks*stride);
+    by(i0+is, j0+js, k0+ks) = gs.by( is*stride, js*stride, ks*stride);
+    bz(i0+is, j0+js, k0+ks) = gs.bz( is*stride, js*stride, ks*stride);
+  }
+
+  // densities; these quantities we average over the volume
+  for(int is=0; is<nxt; is++) 
+  for(int istride=0; istride < stride; istride++) {
+    jx(i0+is, j0+js, k0+ks) += gs.jx( is*stride+istride, js*stride+jstride, ks*stride+kstride);
+    jy(i0+is, j0+js, k0+ks) += gs.jy( is*stride+istride, js*stride+jstride, ks*stride+kstride);
+    jz(i0+is, j0+js, k0+ks) += gs.jz( is*stride+istride, js*stride+jstride, ks*stride+kstride);
+    rh(i0+is, j0+js, k0+ks) += gs.rho(is*stride+istride, js*stride+jstride, ks*stride+kstride);
+  }
 }
 
 
 template<>
-inline void h5io::FieldsWriter<2>::read_tiles(
-    corgi::Grid<2>& grid)
+inline void h5io::FieldsWriter<2>::copy_tile(
+    emf::Tile<2>& tile, int i0, int j0, int k0)
 {
 
-  // clear target arrays
-  for(auto& arr : arrs) arr.clear();
-
   // target arrays
   auto& ex = arrs[0];
   auto& ey = arrs[1];
@@ -99,71 +78,54 @@ inline void h5io::FieldsWriter<2>::read_tiles(
   auto& jz = arrs[8];
   auto& rh = arrs[9];
 
+  auto& gs = tile.get_grids();
 
-  // read my local tiles
-  for(auto cid : grid.get_local_tiles() ){
-    auto& tile = dynamic_cast<emf::Tile<2>&>(grid.get_tile( cid ));
-    auto& gs = tile.get_grids();
-
-    // get arrays
-    auto index = expand_indices( &tile );
-
-    // starting location
-    int i0 = (gs.Nx/stride)*std::get<0>(index);
-    int j0 = (gs.Ny/stride)*std::get<1>(index);
-    int k0 = 0; //(gs.Nz/stride)*std::get<2>(index);
-
-    // tile limits taking into account 0 collapsing dimensions
-    int nxt, nyt;
-    nxt = (int)gs.Nx/stride;
-    nyt = (int)gs.Ny/stride;
-
-    nxt = nxt == 0 ? 1 : nxt;
-    nyt = nyt == 0 ? 1 : nyt;
-
-    // copy tile patch by stride hopping
-    int ks = 0;
-    int kstride = 0;
-
-    for(int js=0; js<nyt; js++) {
-      for(int jstride=0; jstride < stride; jstride++) {
-        for(int is=0; is<nxt; is++) {
-
-          // field quantities; no integration
-          if (jstride==0) {
-            ex(i0+is, j0+js, k0+ks) += gs.ex( is*stride, js*stride, ks*stride);
-            ey(i0+is, j0+js, k0+ks) += gs.ey( is*stride, js*stride, ks*stride);
-            ez(i0+is, j0+js, k0+ks) += gs.ez( is*stride, js*stride, ks*stride);
-
-            bx(i0+is, j0+js, k0+ks) += gs.bx( is*stride, js*stride, ks*stride);
-            by(i0+is, j0+js, k0+ks) += gs.by( is*stride, js*stride, ks*stride);
-            bz(i0+is, j0+js, k0+ks) += gs.bz( is*stride, js*stride, ks*stride);
-          }
-
-          // densities; these quantities we need to integrate over stride
-          for(int istride=0; istride < stride; istride++) {
-            jx(i0+is, j0+js, k0+ks) += gs.jx( is*stride+istride, js*stride+jstride, ks*stride+kstride);
-            jy(i0+is, j0+js, k0+ks) += gs.jy( is*stride+istride, js*stride+jstride, ks*stride+kstride);
-            jz(i0+is, j0+js, k0+ks) += gs.jz( is*stride+istride, js*stride+jstride, ks*stride+kstride);
-            rh(i0+is, j0+js, k0+ks) += gs.rho(is*stride+istride, js*stride+jstride, ks*stride+kstride);
-          }
+  // tile limits taking into account 0 collapsing dimensions
+  int nxt, nyt;
+  nxt = (int)gs.Nx/stride;
+  nyt = (int)gs.Ny/stride;
+
+  nxt = nxt == 0 ? 1 : nxt;
+  nyt = nyt == 0 ? 1 : nyt;
+
+  // copy tile patch by stride hopping
+  int ks = 0;
+  int kstride = 0;
+
+  for(int js=0; js<nyt; js++) {
+    for(int jstride=0; jstride < stride; jstride++) {
+      for(int is=0; is<nxt; is++) {
 
+        // field quantities; no integration
+        if (jstride==0) {
+          ex(i0+is, j0+js, k0+ks) += gs.ex( is*stride, js*stride, ks*stride);
+          ey(i0+is, j0+js, k0+ks) += gs.ey( is*stride, js*stride, ks*stride);
+          ez(i0+is, j0+js, k0+ks) += gs.ez( is*stride, js*stride, ks*stride);
+
+          bx(i0+is, j0+js, k0+ks) += gs.bx( is*stride, js*stride, ks*stride);
+          by(i0+is, j0+js, k0+ks) += gs.by( is*stride, js*stride, ks*stride);
+          bz(i0+is, j0+js, k0+ks) += gs.bz( is*stride, js*stride, ks*stride);
+        }
+
+        // densities; these quantities we need to integrate over stride
+        for(int istride=0; istride < stride; istride++) {
+          jx(i0+is, j0+js, k0+ks) += gs.jx( is*stride+istride, js*stride+jstride, ks*stride+kstride);
+          jy(i0+is, j0+js, k0+ks) += gs.jy( is*stride+istride, js*stride+jstride, ks*stride+kstride);
+          jz(i0+is, j0+js, k0+ks) += gs.jz( is*stride+istride, js*stride+jstride, ks*stride+kstride);
+          rh(i0+is, j0+js, k0+ks) += gs.rho(is*stride+istride, js*stride+jstride, ks*stride+kstride);
         }
+
       }
     }
-
-  } // tiles
+  }
 }
 
 
 template<>
-inline void h5io::FieldsWriter<3>::read_tiles(
-    corgi::Grid<3>& grid)
+inline void h5io::FieldsWriter<3>::copy_tile(
+    emf::Tile<3>& tile, int i0, int j0, int k0)
 {
 
-  // clear target arrays
-  for(auto& arr : arrs) arr.clear();
-
   // target arrays
   auto& ex = arrs[0];
   auto& ey = arrs[1];
@@ -176,103 +138,142 @@ inline void h5io::FieldsWriter<3>::read_tiles(
   auto& jz = arrs[8];
   auto& rh = arrs[9];
 
+  auto& gs = tile.get_grids();
+
+  // tile limits taking into account 0 collapsing dimensions
+  int nxt, nyt, nzt;
+  nxt = (int)gs.Nx/stride;
+  nyt = (int)gs.Ny/stride;
+  nzt = (int)gs.Nz/stride;
+
+  nxt = nxt == 0 ? 1 : nxt;
+  nyt = nyt == 0 ? 1 : nyt;
+  nzt = nzt == 0 ? 1 : nzt;
+
+  // copy tile patch by stride hopping; either downsample or average
+
+  // field quantities; just downsample by hopping with stride
+  for(int ks=0; ks<nzt; ks++) 
+  for(int js=0; js<nyt; js++) 
+  for(int is=0; is<nxt; is++) {
+    ex(i0+is, j0+js, k0+ks) = gs.ex( is*stride, js*stride, ks*stride);
+    ey(i0+is, j0+js, k0+ks) = gs.ey( is*stride, js*stride, ks*stride);
+    ez(i0+is, j0+js, k0+ks) = gs.ez( is*stride, js*stride, ks*stride);
+
+    bx(i0+is, j0+js, k0+ks) = gs.bx( is*stride, js*stride, ks*stride);
+    by(i0+is, j0+js, k0+ks) = gs.by( is*stride, js*stride, ks*stride);
+    bz(i0+is, j0+js, k0+ks) = gs.bz( is*stride, js*stride, ks*stride);
+  }
+
+  // densities; these quantities we average over the volume
+  for(int ks=0; ks<nzt; ks++) 
+  for(int kstride=0; kstride < stride; kstride++) 
+  for(int js=0; js<nyt; js++) 
+  for(int jstride=0; jstride < stride; jstride++) 
+  for(int is=0; is<nxt; is++) 
+  for(int istride=0; istride < stride; istride++) {
+    jx(i0+is, j0+js, k0+ks) += gs.jx( is*stride+istride, js*stride+jstride, ks*stride+kstride);
+    jy(i0+is, j0+js, k0+ks) += gs.jy( is*stride+istride, js*stride+jstride, ks*stride+kstride);
+    jz(i0+is, j0+js, k0+ks) += gs.jz( is*stride+istride, js*stride+jstride, ks*stride+kstride);
+    rh(i0+is, j0+js, k0+ks) += gs.rho(is*stride+istride, js*stride+jstride, ks*stride+kstride);
+  }
+}
+
+template<size_t D>
+inline std::array<int,3> h5io::FieldsWriter<D>::tile_origin(
+    emf::Tile<D>& tile)
+{
+  auto& gs = tile.get_grids();
+  auto index = expand_indices( &tile );
+
+  // starting location; collapsed dimensions start from 0
+  int i0 =           (gs.Nx/stride)*std::get<0>(index);
+  int j0 = D >= 2 ? (gs.Ny/stride)*std::get<1>(index) : 0;
+  int k0 = D >= 3 ? (gs.Nz/stride)*std::get<2>(index) : 0;
+
+  return {i0, j0, k0};
+}
+
+
+template<size_t D>
+inline void h5io::FieldsWriter<D>::read_tiles(
+    corgi::Grid<D>& grid)
+{
+  // clear target arrays
+  for(auto& arr : arrs) arr.clear();
 
   // read my local tiles
   for(auto cid : grid.get_local_tiles() ){
-    auto& tile = dynamic_cast<emf::Tile<3>&>(grid.get_tile( cid ));
-    auto& gs = tile.get_grids();
-
-    // get arrays
-    auto index = expand_indices( &tile );
-
-    // starting location
-    int i0 = (gs.Nx/stride)*std::get<0>(index);
-    int j0 = (gs.Ny/stride)*std::get<1>(index);
-    int k0 = (gs.Nz/stride)*std::get<2>(index);
-
-    // tile limits taking into account 0 collapsing dimensions
-    int nxt, nyt, nzt;
-    nxt = (int)gs.Nx/stride;
-    nyt = (int)gs.Ny/stride;
-    nzt = (int)gs.Nz/stride;
-
-    nxt = nxt == 0 ? 1 : nxt;
-    nyt = nyt == 0 ? 1 : nyt;
-    nzt = nzt == 0 ? 1 : nzt;
-
-    // copy tile patch by stride hopping; either downsample or average
-
-    // field quantities; just downsample by hopping with stride
-    for(int ks=0; ks<nzt; ks++) 
-    for(int js=0; js<nyt; js++) 
-    for(int is=0; is<nxt; is++) {
-      ex(i0+is, j0+js, k0+ks) = gs.ex( is*stride, js*stride, ks*stride);
-      ey(i0+is, j0+js, k0+ks) = gs.ey( is*stride, js*stride, ks*stride);
-      ez(i0+is, j0+js, k0+ks) = gs.ez( is*stride, js*stride, ks*stride);
-
-      bx(i0+is, j0+js, k0+ks) = gs.bx( is*stride, js*stride, ks*stride);
-      by(i0+is, j0+js, k0+ks) = gs.by( is*stride, js*stride, ks*stride);
-      bz(i0+is, j0+js, k0+ks) = gs.bz( is*stride, js*stride, ks*stride);
-    }
+    auto& tile = dynamic_cast<emf::Tile<D>&>(grid.get_tile( cid ));
+    auto i0 = tile_origin(tile);
+    copy_tile(tile, i0[0], i0[1], i0[2]);
+  }
+}
 
-    // densities; these quantities we average over the volume
-    for(int ks=0; ks<nzt; ks++) 
-    for(int kstride=0; kstride < stride; kstride++) 
-    for(int js=0; js<nyt; js++) 
-    for(int jstride=0; jstride < stride; jstride++) 
-    for(int is=0; is<nxt; is++) 
-    for(int istride=0; istride < stride; istride++) {
-      jx(i0+is, j0+js, k0+ks) += gs.jx( is*stride+istride, js*stride+jstride, ks*stride+kstride);
-      jy(i0+is, j0+js, k0+ks) += gs.jy( is*stride+istride, js*stride+jstride, ks*stride+kstride);
-      jz(i0+is, j0+js, k0+ks) += gs.jz( is*stride+istride, js*stride+jstride, ks*stride+kstride);
-      rh(i0+is, j0+js, k0+ks) += gs.rho(is*stride+istride, js*stride+jstride, ks*stride+kstride);
-    }
 
-  } // tiles
+template<size_t D>
+inline std::array<int,3> h5io::FieldsWriter<D>::read_tile(
+    corgi::Grid<D>& grid, uint64_t cid)
+{
+  for(auto& arr : arrs) arr.clear();
+
+  auto& tile = dynamic_cast<emf::Tile<D>&>(grid.get_tile( cid ));
+  copy_tile(tile, 0, 0, 0);
+
+  return tile_origin(tile);
 }
 
+
 template<size_t D>
 inline bool h5io::FieldsWriter<D>::write(
     corgi::Grid<D>& grid, int lap)
 {
+  // build filename
+  std::string full_filename =
+    fname +
+    +"/"+
+    file_name +
+    "_" +
+    std::to_string(lap) +
+    extension;
+
+  if(parallel) {
+    write_collective(grid, full_filename, 
+        {"ex", "ey", "ez", "bx", "by", "bz", "jx", "jy", "jz", "rho"},
+        nx, ny, nz);
+    return true;
+  }
+
   read_tiles(grid);
   mpi_reduce_snapshots(grid);
 
   if( grid.comm.rank() == 0 ) {
 
-    // build filename
-    std::string full_filename =
-      fname +
-      +"/"+
-      file_name +
-      "_" +
-      std::to_string(lap) +
-      extension;
-    //std::cout << "QW: " << full_filename << std::endl;
-
-    // open file and write
-    File file(full_filename, H5F_ACC_TRUNC);
-    file["Nx"] = arrs[0].Nx;
-    file["Ny"] = arrs[0].Ny;
-    file["Nz"] = arrs[0].Nz;
+    // stage datasets; written now or in the io thread
+    StagedFile out(full_filename);
+    auto& file = out.group();
+    file.add("Nx", arrs[0].Nx);
+    file.add("Ny", arrs[0].Ny);
+    file.add("Nz", arrs[0].Nz);
 
     // avoid extra copy by using internal container reference;
     // this works because writer meshes don't have halos
     
-    file["ex"] = arrs[0].serialize();
-    file["ey"] = arrs[1].serialize();
-    file["ez"] = arrs[2].serialize();
+    file.add("ex", arrs[0].serialize());
+    file.add("ey", arrs[1].serialize());
+    file.add("ez", arrs[2].serialize());
 
-    file["bx"] = arrs[3].serialize();
-    file["by"] = arrs[4].serialize();
-    file["bz"] = arrs[5].serialize();
+    file.add("bx", arrs[3].serialize());
+    file.add("by", arrs[4].serialize());
+    file.add("bz", arrs[5].serialize());
 
-    file["jx"] = arrs[6].serialize();
-    file["jy"] = arrs[7].serialize();
-    file["jz"] = arrs[8].serialize();
+    file.add("jx", arrs[6].serialize());
+    file.add("jy", arrs[7].serialize());
+    file.add("jz", arrs[8].serialize());
 
-    file["rho"]= arrs[9].serialize();
-    
+    file.add("rho", arrs[9].serialize());
+
+    this->dispatch(std::move(out));
   }
 
   return true;
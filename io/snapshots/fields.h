@@ -6,6 +6,9 @@
 #include "io/snapshots/snapshot.h"
 #include "external/corgi/corgi.h"
 
+namespace emf {
+  template<size_t D> class Tile;
+}
 
 namespace h5io { 
 
@@ -23,7 +26,10 @@ class FieldsWriter :
     using SnapshotWriter<D>::arrs;
     using SnapshotWriter<D>::rbuf;
 
+    using SnapshotWriter<D>::parallel;
+
     using SnapshotWriter<D>::mpi_reduce_snapshots;
+    using SnapshotWriter<D>::write_collective;
 
   public:
 
@@ -39,15 +45,20 @@ class FieldsWriter :
     int stride = 1;
 
     /// constructor that creates a name and opens the file handle
+    //
+    // with parallel = true every rank writes its own tiles into a shared file 
+    // using parallel HDF5 and only tile-sized arrays are allocated
     FieldsWriter(
         const std::string& prefix, 
         int Nx, int NxMesh,
         int Ny, int NyMesh,
         int Nz, int NzMesh,
-        int stride) :
+        int stride,
+        bool parallel = false) :
       SnapshotWriter<D>{prefix},
       stride{stride}
     {
+      this->parallel = parallel;
 
       //fname = prefix + "-" + to_string(lap) + extension;
       nx = Nx*NxMesh/stride;
@@ -58,6 +69,19 @@ class FieldsWriter :
       ny = ny == 0 ? 1 : ny;
       nz = nz == 0 ? 1 : nz;
 
+      if(parallel) {
+        int nxM = NxMesh/stride;
+        int nyM = NyMesh/stride;
+        int nzM = NzMesh/stride;
+
+        nxM = nxM == 0 ? 1 : nxM;
+        nyM = nyM == 0 ? 1 : nyM;
+        nzM = nzM == 0 ? 1 : nzM;
+
+        for(size_t i=0; i<10; i++) arrs.emplace_back(nxM, nyM, nzM);
+        return;
+      }
+
       for(size_t i=0; i<10; i++) arrs.emplace_back(nx, ny, nz);
       rbuf.emplace_back(nx, ny, nz); // only one collective receive buffer
 
@@ -66,6 +90,15 @@ class FieldsWriter :
     /// read tile meshes into memory
     void read_tiles(corgi::Grid<D>& grid) override;
 
+    /// read one tile into tile-sized arrs (parallel mode)
+    std::array<int,3> read_tile(corgi::Grid<D>& grid, uint64_t cid) override;
+
+    /// copy (downsampled) tile patch into arrs starting from index i0,j0,k0
+    void copy_tile(emf::Tile<D>& tile, int i0, int j0, int k0);
+
+    /// global index of the first element of the tile patch
+    std::array<int,3> tile_origin(emf::Tile<D>& tile);
+
     /// write hdf5 file
     bool write(corgi::Grid<D>& grid, int lap) override;
 
@@ -9,7 +9,6 @@
 
 
 using namespace mpi4cpp;
-using ezh5::File;
 
 
 template<>
@@ -321,37 +320,39 @@ inline bool h5io::MasterPicMomentsWriter<3>::write(
       extension;
     //std::cout << "QW: " << full_filename << std::endl;
 
-    // open file and write
-    File file(full_filename, H5F_ACC_TRUNC);
-    file["Nx"] = arrs[0].Nx;
-    file["Ny"] = arrs[0].Ny;
-    file["Nz"] = arrs[0].Nz;
+    // stage datasets; written now or in the io thread
+    StagedFile out(full_filename);
+    auto& file = out.group();
+    file.add("Nx", arrs[0].Nx);
+    file.add("Ny", arrs[0].Ny);
+    file.add("Nz", arrs[0].Nz);
 
     // avoid extra copy by using internal container reference;
     // this works because writer meshes don't have halos
 
     // NOTE index ordering is different than in multi-rank pic moment writer
     
-    file["dense"] = arrs[0].serialize();
-    file["densp"] = arrs[1].serialize();
-    file["densx"] = arrs[2].serialize(); 
+    file.add("dense", arrs[0].serialize());
+    file.add("densp", arrs[1].serialize());
+    file.add("densx", arrs[2].serialize()); 
 
-    file["Vxe"]   = arrs[3].serialize();
-    file["Vye"]   = arrs[4].serialize();
-    file["Vze"]   = arrs[5].serialize();
+    file.add("Vxe", arrs[3].serialize());
+    file.add("Vye", arrs[4].serialize());
+    file.add("Vze", arrs[5].serialize());
 
-    file["Vxp"]   = arrs[6].serialize();
-    file["Vyp"]   = arrs[7].serialize();
-    file["Vzp"]   = arrs[8].serialize();
+    file.add("Vxp", arrs[6].serialize());
+    file.add("Vyp", arrs[7].serialize());
+    file.add("Vzp", arrs[8].serialize());
 
-    file["pressx"]   = arrs[9].serialize();
-    file["pressy"]   = arrs[10].serialize();
-    file["pressz"]   = arrs[11].serialize();
+    file.add("pressx", arrs[9].serialize());
+    file.add("pressy", arrs[10].serialize());
+    file.add("pressz", arrs[11].serialize());
 
-    file["shearxy"]   = arrs[12].serialize();
-    file["shearxz"]   = arrs[13].serialize();
-    file["shearyz"]   = arrs[14].serialize();
+    file.add("shearxy", arrs[12].serialize());
+    file.add("shearxz", arrs[13].serialize());
+    file.add("shearyz", arrs[14].serialize());
 
+    this->dispatch(std::move(out));
   }
 
   return true;
@@ -0,0 +1,139 @@
+#pragma once
+
+#include <array>
+#include <string>
+#include <stdexcept>
+
+#include <mpi.h>
+#include <hdf5.h>
+
+
+namespace h5io {
+
+/// true if HDF5 was built with MPI-IO support
+inline bool has_parallel_hdf5()
+{
+#ifdef H5_HAVE_PARALLEL
+  return true;
+#else
+  return false;
+#endif
+}
+
+
+/*! \brief Shared HDF5 file written collectively by all ranks through MPI-IO
+ *
+ * Every rank opens the same file; datasets are created with their global
+ * shape and each rank writes its own (tile) blocks into them. All member
+ * functions are collective and must be called by every rank of the
+ * communicator in the same order. Ranks with nothing to write pass an
+ * empty block (nullptr) so that the collective calls stay matched.
+ *
+ * Datasets are stored in (nz, ny, nx) order, i.e., with the same memory
+ * layout as the serialized toolbox::Mesh arrays of the serial writers.
+ */
+class ParallelFile {
+
+  public:
+
+  hid_t file = -1;
+
+  /// data transfer property list; collective MPI-IO
+  hid_t dxpl = -1;
+
+  int rank = 0;
+
+  ParallelFile(const std::string& name, MPI_Comm comm)
+  {
+#ifdef H5_HAVE_PARALLEL
+    MPI_Comm_rank(comm, &rank);
+
+    hid_t fapl = H5Pcreate(H5P_FILE_ACCESS);
+    H5Pset_fapl_mpio(fapl, comm, MPI_INFO_NULL);
+    file = H5Fcreate(name.c_str(), H5F_ACC_TRUNC, H5P_DEFAULT, fapl);
+    H5Pclose(fapl);
+
+    if(file < 0) throw std::runtime_error("ParallelFile: can not create " + name);
+
+    dxpl = H5Pcreate(H5P_DATASET_XFER);
+    H5Pset_dxpl_mpio(dxpl, H5FD_MPIO_COLLECTIVE);
+#else
+    (void)name; (void)comm;
+    throw std::runtime_error("ParallelFile: HDF5 is not built with MPI-IO support");
+#endif
+  }
+
+  ParallelFile(const ParallelFile&) = delete;
+  ParallelFile& operator=(const ParallelFile&) = delete;
+
+  ~ParallelFile()
+  {
+    if(dxpl >= 0) H5Pclose(dxpl);
+    if(file >= 0) H5Fclose(file);
+  }
+
+  /// create float dataset of global size nx*ny*nz; returns its handle
+  hid_t create_dataset(const std::string& name, int nx, int ny, int nz)
+  {
+    hsize_t dims[3] = {(hsize_t)nz, (hsize_t)ny, (hsize_t)nx};
+    hid_t space = H5Screate_simple(3, dims, nullptr);
+    hid_t dset  = H5Dcreate2(file, name.c_str(), H5T_NATIVE_FLOAT, space,
+                             H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+    H5Sclose(space);
+
+    if(dset < 0) throw std::runtime_error("ParallelFile: can not create dataset " + name);
+    return dset;
+  }
+
+  /// write block of size n starting from global index i0 into dset;
+  //  buf is x-fastest (Mesh layout) and nullptr for an empty contribution
+  void write_block(
+      hid_t dset,
+      const float* buf,
+      std::array<int,3> i0,
+      std::array<int,3> n)
+  {
+    hid_t fspace = H5Dget_space(dset);
+
+    hsize_t start[3] = {(hsize_t)i0[2], (hsize_t)i0[1], (hsize_t)i0[0]};
+    hsize_t count[3] = {(hsize_t)n[2],  (hsize_t)n[1],  (hsize_t)n[0]};
+
+    hid_t mspace = H5Screate_simple(3, count, nullptr);
+
+    if(buf == nullptr) {
+      H5Sselect_none(fspace);
+      H5Sselect_none(mspace);
+    } else {
+      H5Sselect_hyperslab(fspace, H5S_SELECT_SET, start, nullptr, count, nullptr);
+    }
+
+    // some HDF5 versions reject null buffers even for empty selections
+    const float dummy = 0.0f;
+    herr_t status = H5Dwrite(dset, H5T_NATIVE_FLOAT, mspace, fspace, dxpl, buf ? buf : &dummy);
+
+    H5Sclose(mspace);
+    H5Sclose(fspace);
+
+    if(status < 0) throw std::runtime_error("ParallelFile: collective write failed");
+  }
+
+  /// integer scalar written by rank 0 (e.g., global mesh dimensions)
+  void write_scalar(const std::string& name, int val)
+  {
+    hid_t space = H5Screate(H5S_SCALAR);
+    hid_t dset  = H5Dcreate2(file, name.c_str(), H5T_NATIVE_INT, space,
+                             H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+
+    hid_t fspace = H5Dget_space(dset);
+    if(rank != 0) H5Sselect_none(fspace);
+
+    H5Dwrite(dset, H5T_NATIVE_INT, fspace, fspace, dxpl, &val);
+
+    H5Sclose(fspace);
+    H5Dclose(dset);
+    H5Sclose(space);
+  }
+
+};
+
+} // end of namespace h5io
@@ -1,17 +1,21 @@
 #pragma once
 
+#include <array>
+#include <map>
 #include <vector>
 #include <string>
+#include <stdexcept>
 
 #include "io/snapshots/snapshot.h"
 #include "external/corgi/corgi.h"
-
+#include "core/pic/moments.h"
 
 namespace h5io { 
 
 /// IO for calculating particle distribution moments
 //
-// Calculates full stress tensor, bulk velocites, and number densities
+// Calculates full stress tensor, bulk velocites, and number densities by
+// default; any other set of moments can be selected with add_moment.
 //
 template<size_t D>
 class PicMomentsWriter :
@@ -25,7 +29,10 @@ class PicMomentsWriter :
     using SnapshotWriter<D>::arrs;
     using SnapshotWriter<D>::rbuf;
 
+    using SnapshotWriter<D>::parallel;
+
     using SnapshotWriter<D>::mpi_reduce_snapshots;
+    using SnapshotWriter<D>::write_collective;
 
   public:
 
@@ -40,16 +47,28 @@ class PicMomentsWriter :
     /// data stride length
     int stride = 1;
 
+    /// selected moments
+    pic::MomentsKernel<D> kernel;
+
+    /// size of one tile in the strided mesh (parallel mode)
+    std::array<int,3> tile_len = {1,1,1};
+
     /// constructor that creates a name and opens the file handle
+    //
+    // with parallel = true every rank writes its own tiles into a shared file 
+    // using parallel HDF5 and only tile-sized arrays (one block per local tile) are allocated
     PicMomentsWriter(
         const std::string& prefix, 
         int Nx, int NxMesh,
         int Ny, int NyMesh,
         int Nz, int NzMesh,
-        int stride) :
+        int stride,
+        bool parallel = false) :
       SnapshotWriter<D>{prefix},
       stride{stride}
     {
+      this->parallel = parallel;
+
       //fname = prefix + "-" + to_string(lap) + extension;
       nx = Nx*NxMesh/stride;
       ny = Ny*NyMesh/stride;
@@ -59,17 +78,97 @@ class PicMomentsWriter :
       ny = ny == 0 ? 1 : ny;
       nz = nz == 0 ? 1 : nz;
 
-      // add correct amount of data containers
-      for(size_t i=0; i<15; i++) arrs.emplace_back(nx, ny, nz);
-      rbuf.emplace_back(nx, ny, nz);
+      if(parallel) {
+        tile_len[0] = NxMesh/stride;
+        tile_len[1] = NyMesh/stride;
+        tile_len[2] = NzMesh/stride;
+        for(auto& n : tile_len) n = n == 0 ? 1 : n;
+      }
+
+      // legacy output: leptons (0), ions (1), and photons (2)
+      kernel.stride = stride;
+      kernel.deposit_rho = true;
+
+      kernel.add_moment("dense",   "dens", 0);
+      kernel.add_moment("densp",   "dens", 1);
+      kernel.add_moment("Vxe",     "vx",   0);
+      kernel.add_moment("Vye",     "vy",   0);
+      kernel.add_moment("Vze",     "vz",   0);
+      kernel.add_moment("Vxp",     "vx",   1);
+      kernel.add_moment("Vyp",     "vy",   1);
+      kernel.add_moment("Vzp",     "vz",   1);
+      kernel.add_moment("pressx",  "pxx", -1);
+      kernel.add_moment("pressy",  "pyy", -1);
+      kernel.add_moment("pressz",  "pzz", -1);
+      kernel.add_moment("shearxy", "pxy", -1);
+      kernel.add_moment("shearxz", "pxz", -1);
+      kernel.add_moment("shearyz", "pyz", -1);
+      kernel.add_moment("densx",   "absu", 2);
+
+      allocate();
+    }
+
+    /// remove all moments (including the default ones)
+    void clear_moments()
+    {
+      kernel.channels.clear();
+      allocate();
+    }
+
+    /// select moment kind of species ispc (-1 for all) to be written as dataset name
+    void add_moment(const std::string& name, const std::string& kind, int ispc = -1)
+    {
+      kernel.add_moment(name, kind, ispc);
+      allocate();
+    }
+
+    /// shape function order of the deposit (0 = nearest cell, 1 = CIC, 2 = TSC)
+    void set_shape(int shape)
+    {
+      if(shape < 0 || shape > 2) throw std::invalid_argument("PicMomentsWriter: shape order must be 0, 1, or 2");
+      kernel.shape = shape;
     }
 
+    int get_shape() const { return kernel.shape; }
+
     /// read tile meshes into memory
     void read_tiles(corgi::Grid<D>& grid) override;
 
+    /// read one tile into tile-sized arrs (parallel mode)
+    std::array<int,3> read_tile(corgi::Grid<D>& grid, uint64_t cid) override;
+
     /// write hdf5 file
     bool write(corgi::Grid<D>& grid, int lap) override;
 
+  private:
+
+    /// scratch block of read_tile
+    std::vector<float> buf;
+
+    /// moment blocks with ghost cells (MomentsKernel::extent) of the local tiles 
+    //  and of their neighbors on other ranks (parallel mode)
+    std::map<uint64_t, std::vector<float>> blocks;
+
+    /// deposit the local tiles into blocks and exchange the blocks that overlap 
+    //  tiles of other ranks; read_tile then sums the overlaps at the tile seams
+    void deposit_blocks(corgi::Grid<D>& grid);
+
+    /// tile and its existing neighbors (each once)
+    std::vector<uint64_t> neighborhood(corgi::Grid<D>& grid, corgi::Tile<D>& tile);
+
+    /// one array per kernel channel; global or tile-sized
+    void allocate()
+    {
+      arrs.clear();
+      rbuf.clear();
+
+      for(size_t c=0; c<kernel.channels.size(); c++) {
+        if(parallel) arrs.emplace_back(tile_len[0], tile_len[1], tile_len[2]);
+        else         arrs.emplace_back(nx, ny, nz);
+      }
+      if(!parallel) rbuf.emplace_back(nx, ny, nz);
+    }
+
 };
 
 } // end of namespace h5io
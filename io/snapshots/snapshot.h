@@ -1,6 +1,7 @@
 #pragma once
 
 #include <array>
+#include <stdexcept>
 #include <mpi4cpp/mpi.h>
 #include <string>
 #include <utility>
@@ -11,6 +12,8 @@
 #include "tools/fastlog.h"
 #include "tools/mesh.h"
 #include "io/namer.h"
+#include "io/snapshots/parallel_h5.h"
+#include "io/async.h"
 
 
 namespace h5io { 
@@ -41,9 +44,22 @@ class SnapshotWriter {
     /// data stride length
     int stride = 1;
 
+    /// write one shared file collectively with parallel HDF5 instead of 
+    //  reducing the global arrays to rank 0; arrs then hold only one tile
+    bool parallel = false;
+
+    /// write the files in the background io thread (h5io::IOThread); 
+    //  the next write waits only if the previous file is not yet written
+    bool async = false;
+
+    /// previous file of this writer in the io thread
+    std::shared_future<void> pending;
+
     /// constructor that creates a name and opens the file handle
     SnapshotWriter( std::string  prefix ) : fname{std::move(prefix)} { }
 
+    virtual ~SnapshotWriter() = default;
+
     // NOTE: modify these 2 functions to make your own snapshot io
 
     /// read tile meshes into memory
@@ -52,6 +68,66 @@ class SnapshotWriter {
     /// write hdf5 file
     virtual bool write(corgi::Grid<D>& grid, int lap) = 0;
 
+    /// write staged file now or, if async, in the io thread
+    void dispatch(StagedFile&& out)
+    {
+      if(async) {
+        IOThread::get().wait(pending); // staging of the previous write is released
+
+        auto job = std::make_shared<StagedFile>(std::move(out));
+        pending = IOThread::get().submit([job]{ job->write(); });
+      } else {
+        wait_io();
+        out.write();
+      }
+    }
+
+    /// read one tile into the (tile-sized) arrs; returns the global index of its first element
+    virtual std::array<int,3> read_tile(corgi::Grid<D>& /*grid*/, uint64_t /*cid*/)
+    {
+      throw std::logic_error("SnapshotWriter: parallel output not supported by this writer");
+    }
+
+    /// write arrs tile-by-tile into global datasets of size nx*ny*nz with collective parallel HDF5
+    // names[i] is the dataset of arrs[i]; every rank participates with all of its 
+    // local tiles so memory use scales with the tile size, not the domain size.
+    void write_collective(
+        corgi::Grid<D>& grid,
+        const std::string& full_filename,
+        const std::vector<std::string>& names,
+        int nx, int ny, int nz)
+    {
+      wait_io(); // collective writes are not run in the io thread
+      ParallelFile file(full_filename, grid.comm);
+      file.write_scalar("Nx", nx);
+      file.write_scalar("Ny", ny);
+      file.write_scalar("Nz", nz);
+
+      std::vector<hid_t> dsets;
+      for(auto& name : names) dsets.push_back( file.create_dataset(name, nx, ny, nz) );
+
+      // collective writes have to match; ranks with fewer tiles write empty blocks
+      const auto cids = grid.get_local_tiles();
+      int ntiles = cids.size();
+      int max_tiles = 0;
+      MPI_Allreduce(&ntiles, &max_tiles, 1, MPI_INT, MPI_MAX, grid.comm);
+
+      const std::array<int,3> n = {arrs[0].Nx, arrs[0].Ny, arrs[0].Nz};
+
+      for(int t=0; t<max_tiles; t++) {
+        const bool has_tile = t < ntiles;
+
+        std::array<int,3> i0 = {0,0,0};
+        if(has_tile) i0 = read_tile(grid, cids[t]);
+
+        for(size_t els=0; els<names.size(); els++) {
+          file.write_block(dsets[els], has_tile ? arrs[els].data() : nullptr, i0, n);
+        }
+      }
+
+      for(auto dset : dsets) H5Dclose(dset);
+    }
+
     /// communicate snapshots with a B-tree cascade to rank 0
     // NOTE: this version communicates faster but requires n=size(arrs)
     //       number of receive buffers
@@ -1,3 +1,5 @@
+#include <algorithm>
+
 #include <mpi4cpp/mpi.h>
 
 #include "io/snapshots/test_prtcls.h"
@@ -5,7 +7,6 @@
 #include "core/pic/particle.h"
 #include "core/pic/tile.h"
 
-using ezh5::File;
 
 template<size_t D>
 h5io::TestPrtclWriter<D>::TestPrtclWriter(
@@ -14,8 +15,10 @@ h5io::TestPrtclWriter<D>::TestPrtclWriter(
         int Ny_in, int NyMesh_in,
         int Nz_in, int NzMesh_in,
         int ppc_in, int n_local_tiles_in,
-        int n_test_particles_approx_in) :
-  SnapshotWriter<D>{prefix}
+        int n_test_particles_approx_in,
+        int nt_in) :
+  SnapshotWriter<D>{prefix},
+  nt{nt_in > 0 ? nt_in : 1}
 {
 
   // enforce long accuracy due to persistent overflows
@@ -91,9 +94,9 @@ h5io::TestPrtclWriter<D>::TestPrtclWriter(
   }
 
 
-  //nt=1;
   np = min_n_prtcls;
   nr = n_comm_size;
+  laps.assign(nt, -1);
 
   // 7+6 (loc, vel, wgt and ex,ey,ez,bz,by,bz), variables per particle to save
   for(size_t i=0; i<=12; i++) arrs.emplace_back(nt, np, nr);
@@ -111,10 +114,6 @@ template<size_t D>
 inline void h5io::TestPrtclWriter<D>::read_tiles(
     corgi::Grid<D>& grid)
 {
-  // clear target arrays
-  for(auto& arr : arrs ) arr.clear();
-  for(auto& arr : arrs2) arr.clear();
-
   // target arrays
   auto& xloc = arrs[0];
   auto& yloc = arrs[1];
@@ -135,7 +134,15 @@ inline void h5io::TestPrtclWriter<D>::read_tiles(
   auto& procs = arrs2[1];
 
   int ip, ir;
-  int tstep = 0;
+  const int tstep = nrec % nt;
+
+  // clear the time slot; it can hold an old record of the ring
+  for(int i=0; i<nr; i++) {
+    for(int j=0; j<np; j++) {
+      for(auto& arr : arrs ) arr(tstep, j, i) = 0.0f;
+      for(auto& arr : arrs2) arr(tstep, j, i) = 0;
+    }
+  }
 
   // read my local tiles
   for(auto cid : grid.get_local_tiles() ){
@@ -143,6 +150,11 @@ inline void h5io::TestPrtclWriter<D>::read_tiles(
     auto& container = tile.get_container( ispc );
     int nparts = container.size();
 
+    // index tracked particles; one full pass per container (or after the rule changes)
+    if(container.track_stride != stride || container.track_cutoff != cutoff_id) {
+      container.enable_tracking(stride, cutoff_id);
+    }
+
     float* loc[3];
     for( int i=0; i<3; i++) loc[i] = &( container.loc(i,0) );
 
@@ -165,52 +177,43 @@ inline void h5io::TestPrtclWriter<D>::read_tiles(
     int* idn[2];
     for(int i=0; i<2; i++) idn[i] = &( container.id(i,0) );
 
-    // long length id
-    long idnl0, idnl1;
-
-    // loop and search over all particles
-    for(size_t n=0; n<container.size(); n++) {
-      idnl0 = static_cast<long>(idn[0][n]);
-      idnl1 = static_cast<long>(idn[1][n]);
-
-      // skip beyond cutoff
-      if(idnl0 >= cutoff_id) continue;
-
-      // process only multiples of stride
-      if(idnl0 % stride == 0) {
-        ip = static_cast<int>(idnl0/stride); // get id
-        ir = static_cast<int>(idnl1);        // get proc
-
-        //std::cout << "...prtcl: " <<
-        //  ip << " " <<
-        //  ir << " " <<
-        //  idn[0][n] << " " <<
-        //  idn[1][n] << "\n";
-
-        // save particle to correct position
-        xloc( tstep, ip, ir) = loc[0][n];
-        yloc( tstep, ip, ir) = loc[1][n];
-        zloc( tstep, ip, ir) = loc[2][n];
-        ux(   tstep, ip, ir) = vel[0][n];
-        uy(   tstep, ip, ir) = vel[1][n];
-        uz(   tstep, ip, ir) = vel[2][n];
-        wgt(  tstep, ip, ir) = ch[n];
-        ids(  tstep, ip, ir) = idn[0][n];
-        procs(tstep, ip, ir) = idn[1][n];
-
-        exp(  tstep, ip, ir) = ex[n];
-        eyp(  tstep, ip, ir) = ey[n];
-        ezp(  tstep, ip, ir) = ez[n];
-
-        bxp(  tstep, ip, ir) = bx[n];
-        byp(  tstep, ip, ir) = by[n];
-        bzp(  tstep, ip, ir) = bz[n];
-
-      }
+    // loop over tracked particles only
+    for(size_t s=0; s<container.tracked.size(); s++) {
+      const int n = container.tracked[s];
+
+      ip = static_cast<int>( static_cast<long>(idn[0][n])/stride ); // get id
+      ir = idn[1][n];                                               // get proc
+
+      // save particle to correct position
+      xloc( tstep, ip, ir) = loc[0][n];
+      yloc( tstep, ip, ir) = loc[1][n];
+      zloc( tstep, ip, ir) = loc[2][n];
+      ux(   tstep, ip, ir) = vel[0][n];
+      uy(   tstep, ip, ir) = vel[1][n];
+      uz(   tstep, ip, ir) = vel[2][n];
+      wgt(  tstep, ip, ir) = ch[n];
+      ids(  tstep, ip, ir) = idn[0][n];
+      procs(tstep, ip, ir) = idn[1][n];
+
+      exp(  tstep, ip, ir) = ex[n];
+      eyp(  tstep, ip, ir) = ey[n];
+      ezp(  tstep, ip, ir) = ez[n];
+
+      bxp(  tstep, ip, ir) = bx[n];
+      byp(  tstep, ip, ir) = by[n];
+      bzp(  tstep, ip, ir) = bz[n];
     }
+  }
+}
 
 
-  }
+template<size_t D>
+void h5io::TestPrtclWriter<D>::record(
+    corgi::Grid<D>& grid, int lap)
+{
+  read_tiles(grid);
+  laps[nrec % nt] = lap;
+  nrec++;
 }
 
 
@@ -303,11 +306,34 @@ template<size_t D>
 inline bool h5io::TestPrtclWriter<D>::write(
     corgi::Grid<D>& grid, int lap)
 {
-  read_tiles(grid);
+  // current lap is part of the output unless it is already recorded
+  if(nrec == 0 || laps[(nrec-1) % nt] != lap) record(grid, lap);
+
   mpi_reduce_snapshots(grid);
 
   if( grid.comm.rank() == 0 ) {
 
+    // ring wrapped around; rotate the oldest record to the first slot
+    const int first = nrec > nt ? nrec % nt : 0;
+    if(first > 0) {
+      std::rotate(laps.begin(), laps.begin() + first, laps.end());
+
+      std::vector<float> rowf(nt);
+      std::vector<int>   rowi(nt);
+      for(int i=0; i<nr; i++) {
+        for(int j=0; j<np; j++) {
+          for(auto& arr : arrs) {
+            for(int t=0; t<nt; t++) rowf[t] = arr((t + first) % nt, j, i);
+            for(int t=0; t<nt; t++) arr(t, j, i) = rowf[t];
+          }
+          for(auto& arr : arrs2) {
+            for(int t=0; t<nt; t++) rowi[t] = arr((t + first) % nt, j, i);
+            for(int t=0; t<nt; t++) arr(t, j, i) = rowi[t];
+          }
+        }
+      }
+    }
+
     // build filename
     std::string full_filename;
 
@@ -331,34 +357,44 @@ inline bool h5io::TestPrtclWriter<D>::write(
 
     //std::cout << "QW: " << full_filename << std::endl;
 
-    // open file and write
-    File file(full_filename, H5F_ACC_TRUNC);
-    file["Nx"] = arrs[0].Nx;
-    file["Ny"] = arrs[0].Ny;
-    file["Nz"] = arrs[0].Nz;
+    // stage datasets; written now or in the io thread
+    StagedFile out(full_filename);
+    auto& file = out.group();
+    file.add("Nx", arrs[0].Nx);
+    file.add("Ny", arrs[0].Ny);
+    file.add("Nz", arrs[0].Nz);
+
 
+    file.add("x", arrs[0].serialize());
+    file.add("y", arrs[1].serialize());
+    file.add("z", arrs[2].serialize());
+    file.add("vx", arrs[3].serialize());
+    file.add("vy", arrs[4].serialize());
+    file.add("vz", arrs[5].serialize());
+    file.add("wgt", arrs[6].serialize());
 
-    file["x"]   = arrs[0].serialize();
-    file["y"]   = arrs[1].serialize();
-    file["z"]   = arrs[2].serialize();
-    file["vx"]  = arrs[3].serialize();
-    file["vy"]  = arrs[4].serialize();
-    file["vz"]  = arrs[5].serialize();
-    file["wgt"] = arrs[6].serialize();
+    file.add("ex", arrs[7].serialize());
+    file.add("ey", arrs[8].serialize());
+    file.add("ez", arrs[9].serialize());
 
-    file["ex"]  = arrs[7].serialize();
-    file["ey"]  = arrs[8].serialize();
-    file["ez"]  = arrs[9].serialize();
+    file.add("bx", arrs[10].serialize());
+    file.add("by", arrs[11].serialize());
+    file.add("bz", arrs[12].serialize());
 
-    file["bx"]  = arrs[10].serialize();
-    file["by"]  = arrs[11].serialize();
-    file["bz"]  = arrs[12].serialize();
+    file.add("id", arrs2[0].serialize());
+    file.add("proc", arrs2[1].serialize());
 
-    file["id"]   = arrs2[0].serialize();
-    file["proc"] = arrs2[1].serialize();
+    file.add("laps", std::vector<int>(laps));
 
+    this->dispatch(std::move(out));
   }
 
+  // empty the buffer; reduction accumulated into the arrays of the receiving ranks
+  for(auto& arr : arrs ) arr.clear();
+  for(auto& arr : arrs2) arr.clear();
+  laps.assign(nt, -1);
+  nrec = 0;
+
   return true;
 }
 
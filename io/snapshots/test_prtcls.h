@@ -17,6 +17,12 @@ namespace h5io {
 // by collecting their ids and then tagging those that are multiples of
 // some stride value. Full history of these pre-identified particles is
 // then saved to disk.
+//
+// The tracked particles are indexed in the containers (see
+// ParticleContainer::tracked) so that a record touches only them. Records
+// go into a ring buffer of nt laps that is flushed to one file by write;
+// the file has the laps of the records in dataset "laps" (-1 for unused
+// slots).
 template<size_t D>
 class TestPrtclWriter :
   public SnapshotWriter<D>
@@ -41,9 +47,15 @@ class TestPrtclWriter :
     /// do not consider particles beyond this id
     long cutoff_id;
 
-    /// how many time steps to save
+    /// how many time steps to save (length of the ring buffer)
     int nt=1;
 
+    /// number of records since the last write
+    int nrec = 0;
+
+    /// lap of each time slot; -1 if empty
+    std::vector<int> laps;
+
     /// total number of (test) particles
     long np;
 
@@ -63,13 +75,17 @@ class TestPrtclWriter :
         int Ny, int NyMesh,
         int Nz, int NzMesh,
         int ppc, int n_local_tiles,
-        int n_test_particles_approx);
+        int n_test_particles_approx,
+        int nt = 1);
 
 
-    /// read tile meshes into memory
+    /// read tracked particles into the next time slot
     void read_tiles(corgi::Grid<D>& grid) override;
 
-    /// write hdf5 file
+    /// store tracked particles of lap into the ring buffer; no communication
+    void record(corgi::Grid<D>& grid, int lap);
+
+    /// write records (and the current lap if not recorded) into an hdf5 file and empty the buffer
     bool write(corgi::Grid<D>& grid, int lap) override;
 
     /// communicate snapshots with a B-tree cascade to rank 0
@@ -4,6 +4,9 @@
 
 #include "io/writers/writer.h"
 #include "io/readers/reader.h"
+#include "io/writers/pic_restart.h"
+#include "io/readers/pic_restart.h"
+#include "io/async.h"
 
 
 namespace vlv{
@@ -21,6 +24,7 @@ inline void write_mesh(
   prefix += std::to_string(grid.comm.rank());
   h5io::Writer writer(prefix, lap);
 
+  h5io::wait_io();
   ezh5::File file(writer.fname.name, H5F_ACC_TRUNC);
 
   for(auto cid : grid.get_local_tiles() ){
@@ -44,6 +48,7 @@ inline void read_mesh(
   prefix += std::to_string(grid.comm.rank());
   h5io::Reader reader(prefix, lap);
 
+  h5io::wait_io();
   ezh5::File file(reader.fname.name, H5F_ACC_RDONLY);
 
   for(auto cid : grid.get_tile_ids() ){
@@ -61,11 +66,14 @@ inline void read_mesh(
 
 namespace emf {
 
+/// write tiles of the rank into one file; with async_io the fields are 
+//  copied and written in the background io thread (h5io::IOThread)
 template<size_t D>
 inline void write_grids( 
     corgi::Grid<D>& grid, 
     int lap,
-    std::string dir
+    std::string dir,
+    bool async_io = false
     )
 {
   if(dir.back() != '/') dir += '/';
@@ -74,6 +82,18 @@ inline void write_grids(
   prefix += std::to_string(grid.comm.rank());
   h5io::Writer writer(prefix, lap);
 
+  if(async_io) {
+    auto out = std::make_shared<h5io::StagedFile>(writer.fname.name);
+    for(auto cid : grid.get_local_tiles() ){
+      const auto& tile 
+        = dynamic_cast<emf::Tile<D>&>(grid.get_tile( cid ));
+      writer.stage(tile, *out);
+    }
+    h5io::IOThread::get().submit([out]{ out->write(); });
+    return;
+  }
+
+  h5io::wait_io();
   ezh5::File file(writer.fname.name, H5F_ACC_TRUNC);
 
   for(auto cid : grid.get_local_tiles() ){
@@ -116,6 +136,7 @@ inline void read_grids(
   prefix += std::to_string(grid.comm.rank());
 
   h5io::Reader reader(prefix, lap);
+  h5io::wait_io();
   ezh5::File file(reader.fname.name, H5F_ACC_RDONLY);
 
   for(auto cid : grid.get_tile_ids() ){
@@ -134,11 +155,14 @@ inline void read_grids(
 namespace pic {
 
 
+/// write particles of the rank into one file; with async_io the particles 
+//  are copied and written in the background io thread (h5io::IOThread)
 template<size_t D>
 void write_particles( 
     corgi::Grid<D>& grid, 
     int lap,
-    std::string dir 
+    std::string dir,
+    bool async_io = false
     )
 {
   if(dir.back() != '/') dir += '/';
@@ -147,13 +171,16 @@ void write_particles(
   prefix += std::to_string(grid.comm.rank());
   h5io::Writer writer(prefix, lap);
 
-  ezh5::File file(writer.fname.name, H5F_ACC_TRUNC);
-
-  for(auto cid : grid.get_local_tiles() ){
-    const auto& tile 
-      = dynamic_cast<pic::Tile<D>&>(grid.get_tile( cid ));
-    writer.write(tile, file);
+  // one dataset per species and quantity with a per-tile offset index
+  if(async_io) {
+    auto out = std::make_shared<h5io::PrtclRestart>( h5io::collect_particle_restart(grid, true) );
+    std::string fname = writer.fname.name;
+    h5io::IOThread::get().submit([out, fname]{ out->write(fname); });
+    return;
   }
+
+  h5io::wait_io();
+  h5io::write_particle_restart(grid, writer.fname.name);
 }
 
 
@@ -170,6 +197,14 @@ inline void read_particles(
   prefix += std::to_string(grid.comm.rank());
 
   h5io::Reader reader(prefix, lap);
+  h5io::wait_io();
+
+  if(h5io::is_particle_restart(reader.fname.name)) {
+    h5io::read_particle_restart(grid, reader.fname.name);
+    return;
+  }
+
+  // older files with one group per tile and species
   ezh5::File file(reader.fname.name, H5F_ACC_RDONLY);
 
   for(auto cid : grid.get_tile_ids() ){
@@ -4,12 +4,12 @@
 #include "core/emf/tile.h"
 
 
-/// Write PlasmaTile content into a hdf5 data group
+/// Copy PlasmaTile content into a staged hdf5 data group
 template<size_t D>
-bool 
-h5io::Writer::write( 
+void
+h5io::Writer::stage( 
   const emf::Tile<D>& tile,
-  ezh5::File& file
+  StagedFile& out
   )
 {
   const auto& gs = tile.get_const_grids();
@@ -18,39 +18,49 @@ h5io::Writer::write(
   auto my_ind = expand_indices( &tile );
   string numbering = create_numbering(my_ind);
 
-  // open individual group for the data
-  auto gr = file["yee_"+ numbering];
+  // individual group for the data
+  auto& gr = out.group("yee_"+ numbering);
 
   // tile location inside grid
-  gr["i"] = static_cast<int>( std::get<0>(my_ind) );
-  gr["j"] = static_cast<int>( std::get<1>(my_ind) );
-  gr["k"] = static_cast<int>( std::get<2>(my_ind) );
+  gr.add("i", static_cast<int>( std::get<0>(my_ind) ));
+  gr.add("j", static_cast<int>( std::get<1>(my_ind) ));
+  gr.add("k", static_cast<int>( std::get<2>(my_ind) ));
 
   // size
-  gr["Nx"] = static_cast<int>( gs.Nx );
-  gr["Ny"] = static_cast<int>( gs.Ny );
-  gr["Nz"] = static_cast<int>( gs.Nz );
+  gr.add("Nx", static_cast<int>( gs.Nx ));
+  gr.add("Ny", static_cast<int>( gs.Ny ));
+  gr.add("Nz", static_cast<int>( gs.Nz ));
 
   //--------------------------------------------------
   // Yee lattice quantities
 
-  gr["jx"] = gs.jx.serialize();
-  gr["jy"] = gs.jy.serialize();
-  gr["jz"] = gs.jz.serialize();
-
-  gr["ex"] = gs.ex.serialize();
-  gr["ey"] = gs.ey.serialize();
-  gr["ez"] = gs.ez.serialize();
+  gr.add("jx", gs.jx.serialize());
+  gr.add("jy", gs.jy.serialize());
+  gr.add("jz", gs.jz.serialize());
 
-  gr["bx"] = gs.bx.serialize();
-  gr["by"] = gs.by.serialize();
-  gr["bz"] = gs.bz.serialize();
+  gr.add("ex", gs.ex.serialize());
+  gr.add("ey", gs.ey.serialize());
+  gr.add("ez", gs.ez.serialize());
 
-  gr["rho"] = gs.rho.serialize();
+  gr.add("bx", gs.bx.serialize());
+  gr.add("by", gs.by.serialize());
+  gr.add("bz", gs.bz.serialize());
 
-
-  return true;
+  gr.add("rho", gs.rho.serialize());
 }
 
 
+/// Write PlasmaTile content into a hdf5 data group
+template<size_t D>
+bool 
+h5io::Writer::write( 
+  const emf::Tile<D>& tile,
+  ezh5::File& file
+  )
+{
+  StagedFile out;
+  stage(tile, out);
+  out.write_to(file);
 
+  return true;
+}
@@ -0,0 +1,257 @@
+#pragma once
+
+#include <array>
+#include <string>
+#include <vector>
+#include <stdexcept>
+#include <algorithm>
+#include <cstdint>
+
+#include <hdf5.h>
+
+#include "io/namer.h"
+#include "core/pic/tile.h"
+#include "external/corgi/corgi.h"
+
+
+namespace h5io {
+
+/// version of the streaming particle restart layout
+//
+// particles-<rank>_<lap>.h5:
+//   format, Nspecies                      scalars
+//   tiles/cid      [ntiles]               tile ids
+//   tiles/index    [ntiles, 3]            tile indices i,j,k
+//   sp-<s>/offset  [ntiles+1]             first particle of each tile
+//   sp-<s>/x, y, z, vx, vy, vz, wgt       [N] float, chunked
+//   sp-<s>/id, proc                       [N] int, chunked
+//
+// Particles of tile t are at offset[t] ... offset[t+1]-1.
+constexpr int prtcl_restart_format = 2;
+
+/// particle datasets per species
+const std::array<std::string, 7> prtcl_restart_fvars = {"x", "y", "z", "vx", "vy", "vz", "wgt"};
+const std::array<std::string, 2> prtcl_restart_ivars = {"id", "proc"};
+
+
+/// create and fill a small contiguous dataset; scalar if dims is empty
+inline void h5_write_array(
+    hid_t loc, const std::string& name, hid_t type,
+    std::vector<hsize_t> dims, const void* data)
+{
+  hid_t space = dims.empty() ? H5Screate(H5S_SCALAR) : H5Screate_simple(dims.size(), dims.data(), nullptr);
+  hid_t dset  = H5Dcreate2(loc, name.c_str(), type, space, H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+  if(dset < 0) throw std::runtime_error("h5_write_array: can not create " + name);
+
+  H5Dwrite(dset, type, H5S_ALL, H5S_ALL, H5P_DEFAULT, data);
+
+  H5Dclose(dset);
+  H5Sclose(space);
+}
+
+
+/// one dataset of n elements, chunked in 1M element pieces
+inline hid_t h5_create_chunked(
+    hid_t loc, const std::string& name, hid_t type, hsize_t n)
+{
+  hid_t space = H5Screate_simple(1, &n, nullptr);
+
+  hid_t dcpl = H5Pcreate(H5P_DATASET_CREATE);
+  if(n > 0) {
+    hsize_t chunk = std::min<hsize_t>(n, 1 << 20);
+    H5Pset_chunk(dcpl, 1, &chunk);
+  }
+
+  hid_t dset = H5Dcreate2(loc, name.c_str(), type, space, H5P_DEFAULT, dcpl, H5P_DEFAULT);
+
+  H5Pclose(dcpl);
+  H5Sclose(space);
+
+  if(dset < 0) throw std::runtime_error("h5_create_chunked: can not create " + name);
+  return dset;
+}
+
+
+/// write n elements from buf to dset starting from element i0
+inline void h5_write_range(
+    hid_t dset, hid_t type, hsize_t i0, hsize_t n, const void* buf)
+{
+  if(n == 0) return;
+
+  hid_t fspace = H5Dget_space(dset);
+  H5Sselect_hyperslab(fspace, H5S_SELECT_SET, &i0, nullptr, &n, nullptr);
+  hid_t mspace = H5Screate_simple(1, &n, nullptr);
+
+  herr_t status = H5Dwrite(dset, type, mspace, fspace, H5P_DEFAULT, buf);
+
+  H5Sclose(mspace);
+  H5Sclose(fspace);
+
+  if(status < 0) throw std::runtime_error("h5_write_range: write failed");
+}
+
+
+/// particles of one tile and species; n values behind each pointer
+struct PrtclSlice {
+  size_t n = 0;
+  std::array<const float*, 7> f = {}; // x, y, z, vx, vy, vz, wgt
+  std::array<const int*, 2>   i = {}; // id, proc
+};
+
+
+/// tile index and particle slices of a restart file
+struct PrtclRestart {
+  int Nspecies = 0;
+  std::vector<uint64_t> tile_cid;
+  std::vector<int> tile_index;                  // i,j,k of each tile
+  std::vector< std::vector<PrtclSlice> > slices; // [ispc][tile]
+
+  /// backing storage of staged copies; empty if slices point to the containers
+  std::vector< std::vector<float> > fstore;
+  std::vector< std::vector<int> >   istore;
+
+  /// write the restart file
+  void write(const std::string& fname) const
+  {
+    const size_t ntiles = tile_cid.size();
+
+    hid_t file = H5Fcreate(fname.c_str(), H5F_ACC_TRUNC, H5P_DEFAULT, H5P_DEFAULT);
+    if(file < 0) throw std::runtime_error("PrtclRestart: can not create " + fname);
+
+    h5_write_array(file, "format",   H5T_NATIVE_INT, {}, &prtcl_restart_format);
+    h5_write_array(file, "Nspecies", H5T_NATIVE_INT, {}, &Nspecies);
+
+    hid_t gtiles = H5Gcreate2(file, "tiles", H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+    h5_write_array(gtiles, "cid",   H5T_NATIVE_UINT64, {ntiles},    tile_cid.data());
+    h5_write_array(gtiles, "index", H5T_NATIVE_INT,    {ntiles, 3}, tile_index.data());
+    H5Gclose(gtiles);
+
+    for(int ispc=0; ispc<Nspecies; ispc++) {
+      const auto& sl = slices[ispc];
+
+      std::vector<int64_t> offset(ntiles+1, 0);
+      for(size_t t=0; t<ntiles; t++) offset[t+1] = offset[t] + sl[t].n;
+
+      hid_t gr = H5Gcreate2(file, ("sp-" + std::to_string(ispc)).c_str(),
+                            H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+      h5_write_array(gr, "offset", H5T_NATIVE_INT64, {ntiles+1}, offset.data());
+
+      const hsize_t N = offset[ntiles];
+
+      // one quantity at a time so that only one chunk cache is filled at once
+      for(size_t v=0; v<prtcl_restart_fvars.size(); v++) {
+        hid_t dset = h5_create_chunked(gr, prtcl_restart_fvars[v], H5T_NATIVE_FLOAT, N);
+        for(size_t t=0; t<ntiles; t++) h5_write_range(dset, H5T_NATIVE_FLOAT, offset[t], sl[t].n, sl[t].f[v]);
+        H5Dclose(dset);
+      }
+
+      for(size_t v=0; v<prtcl_restart_ivars.size(); v++) {
+        hid_t dset = h5_create_chunked(gr, prtcl_restart_ivars[v], H5T_NATIVE_INT, N);
+        for(size_t t=0; t<ntiles; t++) h5_write_range(dset, H5T_NATIVE_INT, offset[t], sl[t].n, sl[t].i[v]);
+        H5Dclose(dset);
+      }
+
+      H5Gclose(gr);
+    }
+
+    H5Fclose(file);
+  }
+};
+
+
+/// collect the particles of all local tiles
+//
+// Without staging the slices point directly to the particle containers (no
+// copies) and are valid only until the particles change. With staging the
+// particles of each species are copied into one contiguous array per
+// quantity, e.g., for writing in the background.
+template<size_t D>
+PrtclRestart collect_particle_restart(
+    corgi::Grid<D>& grid,
+    bool staged = false)
+{
+  PrtclRestart ret;
+
+  const auto cids = grid.get_local_tiles();
+  const size_t ntiles = cids.size();
+
+  std::vector<const pic::Tile<D>*> tiles(ntiles);
+  for(size_t t=0; t<ntiles; t++)
+    tiles[t] = &dynamic_cast<const pic::Tile<D>&>(grid.get_tile( cids[t] ));
+
+  ret.Nspecies = ntiles > 0 ? tiles[0]->Nspecies() : 0;
+
+  //--------------------------------------------------
+  // tile index
+  ret.tile_cid.assign(cids.begin(), cids.end());
+  ret.tile_index.resize(3*ntiles);
+  for(size_t t=0; t<ntiles; t++) {
+    auto ind = expand_indices( tiles[t] );
+    ret.tile_index[3*t + 0] = static_cast<int>( std::get<0>(ind) );
+    ret.tile_index[3*t + 1] = static_cast<int>( std::get<1>(ind) );
+    ret.tile_index[3*t + 2] = static_cast<int>( std::get<2>(ind) );
+  }
+
+  //--------------------------------------------------
+  // particles
+  ret.slices.resize(ret.Nspecies);
+  if(staged) {
+    ret.fstore.resize(7*ret.Nspecies);
+    ret.istore.resize(2*ret.Nspecies);
+  }
+
+  for(int ispc=0; ispc<ret.Nspecies; ispc++) {
+    auto& sl = ret.slices[ispc];
+    sl.resize(ntiles);
+
+    size_t N = 0;
+    for(size_t t=0; t<ntiles; t++) {
+      const auto& container = tiles[t]->get_const_container(ispc);
+      sl[t].n = container.size();
+      for(size_t v=0; v<3; v++) sl[t].f[v]   = container.loc_data(v);
+      for(size_t v=0; v<3; v++) sl[t].f[3+v] = container.vel_data(v);
+      sl[t].f[6] = container.wgt_data();
+      for(size_t v=0; v<2; v++) sl[t].i[v]   = container.id_data(v);
+      N += sl[t].n;
+    }
+
+    if(!staged) continue;
+
+    // copy and point the slices to the copies
+    size_t i0 = 0;
+    for(size_t v=0; v<7; v++) ret.fstore[7*ispc + v].resize(N);
+    for(size_t v=0; v<2; v++) ret.istore[2*ispc + v].resize(N);
+
+    for(size_t t=0; t<ntiles; t++) {
+      for(size_t v=0; v<7; v++) {
+        float* dst = ret.fstore[7*ispc + v].data() + i0;
+        std::copy(sl[t].f[v], sl[t].f[v] + sl[t].n, dst);
+        sl[t].f[v] = dst;
+      }
+      for(size_t v=0; v<2; v++) {
+        int* dst = ret.istore[2*ispc + v].data() + i0;
+        std::copy(sl[t].i[v], sl[t].i[v] + sl[t].n, dst);
+        sl[t].i[v] = dst;
+      }
+      i0 += sl[t].n;
+    }
+  }
+
+  return ret;
+}
+
+
+/// write particles of all local tiles into one file
+//
+// Every species goes into one contiguous dataset per quantity. Tiles are
+// written directly from the particle containers without intermediate copies.
+template<size_t D>
+void write_particle_restart(
+    corgi::Grid<D>& grid,
+    const std::string& fname)
+{
+  collect_particle_restart(grid).write(fname);
+}
+
+
+} // end of namespace h5io
@@ -6,6 +6,9 @@
 template bool h5io::Writer::write(const emf::Tile<1>&, ezh5::File&); 
 template bool h5io::Writer::write(const emf::Tile<2>&, ezh5::File&); 
 template bool h5io::Writer::write(const emf::Tile<3>&, ezh5::File&); 
+template void h5io::Writer::stage(const emf::Tile<1>&, h5io::StagedFile&); 
+template void h5io::Writer::stage(const emf::Tile<2>&, h5io::StagedFile&); 
+template void h5io::Writer::stage(const emf::Tile<3>&, h5io::StagedFile&); 
 
 // vlv
 template bool h5io::Writer::write(const vlv::Tile<1>&   , ezh5::File&); 
@@ -11,6 +11,7 @@
 #include "core/vlv/amr/mesh.h"
 #include "core/pic/tile.h"
 #include "external/ezh5/src/ezh5.hpp"
+#include "io/async.h"
 
 
 namespace h5io {
@@ -85,6 +86,10 @@ class Writer {
     template<size_t D>
     bool write(const emf::Tile<D>& tile, ezh5::File& file);
 
+    /// copy tile data for writing later (see StagedFile)
+    template<size_t D>
+    void stage(const emf::Tile<D>& tile, StagedFile& out);
+
     //template<size_t D>
     //bool write2(const emf::Tile<D>& tile);
 
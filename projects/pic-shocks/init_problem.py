@@ -157,6 +157,25 @@ class Configuration_Shocks(Configuration):
             self.ey_ext = 0.0
             self.ez_ext = 0.0
 
+        # compact mpi particle messages; check decodes every message (debugging)
+        if not("compact_prtcl_msgs" in self.__dict__):
+            self.compact_prtcl_msgs = False
+
+        if not("check_prtcl_msgs" in self.__dict__):
+            self.check_prtcl_msgs = False
+
+        # write field and moment snapshots into one shared file with parallel hdf5
+        if not("parallel_io" in self.__dict__):
+            self.parallel_io = False
+
+        # write snapshots and restarts in a background io thread
+        if not("async_io" in self.__dict__):
+            self.async_io = False
+
+        # damp the fields in the push_e sweep instead of a separate pass
+        if not("fused_damping" in self.__dict__):
+            self.fused_damping = False
+
 
         # DONE
         if do_print:
@@ -257,6 +257,11 @@ class MovingInjector:
 
         #print(d0, conf.inj_startx*conf.c_omp)
 
+        # with fused damping the tiles are only flagged here and damped in push_e_damped
+        if conf.fused_damping:
+            for tile in pytools.tiles_local(grid):
+                tile.fused_damping = False
+
         # do not damp the early region when shock is still forming
         if d0 < conf.inj_startx*conf.c_omp: return
 
@@ -309,7 +314,11 @@ class MovingInjector:
                 #print('between; damping', d1, d0)
                 tile.fld1 = d1
                 tile.fld2 = d0
-                tile.damp_fields()
+
+                if conf.fused_damping:
+                    tile.fused_damping = True
+                else:
+                    tile.damp_fields()
 
         return 
 
@@ -8,6 +8,7 @@ import sys, os
 
 # runko + auxiliary modules
 import pytools  # runko python tools
+import pyrunko  # runko c++ bindings
 
 # problem specific modules
 from init_problem import Configuration_Shocks as Configuration
@@ -291,6 +292,12 @@ if __name__ == "__main__":
     # load virtual mpi halo tiles
     pytools.pic.load_virtual_tiles(sch.grid, conf)
 
+    # compact particle messages; set for all tiles since the receiver decodes with the sender's format
+    if conf.compact_prtcl_msgs:
+        for tile in pytools.tiles_all(sch.grid):
+            tile.compact_particle_messages = True
+            tile.check_particle_messages = conf.check_prtcl_msgs
+
 
     # --------------------------------------------------
     # load physics solvers
@@ -357,6 +364,11 @@ if __name__ == "__main__":
     # I/O objects
     if sch.is_master: print("loading IO objects..."); sys.stdout.flush()
 
+    # collective snapshot output needs hdf5 with mpi-io; fall back to rank 0 reductions
+    if conf.parallel_io and not(pyrunko.emf.has_parallel_hdf5()):
+        if sch.is_master: print("WARNING: hdf5 is not built with MPI-IO; parallel_io disabled")
+        conf.parallel_io = False
+
     # quick field snapshots
     #fld_writer = pyfld.MasterFieldsWriter(
     fld_writer = pyfld.FieldsWriter(
@@ -368,6 +380,7 @@ if __name__ == "__main__":
         conf.Nz,
         conf.NzMesh,
         conf.stride,
+        conf.parallel_io,
     )
 
 
@@ -401,7 +414,8 @@ if __name__ == "__main__":
         conf.NyMesh,
         conf.Nz,
         conf.NzMesh,
-        conf.stride_mom,)
+        conf.stride_mom,
+        conf.parallel_io,)
 
     # 3D box peripherals
     if conf.threeD:
@@ -418,6 +432,13 @@ if __name__ == "__main__":
         #slice_xz_writer.ind = int(0.0*conf.Ly) # side wall 1
         #slice_yz_writer.ind = int(0.0*conf.Lx) # side wall 2
 
+    # write snapshots in the background io thread while the laps continue
+    io_writers = [fld_writer, mom_writer] + prtcl_writers
+    if conf.threeD:
+        io_writers += [slice_xy_writer, slice_xz_writer, slice_yz_writer]
+    for writer in io_writers:
+        writer.async_io = conf.async_io
+
 
 
     # --------------------------------------------------
@@ -577,7 +598,11 @@ if __name__ == "__main__":
 
         # --------------------------------------------------
         # push E
-        sch.operate( dict(name='push_e',   solver='fldpropE', method='push_e',  nhood='local', ) )
+        if conf.fused_damping:
+            # E update and damping of the flagged tiles in one sweep
+            sch.operate( dict(name='push_e',   solver='fldpropE', method='push_e_damped', nhood='local', ) )
+        else:
+            sch.operate( dict(name='push_e',   solver='fldpropE', method='push_e',  nhood='local', ) )
         sch.operate( dict(name='wall_bc',  solver='lwall',    method='field_bc',nhood='local', ) )
 
         # --------------------------------------------------
@@ -642,6 +667,13 @@ if __name__ == "__main__":
                 print("------ lap: {} / t: {}".format(lap, time))
 
             sch.timer.stats("step")
+
+            # background io thread since the last interval; overlaps with the laps
+            io_busy, io_waited, io_jobs = pyrunko.emf.io_stats()
+            if io_jobs > 0:
+                sch.timer.add_comp("io_bg", io_busy)
+                sch.timer.add_comp("io_wait", io_waited)
+
             sch.timer.comp_stats()
             sch.timer.purge_comps()
 
@@ -715,8 +747,8 @@ if __name__ == "__main__":
             #--------------------------------------------------
             # deep IO
             if conf.full_interval > 0 and (lap % conf.full_interval == 0) and (lap > 0):
-                pyfld.write_grids(sch.grid, lap, conf.outdir + "/full_output/")
-                pypic.write_particles(sch.grid, lap, conf.outdir + "/full_output/")
+                pyfld.write_grids(sch.grid, lap, conf.outdir + "/full_output/", conf.async_io)
+                pypic.write_particles(sch.grid, lap, conf.outdir + "/full_output/", conf.async_io)
 
 
             # restart IO (overwrites)
@@ -727,15 +759,18 @@ if __name__ == "__main__":
 
                 pyfld.write_grids(
                     sch.grid, io_stat["deep_io_switch"] + io_stat['restart_num'],
-                    conf.outdir + "/restart/"
+                    conf.outdir + "/restart/",
+                    conf.async_io,
                 )
 
                 pypic.write_particles(
                     sch.grid, io_stat["deep_io_switch"] + io_stat['restart_num'],
-                    conf.outdir + "/restart/"
+                    conf.outdir + "/restart/",
+                    conf.async_io,
                 )
 
                 # if successful adjust info file
+                pyrunko.emf.wait_io()      # restart files need to be complete
                 MPI.COMM_WORLD.barrier()  # sync everybody in case of failure before write
                 if sch.grid.rank() == 0:
                     with open(conf.outdir + "/restart/laps.txt", "a") as lapfile:
@@ -761,6 +796,7 @@ if __name__ == "__main__":
 
     # --------------------------------------------------
     # end of simulation
+    pyrunko.emf.wait_io() # flush background output
 
     timer.stop("total")
     timer.stats("total")
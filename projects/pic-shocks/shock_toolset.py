@@ -340,12 +340,12 @@ class ShockToolset:
                 #print('total number of prtcls in this tile:', npp)
 
                 # get locations
-                xp = np.array(cont.loc(0))
+                xp = cont.loc_view(0)
 
                 # get four velocities
-                uxp = np.array(cont.vel(0))
-                uyp = np.array(cont.vel(1))
-                uzp = np.array(cont.vel(2))
+                uxp = cont.vel_view(0)
+                uyp = cont.vel_view(1)
+                uzp = cont.vel_view(2)
 
                 gam = np.sqrt(1.0 + uxp**2 + uyp**2 + uzp**2)
                 #betax = uxp/gam
@@ -82,6 +82,76 @@ class Configuration_Turbulence(Configuration):
         self.c_corr = 1.0 # no speed of light correction
         self.use_maxwell_split = False
 
+        # cell sorting of particles; 0 = off
+        if not("sort_interval" in self.__dict__):
+            self.sort_interval = 0
+
+        # halo-only mpi messages for fields and currents
+        if not("packed_halos" in self.__dict__):
+            self.packed_halos = False
+
+        # on-node mpi messages through a shared memory window (needs packed_halos for fields)
+        if not("shm_exchange" in self.__dict__):
+            self.shm_exchange = False
+        if not("shm_mbytes" in self.__dict__):
+            self.shm_mbytes = 64
+
+        # thread-private current deposit; pays off with many threads per tile
+        if not("private_currents" in self.__dict__):
+            self.private_currents = False
+
+        # fused interpolate-push-deposit kernel (linear + Higuera-Cary + zigzag)
+        if not("fused_kernel" in self.__dict__):
+            self.fused_kernel = False
+
+        # run the lap with the C++ TaskScheduler (threads over tiles, mpi overlapped with interior tiles)
+        if not("cpp_scheduler" in self.__dict__):
+            self.cpp_scheduler = False
+
+        # inject the initial plasma with the C++ BulkInjector (threads over tiles; same plasma for any rank count)
+        if not("cpp_injector" in self.__dict__):
+            self.cpp_injector = False
+
+        # explicitly vectorized pusher kernel with run-time AVX2/AVX-512 selection
+        if not("simd_pusher" in self.__dict__):
+            self.simd_pusher = False
+
+        # write field and moment snapshots into one shared file with parallel hdf5
+        if not("parallel_io" in self.__dict__):
+            self.parallel_io = False
+
+        # write snapshots and restarts in a background io thread
+        if not("async_io" in self.__dict__):
+            self.async_io = False
+
+        # laps of test particle history buffered between outputs; > 1 records every lap
+        if not("test_prtcl_laps" in self.__dict__):
+            self.test_prtcl_laps = 1
+
+        # laps between dynamic load balancing steps (multiple of interval); 0 keeps the initial tile layout
+        if not("balance_interval" in self.__dict__):
+            self.balance_interval = 0
+
+        # cost of one cell relative to one particle in the load balancing (initial guess)
+        if not("balance_cell_cost" in self.__dict__):
+            self.balance_cell_cost = 1.0
+
+        # shape function order of the moment snapshots (0 = nearest cell, 1 = cic, 2 = tsc)
+        if not("mom_shape" in self.__dict__):
+            self.mom_shape = 0
+
+        # half B and E field updates in one sweep (FDTD2/FDTD4); drops the B exchange in between
+        if not("fused_fields" in self.__dict__):
+            self.fused_fields = False
+
+        # all filter passes with one current exchange (MultiPassBinomial2); needs npasses <= tile size
+        if not("multipass_filter" in self.__dict__):
+            self.multipass_filter = False
+
+        # local pseudo-spectral field solver (PSATD); needs a build with ENABLE_FFTW
+        if not("spectral_fields" in self.__dict__):
+            self.spectral_fields = False
+
         # local variables just for easier/cleaner syntax
         me = np.abs(self.me)
         mi = np.abs(self.mi)
@@ -6,6 +6,7 @@ import sys, os
 
 # runko + auxiliary modules
 import pytools  # runko python tools
+import pyrunko  # runko c++ bindings
 
 # problem specific modules
 from init_problem import Configuration_Turbulence as Configuration
@@ -53,6 +54,213 @@ def insert_em_fields(grid, conf, do_initialization=True):
                             # TODO
     return
         
+#--------------------------------------------------
+# one lap of the simulation in python; one op at a time over tiles.
+# NOTE: build_lap_tasks mirrors these ops for the C++ TaskScheduler; keep them in sync
+def python_lap(sch, grid, conf, lap):
+
+    # --------------------------------------------------
+    # comm E and B
+    sch.operate( dict(name='mpi_b0', solver='mpi', method='b', ) )
+    sch.operate( dict(name='mpi_e0', solver='mpi', method='e', ) )
+    sch.operate( dict(name='upd_bc', solver='tile',method='update_boundaries', args=[grid,[1,2] ], nhood='local', ) )
+
+    # --------------------------------------------------
+    # push B half
+    sch.operate( dict(name='push_half_b1', solver='fldpropB', method='push_half_b', nhood='local',) )
+    #sch.operate( dict(name='wall_bc',      solver='lwall',    method='field_bc',    nhood='local',) )
+
+    # comm B
+    sch.operate( dict(name='mpi_b1',  solver='mpi', method='b',                 ) )
+    sch.operate( dict(name='upd_bc ', solver='tile',method='update_boundaries',args=[grid, [2,] ], nhood='local',) )
+
+    # --------------------------------------------------
+    # move particles (only locals tiles)
+
+    if conf.fused_kernel:
+        # interpolate, push, and deposit currents in one pass; currents are cleared first
+        # since the deposit happens already here
+        sch.operate( dict(name='clear_cur', solver='tile',   method='clear_current', nhood='all', ) )
+        sch.operate( dict(name='fused',     solver='fused',  method='solve', nhood='local', ) )
+    else:
+        # interpolate fields and push particles in x and u
+        sch.operate( dict(name='interp_em', solver='fintp',  method='solve', nhood='local', ) )
+        #sch.operate( dict(name='push',      solver='pusher', method='solve', nhood='local', ) )
+        sch.operate( dict(name='push',      solver='pusher', method='solve', nhood='local', args=[0]) ) # e^-
+        sch.operate( dict(name='push',      solver='pusher', method='solve', nhood='local', args=[1]) ) # e^+
+
+        # clear currents; need to call this before wall operations since they can deposit currents too 
+        sch.operate( dict(name='clear_cur', solver='tile',   method='clear_current', nhood='all', ) )
+
+    # apply moving/reflecting walls
+    #sch.operate( dict(name='walls',     solver='lwall', method='solve', nhood='local', ) )
+
+
+    if conf.fused_fields:
+        # advance half B (also in the halos) and push E in one sweep; no B exchange needed
+        sch.operate( dict(name='push_half_b_e', solver='fldpropB', method='push_half_b_e', nhood='local', ) )
+    else:
+        # --------------------------------------------------
+        # advance half B 
+        sch.operate( dict(name='push_half_b2', solver='fldpropB', method='push_half_b', nhood='local', ) )
+        #sch.operate( dict(name='wall_bc',      solver='lwall',    method='field_bc',    nhood='local', ) )
+
+        # comm B
+        sch.operate( dict(name='mpi_b2', solver='mpi', method='b',                 ) )
+        sch.operate( dict(name='upd_bc', solver='tile',method='update_boundaries', args=[grid, [2,] ], nhood='local',) )
+
+
+        # --------------------------------------------------
+        # push E
+        sch.operate( dict(name='push_e',   solver='fldpropE', method='push_e',  nhood='local', ) )
+        #sch.operate( dict(name='wall_bc',  solver='lwall',    method='field_bc',nhood='local', ) )
+
+    # TODO current deposit + MPI was here
+
+    # --------------------------------------------------
+    # particle communication (only local/boundary tiles)
+
+    # local and global particle exchange 
+    sch.operate( dict(name='check_outg_prtcls',     solver='tile',  method='check_outgoing_particles',     nhood='local', ) )
+    sch.operate( dict(name='pack_outg_prtcls',      solver='tile',  method='pack_outgoing_particles',      nhood='boundary', ) )
+
+    sch.operate( dict(name='mpi_prtcls',            solver='mpi',   method='p1',                           nhood='all', ) )
+    sch.operate( dict(name='mpi_prtcls',            solver='mpi',   method='p2',                           nhood='all', ) )
+
+    sch.operate( dict(name='unpack_vir_prtcls',     solver='tile',  method='unpack_incoming_particles',    nhood='virtual', ) )
+    sch.operate( dict(name='check_outg_vir_prtcls', solver='tile',  method='check_outgoing_particles',     nhood='virtual', ) )
+    sch.operate( dict(name='get_inc_prtcls',        solver='tile',  method='get_incoming_particles',       nhood='local', args=[grid,]) )
+
+    sch.operate( dict(name='del_trnsfrd_prtcls',    solver='tile',  method='delete_transferred_particles', nhood='local', ) )
+    sch.operate( dict(name='del_vir_prtcls',        solver='tile',  method='delete_all_particles',         nhood='virtual', ) )
+
+    # reorder particles by cell; interpolator and depositer then walk the particles cell by cell 
+    # and reuse the field stencil. Incremental sort is cheap since only few particles change cell per lap.
+    if conf.sort_interval > 0 and (lap % conf.sort_interval == 0):
+        sch.operate( dict(name='sort_prtcls',       solver='tile',  method='sort_particles_in_cells',      nhood='local', args=[False,]) )
+
+    # --------------------------------------------------
+    # current calculation; charge conserving current deposition
+    # clear virtual current arrays for boundary addition after mpi, send currents, and exchange between tiles
+    if not(conf.fused_kernel):
+        sch.operate( dict(name='comp_curr', solver='currint', method='solve', nhood='local', ) )
+    sch.operate( dict(name='clear_vir_cur', solver='tile',method='clear_current',     nhood='virtual', ) )
+    sch.operate( dict(name='mpi_cur',       solver='mpi', method='j',                 nhood='all', ) )
+    sch.operate( dict(name='cur_exchange',  solver='tile',method='exchange_currents', nhood='local', args=[grid,], ) )
+
+    # --------------------------------------------------
+    # filter
+    if conf.multipass_filter and conf.npasses > 0:
+        # one exchange; all passes are run on npasses deep halos read from the neighbors
+        sch.operate( dict(name='mpi_cur_flt', solver='mpi', method='j', ) )
+        sch.operate( dict(name='filter',      solver='flt', method='compute', nhood='local', args=[grid,], ) )
+        sch.operate( dict(name='filter_set',  solver='flt', method='solve',   nhood='local', ) )
+    else:
+        for fj in range(conf.npasses):
+
+            # flt uses halo=2 padding so only every 3rd (0,1,2) pass needs update
+            if fj % 2 == 0:
+                sch.operate( dict(name='mpi_cur_flt', solver='mpi', method='j', ) )
+                sch.operate( dict(name='upd_bc',      solver='tile',method='update_boundaries',args=[grid, [0,] ], nhood='local', ) )
+                MPI.COMM_WORLD.barrier()
+            sch.operate( dict(name='filter', solver='flt', method='solve', nhood='local', ) )
+
+
+    # --------------------------------------------------
+    # add antenna contribution
+    sch.antenna.update_rnd_phases()
+    #antenna.get_brms(grid) # debug tracking
+    sch.operate( dict(name='add_antenna', solver='antenna', method='add_ext_cur', nhood='local', ) )
+
+    # --------------------------------------------------
+    # add current to E
+    sch.operate( dict(name='add_cur', solver='tile', method='deposit_current', nhood='local', ) )
+    #operate( dict(name='wall_bc', solver='lwall', method='field_bc', nhood='local', ) )
+
+
+#--------------------------------------------------
+# ops of python_lap for a C++ TaskScheduler (pyrunko.pic.*.TaskScheduler); 
+# one call per sch.operate. With sort=True the lap also sorts the particles by cell.
+# NOTE: the antenna phases need to be updated before every run of the tasks.
+def build_lap_tasks(tasks, sch, conf, sort=False):
+    tasks.clear()
+
+    # comm E and B
+    tasks.add_mpi('mpi_b0', 'b')
+    tasks.add_mpi('mpi_e0', 'e')
+    tasks.add_tile_op('upd_bc', 'update_boundaries', 'local', [1,2])
+
+    # push B half
+    tasks.add_solver('push_half_b1', sch.fldpropB, 'push_half_b', 'local')
+
+    # comm B
+    tasks.add_mpi('mpi_b1', 'b')
+    tasks.add_tile_op('upd_bc ', 'update_boundaries', 'local', [2])
+
+    # move particles
+    if conf.fused_kernel:
+        tasks.add_tile_op('clear_cur', 'clear_current', 'all')
+        tasks.add_solver('fused', sch.fused, 'local')
+    else:
+        tasks.add_solver('interp_em', sch.fintp, 'local')
+        tasks.add_solver('push', sch.pusher, 'local', 0) # e^-
+        tasks.add_solver('push', sch.pusher, 'local', 1) # e^+
+        tasks.add_tile_op('clear_cur', 'clear_current', 'all')
+
+    if conf.fused_fields:
+        tasks.add_solver('push_half_b_e', sch.fldpropB, 'push_half_b_e', 'local')
+    else:
+        # advance half B 
+        tasks.add_solver('push_half_b2', sch.fldpropB, 'push_half_b', 'local')
+
+        # comm B
+        tasks.add_mpi('mpi_b2', 'b')
+        tasks.add_tile_op('upd_bc', 'update_boundaries', 'local', [2])
+
+        # push E
+        tasks.add_solver('push_e', sch.fldpropE, 'push_e', 'local')
+
+    # local and global particle exchange 
+    tasks.add_tile_op('check_outg_prtcls',     'check_outgoing_particles',     'local')
+    tasks.add_tile_op('pack_outg_prtcls',      'pack_outgoing_particles',      'boundary')
+
+    tasks.add_mpi('mpi_prtcls', 'p1')
+    tasks.add_mpi('mpi_prtcls', 'p2')
+
+    tasks.add_tile_op('unpack_vir_prtcls',     'unpack_incoming_particles',    'virtual')
+    tasks.add_tile_op('check_outg_vir_prtcls', 'check_outgoing_particles',     'virtual')
+    tasks.add_tile_op('get_inc_prtcls',        'get_incoming_particles',       'local')
+
+    tasks.add_tile_op('del_trnsfrd_prtcls',    'delete_transferred_particles', 'local')
+    tasks.add_tile_op('del_vir_prtcls',        'delete_all_particles',         'virtual')
+
+    if sort:
+        tasks.add_tile_op('sort_prtcls', 'sort_particles_in_cells', 'local', [0])
+
+    # current calculation and exchange
+    if not(conf.fused_kernel):
+        tasks.add_solver('comp_curr', sch.currint, 'local')
+    tasks.add_tile_op('clear_vir_cur', 'clear_current',     'virtual')
+    tasks.add_mpi('mpi_cur', 'j')
+    tasks.add_tile_op('cur_exchange',  'exchange_currents', 'local')
+
+    # filter; the mpi wait replaces the barrier of the python lap
+    if conf.multipass_filter and conf.npasses > 0:
+        tasks.add_mpi('mpi_cur_flt', 'j')
+        tasks.add_solver('filter',     sch.flt, 'compute', 'local')
+        tasks.add_solver('filter_set', sch.flt, 'solve',   'local')
+    else:
+        for fj in range(conf.npasses):
+            if fj % 2 == 0:
+                tasks.add_mpi('mpi_cur_flt', 'j')
+                tasks.add_tile_op('upd_bc', 'update_boundaries', 'local', [0])
+            tasks.add_solver('filter', sch.flt, 'local')
+
+    # antenna (python; ends the overlap window) and current to E
+    tasks.add_op('add_antenna', sch.antenna, 'add_ext_cur', 'local')
+    tasks.add_tile_op('add_cur', 'deposit_current', 'local')
+
+
 #-------------------------------------------------- 
 #-------------------------------------------------- 
 #-------------------------------------------------- 
@@ -139,7 +347,25 @@ if __name__ == "__main__":
         np.random.seed(rseed + rnd_seed_default)  # sync rnd generator seed for different mpi ranks
 
         # injecting plasma particles
-        if not(conf.use_injector):
+        if not(conf.use_injector) and conf.cpp_injector:
+            # same thermal pair plasma as velocity_profile and density_profile below; no photons
+            assert conf.Nspecies == 2, "cpp_injector supports only e-/e+ plasma"
+
+            for tile in pytools.tiles_local(grid):
+                for ispcs in range(conf.Nspecies):
+                    tile.get_container(ispcs).type = conf.prtcl_types[ispcs] 
+
+            inj = pypic.BulkInjector(seed=rnd_seed_default)
+            inj.add_species(0, conf.ppc, conf.delgam_e)
+            inj.add_species(1, conf.ppc, conf.delgam_i)
+            prtcl_stat = inj.inject(grid)
+
+            if sch.is_example_worker: 
+                print("injected:")
+                print("     e- prtcls: {}".format(prtcl_stat[0]))
+                print("     e+ prtcls: {}".format(prtcl_stat[1]))
+
+        elif not(conf.use_injector):
             prtcl_stat = pytools.pic.inject(grid, velocity_profile, density_profile, conf)
             if sch.is_example_worker: 
                 print("injected:")
@@ -216,6 +442,14 @@ if __name__ == "__main__":
     # load virtual mpi halo tiles
     pytools.pic.load_virtual_tiles(grid, conf)
 
+    # send only the halo regions in mpi field and current messages
+    if conf.packed_halos:
+        sch.set_packed_halos(max(3, conf.npasses) if conf.multipass_filter else 3)
+
+    # read messages of ranks on the same node from shared memory
+    if conf.shm_exchange:
+        sch.set_shm_exchange(conf.shm_mbytes)
+
 
     # --------------------------------------------------
     # load physics solvers
@@ -228,6 +462,16 @@ if __name__ == "__main__":
     #sch.fldpropE = pyfld.FDTD4()
     #sch.fldpropB = pyfld.FDTD4()
 
+    if conf.spectral_fields:
+        if hasattr(pyfld, "PSATD"):
+            # one solver for both; it keeps the fft plans of the tile size
+            sch.fldpropE = pyfld.PSATD()
+            sch.fldpropB = sch.fldpropE
+            conf.fused_fields = False
+        else:
+            if sch.is_master: print("WARNING: pyrunko built without fftw; using FDTD2")
+            conf.spectral_fields = False
+
     # enhance numerical speed of light slightly to suppress numerical Cherenkov instability
     sch.fldpropE.corr = conf.c_corr
     sch.fldpropB.corr = conf.c_corr
@@ -241,6 +485,9 @@ if __name__ == "__main__":
     sch.pusher = pypic.HigueraCaryPusher()
     #sch.pusher  = pypic.rGCAPusher()
 
+    # explicitly vectorized push (boris, vay, and higuera-cary only)
+    sch.pusher.use_simd = conf.simd_pusher
+
     #if conf.gammarad > 0:
     #    sch.pusher   = pypic.BorisDragPusher()
     #    sch.pusher.drag = conf.drag_amplitude
@@ -273,15 +520,54 @@ if __name__ == "__main__":
     #sch.currint = pypic.Esikerpov_2nd() # 3d only
     #sch.currint = pypic.Esikerpov_4th() # 3d only
 
+    # thread-private current arrays instead of atomics (zigzag depositers only)
+    sch.currint.private_currents = conf.private_currents
+
+    # --------------------------------------------------
+    # fused linear interpolator + pusher + zigzag depositer in one pass over the particles;
+    # replaces the fintp, pusher, and currint calls of the lap loop
+    if conf.fused_kernel:
+        sch.fused = pypic.FusedHigueraCaryZigZag()
+        sch.fused.private_currents = conf.private_currents
+
+        if conf.use_maxwell_split:
+            sch.fused.bx_ext = conf.bx_ext 
+            sch.fused.by_ext = conf.by_ext
+            sch.fused.bz_ext = conf.bz_ext
+
+            sch.fused.ex_ext = conf.ex_ext 
+            sch.fused.ey_ext = conf.ey_ext
+            sch.fused.ez_ext = conf.ez_ext
+
     # --------------------------------------------------
     #filter
-    sch.flt = pyfld.Binomial2(conf.NxMesh, conf.NyMesh, conf.NzMesh)
+    if conf.multipass_filter:
+        sch.flt = pyfld.MultiPassBinomial2(conf.NxMesh, conf.NyMesh, conf.NzMesh, conf.npasses)
+    else:
+        sch.flt = pyfld.Binomial2(conf.NxMesh, conf.NyMesh, conf.NzMesh)
 
 
+    # --------------------------------------------------
+    # C++ lap scheduler; separate lap with particle sorting
+    if conf.cpp_scheduler:
+        lap_tasks = pypic.TaskScheduler(grid)
+        lap_tasks.shm_exchange = conf.shm_exchange
+        build_lap_tasks(lap_tasks, sch, conf, sort=False)
+
+        if conf.sort_interval > 0:
+            lap_tasks_sort = pypic.TaskScheduler(grid)
+            lap_tasks_sort.shm_exchange = conf.shm_exchange
+            build_lap_tasks(lap_tasks_sort, sch, conf, sort=True)
+
     # --------------------------------------------------
     # I/O objects
     if sch.is_master: print("loading IO objects..."); sys.stdout.flush()
 
+    # collective snapshot output needs hdf5 with mpi-io; fall back to rank 0 reductions
+    if conf.parallel_io and not(pyrunko.emf.has_parallel_hdf5()):
+        if sch.is_master: print("WARNING: hdf5 is not built with MPI-IO; parallel_io disabled")
+        conf.parallel_io = False
+
     # quick field snapshots
     #fld_writer = pyfld.MasterFieldsWriter(
     fld_writer = pyfld.FieldsWriter(
@@ -293,6 +579,7 @@ if __name__ == "__main__":
         conf.Nz,
         conf.NzMesh,
         conf.stride,
+        conf.parallel_io,
     )
 
 
@@ -310,7 +597,8 @@ if __name__ == "__main__":
                 conf.Nx, conf.NxMesh, conf.Ny, conf.NyMesh, conf.Nz, conf.NzMesh,
                 conf.ppc,
                 n_local_tiles, #len(grid.get_local_tiles()),
-                conf.n_test_prtcls,)
+                conf.n_test_prtcls,
+                conf.test_prtcl_laps,)
         prtcl_writer.ispc = ispc
         prtcl_writers.append(prtcl_writer)
 
@@ -326,7 +614,9 @@ if __name__ == "__main__":
         conf.Nz,
         conf.NzMesh,
         conf.stride_mom,
+        conf.parallel_io,
     )
+    mom_writer.shape = conf.mom_shape
 
     # 3D box peripherals
     if conf.threeD:
@@ -343,6 +633,13 @@ if __name__ == "__main__":
         slice_xz_writer.ind = int(0.0*conf.Ly) # side wall 1
         slice_yz_writer.ind = int(0.0*conf.Lx) # side wall 2
 
+    # write snapshots in the background io thread while the laps continue
+    io_writers = [fld_writer, mom_writer] + prtcl_writers
+    if conf.threeD:
+        io_writers += [slice_xy_writer, slice_xz_writer, slice_yz_writer]
+    for writer in io_writers:
+        writer.async_io = conf.async_io
+
     # --------------------------------------------------
     # --------------------------------------------------
     # --------------------------------------------------
@@ -360,107 +657,30 @@ if __name__ == "__main__":
     time = lap * (conf.cfl / conf.c_omp)
     for lap in range(lap, conf.Nt + 1):
 
-        # --------------------------------------------------
-        # comm E and B
-        sch.operate( dict(name='mpi_b0', solver='mpi', method='b', ) )
-        sch.operate( dict(name='mpi_e0', solver='mpi', method='e', ) )
-        sch.operate( dict(name='upd_bc', solver='tile',method='update_boundaries', args=[grid,[1,2] ], nhood='local', ) )
-
-        # --------------------------------------------------
-        # push B half
-        sch.operate( dict(name='push_half_b1', solver='fldpropB', method='push_half_b', nhood='local',) )
-        #sch.operate( dict(name='wall_bc',      solver='lwall',    method='field_bc',    nhood='local',) )
-
-        # comm B
-        sch.operate( dict(name='mpi_b1',  solver='mpi', method='b',                 ) )
-        sch.operate( dict(name='upd_bc ', solver='tile',method='update_boundaries',args=[grid, [2,] ], nhood='local',) )
-
-        # --------------------------------------------------
-        # move particles (only locals tiles)
-
-        # interpolate fields and push particles in x and u
-        sch.operate( dict(name='interp_em', solver='fintp',  method='solve', nhood='local', ) )
-        #sch.operate( dict(name='push',      solver='pusher', method='solve', nhood='local', ) )
-        sch.operate( dict(name='push',      solver='pusher', method='solve', nhood='local', args=[0]) ) # e^-
-        sch.operate( dict(name='push',      solver='pusher', method='solve', nhood='local', args=[1]) ) # e^+
-
-
-        # clear currents; need to call this before wall operations since they can deposit currents too 
-        sch.operate( dict(name='clear_cur', solver='tile',   method='clear_current', nhood='all', ) )
-
-        # apply moving/reflecting walls
-        #sch.operate( dict(name='walls',     solver='lwall', method='solve', nhood='local', ) )
+        # whole lap in C++
+        if conf.cpp_scheduler:
+            sch.antenna.update_rnd_phases()
 
+            if conf.sort_interval > 0 and (lap % conf.sort_interval == 0):
+                sch.run_tasks(lap_tasks_sort)
+            else:
+                sch.run_tasks(lap_tasks)
 
-        # --------------------------------------------------
-        # advance half B 
-        sch.operate( dict(name='push_half_b2', solver='fldpropB', method='push_half_b', nhood='local', ) )
-        #sch.operate( dict(name='wall_bc',      solver='lwall',    method='field_bc',    nhood='local', ) )
-
-        # comm B
-        sch.operate( dict(name='mpi_b2', solver='mpi', method='b',                 ) )
-        sch.operate( dict(name='upd_bc', solver='tile',method='update_boundaries', args=[grid, [2,] ], nhood='local',) )
-
-
-        # --------------------------------------------------
-        # push E
-        sch.operate( dict(name='push_e',   solver='fldpropE', method='push_e',  nhood='local', ) )
-        #sch.operate( dict(name='wall_bc',  solver='lwall',    method='field_bc',nhood='local', ) )
-
-        # TODO current deposit + MPI was here
-
-        # --------------------------------------------------
-        # particle communication (only local/boundary tiles)
-
-        # local and global particle exchange 
-        sch.operate( dict(name='check_outg_prtcls',     solver='tile',  method='check_outgoing_particles',     nhood='local', ) )
-        sch.operate( dict(name='pack_outg_prtcls',      solver='tile',  method='pack_outgoing_particles',      nhood='boundary', ) )
-
-        sch.operate( dict(name='mpi_prtcls',            solver='mpi',   method='p1',                           nhood='all', ) )
-        sch.operate( dict(name='mpi_prtcls',            solver='mpi',   method='p2',                           nhood='all', ) )
-
-        sch.operate( dict(name='unpack_vir_prtcls',     solver='tile',  method='unpack_incoming_particles',    nhood='virtual', ) )
-        sch.operate( dict(name='check_outg_vir_prtcls', solver='tile',  method='check_outgoing_particles',     nhood='virtual', ) )
-        sch.operate( dict(name='get_inc_prtcls',        solver='tile',  method='get_incoming_particles',       nhood='local', args=[grid,]) )
-
-        sch.operate( dict(name='del_trnsfrd_prtcls',    solver='tile',  method='delete_transferred_particles', nhood='local', ) )
-        sch.operate( dict(name='del_vir_prtcls',        solver='tile',  method='delete_all_particles',         nhood='virtual', ) )
-
-        # --------------------------------------------------
-        # current calculation; charge conserving current deposition
-        # clear virtual current arrays for boundary addition after mpi, send currents, and exchange between tiles
-        sch.operate( dict(name='comp_curr', solver='currint', method='solve', nhood='local', ) )
-        sch.operate( dict(name='clear_vir_cur', solver='tile',method='clear_current',     nhood='virtual', ) )
-        sch.operate( dict(name='mpi_cur',       solver='mpi', method='j',                 nhood='all', ) )
-        sch.operate( dict(name='cur_exchange',  solver='tile',method='exchange_currents', nhood='local', args=[grid,], ) )
-
-        # --------------------------------------------------
-        # filter
-        for fj in range(conf.npasses):
-
-            # flt uses halo=2 padding so only every 3rd (0,1,2) pass needs update
-            if fj % 2 == 0:
-                sch.operate( dict(name='mpi_cur_flt', solver='mpi', method='j', ) )
-                sch.operate( dict(name='upd_bc',      solver='tile',method='update_boundaries',args=[grid, [0,] ], nhood='local', ) )
-                MPI.COMM_WORLD.barrier()
-            sch.operate( dict(name='filter', solver='flt', method='solve', nhood='local', ) )
-
-
-        # --------------------------------------------------
-        # add antenna contribution
-        sch.antenna.update_rnd_phases()
-        #antenna.get_brms(grid) # debug tracking
-        sch.operate( dict(name='add_antenna', solver='antenna', method='add_ext_cur', nhood='local', ) )
-
-        # --------------------------------------------------
-        # add current to E
-        sch.operate( dict(name='add_cur', solver='tile', method='deposit_current', nhood='local', ) )
-        #operate( dict(name='wall_bc', solver='lwall', method='field_bc', nhood='local', ) )
+        # python lap; one op at a time over tiles
+        else:
+            python_lap(sch, grid, conf, lap)
 
 
         ##################################################
         # data reduction and I/O
 
+        # test particle histories; only the tracked particles are visited
+        if conf.test_prtcl_laps > 1:
+            t1 = timer.start_comp("prtcl_rec")
+            for pw in prtcl_writers:
+                pw.record(grid, lap)
+            timer.stop_comp(t1)
+
         timer.lap("step")
         if lap % conf.interval == 0:
             if sch.is_master:
@@ -468,7 +688,21 @@ if __name__ == "__main__":
                 print("------ lap: {} / t: {}".format(lap, time))
 
             timer.stats("step")
+
+            # background io thread since the last interval; overlaps with the laps
+            io_busy, io_waited, io_jobs = pyrunko.emf.io_stats()
+            if io_jobs > 0:
+                timer.add_comp("io_bg", io_busy)
+                timer.add_comp("io_wait", io_waited)
+
             timer.comp_stats()
+
+            # dynamic load balancing; cost model fitted from the work since the last interval
+            if conf.balance_interval > 0 and lap % conf.balance_interval == 0:
+                lba = pytools.pic.rebalance(grid, conf, t_work=timer.comp_total(), do_print=sch.is_master)
+                if lba["moved"] > 0 and conf.packed_halos:
+                    sch.set_packed_halos()
+
             timer.purge_comps()
 
             # io/analyze (independent)
@@ -520,8 +754,8 @@ if __name__ == "__main__":
             #--------------------------------------------------
             # deep IO
             if conf.full_interval > 0 and (lap % conf.full_interval == 0) and (lap > 0):
-                pyfld.write_grids(grid, lap, conf.outdir + "/full_output/")
-                pypic.write_particles(grid, lap, conf.outdir + "/full_output/")
+                pyfld.write_grids(grid, lap, conf.outdir + "/full_output/", conf.async_io)
+                pypic.write_particles(grid, lap, conf.outdir + "/full_output/", conf.async_io)
 
 
             # restart IO (overwrites)
@@ -532,15 +766,18 @@ if __name__ == "__main__":
 
                 pyfld.write_grids(
                     grid, io_stat["deep_io_switch"] + io_stat['restart_num'],
-                    conf.outdir + "/restart/"
+                    conf.outdir + "/restart/",
+                    conf.async_io,
                 )
 
                 pypic.write_particles(
                     grid, io_stat["deep_io_switch"] + io_stat['restart_num'],
-                    conf.outdir + "/restart/"
+                    conf.outdir + "/restart/",
+                    conf.async_io,
                 )
 
                 # if successful adjust info file
+                pyrunko.emf.wait_io()      # restart files need to be complete
                 MPI.COMM_WORLD.barrier()  # sync everybody in case of failure before write
                 if grid.rank() == 0:
                     with open(conf.outdir + "/restart/laps.txt", "a") as lapfile:
@@ -566,6 +803,7 @@ if __name__ == "__main__":
 
     # --------------------------------------------------
     # end of simulation
+    pyrunko.emf.wait_io() # flush background output
 
     timer.stop("total")
     timer.stats("total")
@@ -0,0 +1,153 @@
+# -*- coding: utf-8 -*-
+
+# Micro-benchmark of the cell-ordered particle mode and the fused kernel.
+#
+# Fills one 3D tile with particles at random (unordered) locations and
+# measures the time per particle update of the interpolate-push-deposit
+# cycle with and without cell sorting. In the sorted mode the particles
+# are re-sorted incrementally every lap, just like in the main lap loop.
+# The fused mode does the whole cycle in one pass (FusedBorisZigZag).
+#
+# usage: python3 cell_sorting.py [NxMesh] [ppc] [laps]
+
+import sys
+import time
+import numpy as np
+
+import pycorgi
+import pyrunko
+import pytools
+
+
+class Conf:
+    Nx = 1
+    Ny = 1
+    Nz = 1
+
+    NxMesh = 32
+    NyMesh = 32
+    NzMesh = 32
+
+    xmin = 0.0
+    ymin = 0.0
+    zmin = 0.0
+
+    cfl = 0.45
+    ppc = 32
+    vel = 0.1
+
+    me = -1.0
+    mi =  1.0
+    qe = -1.0
+
+    Nspecies = 2
+    laps = 10
+
+    oneD   = False
+    twoD   = False
+    threeD = True
+
+
+def load_particles(tile, conf, rng):
+    N = conf.NxMesh*conf.NyMesh*conf.NzMesh*conf.ppc
+
+    # keep a margin of 1 cell so that the particles stay inside
+    # the tile during the benchmark
+    lo = 1.0
+    hi = np.array([conf.NxMesh, conf.NyMesh, conf.NzMesh]) - 1.0
+
+    for ispcs in range(conf.Nspecies):
+        container = tile.get_container(ispcs)
+        container.reserve(N)
+
+        xs = lo + (hi - lo)*rng.random((N,3))
+        us = conf.vel*(2.0*rng.random((N,3)) - 1.0)
+
+        for n in range(N):
+            container.add_particle(xs[n,:].tolist(), us[n,:].tolist(), 1.0)
+
+
+def run(conf, mode):
+    rng = np.random.default_rng(42)
+
+    grid = pycorgi.threeD.Grid(conf.Nx, conf.Ny, conf.Nz)
+    grid.set_grid_lims(
+            0.0, conf.Nx*conf.NxMesh,
+            0.0, conf.Ny*conf.NyMesh,
+            0.0, conf.Nz*conf.NzMesh)
+    pytools.pic.load_tiles(grid, conf)
+
+    tile = grid.get_tile(0,0,0)
+    load_particles(tile, conf, rng)
+
+    # some non-zero fields
+    gs = tile.get_grids(0)
+    for k in range(conf.NzMesh):
+        for j in range(conf.NyMesh):
+            for i in range(conf.NxMesh):
+                gs.ex[i,j,k] = 0.01*np.sin(0.1*i)
+                gs.by[i,j,k] = 0.01*np.cos(0.1*j)
+                gs.bz[i,j,k] = 0.1
+
+    fintp   = pyrunko.pic.threeD.LinearInterpolator()
+    pusher  = pyrunko.pic.threeD.BorisPusher()
+    currint = pyrunko.pic.threeD.ZigZag()
+
+    fused = pyrunko.pic.threeD.FusedBorisZigZag()
+
+    sort = mode == "sorted"
+    if sort:
+        tile.sort_particles_in_cells(True)
+
+    t = {'interp':0.0, 'push':0.0, 'sort':0.0, 'deposit':0.0}
+    for lap in range(conf.laps):
+        if mode == "fused":
+            t0 = time.perf_counter()
+            fused.solve(tile)
+            t['push'] += time.perf_counter() - t0
+            continue
+
+        t0 = time.perf_counter()
+        fintp.solve(tile)
+
+        t1 = time.perf_counter()
+        pusher.solve(tile)
+
+        t2 = time.perf_counter()
+        if sort:
+            tile.sort_particles_in_cells(False)
+
+        t3 = time.perf_counter()
+        currint.solve(tile)
+        t4 = time.perf_counter()
+
+        t['interp']  += t1 - t0
+        t['push']    += t2 - t1
+        t['sort']    += t3 - t2
+        t['deposit'] += t4 - t3
+
+    return t
+
+
+if __name__ == "__main__":
+    conf = Conf()
+    if len(sys.argv) > 1: conf.NxMesh = conf.NyMesh = conf.NzMesh = int(sys.argv[1])
+    if len(sys.argv) > 2: conf.ppc  = int(sys.argv[2])
+    if len(sys.argv) > 3: conf.laps = int(sys.argv[3])
+
+    Nupdates = conf.Nspecies*conf.ppc*conf.NxMesh*conf.NyMesh*conf.NzMesh*conf.laps
+
+    print("tile {}^3, ppc {}, species {}, laps {}".format(
+        conf.NxMesh, conf.ppc, conf.Nspecies, conf.laps))
+    print("{:>10s} {:>10s} {:>10s} {:>10s} {:>10s} {:>10s}".format(
+        "mode", "interp", "push", "sort", "deposit", "total"))
+
+    for mode in ["unsorted", "sorted", "fused"]:
+        t = run(conf, mode)
+        tot = sum(t.values())
+
+        # ns per particle update
+        fmt = lambda x: 1.0e9*x/Nupdates
+        print("{:>10s} {:10.2f} {:10.2f} {:10.2f} {:10.2f} {:10.2f}  ns/prtcl".format(
+            mode,
+            fmt(t['interp']), fmt(t['push']), fmt(t['sort']), fmt(t['deposit']), fmt(tot)))
@@ -0,0 +1,125 @@
+# -*- coding: utf-8 -*-
+
+# Micro-benchmark of the current deposit with atomic adds vs. thread-private
+# current arrays (depositer.private_currents).
+#
+# Fills one 3D tile with particles at random locations and measures the
+# time per particle of the zigzag depositers. The script re-launches itself
+# with OMP_NUM_THREADS set to each of the requested thread counts.
+#
+# usage: python3 current_deposit.py [NxMesh] [ppc] [laps] [threads,...]
+
+import os
+import sys
+import time
+import subprocess
+import numpy as np
+
+import pycorgi
+import pyrunko
+import pytools
+
+
+class Conf:
+    Nx = 1
+    Ny = 1
+    Nz = 1
+
+    NxMesh = 32
+    NyMesh = 32
+    NzMesh = 32
+
+    xmin = 0.0
+    ymin = 0.0
+    zmin = 0.0
+
+    cfl = 0.45
+    ppc = 32
+    vel = 0.1
+
+    me = -1.0
+    mi =  1.0
+    qe = -1.0
+
+    Nspecies = 2
+    laps = 10
+
+    oneD   = False
+    twoD   = False
+    threeD = True
+
+
+def load_particles(tile, conf, rng):
+    N = conf.NxMesh*conf.NyMesh*conf.NzMesh*conf.ppc
+
+    # keep a margin of 1 cell so that the stencils stay inside the halos
+    lo = 1.0
+    hi = np.array([conf.NxMesh, conf.NyMesh, conf.NzMesh]) - 1.0
+
+    for ispcs in range(conf.Nspecies):
+        container = tile.get_container(ispcs)
+        container.reserve(N)
+
+        xs = lo + (hi - lo)*rng.random((N,3))
+        us = conf.vel*(2.0*rng.random((N,3)) - 1.0)
+
+        for n in range(N):
+            container.add_particle(xs[n,:].tolist(), us[n,:].tolist(), 1.0)
+
+
+def run(conf):
+    rng = np.random.default_rng(42)
+
+    grid = pycorgi.threeD.Grid(conf.Nx, conf.Ny, conf.Nz)
+    grid.set_grid_lims(
+            0.0, conf.Nx*conf.NxMesh,
+            0.0, conf.Ny*conf.NyMesh,
+            0.0, conf.Nz*conf.NzMesh)
+    pytools.pic.load_tiles(grid, conf)
+
+    tile = grid.get_tile(0,0,0)
+    load_particles(tile, conf, rng)
+
+    Nupdates = conf.Nspecies*conf.ppc*conf.NxMesh*conf.NyMesh*conf.NzMesh*conf.laps
+    nthreads = os.environ.get("OMP_NUM_THREADS", "-")
+
+    for name in ["ZigZag", "ZigZag_2nd", "ZigZag_3rd", "ZigZag_4th"]:
+        for private in [False, True]:
+            currint = getattr(pyrunko.pic.threeD, name)()
+            currint.private_currents = private
+
+            currint.solve(tile) # warm-up; allocates the scratch arrays
+
+            t0 = time.perf_counter()
+            for lap in range(conf.laps):
+                currint.solve(tile)
+            t1 = time.perf_counter()
+
+            # ns per particle update
+            print("{:>8s} {:>12s} {:>10s} {:10.2f}  ns/prtcl".format(
+                nthreads, name, "private" if private else "atomic", 1.0e9*(t1-t0)/Nupdates))
+            sys.stdout.flush()
+
+
+if __name__ == "__main__":
+    conf = Conf()
+    if len(sys.argv) > 1: conf.NxMesh = conf.NyMesh = conf.NzMesh = int(sys.argv[1])
+    if len(sys.argv) > 2: conf.ppc  = int(sys.argv[2])
+    if len(sys.argv) > 3: conf.laps = int(sys.argv[3])
+
+    # child process; thread count is already fixed
+    if "RUNKO_BENCH_CHILD" in os.environ:
+        run(conf)
+        sys.exit(0)
+
+    threads = [1, 8, 64]
+    if len(sys.argv) > 4: threads = [int(t) for t in sys.argv[4].split(",")]
+
+    print("tile {}^3, ppc {}, species {}, laps {}".format(
+        conf.NxMesh, conf.ppc, conf.Nspecies, conf.laps))
+    print("{:>8s} {:>12s} {:>10s} {:>10s}".format("threads", "depositer", "mode", "time"))
+    sys.stdout.flush()
+
+    for nt in threads:
+        env = dict(os.environ, OMP_NUM_THREADS=str(nt), RUNKO_BENCH_CHILD="1")
+        subprocess.run([sys.executable] + sys.argv[:4], env=env, check=True)
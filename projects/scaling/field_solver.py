@@ -0,0 +1,93 @@
+# -*- coding: utf-8 -*-
+
+# Roofline-style micro-benchmark of the FDTD field update: separate
+# push_half_b and push_e sweeps vs. the fused push_half_b_e sweep.
+#
+# The time per cell is converted into an effective memory bandwidth with
+# the compulsory traffic of each variant (every mesh value read and written
+# once per sweep): the separate sweeps move 2 x (6 reads + 3 writes) floats
+# per cell, the fused sweep 6 reads + 6 writes. The bandwidth is compared
+# to a streaming copy (numpy) of the same total size, which sets the roof
+# for tiles that do not fit in cache. Tiles that fit in L2 can exceed it.
+#
+# usage: python3 field_solver.py [laps] [NxMesh,...]
+
+import sys
+import time
+import numpy as np
+
+import pycorgi
+import pyrunko
+
+
+# floats moved per cell and flops per cell (3D, rough count of adds and multiplies)
+TRAFFIC = {"separate": 2*(6 + 3), "fused": 6 + 6}
+FLOPS = {"FDTD2": 2*3*7, "FDTD4": 2*3*10}
+
+
+# streaming bandwidth (GB/s) of a copy between two arrays of n floats
+def stream_bandwidth(n, reps=10):
+    a = np.ones(n, dtype=np.float32)
+    b = np.zeros(n, dtype=np.float32)
+    np.copyto(b, a)
+
+    t0 = time.perf_counter()
+    for r in range(reps):
+        np.copyto(b, a)
+    t1 = time.perf_counter()
+    return 2*4*n*reps/(t1 - t0)/1e9
+
+
+def run(N, laps):
+    grid = pycorgi.threeD.Grid(1, 1, 1)
+    grid.set_grid_lims(0.0, N, 0.0, N, 0.0, N)
+
+    tile = pyrunko.emf.threeD.Tile(N, N, N)
+    grid.add_tile(tile, (0, 0, 0))
+    ncells = N*N*N
+
+    rows = []
+    for name in ["FDTD2", "FDTD4"]:
+        fld = getattr(pyrunko.emf.threeD, name)()
+
+        for mode in ["separate", "fused"]:
+            if mode == "separate":
+                def step():
+                    fld.push_half_b(tile)
+                    fld.push_e(tile)
+            else:
+                def step():
+                    fld.push_half_b_e(tile)
+
+            step() # warm-up
+
+            t0 = time.perf_counter()
+            for lap in range(laps):
+                step()
+            t1 = time.perf_counter()
+
+            dt = (t1 - t0)/(laps*ncells)
+            bw = 4*TRAFFIC[mode]/dt/1e9
+            gflops = FLOPS[name]/dt/1e9
+            rows.append((name, mode, dt, bw, FLOPS[name]/(4.0*TRAFFIC[mode]), gflops))
+
+    return rows
+
+
+if __name__ == "__main__":
+    laps = 20
+    sizes = [16, 32, 64]
+    if len(sys.argv) > 1: laps = int(sys.argv[1])
+    if len(sys.argv) > 2: sizes = [int(n) for n in sys.argv[2].split(",")]
+
+    print("{:>6s} {:>6s} {:>9s} {:>10s} {:>8s} {:>7s} {:>8s} {:>8s}".format(
+        "tile", "solver", "mode", "ns/cell", "GB/s", "stream", "fl/byte", "GFlop/s"))
+
+    for N in sizes:
+        # roof: streaming copy of the 6 field meshes (with halos) of the tile
+        roof = stream_bandwidth(6*(N+6)**3)
+
+        for name, mode, dt, bw, ai, gflops in run(N, laps):
+            print("{:>6d} {:>6s} {:>9s} {:10.3f} {:8.2f} {:7.2f} {:8.3f} {:8.2f}".format(
+                N, name, mode, 1e9*dt, bw, bw/roof, ai, gflops))
+        sys.stdout.flush()
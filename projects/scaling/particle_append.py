@@ -0,0 +1,85 @@
+# -*- coding: utf-8 -*-
+
+# Micro-benchmark of adding particles to a container.
+#
+# Compares the per-particle add_particle calls with the bulk
+# append_particles (one capacity check and column copies per call) for
+# different numbers of particles per call. The containers start empty so
+# that the cost of growing the arrays is included.
+#
+# usage: python3 particle_append.py [N] [repeats]
+
+import sys
+import time
+import numpy as np
+
+import pyrunko
+
+
+def new_container():
+    con = pyrunko.pic.threeD.ParticleContainer()
+    con.q = -1.0
+    con.m =  1.0
+    return con
+
+
+def time_add_particle(xs, us, ws, repeats):
+    best = np.inf
+    for r in range(repeats):
+        con = new_container()
+
+        # lists are converted outside of the timed loop
+        xl = xs.tolist()
+        ul = us.tolist()
+        wl = ws.tolist()
+
+        t0 = time.perf_counter()
+        for n in range(len(wl)):
+            con.add_particle(xl[n], ul[n], wl[n])
+        t1 = time.perf_counter()
+
+        assert con.size() == len(wl)
+        best = min(best, t1 - t0)
+    return best
+
+
+def time_append(xs, us, ws, chunk, repeats):
+    N = len(ws)
+    best = np.inf
+    for r in range(repeats):
+        con = new_container()
+
+        t0 = time.perf_counter()
+        for n0 in range(0, N, chunk):
+            n1 = min(n0 + chunk, N)
+            con.append_particles(
+                    xs[n0:n1,0], xs[n0:n1,1], xs[n0:n1,2],
+                    us[n0:n1,0], us[n0:n1,1], us[n0:n1,2],
+                    ws[n0:n1])
+        t1 = time.perf_counter()
+
+        assert con.size() == N
+        best = min(best, t1 - t0)
+    return best
+
+
+if __name__ == "__main__":
+    N       = int(sys.argv[1]) if len(sys.argv) > 1 else 1000000
+    repeats = int(sys.argv[2]) if len(sys.argv) > 2 else 3
+
+    rng = np.random.default_rng(42)
+
+    # contiguous float32 columns; append_particles reads them without a copy
+    xs = np.asfortranarray(rng.random((N,3), dtype=np.float32))
+    us = np.asfortranarray(rng.random((N,3), dtype=np.float32))
+    ws = np.ones(N, dtype=np.float32)
+
+    print("particles {}, best of {}".format(N, repeats))
+    print("{:>28s} {:>12s}".format("method", "Mprtcl/s"))
+
+    t = time_add_particle(xs, us, ws, repeats)
+    print("{:>28s} {:12.3f}".format("add_particle", 1.0e-6*N/t))
+
+    for chunk in [1, 64, 4096, N]:
+        t = time_append(xs, us, ws, chunk, repeats)
+        print("{:>28s} {:12.3f}".format("append_particles ({})".format(chunk), 1.0e-6*N/t))
@@ -0,0 +1,130 @@
+# -*- coding: utf-8 -*-
+
+# Micro-benchmark of the particle exchange between tiles of one rank.
+#
+# Fills a periodic 3D grid of many small tiles with particles, pushes them
+# every lap so that a fraction crosses the tile boundaries, and measures the
+# time per particle of the exchange steps (check_outgoing_particles,
+# get_incoming_particles, delete_transferred_particles). Many tiles per rank
+# and high velocities stress the neighbor transfer.
+#
+# usage: python3 particle_exchange.py [Ntiles] [NxMesh] [ppc] [laps] [vel]
+
+import sys
+import time
+import numpy as np
+
+import pycorgi
+import pyrunko
+import pytools
+
+
+class Conf:
+    Nx = 6
+    Ny = 6
+    Nz = 6
+
+    NxMesh = 8
+    NyMesh = 8
+    NzMesh = 8
+
+    xmin = 0.0
+    ymin = 0.0
+    zmin = 0.0
+
+    cfl = 0.45
+    ppc = 4
+    vel = 0.5
+
+    me = -1.0
+    mi =  1.0
+    qe = -1.0
+
+    Nspecies = 2
+    laps = 20
+
+    oneD   = False
+    twoD   = False
+    threeD = True
+
+
+def load_particles(grid, conf, rng):
+    N = conf.NxMesh*conf.NyMesh*conf.NzMesh*conf.ppc
+    lens = np.array([conf.NxMesh, conf.NyMesh, conf.NzMesh])
+
+    for i in range(conf.Nx):
+        for j in range(conf.Ny):
+            for k in range(conf.Nz):
+                load_tile(grid.get_tile(i,j,k), (i,j,k), conf, rng, N, lens)
+
+
+def load_tile(tile, ind, conf, rng, N, lens):
+    mins = np.array(pytools.ind2loc(ind, (0,0,0), conf))
+
+    for ispcs in range(conf.Nspecies):
+        container = tile.get_container(ispcs)
+
+        xs = mins + lens*rng.random((N,3))
+        us = conf.vel*(2.0*rng.random((N,3)) - 1.0)
+
+        for n in range(N):
+            container.add_particle(xs[n,:].tolist(), us[n,:].tolist(), 1.0)
+
+
+def run(conf):
+    rng = np.random.default_rng(42)
+
+    grid = pycorgi.threeD.Grid(conf.Nx, conf.Ny, conf.Nz)
+    grid.set_grid_lims(
+            0.0, conf.Nx*conf.NxMesh,
+            0.0, conf.Ny*conf.NyMesh,
+            0.0, conf.Nz*conf.NzMesh)
+    pytools.pic.load_tiles(grid, conf)
+    load_particles(grid, conf, rng)
+
+    tiles = [grid.get_tile(cid) for cid in grid.get_local_tiles()]
+
+    intp = pyrunko.pic.threeD.LinearInterpolator()
+    push = pyrunko.pic.threeD.BorisPusher()
+
+    Nprtcls = sum(t.get_container(i).size() for t in tiles for i in range(conf.Nspecies))
+    timings = {"check_outgoing": 0.0, "get_incoming": 0.0, "delete_transferred": 0.0}
+
+    for lap in range(conf.laps):
+        for tile in tiles:
+            intp.solve(tile)
+            push.solve(tile)
+
+        t0 = time.perf_counter()
+        for tile in tiles: tile.check_outgoing_particles()
+        t1 = time.perf_counter()
+        for tile in tiles: tile.get_incoming_particles(grid)
+        t2 = time.perf_counter()
+        for tile in tiles: tile.delete_transferred_particles()
+        t3 = time.perf_counter()
+
+        timings["check_outgoing"]     += t1 - t0
+        timings["get_incoming"]       += t2 - t1
+        timings["delete_transferred"] += t3 - t2
+
+    # particle number is conserved in the periodic box
+    Nend = sum(t.get_container(i).size() for t in tiles for i in range(conf.Nspecies))
+    assert Nend == Nprtcls
+
+    for name, t in timings.items():
+        print("{:>20s} {:10.2f}  ns/prtcl".format(name, 1.0e9*t/(Nprtcls*conf.laps)))
+    print("{:>20s} {:10.2f}  ns/prtcl".format("total", 1.0e9*sum(timings.values())/(Nprtcls*conf.laps)))
+
+
+if __name__ == "__main__":
+    conf = Conf()
+    if len(sys.argv) > 1: conf.Nx = conf.Ny = conf.Nz = int(sys.argv[1])
+    if len(sys.argv) > 2: conf.NxMesh = conf.NyMesh = conf.NzMesh = int(sys.argv[2])
+    if len(sys.argv) > 3: conf.ppc  = int(sys.argv[3])
+    if len(sys.argv) > 4: conf.laps = int(sys.argv[4])
+    if len(sys.argv) > 5: conf.vel  = float(sys.argv[5])
+
+    print("tiles {}^3 of {}^3 cells, ppc {}, species {}, laps {}, vel {}".format(
+        conf.Nx, conf.NxMesh, conf.ppc, conf.Nspecies, conf.laps, conf.vel))
+
+    run(conf)
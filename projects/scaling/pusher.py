@@ -0,0 +1,74 @@
+# -*- coding: utf-8 -*-
+
+# Micro-benchmark of the scalar vs. explicitly vectorized pushers 
+# (pusher.use_simd).
+#
+# Fills one 3D tile with particles, interpolates random fields once, and 
+# measures the time per particle of the Boris, Vay, and Higuera-Cary pushers.
+#
+# usage: python3 pusher.py [NxMesh] [ppc] [laps]
+
+import sys
+import time
+import numpy as np
+
+import pycorgi
+import pyrunko
+import pytools
+
+from current_deposit import Conf, load_particles
+
+
+def run(conf):
+    rng = np.random.default_rng(42)
+
+    grid = pycorgi.threeD.Grid(conf.Nx, conf.Ny, conf.Nz)
+    grid.set_grid_lims(
+            0.0, conf.Nx*conf.NxMesh,
+            0.0, conf.Ny*conf.NyMesh,
+            0.0, conf.Nz*conf.NzMesh)
+    pytools.pic.load_tiles(grid, conf)
+
+    tile = grid.get_tile(0,0,0)
+    load_particles(tile, conf, rng)
+
+    gs = tile.get_grids(0)
+    for comp in [gs.ex, gs.ey, gs.ez, gs.bx, gs.by, gs.bz]:
+        for k in range(conf.NzMesh):
+            for j in range(conf.NyMesh):
+                for i in range(conf.NxMesh):
+                    comp[i,j,k] = 0.1*(2.0*rng.random() - 1.0)
+
+    pyrunko.pic.threeD.LinearInterpolator().solve(tile)
+
+    Nupdates = conf.Nspecies*conf.ppc*conf.NxMesh*conf.NyMesh*conf.NzMesh*conf.laps
+
+    for name in ["BorisPusher", "VayPusher", "HigueraCaryPusher"]:
+        for simd in [False, True]:
+            pusher = getattr(pyrunko.pic.threeD, name)()
+            pusher.use_simd = simd
+
+            pusher.solve(tile) # warm-up
+
+            t0 = time.perf_counter()
+            for lap in range(conf.laps):
+                pusher.solve(tile)
+            t1 = time.perf_counter()
+
+            # ns per particle update
+            print("{:>18s} {:>8s} {:10.2f}  ns/prtcl".format(
+                name, "simd" if simd else "scalar", 1.0e9*(t1-t0)/Nupdates))
+            sys.stdout.flush()
+
+
+if __name__ == "__main__":
+    conf = Conf()
+    if len(sys.argv) > 1: conf.NxMesh = conf.NyMesh = conf.NzMesh = int(sys.argv[1])
+    if len(sys.argv) > 2: conf.ppc  = int(sys.argv[2])
+    if len(sys.argv) > 3: conf.laps = int(sys.argv[3])
+
+    print("tile {}^3, ppc {}, species {}, laps {}".format(
+        conf.NxMesh, conf.ppc, conf.Nspecies, conf.laps))
+    print("{:>18s} {:>8s} {:>10s}".format("pusher", "kernel", "time"))
+
+    run(conf)
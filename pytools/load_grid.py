@@ -541,3 +541,74 @@ def save_mpi_grid_to_disk(outdir, lap, grid, conf):
 
         f5.close()
 
+
+
+# curve index of every tile of an (nx,ny,nz) tile grid; Hilbert curve in 2D/3D
+def hilbert_indices(nx, ny, nz):
+    hind = np.zeros((nx, ny, nz), int)
+
+    if ny == 1 and nz == 1:  # 1D; curve along x
+        hind[:, 0, 0] = np.arange(nx)
+        return hind
+
+    m0 = np.log2(nx)
+    m1 = np.log2(ny)
+    m2 = np.log2(nz)
+    if not (m0.is_integer() and m1.is_integer() and m2.is_integer()):
+        raise ValueError("Nx, Ny, and Nz need to be powers of 2 (i.e. 2^m)")
+
+    if nz == 1:
+        hgen = pyrunko.tools.twoD.HilbertGen(int(m0), int(m1))
+        for i in range(nx):
+            for j in range(ny):
+                hind[i, j, 0] = hgen.hindex(i, j)
+    else:
+        hgen = pyrunko.tools.threeD.HilbertGen(int(m0), int(m1), int(m2))
+        for i in range(nx):
+            for j in range(ny):
+                for k in range(nz):
+                    hind[i, j, k] = hgen.hindex(i, j, k)
+
+    return hind
+
+
+# split the curve into comm_size contiguous pieces of about equal total cost
+# costs and hind are arrays of the same shape; returns the rank of every tile.
+# Every rank gets at least one tile if there are enough tiles.
+def hilbert_partition(costs, hind, comm_size):
+    order = np.argsort(hind, axis=None, kind="stable")
+    c = np.asarray(costs, dtype=float).flatten()[order]
+
+    total = np.sum(c)
+    ntiles = len(c)
+    if total <= 0.0:
+        c = np.ones(ntiles)
+        total = float(ntiles)
+
+    # rank of a tile from the cost at its midpoint along the curve
+    mid = np.cumsum(c) - 0.5 * c
+    raw = np.floor(comm_size * mid / total).astype(int)
+
+    # no rank is skipped and the last ranks are not left empty
+    ranks = np.zeros(ntiles, int)
+    prev = -1
+    for n in range(ntiles):
+        lo = comm_size - ntiles + n
+        r = max(min(raw[n], prev + 1, comm_size - 1), lo, 0)
+        ranks[n] = r
+        prev = r
+
+    owners = np.zeros(ntiles, int)
+    owners[order] = ranks
+    return owners.reshape(np.shape(costs))
+
+
+# ratio of the largest to the mean rank load for a given tile ownership
+def load_imbalance(costs, owners, comm_size):
+    loads = np.bincount(
+        np.asarray(owners).flatten(),
+        weights=np.asarray(costs, dtype=float).flatten(),
+        minlength=comm_size,
+    )
+    mean = np.mean(loads)
+    return np.max(loads) / mean if mean > 0.0 else 1.0
@@ -5,3 +5,5 @@ from .tile_initialization import load_tiles
 from .tile_initialization import load_virtual_tiles
 
 from .injector import inject
+
+from .load_balance import rebalance
@@ -61,13 +61,13 @@ def inject(grid,
                         if align_species and conf.prtcl_types[ispcs] in ['e+', 'p']:
                             #EPS = 1.0e-5
                             ref_container = tile.get_container(0)
-                            xxs = ref_container.loc(0) #+ EPS*np.random.rand(1)
-                            yys = ref_container.loc(1) #+ EPS*np.random.rand(1)
-                            zzs = ref_container.loc(2) #+ EPS*np.random.rand(1)
+                            xxs = ref_container.loc_view(0) #+ EPS*np.random.rand(1)
+                            yys = ref_container.loc_view(1) #+ EPS*np.random.rand(1)
+                            zzs = ref_container.loc_view(2) #+ EPS*np.random.rand(1)
 
-                            vxs = ref_container.vel(0)
-                            vys = ref_container.vel(1)
-                            vzs = ref_container.vel(2)
+                            vxs = ref_container.vel_view(0)
+                            vys = ref_container.vel_view(1)
+                            vzs = ref_container.vel_view(2)
 
                         ip_mesh = 0
 
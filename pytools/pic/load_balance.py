@@ -0,0 +1,144 @@
+# -*- coding: utf-8 -*-
+
+import numpy as np
+from mpi4py import MPI
+
+import pyrunko.pic as pypic
+from pytools.load_grid import hilbert_indices, hilbert_partition, load_imbalance
+from .tile_initialization import initialize_tile, load_virtual_tiles
+
+
+def _modules(conf):
+    if conf.threeD:
+        return pypic.threeD
+    elif conf.twoD:
+        return pypic.twoD
+    return pypic.oneD
+
+
+# tile (i,j,k) indices as they are given to the grid
+def _ind(i, j, k, conf):
+    if conf.threeD:
+        return (i, j, k)
+    elif conf.twoD:
+        return (i, j)
+    return (i,)
+
+
+# fit the cost of one cell relative to one particle from the measured work
+# time of each rank: t_work = a*prtcls + b*cells. Returns default if the
+# ranks do not constrain the fit.
+def fit_cell_cost(t_work, nprtcls, ncells, default):
+    data = MPI.COMM_WORLD.allgather((t_work, nprtcls, ncells))
+    t = np.array([d[0] for d in data])
+    A = np.array([[d[1], d[2]] for d in data], dtype=float)
+
+    coef, _, rank, _ = np.linalg.lstsq(A, t, rcond=None)
+    a, b = coef
+    if rank < 2 or a <= 0.0 or b < 0.0:
+        return default, t
+    return b / a, t
+
+
+# Move tiles between ranks so that each rank gets a contiguous piece of the
+# Hilbert curve with about the same cost. The cost of a tile is its number
+# of particles plus cell_cost per cell. If t_work (seconds spent in this
+# rank's computation since the last call, e.g., from Timer.comp_total) is
+# given, cell_cost is fitted from it; otherwise conf.balance_cell_cost is used.
+#
+# Tiles are moved only if the predicted imbalance (max/mean rank cost)
+# improves by more than min_gain. Returns the before/after metrics.
+#
+# NOTE: needs to be called by all ranks between laps. Virtual tiles are
+#       reloaded; per-tile settings (e.g. packed halo owners) have to be
+#       set again by the caller if tiles were moved.
+def rebalance(grid, conf, t_work=None, min_gain=0.05, do_print=False):
+    mods = _modules(conf)
+
+    rank = grid.rank()
+    comm_size = grid.size()
+    nx, ny, nz = grid.get_Nx(), grid.get_Ny(), grid.get_Nz()
+    ncells = conf.NxMesh * conf.NyMesh * conf.NzMesh
+
+    cids = np.zeros((nx, ny, nz), int)
+    old = np.zeros((nx, ny, nz), int)
+    for i in range(nx):
+        for j in range(ny):
+            for k in range(nz):
+                ind = _ind(i, j, k, conf)
+                cids[i, j, k] = grid.id(*ind)
+                old[i, j, k] = grid.get_mpi_grid(*ind)
+
+    counts = np.array(mods.tile_particle_counts(grid))[cids]
+
+    # relative cost of field work per cell
+    try:
+        cell_cost = conf.balance_cell_cost
+    except:
+        cell_cost = 1.0
+
+    stats = {"measured": None}
+    if t_work is not None:
+        nprtcls = np.sum(counts[old == rank])
+        nlocal = ncells * np.sum(old == rank)
+        cell_cost, t = fit_cell_cost(t_work, nprtcls, nlocal, cell_cost)
+        stats["measured"] = np.max(t) / np.mean(t) if np.mean(t) > 0.0 else 1.0
+
+    costs = counts + cell_cost * ncells
+    new = hilbert_partition(costs, hilbert_indices(nx, ny, nz), comm_size)
+
+    stats["cell_cost"] = cell_cost
+    stats["before"] = load_imbalance(costs, old, comm_size)
+    stats["after"] = load_imbalance(costs, new, comm_size)
+    stats["moved"] = 0
+
+    if stats["after"] > stats["before"] * (1.0 - min_gain):
+        stats["after"] = stats["before"]
+        if do_print:
+            print("lba : imbalance {:.3f} (measured {}); tiles not moved".format(
+                stats["before"], stats["measured"]))
+        return stats
+
+    # new ownership; same on all ranks
+    if rank == 0:
+        for i in range(nx):
+            for j in range(ny):
+                for k in range(nz):
+                    grid.set_mpi_grid(*_ind(i, j, k, conf), int(new[i, j, k]))
+    grid.bcast_mpi_grid()
+
+    # fresh tiles for the ones that arrive
+    for i in range(nx):
+        for j in range(ny):
+            for k in range(nz):
+                if new[i, j, k] != rank or old[i, j, k] == rank:
+                    continue
+
+                tile = mods.Tile(conf.NxMesh, conf.NyMesh, conf.NzMesh)
+                grid.add_tile(tile, _ind(i, j, k, conf))
+                initialize_tile(tile, (i, j, k), grid, conf)
+
+                if hasattr(conf, "prtcl_types"):
+                    for ispcs in range(conf.Nspecies):
+                        tile.get_container(ispcs).type = conf.prtcl_types[ispcs]
+
+    old_by_cid = np.zeros(nx * ny * nz, int)
+    new_by_cid = np.zeros(nx * ny * nz, int)
+    old_by_cid[cids.flatten()] = old.flatten()
+    new_by_cid[cids.flatten()] = new.flatten()
+    mods.migrate_tiles(grid, old_by_cid.tolist(), new_by_cid.tolist())
+
+    # neighborhood of the new local tiles
+    grid.analyze_boundaries()
+    grid.send_tiles()
+    grid.recv_tiles()
+    MPI.COMM_WORLD.barrier()
+    load_virtual_tiles(grid, conf)
+
+    stats["moved"] = int(np.sum(new != old))
+
+    if do_print:
+        print("lba : imbalance {:.3f} -> {:.3f} (measured {}); moved {} tiles; cell cost {:.3g}".format(
+            stats["before"], stats["after"], stats["measured"], stats["moved"], cell_cost))
+
+    return stats
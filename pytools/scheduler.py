@@ -1,4 +1,5 @@
 import sys, os
+import pyrunko
 import pytools  # runko python tools
 from mpi4py import MPI
 
@@ -30,6 +31,10 @@ class Scheduler:
 
         self.debug = False # debug mode
 
+        self.packed_halos = False # halo-only mpi messages for fields and currents
+        self.current_depth = 3    # interior depth of packed current halos
+        self.shm_exchange = False # on-node messages through shared memory
+
     # swithc from all-in mode to task mode
     def switch_to_task_mode(self,):
         self.mpi_task_mode = True
@@ -54,6 +59,60 @@ class Scheduler:
             self.is_example_worker = False
 
 
+    # switch mpi field and current messages (j, e, b) to packed halo regions; 
+    # needs to be called again if tile ownership changes. Current halos reach
+    # current_depth cells into the sending tile (npasses of MultiPassBinomial2).
+    def set_packed_halos(self, current_depth=None):
+        if current_depth is not None:
+            self.current_depth = current_depth
+
+        for tile in pytools.tiles_all(self.grid):
+            tile.set_halo_owners(self.grid)
+            tile.set_current_depth(self.current_depth)
+        self.packed_halos = True
+        self.check_shm_capacity()
+
+
+    # exchange packed halos and particle messages of ranks on the same node through 
+    # a shared memory window of mbytes per rank; only offsets go through mpi.
+    # NOTE: received data stays in the sender's memory until the next mpi op, so 
+    #       unpack_halos and unpack_incoming_particles need to run before it
+    def set_shm_exchange(self, mbytes=64):
+        pyrunko.tools.shm_init(int(mbytes*1024**2))
+        self.shm_exchange = True
+        self.check_shm_capacity()
+
+
+    # packed halos sent on-node in one mpi op have to fit into the shared memory 
+    # window; their size is fixed by tile ownership so it is checked here and not 
+    # in the middle of a lap. Particle messages that do not fit go through mpi.
+    def check_shm_capacity(self):
+        if not(self.shm_exchange and self.packed_halos):
+            return
+
+        words = 0
+        for mode in range(3): # j, e, b
+            words = max(words, sum(tile.shm_halo_words(mode) for tile in pytools.tiles_local(self.grid)))
+
+        # every rank stops with the same error
+        nbytes = MPI.COMM_WORLD.allreduce(4*words, op=MPI.MAX)
+        if nbytes > pyrunko.tools.shm_capacity():
+            raise RuntimeError("sch : packed halos need {:.2f} MB of shared memory per rank; set_shm_exchange has {:.2f} MB".format(
+                nbytes/1024**2, pyrunko.tools.shm_capacity()/1024**2))
+
+
+    # run one lap of a C++ TaskScheduler (pyrunko.pic.*.TaskScheduler) and 
+    # book its op timings like the ones of operate
+    def run_tasks(self, tasks):
+        tasks.timings = {}
+        tasks.run()
+
+        for name, t in tasks.timings.items():
+            if not(name in self.timer.components):
+                self.timer.components[name] = []
+            self.timer.components[name].append(t)
+
+
     def is_active_tile(self, tile):
         return True
 
@@ -120,10 +179,19 @@ class Scheduler:
             if op['method'] == 'p2': mpid = 4
     
             t1 = self.timer.start_comp(op['name'])
+
+            # previous messages in the shared memory window have been consumed on the node
+            if self.shm_exchange:
+                pyrunko.tools.shm_begin_phase()
     
             self.grid.recv_data(mpid)
             self.grid.send_data(mpid)
             self.grid.wait_data(mpid)
+
+            # copy received halo regions into virtual tiles
+            if self.packed_halos and mpid <= 2:
+                for tile in pytools.tiles_virtual(self.grid):
+                    tile.unpack_halos(mpid)
     
             self.timer.stop_comp(t1)
     
@@ -82,6 +82,22 @@ class Timer:
 
         self.components[name][-1] = t0 - self.components[name][-1]
 
+    def add_comp(self, name, duration):
+        # component measured elsewhere (e.g., in a background thread)
+        if not (name in self.components):
+            self.components[name] = []
+
+        self.components[name].append(duration)
+
+    # total time of components since the last purge; skips names starting with exclude
+    def comp_total(self, exclude=("mpi", "io")):
+        t0 = 0.0
+        for name in self.components:
+            if name.startswith(tuple(exclude)):
+                continue
+            t0 += np.sum(np.array(self.components[name]))
+        return t0
+
     def stats(self, name):
 
         ts = np.array(self.names[name])
@@ -270,3 +270,66 @@ class FilterTests(unittest.TestCase):
         self.assertAlmostEqual(sumx, sumx1, places=5)
         self.assertAlmostEqual(sumy, sumy1, places=5)
         self.assertAlmostEqual(sumz, sumz1, places=5)
+
+    # all passes with one exchange gives the same currents as the
+    # one-pass filter with update_boundaries before every other pass
+    def test_multipass(self):
+
+        for D in [2, 3]:
+            conf = Conf()
+            conf.Nx, conf.Ny, conf.Nz = 3, 3, (3 if D == 3 else 1)
+            conf.NxMesh, conf.NyMesh, conf.NzMesh = 6, 5, (4 if D == 3 else 1)
+            npasses = 4
+
+            mods = pyfields.threeD if D == 3 else pyfields.twoD
+            np.random.seed(1)
+
+            grids = []
+            for n in range(2):
+                if D == 3:
+                    grid = pycorgi.threeD.Grid(conf.Nx, conf.Ny, conf.Nz)
+                    grid.set_grid_lims(0.0, 1.0, 0.0, 1.0, 0.0, 1.0)
+                else:
+                    grid = pycorgi.twoD.Grid(conf.Nx, conf.Ny, conf.Nz)
+                    grid.set_grid_lims(0.0, 1.0, 0.0, 1.0)
+
+                for i in range(conf.Nx):
+                    for j in range(conf.Ny):
+                        for k in range(conf.Nz):
+                            tile = mods.Tile(conf.NxMesh, conf.NyMesh, conf.NzMesh)
+                            grid.add_tile(tile, (i, j, k) if D == 3 else (i, j))
+                grids.append(grid)
+
+            # same random currents in both grids
+            for cid in grids[0].get_tile_ids():
+                gs0 = grids[0].get_tile(cid).get_grids()
+                gs1 = grids[1].get_tile(cid).get_grids()
+                for q in range(conf.NxMesh):
+                    for r in range(conf.NyMesh):
+                        for s in range(conf.NzMesh):
+                            for m0, m1 in [(gs0.jx, gs1.jx), (gs0.jy, gs1.jy), (gs0.jz, gs1.jz)]:
+                                val = np.random.rand()
+                                m0[q, r, s] = val
+                                m1[q, r, s] = val
+
+            # reference; halo of 3 lasts for two passes
+            flt = mods.Binomial2(conf.NxMesh, conf.NyMesh, conf.NzMesh)
+            for fj in range(npasses):
+                if fj % 2 == 0:
+                    for cid in grids[0].get_tile_ids():
+                        grids[0].get_tile(cid).update_boundaries(grids[0], [0])
+                for cid in grids[0].get_tile_ids():
+                    flt.solve(grids[0].get_tile(cid))
+
+            mflt = mods.MultiPassBinomial2(conf.NxMesh, conf.NyMesh, conf.NzMesh, npasses)
+            for cid in grids[1].get_tile_ids():
+                mflt.compute(grids[1].get_tile(cid), grids[1])
+            for cid in grids[1].get_tile_ids():
+                mflt.solve(grids[1].get_tile(cid))
+
+            for cid in grids[0].get_tile_ids():
+                jx0, jy0, jz0 = get_js(grids[0].get_tile(cid), conf)
+                jx1, jy1, jz1 = get_js(grids[1].get_tile(cid), conf)
+                self.assertTrue(np.array_equal(jx0, jx1))
+                self.assertTrue(np.array_equal(jy0, jy1))
+                self.assertTrue(np.array_equal(jz0, jz1))
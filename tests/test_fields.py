@@ -109,6 +109,537 @@ class FLD_inits(unittest.TestCase):
         fdtd2.push_e(tile)
         fdtd2.push_half_b(tile)
 
+    # fused half B + E sweep gives the same fields as the separate updates with a B exchange in between
+    def test_propagators_fused_3d(self):
+        conf = Conf()
+        conf.threeD = True
+        conf.Nx, conf.Ny, conf.Nz = 2, 2, 2
+
+        for name in ["FDTD2", "FDTD4"]:
+            np.random.seed(2)
+
+            grids = []
+            for n in range(2):
+                grid = pycorgi.threeD.Grid(conf.Nx, conf.Ny, conf.Nz)
+                grid.set_grid_lims(conf.xmin, conf.xmax, conf.ymin, conf.ymax, conf.zmin, conf.zmax)
+                loadTiles3D(grid, conf)
+                grids.append(grid)
+
+            for cid in grids[0].get_tile_ids():
+                gs0 = grids[0].get_tile(cid).get_grids()
+                gs1 = grids[1].get_tile(cid).get_grids()
+                for m in ["ex", "ey", "ez", "bx", "by", "bz"]:
+                    for q in range(conf.NxMesh):
+                        for r in range(conf.NyMesh):
+                            for s in range(conf.NzMesh):
+                                val = np.random.rand()
+                                getattr(gs0, m)[q,r,s] = val
+                                getattr(gs1, m)[q,r,s] = val
+
+            for grid in grids:
+                for cid in grid.get_tile_ids():
+                    grid.get_tile(cid).update_boundaries(grid)
+
+            fld = getattr(pyrunko.emf.threeD, name)()
+
+            for cid in grids[0].get_tile_ids():
+                fld.push_half_b(grids[0].get_tile(cid))
+            for cid in grids[0].get_tile_ids():
+                grids[0].get_tile(cid).update_boundaries(grids[0], [2])
+            for cid in grids[0].get_tile_ids():
+                fld.push_e(grids[0].get_tile(cid))
+
+            for cid in grids[1].get_tile_ids():
+                fld.push_half_b_e(grids[1].get_tile(cid))
+
+            for cid in grids[0].get_tile_ids():
+                gs0 = grids[0].get_tile(cid).get_grids()
+                gs1 = grids[1].get_tile(cid).get_grids()
+                for m in ["ex", "ey", "ez", "bx", "by", "bz"]:
+                    for q in range(conf.NxMesh):
+                        for r in range(conf.NyMesh):
+                            for s in range(conf.NzMesh):
+                                self.assertEqual(getattr(gs0, m)[q,r,s], getattr(gs1, m)[q,r,s])
+
+
+    # tabulated damping profile relaxes into the reference fields; damping in
+    # the E sweep gives the same interior as push_e followed by damp_fields
+    def test_damping_profile_2d(self):
+        conf = Conf()
+        conf.twoD = True
+        conf.Nx, conf.Ny = 1, 1
+        conf.NxMesh, conf.NyMesh = 10, 6
+
+        fld1, fld2, ksupp = 2.0, 8.0, 10.0
+
+        tiles = []
+        for n in range(2):
+            grid = pycorgi.twoD.Grid(conf.Nx, conf.Ny)
+            grid.set_grid_lims(0.0, conf.NxMesh, 0.0, conf.NyMesh)
+
+            c = pyrunko.emf.twoD.TileDamped2D_LX(conf.NxMesh, conf.NyMesh, 1)
+            grid.add_tile(c, (0,0))
+
+            c.fld1 = fld1
+            c.fld2 = fld2
+            c.ksupp = ksupp
+            tiles.append(c)
+
+        np.random.seed(3)
+        ms = ["ex", "ey", "ez", "bx", "by", "bz"]
+        for m in ms:
+            for q in range(conf.NxMesh):
+                for r in range(conf.NyMesh):
+                    val = np.random.rand()
+                    ref = np.random.rand()
+                    for c in tiles:
+                        getattr(c.get_grids(), m)[q,r,0] = val
+                        getattr(c, m + "_ref")[q,r,0] = ref
+
+        fld = pyrunko.emf.twoD.FDTD2()
+        fld.push_e(tiles[0])
+        tiles[0].damp_fields()
+
+        tiles[1].fused_damping = True
+        fld.push_e_damped(tiles[1])
+
+        for m in ms:
+            for q in range(conf.NxMesh):
+                for r in range(conf.NyMesh):
+                    v0 = getattr(tiles[0].get_grids(), m)[q,r,0]
+                    v1 = getattr(tiles[1].get_grids(), m)[q,r,0]
+                    self.assertEqual(v0, v1)
+
+                    # fully damped behind fld1
+                    ref = getattr(tiles[0], m + "_ref")[q,r,0]
+                    if q <= fld1:
+                        self.assertEqual(v0, ref)
+
+        # profile against the damping law in a fresh pass
+        for m in ms:
+            for q in range(conf.NxMesh):
+                getattr(tiles[0].get_grids(), m)[q,0,0] = 1.0
+                getattr(tiles[0], m + "_ref")[q,0,0] = 0.0
+        tiles[0].damp_fields()
+
+        for q in range(conf.NxMesh):
+            t1 = 1.0
+            if q <= fld1:
+                t1 = 0.0
+            elif q < fld2:
+                t1 = np.exp(-ksupp*((fld2 - q)/(fld2 - fld1))**3)
+            self.assertAlmostEqual(tiles[0].get_grids().ex[q,0,0], t1, places=5)
+
+
+    # frequency of a standing vacuum wave (8 cells per wavelength) over a
+    # periodic chain of tiles; returns w/(k c) - 1 and the max amplitude
+    def standing_wave_1d(self, fld, cfl, laps):
+        conf = Conf()
+        conf.oneD = True
+        conf.Nx, conf.Ny, conf.Nz = 4, 1, 1
+        conf.NxMesh, conf.NyMesh, conf.NzMesh = 16, 1, 1
+
+        grid = pycorgi.oneD.Grid(conf.Nx, 1, 1)
+        grid.set_grid_lims(conf.xmin, conf.xmax)
+        loadTiles1D(grid, conf)
+
+        L = conf.Nx*conf.NxMesh
+        k = 2.0*np.pi*8/L
+        for cid in grid.get_tile_ids():
+            tile = grid.get_tile(cid)
+            tile.cfl = cfl
+            (i,) = tile.index
+            gs = tile.get_grids()
+            for q in range(conf.NxMesh):
+                gs.ey[q,0,0] = np.sin(k*(i*conf.NxMesh + q))
+
+        tiles = [grid.get_tile(cid) for cid in grid.get_tile_ids()]
+        amps = []
+        for lap in range(laps):
+            a = 0.0
+            for tile in tiles:
+                (i,) = tile.index
+                x = i*conf.NxMesh + np.arange(conf.NxMesh)
+                a += np.sum(np.array([tile.get_grids().ey[q,0,0] for q in range(conf.NxMesh)])*np.exp(-1j*k*x))
+            amps.append(a)
+
+            for tile in tiles: tile.update_boundaries(grid)
+            for tile in tiles: fld.push_half_b(tile)
+            for tile in tiles: tile.update_boundaries(grid)
+            for tile in tiles: fld.push_half_b(tile)
+            for tile in tiles: tile.update_boundaries(grid)
+            for tile in tiles: fld.push_e(tile)
+
+        # any mix of the two eigenmodes satisfies a(n+1) + a(n-1) = 2 cos(w) a(n)
+        a = np.array(amps)
+        cosw = np.real(np.sum(np.conj(a[1:-1])*(a[2:] + a[:-2])))/(2.0*np.sum(np.abs(a[1:-1])**2))
+        w = np.arccos(cosw)
+        return w/(k*cfl) - 1.0, np.max(np.abs(a))/np.abs(a[0])
+
+    @unittest.skipIf(not hasattr(pyrunko.emf.oneD, "PSATD"), "built without fftw")
+    def test_psatd_dispersion(self):
+        cfl = 0.45
+        err2, _ = self.standing_wave_1d(pyrunko.emf.oneD.FDTD2(), cfl, 40)
+        err4, _ = self.standing_wave_1d(pyrunko.emf.oneD.FDTD4(), cfl, 40)
+        errs, _ = self.standing_wave_1d(pyrunko.emf.oneD.PSATD(), cfl, 40)
+
+        # FDTD2 ~ 2e-2, FDTD4 ~ 4e-3; PSATD ~ 5e-4 is limited by the taps truncated to the halo
+        self.assertLess(abs(errs), 1.0e-3)
+        self.assertLess(abs(errs), 0.2*abs(err4))
+        self.assertLess(abs(err4), abs(err2))
+
+        # stable beyond the FDTD limit
+        errs, amp = self.standing_wave_1d(pyrunko.emf.oneD.PSATD(), 1.5, 200)
+        self.assertLess(abs(errs), 3.0e-3)
+        self.assertLess(amp, 1.5)
+
+    # tile seams have to be invisible: a periodic 3x2 tiling has to give the 
+    # same fields as one periodic tile of the whole box
+    @unittest.skipIf(not hasattr(pyrunko.emf.twoD, "PSATD"), "built without fftw")
+    def test_psatd_tile_seams(self):
+
+        def run(Nx, Ny, NxMesh, NyMesh):
+            conf = Conf()
+            conf.twoD = True
+            conf.Nx, conf.Ny, conf.Nz = Nx, Ny, 1
+            conf.NxMesh, conf.NyMesh, conf.NzMesh = NxMesh, NyMesh, 1
+
+            grid = pycorgi.twoD.Grid(conf.Nx, conf.Ny, 1)
+            grid.set_grid_lims(conf.xmin, conf.xmax, conf.ymin, conf.ymax)
+            loadTiles2D(grid, conf)
+
+            # smooth random fields as a function of the global cell
+            rng = np.random.RandomState(3)
+            amps = rng.rand(6, 4) - 0.5
+            for cid in grid.get_tile_ids():
+                tile = grid.get_tile(cid)
+                tile.cfl = 0.45
+                i, j = tile.index
+                gs = tile.get_grids()
+                for c, m in enumerate(['ex', 'ey', 'ez', 'bx', 'by', 'bz']):
+                    for r in range(NyMesh):
+                        for q in range(NxMesh):
+                            x = 2.0*np.pi*(i*NxMesh + q)/24.0
+                            y = 2.0*np.pi*(j*NyMesh + r)/16.0
+                            getattr(gs, m)[q,r,0] = amps[c,0]*np.sin(x) + amps[c,1]*np.cos(2*y) \
+                                                  + amps[c,2]*np.sin(3*x + 5*y) + amps[c,3]*np.cos(7*x - 2*y)
+
+            fld = pyrunko.emf.twoD.PSATD()
+            tiles = [grid.get_tile(cid) for cid in grid.get_tile_ids()]
+            for lap in range(3):
+                for tile in tiles: tile.update_boundaries(grid)
+                for tile in tiles: fld.push_half_b(tile)
+                for tile in tiles: tile.update_boundaries(grid)
+                for tile in tiles: fld.push_half_b(tile)
+                for tile in tiles: tile.update_boundaries(grid)
+                for tile in tiles: fld.push_e(tile)
+
+            # global arrays
+            out = {}
+            for m in ['ex', 'ey', 'ez', 'bx', 'by', 'bz']:
+                arr = np.zeros((Nx*NxMesh, Ny*NyMesh))
+                for tile in tiles:
+                    i, j = tile.index
+                    gs = tile.get_grids()
+                    for r in range(NyMesh):
+                        for q in range(NxMesh):
+                            arr[i*NxMesh + q, j*NyMesh + r] = getattr(gs, m)[q,r,0]
+                out[m] = arr
+            return out
+
+        tiled  = run(3, 2, 8, 8)
+        single = run(1, 1, 24, 16)
+        for m in ['ex', 'ey', 'ez', 'bx', 'by', 'bz']:
+            np.testing.assert_allclose(tiled[m], single[m], rtol=0.0, atol=1.0e-5)
+
+
+
+
+
+# reference of the conductor boundaries: the blends of update_b and update_e
+# applied one stage at a time in double precision (the algorithm before the
+# per-tile tables)
+class ConductorReference:
+
+    EPS = 1.0e-7
+
+    # staggering of the field components; see tools/staggered_grid.h
+    stagger = {
+        'mid': (1,1,1),
+        'ex': (1,0,0), 'ey': (0,1,0), 'ez': (1,0,1),
+        'bx': (0,1,1), 'by': (1,0,1), 'bz': (1,1,0),
+        }
+
+    def __init__(self, D, prm, N):
+        self.D = D
+        self.p = prm
+        self.N = N # global cells
+
+    @staticmethod
+    def shape(r, r0, delta):
+        return 0.5*(1.0 - np.tanh((r - r0)/delta))
+
+    def pos(self, st, ig, jg, kg):
+        sx, sy, sz = self.stagger[st]
+        x = ig + 0.5*sx - self.p['cenx']
+        y = jg + 0.5*sy - self.p['ceny'] if self.D >= 2 else 0.0*ig
+        z = kg + 0.5*sz - self.p['cenz'] if self.D >= 3 else 0.0*ig
+        return np.stack([x, y, z])
+
+    def dipole(self, r):
+        p, EPS = self.p, self.EPS
+        x, y, z = r
+        if self.D == 1:
+            return p['B0']*np.stack([2.0/(x**3 + EPS), 0.0*x, 0.0*x])
+
+        if self.D == 2:
+            mu = (np.sin(p['chi_mu']), np.cos(p['chi_mu']), 0.0)
+        else:
+            mu = (np.sin(p['chi_mu'])*np.cos(p['phase_mu']), 
+                  np.sin(p['chi_mu'])*np.sin(p['phase_mu']), 
+                  np.cos(p['chi_mu']))
+        rad = np.sqrt(x*x + y*y + z*z)
+        mudotr = mu[0]*x + mu[1]*y + mu[2]*z
+        return p['B0']*np.stack([3.0*q*mudotr/(rad**5 + EPS) - m/(rad**3 + EPS) for q, m in zip(r, mu)])
+
+    def omega(self):
+        p = self.p
+        Om = 2.0*np.pi/p['period'] if p['period'] > self.EPS else 0.0
+        if self.D == 1: return np.array([Om, 0.0, 0.0])
+        if self.D == 2: return np.array([0.0, Om, 0.0])
+        return Om*np.array([np.sin(p['chi_om'])*np.cos(p['phase_om']), 
+                            np.sin(p['chi_om'])*np.sin(p['phase_om']), 
+                            np.cos(p['chi_om'])])
+
+    def rcyl(self, r):
+        if self.D == 1: return 0.0*r[0]
+        if self.D == 2: return np.abs(r[0])
+        return np.sqrt(r[0]**2 + r[1]**2)
+
+    # update_b and update_e of one tile; e and b are lists of the 3 components 
+    # over the tile incl. halos (only the first D dimensions have halos)
+    def update(self, mins, lens, e, b):
+        D, p, N, H = self.D, self.p, self.N, 2
+        shape = self.shape
+
+        maxs = [mins[d] + lens[d] for d in range(D)]
+        ranges = [np.arange(-3, lens[d] + 3) + mins[d] if d < D else np.zeros(1) for d in range(3)]
+        ig, jg, kg = np.meshgrid(*ranges, indexing='ij')
+        h = [ig, jg, kg][D-1] # height
+
+        left  = D >= 2 and mins[0] < 1
+        right = D >= 2 and maxs[0] > N[0] - 1
+        front = D == 3 and mins[1] < 1
+        back  = D == 3 and maxs[1] > N[1] - 1
+        bot   = mins[D-1] < 1
+        top   = maxs[D-1] > N[D-1] - 1
+        box   = left or right or front or back or bot or top
+
+        corners = [self.pos('mid', *[(maxs[d] if (c >> d) & 1 else mins[d]) if d < D else 0.0 for d in range(3)])
+                   for c in range(8)]
+        inside_star = any(np.sqrt(np.sum(x**2)) < 1.1*p['radius'] for x in corners)
+
+        rbox, inside_cyl = 0.0, False
+        if D == 2: rbox = 0.5*N[0] - 0.5*lens[0]
+        if D == 3: rbox = 0.5*N[0] - H - 1
+        if D >= 2: inside_cyl = any(self.rcyl(x) > rbox for x in corners)
+
+        tile_len = lens[D-1]
+        delta_ext = 0.25*tile_len
+        rmid = self.pos('mid', ig, jg, kg)
+        rcyl = self.rcyl(rmid)
+
+        in_box = (h < H) | (h > N[D-1] - 1)
+        if left:  in_box |= ig < H
+        if right: in_box |= ig > N[0] - H - 1
+        if front: in_box |= jg < H
+        if back:  in_box |= jg > N[1] - H - 1
+        in_box = in_box.astype(float)
+
+        #--------------------------------------------------
+        # update_b
+        for c, st in enumerate(['bx', 'by', 'bz']):
+            r = self.pos(st, ig, jg, kg)
+            f0 = self.dipole(r)[c]
+
+            if inside_star:
+                s = shape(np.abs(r[D-1]), p['radius'], p['delta'])
+                b[c] = s*f0 + (1.0 - s)*b[c]
+            if D >= 2 and inside_cyl:
+                s = shape(self.rcyl(r), rbox, delta_ext)
+                b[c] = s*b[c] + (1.0 - s)*f0
+            if top:
+                s = shape(h, N[D-1] - 0.5*tile_len, delta_ext)
+                b[c] = s*b[c] + (1.0 - s)*f0
+            if bot:
+                s = (rcyl < 1.5*p['radius_pc']).astype(float)
+                b[c] = s*b[c] + (1.0 - s)*f0
+            if box:
+                b[c] = in_box*f0 + (1.0 - in_box)*b[c]
+
+        #--------------------------------------------------
+        # update_e
+        if D >= 2:
+            sl = tuple(slice(3, 3 + lens[d]) if d < D else slice(None) for d in range(3))
+            rad = np.sqrt(np.sum(rmid[(slice(None),) + sl]**2, axis=0))
+            rc = rcyl[sl]
+            Rbc = p['radius']/(p['radius_pc']/p['radius'])**2
+            s = 1.0 - shape(rc, rad*np.sqrt(rad/Rbc), p['delta_pc'])
+            s = np.where(h[sl] < p['radius'] + 2, 1.0 - shape(rc, p['radius_pc'], p['delta_pc']), s)
+
+            ei = [f[sl] for f in e]
+            bi = [f[sl] for f in b]
+            bn = np.sqrt(bi[0]**2 + bi[1]**2 + bi[2]**2) + self.EPS
+            epar = (ei[0]*bi[0] + ei[1]*bi[1] + ei[2]*bi[2])/bn
+            for c in range(3):
+                e[c][sl] = s*(ei[c] - epar*bi[c]/bn) + (1.0 - s)*ei[c]
+
+        Om = self.omega()
+        for c, st in enumerate(['ex', 'ey', 'ez']):
+            if inside_star and D == 1:
+                r = self.pos('ex', ig, jg, kg)
+                s = shape(np.abs(r[0]), p['radius'] + 1.0, p['delta'])
+                e[c] = (1.0 - s)*e[c]
+            elif inside_star:
+                r = self.pos(st, ig, jg, kg)
+                s = shape(np.abs(r[D-1]), p['radius'], p['delta'])
+                s *= shape(self.rcyl(r), p['radius_pc'] + p['delta_pc'], p['delta_pc'])
+                vrot = np.cross(Om, r, axis=0)
+                erot = -np.cross(vrot, self.dipole(r), axis=0)
+                e[c] = s*erot[c] + (1.0 - s)*e[c]
+
+            if D >= 2 and inside_cyl:
+                e[c] *= shape(rcyl, rbox, delta_ext)
+            if top:
+                e[c] *= shape(h, N[D-1] - 0.5*tile_len, delta_ext)
+            if bot and D >= 2:
+                e[c] *= np.where(rcyl < 1.5*p['radius_pc'], 1.0, 1.0 - shape(h, 0.5*tile_len, delta_ext))
+            if box:
+                e[c] *= 1.0 - in_box
+
+
+class Conductors(unittest.TestCase):
+
+    def fields(self, tile, D, lens):
+        gs = tile.get_grids()
+        ranges = [range(-3, lens[d] + 3) if d < D else [0] for d in range(3)]
+        shp = [len(r) for r in ranges]
+        out = []
+        for m in ['ex', 'ey', 'ez', 'bx', 'by', 'bz']:
+            arr = np.zeros(shp)
+            mesh = getattr(gs, m)
+            for a, i in enumerate(ranges[0]):
+                for q, j in enumerate(ranges[1]):
+                    for t, k in enumerate(ranges[2]):
+                        arr[a,q,t] = mesh[i,j,k]
+            out.append(arr)
+        return out
+
+    def randomize(self, tile, D, lens, rng):
+        gs = tile.get_grids()
+        ranges = [range(-3, lens[d] + 3) if d < D else [0] for d in range(3)]
+        for m in ['ex', 'ey', 'ez', 'bx', 'by', 'bz']:
+            mesh = getattr(gs, m)
+            for i in ranges[0]:
+                for j in ranges[1]:
+                    for k in ranges[2]:
+                        mesh[i,j,k] = rng.rand() - 0.5
+
+    # run update_b and update_e on every tile of the grid and compare with the reference
+    def check(self, grid, cd, ref, D, lens, rng):
+        for cid in grid.get_tile_ids():
+            tile = grid.get_tile(cid)
+            self.randomize(tile, D, lens, rng)
+            f = self.fields(tile, D, lens)
+
+            cd.update_b(tile)
+            cd.update_e(tile)
+            out = self.fields(tile, D, lens)
+
+            index = tuple(tile.index)
+            mins = [index[d]*lens[d] for d in range(D)]
+            e, b = f[:3], f[3:]
+            ref.update(mins, lens, e, b)
+
+            for m, fo, fr in zip(['ex', 'ey', 'ez', 'bx', 'by', 'bz'], out, e + b):
+                np.testing.assert_allclose(fo, fr, rtol=1.0e-4, atol=1.0e-5*max(1.0, np.max(np.abs(fr))), 
+                                           err_msg="{} of tile {}".format(m, index))
+
+    def conductor(self, cd, prm, N):
+        for key, val in prm.items():
+            setattr(cd, key, val)
+        cd.Nx, cd.Ny, cd.Nz = N
+
+    def test_conductor_1d(self):
+        Nx, NxMesh = 4, 8
+        grid = pycorgi.oneD.Grid(Nx, 1, 1)
+        grid.set_grid_lims(0.0, Nx*NxMesh)
+        for i in range(Nx):
+            grid.add_tile(pyrunko.emf.oneD.Tile(NxMesh, 1, 1), (i,))
+
+        prm = dict(radius=6.0, delta=1.0, B0=2.0, period=20.0, radius_pc=3.0, delta_pc=1.0, 
+                   cenx=0.25, ceny=0.0, cenz=0.0, chi_mu=0.0, chi_om=0.0, phase_mu=0.0, phase_om=0.0)
+        N = (Nx*NxMesh, 1, 1)
+        cd = pyrunko.emf.oneD.Conductor()
+        self.conductor(cd, prm, N)
+
+        rng = np.random.RandomState(1)
+        self.check(grid, cd, ConductorReference(1, prm, N), 1, (NxMesh, 1, 1), rng)
+
+    def test_conductor_2d(self):
+        Nx, Ny, NxMesh = 4, 3, 8
+        grid = pycorgi.twoD.Grid(Nx, Ny, 1)
+        grid.set_grid_lims(0.0, Nx*NxMesh, 0.0, Ny*NxMesh)
+        for i in range(Nx):
+            for j in range(Ny):
+                grid.add_tile(pyrunko.emf.twoD.Tile(NxMesh, NxMesh, 1), (i,j))
+
+        prm = dict(radius=6.0, delta=1.0, B0=2.0, period=20.0, radius_pc=3.0, delta_pc=1.0, 
+                   cenx=16.25, ceny=0.25, cenz=0.0, chi_mu=0.3, chi_om=0.0, phase_mu=0.0, phase_om=0.0)
+        N = (Nx*NxMesh, Ny*NxMesh, 1)
+        cd = pyrunko.emf.twoD.Conductor()
+        self.conductor(cd, prm, N)
+
+        rng = np.random.RandomState(2)
+        self.check(grid, cd, ConductorReference(2, prm, N), 2, (NxMesh, NxMesh, 1), rng)
+
+    def test_conductor_3d(self):
+        Nx, NxMesh = 3, 6
+        grid = pycorgi.threeD.Grid(Nx, Nx, Nx)
+        grid.set_grid_lims(0.0, Nx*NxMesh, 0.0, Nx*NxMesh, 0.0, Nx*NxMesh)
+        for i in range(Nx):
+            for j in range(Nx):
+                for k in range(Nx):
+                    grid.add_tile(pyrunko.emf.threeD.Tile(NxMesh, NxMesh, NxMesh), (i,j,k))
+
+        prm = dict(radius=4.0, delta=1.0, B0=2.0, period=25.0, radius_pc=2.0, delta_pc=1.0, 
+                   cenx=9.25, ceny=9.25, cenz=0.25, chi_mu=0.4, chi_om=0.2, phase_mu=0.3, phase_om=0.1)
+        N = (Nx*NxMesh, Nx*NxMesh, Nx*NxMesh)
+        cd = pyrunko.emf.threeD.Conductor()
+        self.conductor(cd, prm, N)
+
+        rng = np.random.RandomState(3)
+        lens = (NxMesh, NxMesh, NxMesh)
+        self.check(grid, cd, ConductorReference(3, prm, N), 3, lens, rng)
+
+        # rotate the star; the cached tables have to follow the phases
+        for lap in range(2):
+            prm['phase_mu'] += 0.7
+            prm['phase_om'] += 0.5
+            cd.phase_mu, cd.phase_om = prm['phase_mu'], prm['phase_om']
+            self.check(grid, cd, ConductorReference(3, prm, N), 3, lens, rng)
+
+        # stale tables would still match the old phases
+        tile = grid.get_tile(grid.get_tile_ids()[0])
+        self.randomize(tile, 3, lens, rng)
+        f = self.fields(tile, 3, lens)
+        cd.update_b(tile)
+        out = self.fields(tile, 3, lens)
+
+        old = dict(prm, phase_mu=prm['phase_mu'] - 0.7)
+        e, b = f[:3], f[3:]
+        ConductorReference(3, old, N).update([NxMesh*q for q in tile.index], lens, e, b)
+        self.assertGreater(np.max(np.abs(out[3] - b[0])), 1.0e-3)
 
 
 
@@ -959,3 +1490,90 @@ class Communications(unittest.TestCase):
 
 
         
+
+
+    # packed halo messages (emf.Tile.set_halo_owners) have to give the same
+    # fields and currents as sending the full tile. Tiles of the middle column
+    # play a second rank whose virtual copies on this rank receive only the 
+    # packed halo regions.
+    def packed_halo_exchange(self, D, lens, tiles):
+        ms = [['jx', 'jy', 'jz'], ['ex', 'ey', 'ez'], ['bx', 'by', 'bz']]
+        ranges = [range(-3, lens[d] + 3) if d < D else [0] for d in range(3)]
+        rank = MPI.COMM_WORLD.Get_rank()
+
+        grids = []
+        for g in range(2):
+            if D == 2:
+                grid = pycorgi.twoD.Grid(tiles[0], tiles[1], 1)
+                grid.set_grid_lims(0.0, 1.0, 0.0, 1.0)
+            else:
+                grid = pycorgi.threeD.Grid(tiles[0], tiles[1], tiles[2])
+                grid.set_grid_lims(0.0, 1.0, 0.0, 1.0, 0.0, 1.0)
+
+            rng = np.random.RandomState(7)
+            for ind in np.ndindex(*tiles[:D]):
+                if D == 2: c = pyrunko.emf.twoD.Tile(*lens)
+                else:      c = pyrunko.emf.threeD.Tile(*lens)
+                grid.add_tile(c, ind)
+
+                gs = c.get_grids()
+                for mode in range(3):
+                    for m in ms[mode]:
+                        mesh = getattr(gs, m)
+                        for i in ranges[0]:
+                            for j in ranges[1]:
+                                for k in ranges[2]:
+                                    mesh[i,j,k] = rng.rand()
+
+                if ind[0] == 1: c.communication.owner = rank + 1
+
+            for cid in grid.get_tile_ids():
+                grid.get_tile(cid).set_halo_owners(grid)
+            grids.append(grid)
+
+        for mode in range(3):
+
+            # virtual copies of the other rank only hold the packed regions
+            for cid in grids[1].get_tile_ids():
+                vir = grids[1].get_tile(cid)
+                if vir.communication.owner == rank: continue
+
+                gs = vir.get_grids()
+                for m in ms[mode]:
+                    mesh = getattr(gs, m)
+                    for i in ranges[0]:
+                        for j in ranges[1]:
+                            for k in ranges[2]:
+                                mesh[i,j,k] = 1.0e6
+                vir.copy_halos(grids[0].get_tile(cid), rank, mode)
+
+                # some of the tile is not sent
+                self.assertEqual(getattr(gs, ms[mode][0])[lens[0]//2, 0, 0], 1.0e6)
+
+            for grid in grids:
+                for cid in grid.get_tile_ids():
+                    c = grid.get_tile(cid)
+                    if c.communication.owner != rank: continue
+                    if mode == 0:
+                        c.exchange_currents(grid)
+                    else:
+                        c.update_boundaries(grid, [mode])
+
+            for cid in grids[0].get_tile_ids():
+                c1 = grids[0].get_tile(cid)
+                c2 = grids[1].get_tile(cid)
+                if c1.communication.owner != rank: continue
+
+                for m in ms[mode]:
+                    m1 = getattr(c1.get_grids(), m)
+                    m2 = getattr(c2.get_grids(), m)
+                    for i in ranges[0]:
+                        for j in ranges[1]:
+                            for k in ranges[2]:
+                                self.assertEqual(m1[i,j,k], m2[i,j,k])
+
+    def test_packed_halos2D(self):
+        self.packed_halo_exchange(2, (8, 8, 1), (3, 3, 1))
+
+    def test_packed_halos3D(self):
+        self.packed_halo_exchange(3, (8, 4, 4), (3, 2, 2))
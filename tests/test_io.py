@@ -395,6 +395,128 @@ class IO(unittest.TestCase):
                                                 places=6)
 
 
+    # collective parallel hdf5 snapshot has to match the rank 0 reduced one
+    @unittest.skipIf(not(pyrunko.emf.has_parallel_hdf5()), "hdf5 without MPI-IO")
+    def test_parallel_snapshots2D(self):
+
+        conf = Conf()
+        conf.twoD = True
+
+        conf.Nx = 3
+        conf.Ny = 4
+        conf.Nz = 1
+        conf.NxMesh = 6
+        conf.NyMesh = 4
+        conf.NzMesh = 1 
+        conf.outdir = "io_test_par_2D/"
+
+        if not os.path.exists( conf.outdir ):
+            os.makedirs(conf.outdir)
+        if not os.path.exists( conf.outdir + "par/" ):
+            os.makedirs(conf.outdir + "par/")
+
+        grid = pycorgi.twoD.Grid(conf.Nx, conf.Ny)
+        grid.set_grid_lims(conf.xmin, conf.xmax, conf.ymin, conf.ymax)
+
+        loadTiles2D(grid, conf)
+
+        ref = fill_ref(grid, conf)
+        fill_grids(grid, ref, conf)
+
+        for stride in [1, 2]:
+            writer = pyrunko.emf.twoD.FieldsWriter(conf.outdir,
+                    conf.Nx, conf.NxMesh, conf.Ny, conf.NyMesh, conf.Nz, conf.NzMesh, stride)
+            pwriter = pyrunko.emf.twoD.FieldsWriter(conf.outdir + "par/",
+                    conf.Nx, conf.NxMesh, conf.Ny, conf.NyMesh, conf.Nz, conf.NzMesh, stride, True)
+            self.assertTrue(pwriter.parallel)
+
+            writer.write(grid, stride)
+            pwriter.write(grid, stride)
+
+            f1 = h5py.File(conf.outdir          + "flds_{}.h5".format(stride), "r")
+            f2 = h5py.File(conf.outdir + "par/" + "flds_{}.h5".format(stride), "r")
+
+            for m in ["Nx", "Ny", "Nz"]:
+                self.assertEqual(f1[m][()], f2[m][()])
+
+            for m in ["jx", "jy", "jz", "ex", "ey", "ez", "bx", "by", "bz", "rho"]:
+                v1 = np.ravel(f1[m][()])
+                v2 = np.ravel(f2[m][()])
+                self.assertEqual(len(v1), len(v2))
+                np.testing.assert_allclose(v1, v2, rtol=1e-6)
+
+            f1.close()
+            f2.close()
+
+
+    def test_async_snapshots2D(self):
+
+        conf = Conf()
+        conf.twoD = True
+
+        conf.Nx = 3
+        conf.Ny = 4
+        conf.Nz = 1
+        conf.NxMesh = 6
+        conf.NyMesh = 4
+        conf.NzMesh = 1 
+        conf.outdir = "io_test_async_2D/"
+
+        if not os.path.exists( conf.outdir ):
+            os.makedirs(conf.outdir)
+        if not os.path.exists( conf.outdir + "bg/" ):
+            os.makedirs(conf.outdir + "bg/")
+
+        grid = pycorgi.twoD.Grid(conf.Nx, conf.Ny)
+        grid.set_grid_lims(conf.xmin, conf.xmax, conf.ymin, conf.ymax)
+
+        loadTiles2D(grid, conf)
+
+        ref = fill_ref(grid, conf)
+        fill_grids(grid, ref, conf)
+
+        writer = pyrunko.emf.twoD.FieldsWriter(conf.outdir,
+                conf.Nx, conf.NxMesh, conf.Ny, conf.NyMesh, conf.Nz, conf.NzMesh, 1)
+        awriter = pyrunko.emf.twoD.FieldsWriter(conf.outdir + "bg/",
+                conf.Nx, conf.NxMesh, conf.Ny, conf.NyMesh, conf.Nz, conf.NzMesh, 1)
+        awriter.async_io = True
+
+        writer.write(grid, 0)
+        awriter.write(grid, 0)
+        awriter.write(grid, 1) # waits only for its own previous file
+
+        # restart files in the background too
+        pyrunko.emf.twoD.write_grids(grid, 0, conf.outdir + "bg/", True)
+
+        # changes after the call do not end up in the files
+        fill_grids(grid, np.zeros_like(ref), conf)
+
+        pyrunko.emf.wait_io()
+        busy, waited, jobs = pyrunko.emf.io_stats()
+        self.assertEqual(jobs, 3)
+
+        f1 = h5py.File(conf.outdir + "flds_0.h5", "r")
+        for lap in [0, 1]:
+            f2 = h5py.File(conf.outdir + "bg/" + "flds_{}.h5".format(lap), "r")
+            for m in ["jx", "jy", "jz", "ex", "ey", "ez", "bx", "by", "bz", "rho"]:
+                np.testing.assert_array_equal(f1[m][()], f2[m][()])
+            f2.close()
+        f1.close()
+
+        # background restart file is complete
+        pyrunko.emf.twoD.read_grids(grid, 0, conf.outdir + "bg/")
+
+        NxM = conf.NxMesh
+        NyM = conf.NyMesh
+        for i in range(grid.get_Nx()):
+            for j in range(grid.get_Ny()):
+                gs = grid.get_tile(i,j,0).get_grids(0)
+                for q in range(conf.NxMesh):
+                    for r in range(conf.NyMesh):
+                        self.assertAlmostEqual(gs.ex[q,r,0], ref[i*NxM + q, j*NyM + r, 0, 0], places=5)
+                        self.assertAlmostEqual(gs.bz[q,r,0], ref[i*NxM + q, j*NyM + r, 0, 5], places=5)
+
+
     # compare two AdaptiveMesh3D objects and assert their equality
     def compareMeshes(self, vm, ref):
         cells = vm.get_cells(True)
@@ -550,7 +672,24 @@ class IO(unittest.TestCase):
         #print("write prtcls")
         pyrunko.pic.twoD.write_particles(grid, 0, conf.outdir)
 
-        # TODO: read with h5py
+        # one dataset per species with per-tile offsets
+        f5 = h5py.File(conf.outdir + "particles-{}_0.h5".format(grid.rank()), "r")
+        self.assertEqual(f5["Nspecies"][()], conf.Nspecies)
+        cids = f5["tiles/cid"][()]
+        self.assertEqual(len(cids), len(grid.get_local_tiles()))
+
+        for ispcs in range(conf.Nspecies):
+            offset = f5["sp-{}/offset".format(ispcs)][()]
+            self.assertEqual(len(offset), len(cids) + 1)
+            self.assertEqual(len(f5["sp-{}/x".format(ispcs)]), offset[-1])
+
+            for t, cid in enumerate(cids):
+                container = grid.get_tile(int(cid)).get_container(ispcs)
+                self.assertEqual(offset[t+1] - offset[t], container.size())
+
+                xs = f5["sp-{}/x".format(ispcs)][offset[t]:offset[t+1]]
+                np.testing.assert_allclose(xs, container.loc(0))
+        f5.close()
 
 
 
@@ -623,6 +762,186 @@ class IO(unittest.TestCase):
                             self.assertAlmostEqual(wgs1[n], wgs2[n], places=6)
 
 
+    def test_moments2D(self):
+
+        conf = Conf()
+        conf.twoD = True
+
+        conf.Nx = 3
+        conf.Ny = 4
+        conf.Nz = 1
+        conf.NxMesh = 5
+        conf.NyMesh = 6
+        conf.NzMesh = 1 
+        conf.outdir = "io_test_2D/"
+        conf.ppc = 2
+        conf.Nspecies = 2
+        conf.Nspecies_test = 0
+
+        #tmp non-needed variables
+        conf.omp = 1
+        conf.gamma_e = 0.0
+        conf.me = 1
+        conf.mi = 4
+        conf.cfl = 1.0
+        conf.c_omp = 1.0
+
+        # particles also slightly outside of the domain; they go to its edge cells
+        def filler(xloc, ispcs, conf):
+            x0 = [xloc[0] + 1.2*np.random.rand() - 0.1, xloc[1] + 1.2*np.random.rand() - 0.1, 0.0]
+            u0 = [0.1*(ispcs+1), -0.2, 0.3*xloc[0]]
+            return x0, u0
+
+        if not os.path.exists( conf.outdir ):
+            os.makedirs(conf.outdir)
+
+        grid = pycorgi.twoD.Grid(conf.Nx, conf.Ny)
+        grid.set_grid_lims(conf.xmin, conf.xmax, conf.ymin, conf.ymax)
+
+        for i in range(grid.get_Nx()):
+            for j in range(grid.get_Ny()):
+                c = pyrunko.pic.twoD.Tile(conf.NxMesh, conf.NyMesh, conf.NzMesh)
+                pytools.pic.initialize_tile(c, (i, j, 0), grid, conf)
+                grid.add_tile(c, (i,j)) 
+
+        pytools.pic.inject(grid, filler, density_profile, conf)
+
+        # reference sums over all particles
+        ref = {"dens0": 0.0, "dens1": 0.0, "pxx": 0.0, "ekin1": 0.0}
+        for cid in grid.get_local_tiles():
+            tile = grid.get_tile(cid)
+            for ispcs in range(conf.Nspecies):
+                cont = tile.get_container(ispcs)
+                w = np.array(cont.wgt())
+                u = np.array(cont.vel(0))
+                v = np.array(cont.vel(1))
+                z = np.array(cont.vel(2))
+                gam = np.sqrt(1.0 + u*u + v*v + z*z)
+
+                ref["dens{}".format(ispcs)] += np.sum(w)
+                ref["pxx"] += np.sum(w*cont.m*u*u/gam)
+                if ispcs == 1: ref["ekin1"] += np.sum(w*cont.m*(gam-1.0))
+
+        # default (legacy) moments
+        mom_writer = pyrunko.pic.twoD.PicMomentsWriter(conf.outdir,
+                conf.Nx, conf.NxMesh, conf.Ny, conf.NyMesh, conf.Nz, conf.NzMesh, 1)
+        mom_writer.write(grid, 0)
+
+        f5 = h5py.File(conf.outdir + "moms_0.h5", "r")
+        self.assertAlmostEqual(np.sum(f5["dense"][()]) /ref["dens0"], 1.0, places=5)
+        self.assertAlmostEqual(np.sum(f5["densp"][()]) /ref["dens1"], 1.0, places=5)
+        self.assertAlmostEqual(np.sum(f5["pressx"][()])/ref["pxx"],   1.0, places=5)
+
+        # all ions have the same vx = u/gamma; cells without particles stay zero
+        densp = f5["densp"][()]
+        vxp   = f5["Vxp"][()]
+        vx_ref = 0.2/np.sqrt(1.0 + 0.2**2 + 0.2**2 + (0.3*np.arange(conf.Nx*conf.NxMesh))**2)
+        self.assertTrue(np.all(vxp[densp <= 0.0] == 0.0))
+        self.assertTrue(np.all(vxp[densp > 0.0] <= 0.2))
+        self.assertTrue(np.all(vxp[densp > 0.0] >= vx_ref.min() - 1e-6))
+        f5.close()
+
+        # user-selected moments with a cic shape; sums are conserved
+        mom_writer.clear_moments()
+        mom_writer.add_moment("n_ion", "dens", 1)
+        mom_writer.add_moment("vy_ion", "vy", 1)
+        mom_writer.add_moment("ekin_ion", "ekin", 1)
+        mom_writer.shape = 1
+
+        with self.assertRaises(Exception):
+            mom_writer.add_moment("bad", "xyz", 0)
+
+        mom_writer.write(grid, 1)
+
+        f5 = h5py.File(conf.outdir + "moms_1.h5", "r")
+        self.assertEqual(sorted(f5.keys()), ["Nx", "Ny", "Nz", "ekin_ion", "n_ion", "vy_ion"])
+        n_ion = f5["n_ion"][()]
+        vy_ion = f5["vy_ion"][()]
+        self.assertAlmostEqual(np.sum(n_ion)/ref["dens1"], 1.0, places=5)
+        self.assertAlmostEqual(np.sum(f5["ekin_ion"][()])/ref["ekin1"], 1.0, places=5)
+        self.assertTrue(np.all(vy_ion[n_ion > 0.0] < 0.0))
+        f5.close()
+
+
+    # parallel moments have to match the serial ones; with CIC/TSC shapes the
+    # ghost cells of the tile blocks are summed into the neighboring tiles
+    @unittest.skipIf(not(pyrunko.emf.has_parallel_hdf5()), "hdf5 without MPI-IO")
+    def test_parallel_moments2D(self):
+
+        conf = Conf()
+        conf.twoD = True
+
+        conf.Nx = 3
+        conf.Ny = 4
+        conf.Nz = 1
+        conf.NxMesh = 6
+        conf.NyMesh = 4
+        conf.NzMesh = 1 
+        conf.outdir = "io_test_par_mom_2D/"
+        conf.ppc = 2
+        conf.Nspecies = 2
+        conf.Nspecies_test = 0
+
+        #tmp non-needed variables
+        conf.omp = 1
+        conf.gamma_e = 0.0
+        conf.me = 1
+        conf.mi = 4
+        conf.cfl = 1.0
+        conf.c_omp = 1.0
+
+        # particles also slightly outside of the domain; they go to its edge cells
+        def filler(xloc, ispcs, conf):
+            x0 = [xloc[0] + 1.2*np.random.rand() - 0.1, xloc[1] + 1.2*np.random.rand() - 0.1, 0.0]
+            u0 = [0.1*(ispcs+1), -0.2, 0.3*xloc[0]]
+            return x0, u0
+
+        if not os.path.exists( conf.outdir ):
+            os.makedirs(conf.outdir)
+        if not os.path.exists( conf.outdir + "par/" ):
+            os.makedirs(conf.outdir + "par/")
+
+        grid = pycorgi.twoD.Grid(conf.Nx, conf.Ny)
+        grid.set_grid_lims(conf.xmin, conf.xmax, conf.ymin, conf.ymax)
+
+        for i in range(grid.get_Nx()):
+            for j in range(grid.get_Ny()):
+                c = pyrunko.pic.twoD.Tile(conf.NxMesh, conf.NyMesh, conf.NzMesh)
+                pytools.pic.initialize_tile(c, (i, j, 0), grid, conf)
+                grid.add_tile(c, (i,j)) 
+
+        pytools.pic.inject(grid, filler, density_profile, conf)
+
+        for stride in [1, 2]:
+            for shape in [0, 1, 2]:
+                writer = pyrunko.pic.twoD.PicMomentsWriter(conf.outdir,
+                        conf.Nx, conf.NxMesh, conf.Ny, conf.NyMesh, conf.Nz, conf.NzMesh, stride)
+                pwriter = pyrunko.pic.twoD.PicMomentsWriter(conf.outdir + "par/",
+                        conf.Nx, conf.NxMesh, conf.Ny, conf.NyMesh, conf.Nz, conf.NzMesh, stride, True)
+                self.assertTrue(pwriter.parallel)
+
+                writer.shape = shape
+                pwriter.shape = shape
+                self.assertEqual(pwriter.shape, shape)
+
+                lap = 10*stride + shape
+                writer.write(grid, lap)
+                pwriter.write(grid, lap)
+
+                f1 = h5py.File(conf.outdir          + "moms_{}.h5".format(lap), "r")
+                f2 = h5py.File(conf.outdir + "par/" + "moms_{}.h5".format(lap), "r")
+
+                self.assertEqual(sorted(f1.keys()), sorted(f2.keys()))
+                for m in f1.keys():
+                    v1 = np.ravel(f1[m][()])
+                    v2 = np.ravel(f2[m][()])
+                    self.assertEqual(len(v1), len(v2))
+                    np.testing.assert_allclose(v1, v2, rtol=1e-5, atol=1e-6)
+
+                f1.close()
+                f2.close()
+
+
 
 
 
@@ -627,6 +627,160 @@ class PIC(unittest.TestCase):
 
 
 
+    # halos and particles of ranks on the same node sent through the shared memory 
+    # window must give the same fields and particles as plain mpi messages. Run with 
+    # more than one rank (mpirun -np 2) to exercise the window; a single rank has 
+    # no on-node neighbors and all three runs take the mpi paths.
+    def test_shm_exchange(self):
+
+        conf = Conf()
+        conf.twoD = True
+        conf.Nx = 4
+        conf.Ny = 4
+        conf.NxMesh = 4
+        conf.NyMesh = 4
+        conf.ppc = 2
+        conf.vel = 0.3
+        conf.update_bbox()
+
+        def run(packed, mbytes):
+            np.random.seed(42)
+
+            sch = pytools.Scheduler(print_banner=False)
+            sch.timer = pytools.Timer()
+
+            grid = pycorgi.twoD.Grid(conf.Nx, conf.Ny, conf.Nz)
+            grid.set_grid_lims(conf.xmin, conf.xmax, conf.ymin, conf.ymax)
+            sch.grid = grid
+
+            pytools.balance_mpi(grid, conf, do_print=False)
+            pytools.pic.load_tiles(grid, conf)
+            insert_em(grid, conf, linear_field)
+            pytools.pic.inject(grid, filler, density_profile, conf)
+
+            sch.fldpropE = pyrunko.emf.twoD.FDTD2()
+            sch.fldpropB = pyrunko.emf.twoD.FDTD2()
+            sch.fintp    = pyrunko.pic.twoD.LinearInterpolator()
+            sch.pusher   = pyrunko.pic.twoD.BorisPusher()
+            sch.currint  = pyrunko.pic.twoD.ZigZag()
+
+            grid.analyze_boundaries()
+            grid.send_tiles()
+            grid.recv_tiles()
+            MPI.COMM_WORLD.barrier()
+            pytools.pic.load_virtual_tiles(grid, conf)
+
+            if packed:
+                sch.set_packed_halos()
+            if mbytes is not None:
+                sch.set_shm_exchange(mbytes)
+
+            for lap in range(4):
+                sch.operate( dict(name='mpi_b0', solver='mpi',  method='b', ) )
+                sch.operate( dict(name='mpi_e0', solver='mpi',  method='e', ) )
+                sch.operate( dict(name='upd_bc', solver='tile', method='update_boundaries', args=[grid,[1,2]], nhood='local', ) )
+
+                sch.operate( dict(name='push_half_b1', solver='fldpropB', method='push_half_b', nhood='local', ) )
+                sch.operate( dict(name='mpi_b1', solver='mpi',  method='b', ) )
+                sch.operate( dict(name='upd_bc', solver='tile', method='update_boundaries', args=[grid,[2,]], nhood='local', ) )
+
+                sch.operate( dict(name='interp_em', solver='fintp',  method='solve', nhood='local', ) )
+                sch.operate( dict(name='push',      solver='pusher', method='solve', nhood='local', ) )
+                sch.operate( dict(name='clear_cur', solver='tile',   method='clear_current', nhood='all', ) )
+
+                sch.operate( dict(name='push_half_b2', solver='fldpropB', method='push_half_b', nhood='local', ) )
+                sch.operate( dict(name='mpi_b2', solver='mpi',  method='b', ) )
+                sch.operate( dict(name='upd_bc', solver='tile', method='update_boundaries', args=[grid,[2,]], nhood='local', ) )
+                sch.operate( dict(name='push_e', solver='fldpropE', method='push_e', nhood='local', ) )
+
+                sch.operate( dict(name='check_outg_prtcls',     solver='tile', method='check_outgoing_particles',     nhood='local', ) )
+                sch.operate( dict(name='pack_outg_prtcls',      solver='tile', method='pack_outgoing_particles',      nhood='boundary', ) )
+                sch.operate( dict(name='mpi_prtcls',            solver='mpi',  method='p1',                           nhood='all', ) )
+                sch.operate( dict(name='mpi_prtcls',            solver='mpi',  method='p2',                           nhood='all', ) )
+                sch.operate( dict(name='unpack_vir_prtcls',     solver='tile', method='unpack_incoming_particles',    nhood='virtual', ) )
+                sch.operate( dict(name='check_outg_vir_prtcls', solver='tile', method='check_outgoing_particles',     nhood='virtual', ) )
+                sch.operate( dict(name='get_inc_prtcls',        solver='tile', method='get_incoming_particles',       nhood='local', args=[grid,]) )
+                sch.operate( dict(name='del_trnsfrd_prtcls',    solver='tile', method='delete_transferred_particles', nhood='local', ) )
+                sch.operate( dict(name='del_vir_prtcls',        solver='tile', method='delete_all_particles',         nhood='virtual', ) )
+
+                sch.operate( dict(name='comp_curr',     solver='currint', method='solve', nhood='local', ) )
+                sch.operate( dict(name='clear_vir_cur', solver='tile', method='clear_current',     nhood='virtual', ) )
+                sch.operate( dict(name='mpi_cur',       solver='mpi',  method='j',                 nhood='all', ) )
+                sch.operate( dict(name='cur_exchange',  solver='tile', method='exchange_currents', nhood='local', args=[grid,], ) )
+
+            # particles and meshes of the local tiles
+            res = {}
+            for tile in pytools.tiles_local(grid):
+                con = tile.get_container(0)
+                prtcls = [ [con[n,v] for v in range(6)] for n in range(con.size()) ]
+
+                gs = tile.get_grids()
+                meshes = [ [getattr(gs, m)[i,j,0] for j in range(conf.NyMesh) for i in range(conf.NxMesh)]
+                           for m in ['ex', 'ey', 'ez', 'bx', 'by', 'bz', 'jx', 'jy', 'jz'] ]
+                res[tile.cid] = (prtcls, meshes)
+
+            if mbytes is not None:
+                pyrunko.tools.shm_free()
+
+            return res
+
+        ref = run(False, None)
+
+        # packed halos and particles through the window; particles only through a 
+        # window of 100 bytes so that most particle messages fall back to mpi
+        for packed, mbytes in [(True, 1.0), (False, 1.0e-4)]:
+            res = run(packed, mbytes)
+
+            self.assertEqual(sorted(res.keys()), sorted(ref.keys()))
+            for cid in ref:
+                self.assertEqual(res[cid][0], ref[cid][0])
+                self.assertEqual(res[cid][1], ref[cid][1])
+
+
+    # packed halos that do not fit into the shared memory window stop at setup 
+    def test_shm_capacity(self):
+
+        conf = Conf()
+        conf.twoD = True
+        conf.Nx = 4
+        conf.Ny = 4
+        conf.NxMesh = 4
+        conf.NyMesh = 4
+        conf.update_bbox()
+
+        sch = pytools.Scheduler(print_banner=False)
+        grid = pycorgi.twoD.Grid(conf.Nx, conf.Ny, conf.Nz)
+        grid.set_grid_lims(conf.xmin, conf.xmax, conf.ymin, conf.ymax)
+        sch.grid = grid
+
+        pytools.balance_mpi(grid, conf, do_print=False)
+        pytools.pic.load_tiles(grid, conf)
+        grid.analyze_boundaries()
+        grid.send_tiles()
+        grid.recv_tiles()
+        MPI.COMM_WORLD.barrier()
+        pytools.pic.load_virtual_tiles(grid, conf)
+
+        sch.set_packed_halos()
+        sch.set_shm_exchange(1.0)
+        self.assertEqual(pyrunko.tools.shm_capacity(), 1024**2)
+
+        # 3 components of 4 byte floats per packed halo cell
+        words = [ sum(tile.shm_halo_words(mode) for tile in pytools.tiles_local(grid)) for mode in range(3) ]
+        for w in words:
+            self.assertEqual(w % 3, 0)
+        self.assertGreaterEqual(words[0], words[1]) # currents include the halo strips
+        self.assertEqual(words[1], words[2])
+
+        # 40 bytes is less than any packed halo message 
+        on_node = MPI.COMM_WORLD.allreduce(max(words) > 0, op=MPI.LOR)
+        if on_node:
+            with self.assertRaises(RuntimeError):
+                sch.set_shm_exchange(40.0/1024**2)
+
+        pyrunko.tools.shm_free()
+
+
     def test_const_field_interpolation_2d(self):
 
         conf = Conf()
@@ -1251,6 +1405,906 @@ class PIC(unittest.TestCase):
                                     self.assertAlmostEqual(gs.jz[l,m,n], 0.0, places=5 )
 
 
+    def test_cell_sorting(self):
+        # cell-ordered particles must give the same interpolated fields and 
+        # deposited currents as the unsorted ones
+
+        conf = Conf()
+        conf.threeD = True
+        conf.NxMesh = 5
+        conf.NyMesh = 6
+        conf.NzMesh = 7
+        conf.ppc = 4
+        conf.update_bbox()
+
+        grid = pycorgi.threeD.Grid(conf.Nx, conf.Ny, conf.Nz)
+        grid.set_grid_lims(conf.xmin, conf.xmax, conf.ymin, conf.ymax, conf.zmin, conf.zmax)
+        pytools.pic.load_tiles(grid, conf)
+
+        tile = grid.get_tile(0,0,0)
+        container = tile.get_container(0)
+
+        # random (unordered) particle locations
+        Np = conf.ppc*conf.NxMesh*conf.NyMesh*conf.NzMesh
+        for n in range(Np):
+            x0 = [randab(0.0, conf.NxMesh), randab(0.0, conf.NyMesh), randab(0.0, conf.NzMesh)]
+            u0 = [randab(-0.1, 0.1), randab(-0.1, 0.1), randab(-0.1, 0.1)]
+            container.add_particle(x0, u0, 1.0)
+
+        gs = tile.get_grids(0)
+        for k in range(conf.NzMesh):
+            for j in range(conf.NyMesh):
+                for i in range(conf.NxMesh):
+                    gs.ex[i,j,k] = randab(-1.0, 1.0)
+                    gs.ey[i,j,k] = randab(-1.0, 1.0)
+                    gs.ez[i,j,k] = randab(-1.0, 1.0)
+                    gs.bx[i,j,k] = randab(-1.0, 1.0)
+                    gs.by[i,j,k] = randab(-1.0, 1.0)
+                    gs.bz[i,j,k] = randab(-1.0, 1.0)
+
+        fintp = pyrunko.pic.threeD.LinearInterpolator()
+        currint = pyrunko.pic.threeD.ZigZag()
+
+        def interpolate():
+            fintp.solve(tile)
+            ids0 = container.id(0)
+            ids1 = container.id(1)
+            return { (ids0[n], ids1[n]): [container[n,v] for v in range(6,12)] for n in range(container.size()) }
+
+        def deposit():
+            currint.solve(tile)
+            return [ [gs.jx[l,m,n], gs.jy[l,m,n], gs.jz[l,m,n]] 
+                    for l in range(conf.NxMesh) for m in range(conf.NyMesh) for n in range(conf.NzMesh) ]
+
+        def cell_keys():
+            xs = container.loc(0)
+            ys = container.loc(1)
+            zs = container.loc(2)
+            return [ int(np.floor(xs[n])) + conf.NxMesh*(int(np.floor(ys[n])) + conf.NyMesh*int(np.floor(zs[n])))
+                    for n in range(container.size()) ]
+
+        ref_flds = interpolate()
+        ref_curs = deposit()
+        self.assertFalse(container.cells_sorted)
+
+        for full in [True, False]:
+            if not(full):
+                # move some particles into other cells; invalidates the ordering
+                for n in range(0, container.size(), 7):
+                    container[n,0] = randab(0.0, conf.NxMesh)
+                self.assertFalse(container.cells_sorted)
+
+                ref_flds = interpolate()
+                ref_curs = deposit()
+
+            tile.sort_particles_in_cells(full)
+            self.assertTrue(container.cells_sorted)
+            self.assertEqual(container.size(), Np)
+
+            keys = cell_keys()
+            self.assertTrue( all(keys[n] <= keys[n+1] for n in range(len(keys)-1)) )
+
+            flds = interpolate()
+            self.assertEqual(len(flds), len(ref_flds))
+            for key, val in ref_flds.items():
+                for v in range(6):
+                    self.assertAlmostEqual(flds[key][v], val[v], places=6)
+
+            curs = deposit()
+            for c, cref in zip(curs, ref_curs):
+                for v in range(3):
+                    self.assertAlmostEqual(c[v], cref[v], places=5)
+
+        # tile and container default to the same (full) sort
+        for n in range(0, container.size(), 3):
+            container[n,0] = randab(0.0, conf.NxMesh)
+        tile.sort_particles_in_cells()
+        self.assertTrue(container.cells_sorted)
+        keys = cell_keys()
+        self.assertTrue( all(keys[n] <= keys[n+1] for n in range(len(keys)-1)) )
+
+
+    def test_particle_tracking(self):
+        # tracked particle index has to follow particles through sorting, 
+        # deletion, and appending
+
+        conf = Conf()
+        conf.threeD = True
+        conf.NxMesh = 5
+        conf.NyMesh = 6
+        conf.NzMesh = 7
+        conf.ppc = 4
+        conf.update_bbox()
+
+        grid = pycorgi.threeD.Grid(conf.Nx, conf.Ny, conf.Nz)
+        grid.set_grid_lims(conf.xmin, conf.xmax, conf.ymin, conf.ymax, conf.zmin, conf.zmax)
+        pytools.pic.load_tiles(grid, conf)
+
+        tile = grid.get_tile(0,0,0)
+        container = tile.get_container(0)
+        container.set_keygen_state(0, 0)
+
+        def add_random(N):
+            xs = np.random.rand(N,3)*[conf.NxMesh, conf.NyMesh, conf.NzMesh]
+            us = np.random.rand(N,3) - 0.5
+            container.append_particles(xs[:,0], xs[:,1], xs[:,2], us[:,0], us[:,1], us[:,2], np.ones(N))
+
+        stride, cutoff = 3, 500
+        def check():
+            ids = container.id(0)
+            ref = sorted(i for i in ids if i < cutoff and i % stride == 0)
+            trk = container.tracked()
+            self.assertEqual(len(trk), len(set(trk)))
+            self.assertEqual(sorted(ids[n] for n in trk), ref)
+
+        add_random(300)
+        container.enable_tracking(stride, cutoff)
+        self.assertEqual(container.track_stride, stride)
+        check()
+
+        add_random(200) # new particles are indexed when added
+        container.add_particle([0.5, 0.5, 0.5], [0.0, 0.0, 0.0], 1.0)
+        check()
+
+        tile.sort_particles_in_cells(True)
+        check()
+
+        for n in range(0, container.size(), 5):
+            container[n,0] = randab(0.0, conf.NxMesh)
+        tile.sort_particles_in_cells(False)
+        check()
+
+        # remove particles that leave the tile
+        for n in range(0, container.size(), 4):
+            container[n,0] = -1.0
+        tile.check_outgoing_particles()
+        tile.delete_transferred_particles()
+        self.assertLess(container.size(), 501)
+        check()
+
+        tile.delete_all_particles()
+        self.assertEqual(len(container.tracked()), 0)
+
+        container.enable_tracking(0, 0)
+        add_random(10)
+        self.assertEqual(len(container.tracked()), 0)
+
+
+    def test_private_currents(self):
+        # thread-private current accumulation must give the same currents 
+        # as the atomic deposit for all zigzag variants
+
+        conf = Conf()
+        conf.threeD = True
+        conf.NxMesh = 5
+        conf.NyMesh = 6
+        conf.NzMesh = 7
+        conf.ppc = 4
+        conf.update_bbox()
+
+        grid = pycorgi.threeD.Grid(conf.Nx, conf.Ny, conf.Nz)
+        grid.set_grid_lims(conf.xmin, conf.xmax, conf.ymin, conf.ymax, conf.zmin, conf.zmax)
+        pytools.pic.load_tiles(grid, conf)
+
+        tile = grid.get_tile(0,0,0)
+        container = tile.get_container(0)
+
+        Np = conf.ppc*conf.NxMesh*conf.NyMesh*conf.NzMesh
+        for n in range(Np):
+            x0 = [randab(0.0, conf.NxMesh), randab(0.0, conf.NyMesh), randab(0.0, conf.NzMesh)]
+            u0 = [randab(-0.1, 0.1), randab(-0.1, 0.1), randab(-0.1, 0.1)]
+            container.add_particle(x0, u0, 1.0)
+
+        gs = tile.get_grids(0)
+
+        def deposit(currint):
+            currint.solve(tile)
+            return [ [gs.jx[l,m,n], gs.jy[l,m,n], gs.jz[l,m,n]] 
+                    for l in range(conf.NxMesh) for m in range(conf.NyMesh) for n in range(conf.NzMesh) ]
+
+        for Depositer in [
+                pyrunko.pic.threeD.ZigZag, 
+                pyrunko.pic.threeD.ZigZag_2nd,
+                pyrunko.pic.threeD.ZigZag_3rd,
+                pyrunko.pic.threeD.ZigZag_4th,
+                ]:
+            currint = Depositer()
+            self.assertFalse(currint.private_currents)
+            ref_curs = deposit(currint)
+
+            currint.private_currents = True
+            for rep in range(2): # second call re-uses the scratch arrays
+                curs = deposit(currint)
+                for c, cref in zip(curs, ref_curs):
+                    for v in range(3):
+                        self.assertAlmostEqual(c[v], cref[v], places=5)
+
+        # cell-ordered path
+        currint = pyrunko.pic.threeD.ZigZag()
+        ref_curs = deposit(currint)
+        tile.sort_particles_in_cells(True)
+
+        currint.private_currents = True
+        curs = deposit(currint)
+        for c, cref in zip(curs, ref_curs):
+            for v in range(3):
+                self.assertAlmostEqual(c[v], cref[v], places=5)
+
+
+    def test_fused_kernel(self):
+        # fused interpolate-push-deposit must give the same particles and 
+        # currents as the separate interpolator, pusher, and depositer
+
+        conf = Conf()
+        conf.threeD = True
+        conf.NxMesh = 5
+        conf.NyMesh = 6
+        conf.NzMesh = 7
+        conf.ppc = 4
+        conf.update_bbox()
+
+        def make_tile():
+            grid = pycorgi.threeD.Grid(conf.Nx, conf.Ny, conf.Nz)
+            grid.set_grid_lims(conf.xmin, conf.xmax, conf.ymin, conf.ymax, conf.zmin, conf.zmax)
+            pytools.pic.load_tiles(grid, conf)
+            return grid, grid.get_tile(0,0,0)
+
+        # same random particles and fields in both tiles
+        grid_ref, tile_ref = make_tile()
+        grid_fus, tile_fus = make_tile()
+
+        Np = conf.ppc*conf.NxMesh*conf.NyMesh*conf.NzMesh
+        for n in range(Np):
+            x0 = [randab(1.0, conf.NxMesh-1), randab(1.0, conf.NyMesh-1), randab(1.0, conf.NzMesh-1)]
+            u0 = [randab(-1.0, 1.0), randab(-1.0, 1.0), randab(-1.0, 1.0)]
+            for tile in [tile_ref, tile_fus]:
+                tile.get_container(0).add_particle(x0, u0, 1.0)
+
+        for k in range(-1, conf.NzMesh+1):
+            for j in range(-1, conf.NyMesh+1):
+                for i in range(-1, conf.NxMesh+1):
+                    flds = [randab(-0.1, 0.1) for f in range(6)]
+                    for tile in [tile_ref, tile_fus]:
+                        gs = tile.get_grids(0)
+                        gs.ex[i,j,k], gs.ey[i,j,k], gs.ez[i,j,k] = flds[0:3]
+                        gs.bx[i,j,k], gs.by[i,j,k], gs.bz[i,j,k] = flds[3:6]
+
+        fintp   = pyrunko.pic.threeD.LinearInterpolator()
+        currint = pyrunko.pic.threeD.ZigZag()
+
+        # test particles get their interpolated fields also from the fused kernel
+        tile_fus.get_container(0).enable_tracking(2, 1000000)
+        self.assertTrue(len(tile_fus.get_container(0).tracked()) > 0)
+
+        for Pusher, Fused in [
+                (pyrunko.pic.threeD.BorisPusher,       pyrunko.pic.threeD.FusedBorisZigZag),
+                (pyrunko.pic.threeD.HigueraCaryPusher, pyrunko.pic.threeD.FusedHigueraCaryZigZag),
+                ]:
+            for private in [False, True]:
+                pusher = Pusher()
+                pusher.bz_ext = 0.05
+
+                fused = Fused()
+                fused.bz_ext = 0.05
+                fused.private_currents = private
+
+                fintp.solve(tile_ref)
+                pusher.solve(tile_ref)
+                currint.solve(tile_ref)
+
+                fused.solve(tile_fus)
+
+                con_ref = tile_ref.get_container(0)
+                con_fus = tile_fus.get_container(0)
+                for n in range(Np):
+                    for v in range(6):
+                        self.assertAlmostEqual(con_fus[n,v], con_ref[n,v], places=5)
+
+                for n in con_fus.tracked():
+                    for v in range(6, 12):
+                        self.assertAlmostEqual(con_fus[n,v], con_ref[n,v], places=5)
+
+                gs_ref = tile_ref.get_grids(0)
+                gs_fus = tile_fus.get_grids(0)
+                for k in range(conf.NzMesh):
+                    for j in range(conf.NyMesh):
+                        for i in range(conf.NxMesh):
+                            self.assertAlmostEqual(gs_fus.jx[i,j,k], gs_ref.jx[i,j,k], places=5)
+                            self.assertAlmostEqual(gs_fus.jy[i,j,k], gs_ref.jy[i,j,k], places=5)
+                            self.assertAlmostEqual(gs_fus.jz[i,j,k], gs_ref.jz[i,j,k], places=5)
+
+
+    def test_external_field_policies(self):
+        # tabulated and dipole external fields must act like the equivalent 
+        # uniform external field at the particle location
+
+        conf = Conf()
+        conf.threeD = True
+        conf.NxMesh = 5
+        conf.NyMesh = 5
+        conf.NzMesh = 5
+        conf.update_bbox()
+
+        B0 = 20.0
+        cen = [-3.0, 1.0, -2.0]
+
+        def push_one(x0, u0, setup):
+            grid = pycorgi.threeD.Grid(conf.Nx, conf.Ny, conf.Nz)
+            grid.set_grid_lims(conf.xmin, conf.xmax, conf.ymin, conf.ymax, conf.zmin, conf.zmax)
+            pytools.pic.load_tiles(grid, conf)
+            tile = grid.get_tile(0,0,0)
+            tile.get_container(0).add_particle(x0, u0, 1.0)
+
+            pyrunko.pic.threeD.LinearInterpolator().solve(tile) # zero fields
+            pusher = pyrunko.pic.threeD.BorisPusher()
+            setup(pusher)
+            pusher.solve(tile)
+
+            con = tile.get_container(0)
+            return [con[0,v] for v in range(6)]
+
+        for n in range(5):
+            x0 = [randab(1.0, conf.NxMesh-1), randab(1.0, conf.NyMesh-1), randab(1.0, conf.NzMesh-1)]
+            u0 = [randab(-1.0, 1.0), randab(-1.0, 1.0), randab(-1.0, 1.0)]
+
+            # dipole along z; B0*(3 z r/r^5 - zhat/r^3)
+            r = [x0[i] - cen[i] for i in range(3)]
+            rad = np.sqrt(r[0]**2 + r[1]**2 + r[2]**2)
+            bdip = [B0*(3.0*r[2]*r[i]/rad**5 - (1.0 if i == 2 else 0.0)/rad**3) for i in range(3)]
+
+            def uniform(p):
+                p.ey_ext = 0.01
+                p.bx_ext, p.by_ext, p.bz_ext = bdip
+
+            def dipole(p):
+                p.ey_ext = 0.01
+                p.dipole_B0 = B0
+                p.dipole_cenx, p.dipole_ceny, p.dipole_cenz = cen
+
+            def table(p):
+                p.ey_ext = 0.01
+                p.set_ext_table(0, -10.0, 30.0, 2*([0.0, 0.0, 0.0] + bdip))
+
+            ref = push_one(x0, u0, uniform)
+            for setup in [dipole, table]:
+                prtcl = push_one(x0, u0, setup)
+                for v in range(6):
+                    self.assertAlmostEqual(prtcl[v], ref[v], places=5)
+
+
+    def test_simd_pushers(self):
+        # explicitly vectorized pushers must agree with the scalar loops
+
+        conf = Conf()
+        conf.threeD = True
+        conf.NxMesh = 5
+        conf.NyMesh = 5
+        conf.NzMesh = 5
+        conf.ppc = 3 # 375 particles; last simd block is partial
+        conf.update_bbox()
+
+        def make_tile():
+            grid = pycorgi.threeD.Grid(conf.Nx, conf.Ny, conf.Nz)
+            grid.set_grid_lims(conf.xmin, conf.xmax, conf.ymin, conf.ymax, conf.zmin, conf.zmax)
+            pytools.pic.load_tiles(grid, conf)
+            return grid, grid.get_tile(0,0,0)
+
+        grid_ref, tile_ref = make_tile()
+        grid_vec, tile_vec = make_tile()
+
+        Np = conf.ppc*conf.NxMesh*conf.NyMesh*conf.NzMesh
+        for n in range(Np):
+            x0 = [randab(1.0, conf.NxMesh-1), randab(1.0, conf.NyMesh-1), randab(1.0, conf.NzMesh-1)]
+            u0 = [randab(-1.0, 1.0), randab(-1.0, 1.0), randab(-1.0, 1.0)]
+            for tile in [tile_ref, tile_vec]:
+                tile.get_container(0).add_particle(x0, u0, 1.0)
+
+        for k in range(-1, conf.NzMesh+1):
+            for j in range(-1, conf.NyMesh+1):
+                for i in range(-1, conf.NxMesh+1):
+                    flds = [randab(-0.1, 0.1) for f in range(6)]
+                    for tile in [tile_ref, tile_vec]:
+                        gs = tile.get_grids(0)
+                        gs.ex[i,j,k], gs.ey[i,j,k], gs.ez[i,j,k] = flds[0:3]
+                        gs.bx[i,j,k], gs.by[i,j,k], gs.bz[i,j,k] = flds[3:6]
+
+        fintp = pyrunko.pic.threeD.LinearInterpolator()
+
+        for Pusher in [
+                pyrunko.pic.threeD.BorisPusher,
+                pyrunko.pic.threeD.VayPusher,
+                pyrunko.pic.threeD.HigueraCaryPusher,
+                ]:
+            pusher_ref = Pusher()
+            pusher_vec = Pusher()
+            pusher_vec.use_simd = True
+            for pusher in [pusher_ref, pusher_vec]:
+                pusher.bz_ext = 0.05
+
+            fintp.solve(tile_ref)
+            fintp.solve(tile_vec)
+            pusher_ref.solve(tile_ref)
+            pusher_vec.solve(tile_vec)
+
+            con_ref = tile_ref.get_container(0)
+            con_vec = tile_vec.get_container(0)
+            for n in range(Np):
+                for v in range(6):
+                    self.assertAlmostEqual(con_vec[n,v], con_ref[n,v], places=5)
+
+
+    def test_task_scheduler(self):
+        # lap run by the C++ TaskScheduler must give the same particles and 
+        # currents as calling the same ops tile by tile
+
+        conf = Conf()
+        conf.twoD = True
+        conf.Nx = 3
+        conf.Ny = 3
+        conf.NxMesh = 4
+        conf.NyMesh = 4
+        conf.ppc = 2
+        conf.vel = 0.3
+        conf.update_bbox()
+
+        def make_grid():
+            np.random.seed(42)
+            grid = pycorgi.twoD.Grid(conf.Nx, conf.Ny, conf.Nz)
+            grid.set_grid_lims(conf.xmin, conf.xmax, conf.ymin, conf.ymax)
+            pytools.pic.load_tiles(grid, conf)
+            insert_em(grid, conf, zero_field, zero_field=True)
+            pytools.pic.inject(grid, filler, density_profile, conf)
+            return grid
+
+        grid_ref = make_grid()
+        grid_tsk = make_grid()
+
+        fintp   = pyrunko.pic.twoD.LinearInterpolator()
+        pusher  = pyrunko.pic.twoD.BorisPusher()
+        currint = pyrunko.pic.twoD.ZigZag()
+        pusher.bz_ext = 0.1
+
+        # python op; called once per local tile
+        class Counter:
+            calls = 0
+            def count(self, tile):
+                self.calls += 1
+        counter = Counter()
+
+        tasks = pyrunko.pic.twoD.TaskScheduler(grid_tsk)
+        tasks.add_solver('interp_em', fintp, 'local')
+        tasks.add_solver('push', pusher, 'local')
+        tasks.add_tile_op('check_outg_prtcls', 'check_outgoing_particles', 'local')
+        tasks.add_tile_op('get_inc_prtcls', 'get_incoming_particles', 'local')
+        tasks.add_tile_op('del_trnsfrd_prtcls', 'delete_transferred_particles', 'local')
+        tasks.add_tile_op('clear_cur', 'clear_current', 'all')
+        tasks.add_solver('comp_curr', currint, 'local')
+        tasks.add_tile_op('cur_exchange', 'exchange_currents', 'local')
+        tasks.add_op('count', counter, 'count', 'local')
+
+        for lap in range(5):
+            tasks.run()
+
+            for method in ['interp', 'push', 'check_outgoing_particles', 'get_incoming_particles', 
+                           'delete_transferred_particles', 'clear_current', 'currint', 'exchange_currents']:
+                for tile in pytools.tiles_local(grid_ref):
+                    if method == 'interp':                   fintp.solve(tile)
+                    elif method == 'push':                   pusher.solve(tile)
+                    elif method == 'currint':                currint.solve(tile)
+                    elif method == 'get_incoming_particles': tile.get_incoming_particles(grid_ref)
+                    elif method == 'exchange_currents':      tile.exchange_currents(grid_ref)
+                    else: getattr(tile, method)()
+
+        self.assertEqual(counter.calls, 5*conf.Nx*conf.Ny)
+        self.assertTrue('push' in tasks.timings)
+
+        for tile_ref, tile_tsk in zip(pytools.tiles_local(grid_ref), pytools.tiles_local(grid_tsk)):
+            con_ref = tile_ref.get_container(0)
+            con_tsk = tile_tsk.get_container(0)
+            self.assertEqual(con_tsk.size(), con_ref.size())
+
+            for n in range(con_ref.size()):
+                for v in range(6):
+                    self.assertAlmostEqual(con_tsk[n,v], con_ref[n,v], places=5)
+
+            gs_ref = tile_ref.get_grids(0)
+            gs_tsk = tile_tsk.get_grids(0)
+            for j in range(conf.NyMesh):
+                for i in range(conf.NxMesh):
+                    self.assertAlmostEqual(gs_tsk.jx[i,j,0], gs_ref.jx[i,j,0], places=5)
+                    self.assertAlmostEqual(gs_tsk.jy[i,j,0], gs_ref.jy[i,j,0], places=5)
+
+
+    def test_task_scheduler_lap(self):
+        # TaskScheduler lap of the turbulence project (build_lap_tasks) must give
+        # the same fields and particles as its python lap (python_lap)
+        import importlib.util
+        path = os.path.join(os.path.dirname(os.path.abspath(__file__)), '..', 'projects', 'pic-turbulence')
+        sys.path.insert(0, path)
+        try:
+            spec = importlib.util.spec_from_file_location("turbulence_pic", os.path.join(path, 'pic.py'))
+            turb = importlib.util.module_from_spec(spec)
+            spec.loader.exec_module(turb)
+        finally:
+            sys.path.remove(path)
+
+        conf = Conf()
+        conf.twoD = True
+        conf.Nx = 3
+        conf.Ny = 3
+        conf.NxMesh = 4
+        conf.NyMesh = 4
+        conf.Nspecies = 2
+        conf.ppc = 2
+        conf.vel = 0.3
+        conf.npasses = 2
+        conf.sort_interval = 2
+        conf.update_bbox()
+
+        # python antenna; adds a constant current
+        class Antenna:
+            def update_rnd_phases(self):
+                pass
+            def add_ext_cur(self, tile):
+                gs = tile.get_grids(0)
+                gs.jz[1,1,0] += 0.01
+
+        def make_sch():
+            np.random.seed(42)
+            grid = pycorgi.twoD.Grid(conf.Nx, conf.Ny, conf.Nz)
+            grid.set_grid_lims(conf.xmin, conf.xmax, conf.ymin, conf.ymax)
+            pytools.pic.load_tiles(grid, conf)
+            insert_em(grid, conf, const_field)
+            pytools.pic.inject(grid, filler, density_profile, conf)
+
+            sch = pytools.Scheduler(print_banner=False)
+            sch.grid  = grid
+            sch.timer = pytools.Timer()
+
+            sch.fldpropE = pyrunko.emf.twoD.FDTD2()
+            sch.fldpropB = pyrunko.emf.twoD.FDTD2()
+            sch.fintp    = pyrunko.pic.twoD.LinearInterpolator()
+            sch.pusher   = pyrunko.pic.twoD.HigueraCaryPusher()
+            sch.currint  = pyrunko.pic.twoD.ZigZag()
+            sch.fused    = pyrunko.pic.twoD.FusedHigueraCaryZigZag()
+            sch.antenna  = Antenna()
+
+            if conf.multipass_filter:
+                sch.flt = pyrunko.emf.twoD.MultiPassBinomial2(conf.NxMesh, conf.NyMesh, conf.NzMesh, conf.npasses)
+            else:
+                sch.flt = pyrunko.emf.twoD.Binomial2(conf.NxMesh, conf.NyMesh, conf.NzMesh)
+            return sch
+
+        for fused in [False, True]:
+            conf.fused_kernel     = fused
+            conf.fused_fields     = fused
+            conf.multipass_filter = fused
+
+            sch_ref = make_sch()
+            sch_tsk = make_sch()
+
+            tasks = pyrunko.pic.twoD.TaskScheduler(sch_tsk.grid)
+            turb.build_lap_tasks(tasks, sch_tsk, conf, sort=False)
+
+            tasks_sort = pyrunko.pic.twoD.TaskScheduler(sch_tsk.grid)
+            turb.build_lap_tasks(tasks_sort, sch_tsk, conf, sort=True)
+
+            for lap in range(1, 5):
+                turb.python_lap(sch_ref, sch_ref.grid, conf, lap)
+
+                sch_tsk.antenna.update_rnd_phases()
+                sch_tsk.run_tasks(tasks_sort if lap % conf.sort_interval == 0 else tasks)
+
+            for tile_ref, tile_tsk in zip(pytools.tiles_local(sch_ref.grid), pytools.tiles_local(sch_tsk.grid)):
+                for ispc in range(conf.Nspecies):
+                    con_ref = tile_ref.get_container(ispc)
+                    con_tsk = tile_tsk.get_container(ispc)
+                    self.assertEqual(con_tsk.size(), con_ref.size())
+
+                    for n in range(con_ref.size()):
+                        for v in range(6):
+                            self.assertAlmostEqual(con_tsk[n,v], con_ref[n,v], places=5)
+
+                gs_ref = tile_ref.get_grids(0)
+                gs_tsk = tile_tsk.get_grids(0)
+                for m in ['ex', 'ey', 'ez', 'bx', 'by', 'bz', 'jx', 'jy', 'jz']:
+                    for j in range(conf.NyMesh):
+                        for i in range(conf.NxMesh):
+                            self.assertAlmostEqual(getattr(gs_tsk, m)[i,j,0], getattr(gs_ref, m)[i,j,0], places=5)
+
+
+    # PSATD shares its fft buffers between tiles; the threaded TaskScheduler
+    # has to give the same fields as the tile by tile python loop
+    @unittest.skipIf(not hasattr(pyrunko.emf.twoD, "PSATD"), "built without fftw")
+    def test_task_scheduler_psatd(self):
+
+        conf = Conf()
+        conf.twoD = True
+        conf.Nx = 4
+        conf.Ny = 4
+        conf.NxMesh = 8
+        conf.NyMesh = 8
+        conf.update_bbox()
+
+        def make_grid():
+            np.random.seed(7)
+            grid = pycorgi.twoD.Grid(conf.Nx, conf.Ny, conf.Nz)
+            grid.set_grid_lims(conf.xmin, conf.xmax, conf.ymin, conf.ymax)
+            pytools.pic.load_tiles(grid, conf)
+            for tile in pytools.tiles_local(grid):
+                gs = tile.get_grids(0)
+                for m in ['ex', 'ey', 'ez', 'bx', 'by', 'bz']:
+                    for j in range(conf.NyMesh):
+                        for i in range(conf.NxMesh):
+                            getattr(gs, m)[i,j,0] = np.random.rand() - 0.5
+            return grid
+
+        grid_ref = make_grid()
+        grid_tsk = make_grid()
+        fld = pyrunko.emf.twoD.PSATD()
+
+        tasks = pyrunko.pic.twoD.TaskScheduler(grid_tsk)
+        tasks.add_tile_op('upd_bc', 'update_boundaries', 'local', [1,2])
+        tasks.add_solver('push_half_b', fld, 'push_half_b', 'local')
+        tasks.add_tile_op('upd_bc', 'update_boundaries', 'local', [2])
+        tasks.add_solver('push_e', fld, 'push_e', 'local')
+
+        for lap in range(3):
+            tasks.run()
+
+            for tile in pytools.tiles_local(grid_ref): tile.update_boundaries(grid_ref, [1,2])
+            for tile in pytools.tiles_local(grid_ref): fld.push_half_b(tile)
+            for tile in pytools.tiles_local(grid_ref): tile.update_boundaries(grid_ref, [2])
+            for tile in pytools.tiles_local(grid_ref): fld.push_e(tile)
+
+        for tile_ref, tile_tsk in zip(pytools.tiles_local(grid_ref), pytools.tiles_local(grid_tsk)):
+            gs_ref = tile_ref.get_grids(0)
+            gs_tsk = tile_tsk.get_grids(0)
+            for m in ['ex', 'ey', 'ez', 'bx', 'by', 'bz']:
+                for j in range(conf.NyMesh):
+                    for i in range(conf.NxMesh):
+                        self.assertEqual(getattr(gs_tsk, m)[i,j,0], getattr(gs_ref, m)[i,j,0])
+
+
+    def test_append_particles(self):
+
+        container = pyrunko.pic.threeD.ParticleContainer()
+        container.set_keygen_state(0, 0)
+
+        container.add_particle([0.5, 0.5, 0.5], [0.1, 0.2, 0.3], 1.0)
+
+        # bulk addition in chunks; values go to the end in order
+        N = 1000
+        xs = np.random.rand(N,3).astype(np.float32)
+        us = np.random.rand(N,3).astype(np.float32)
+        ws = np.random.rand(N).astype(np.float32)
+
+        for n0, n1 in [(0, 10), (10, 500), (500, N)]:
+            container.append_particles(
+                    xs[n0:n1,0], xs[n0:n1,1], xs[n0:n1,2],
+                    us[n0:n1,0], us[n0:n1,1], us[n0:n1,2],
+                    ws[n0:n1])
+
+        self.assertEqual(container.size(), N+1)
+
+        for i in range(3):
+            np.testing.assert_array_equal(container.loc(i)[1:], xs[:,i])
+            np.testing.assert_array_equal(container.vel(i)[1:], us[:,i])
+        np.testing.assert_array_equal(container.wgt()[1:], ws)
+
+        # new particles get unique keys from the same generator
+        ids = container.id(0)
+        self.assertEqual(len(set(ids)), N+1)
+
+        with self.assertRaises(ValueError):
+            container.append_particles(xs[:2,0], xs[:2,1], xs[:2,2], us[:2,0], us[:2,1], us[:2,2], ws[:1])
+
+
+    def test_particle_views(self):
+
+        container = pyrunko.pic.twoD.ParticleContainer()
+        container.set_keygen_state(0, 0)
+
+        N = 100
+        xs = np.random.rand(N,3).astype(np.float32)
+        us = np.random.rand(N,3).astype(np.float32)
+        ws = np.ones(N, dtype=np.float32)
+        container.append_particles(xs[:,0], xs[:,1], xs[:,2], us[:,0], us[:,1], us[:,2], ws)
+
+        # views share the memory of the container
+        for i in range(3):
+            np.testing.assert_array_equal(container.loc_view(i), xs[:,i])
+            np.testing.assert_array_equal(container.vel_view(i), us[:,i])
+        np.testing.assert_array_equal(container.wgt_view(), ws)
+        np.testing.assert_array_equal(container.id_view(0), container.id(0))
+
+        # read-only by default
+        with self.assertRaises(ValueError):
+            container.vel_view(0)[0] = 1.0
+
+        v = container.vel_view(0, writable=True)
+        v *= 2.0
+        np.testing.assert_allclose(container.vel(0), 2.0*us[:,0])
+
+        # locations only through set_loc; it invalidates the cell ordering
+        with self.assertRaises(ValueError):
+            container.loc_view(0)[0] = 1.0
+        with self.assertRaises(TypeError):
+            container.loc_view(0, writable=True)
+
+        container.sort_in_cells([1,1,1])
+        self.assertTrue(container.cells_sorted)
+
+        # bulk setters
+        container.set_loc(1, np.zeros(N))
+        self.assertEqual(np.sum(np.abs(container.loc_view(1))), 0.0)
+        self.assertFalse(container.cells_sorted)
+
+        container.set_wgt(0.5*ws)
+        np.testing.assert_array_equal(container.wgt(), 0.5*ws)
+
+        with self.assertRaises(ValueError):
+            container.set_vel(2, np.zeros(N+1))
+
+        # view keeps the container alive
+        view = container.loc_view(0)
+        del container
+        np.testing.assert_array_equal(view, xs[:,0])
+
+
+    # known-answer vectors of Philox4x32-10 from the Random123 distribution (kat_vectors)
+    def test_philox_kat(self):
+
+        kat = [
+            ([0x00000000, 0x00000000, 0x00000000, 0x00000000], [0x00000000, 0x00000000],
+             [0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8]),
+            ([0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff], [0xffffffff, 0xffffffff],
+             [0x408f276d, 0x41c83b0e, 0xa20bc7c6, 0x6d5451fd]),
+            ([0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344], [0xa4093822, 0x299f31d0],
+             [0xd16cfe09, 0x94fdcceb, 0x5001e420, 0x24126ea1]),
+            ]
+
+        for ctr, key, ref in kat:
+            self.assertEqual(list(pyrunko.pic.philox4x32(ctr, key)), ref)
+
+
+    def test_juttner_sampler(self):
+
+        N = 200000
+
+        # relativistic; <gamma> = 3 theta + K1(1/theta)/K2(1/theta)
+        ux, uy, uz = pyrunko.pic.sample_boosted_juttner(N, 1.0, seed=1)
+        gam = np.sqrt(1.0 + ux**2 + uy**2 + uz**2)
+        self.assertAlmostEqual(np.mean(gam), 3.3705, delta=0.02)
+
+        # cold plasma; <ux^2> = theta
+        ux, uy, uz = pyrunko.pic.sample_boosted_juttner(N, 0.01, seed=2)
+        self.assertAlmostEqual(np.mean(ux**2), 0.01, delta=2.0e-4)
+        self.assertAlmostEqual(np.mean(uz**2), 0.01, delta=2.0e-4)
+
+        # drift to -y; in-plane sampling
+        ux, uy, uz = pyrunko.pic.sample_boosted_juttner(N, 0.01, gamma=2.0, direction=-2, dims=2, seed=3)
+        self.assertLess(np.mean(uy), -1.7)
+        self.assertAlmostEqual(np.mean(ux), 0.0, delta=0.01)
+        self.assertEqual(np.max(np.abs(uz)), 0.0)
+
+        # same seed, same numbers
+        ux2, uy2, uz2 = pyrunko.pic.sample_boosted_juttner(N, 0.01, gamma=2.0, direction=-2, dims=2, seed=3)
+        np.testing.assert_array_equal(uy, uy2)
+
+
+    def test_bulk_injector(self):
+
+        conf = Conf()
+        conf.twoD = True
+        conf.Nx = 2
+        conf.Ny = 2
+        conf.NxMesh = 4
+        conf.NyMesh = 5
+        conf.Nspecies = 2
+        conf.update_bbox()
+
+        def make_grid():
+            grid = pycorgi.twoD.Grid(conf.Nx, conf.Ny, conf.Nz)
+            grid.set_grid_lims(conf.xmin, conf.xmax, conf.ymin, conf.ymax)
+            pytools.pic.load_tiles(grid, conf)
+
+            inj = pyrunko.pic.twoD.BulkInjector(seed=7)
+            inj.add_species(0, 2.5, 0.1)
+            inj.add_species(1, 2.5, 0.1, gamma=0.5)
+            inj.set_density(lambda x, y, z, ispc: 1.0 if x < conf.Nx*conf.NxMesh/2 else 0.0)
+            return grid, inj.inject(grid)
+
+        grid, added = make_grid()
+        grid2, added2 = make_grid()
+
+        # 2.5 ppc on average in the left half
+        ncells = conf.Nx*conf.NxMesh*conf.Ny*conf.NyMesh//2
+        self.assertEqual(added[0], added[1])
+        self.assertTrue(2.0*ncells <= added[0] <= 3.0*ncells)
+        self.assertEqual(added, added2)
+
+        for cid in grid.get_local_tiles():
+            tile  = grid.get_tile(cid)
+            tile2 = grid2.get_tile(cid)
+            c0 = tile.get_container(0)
+            c1 = tile.get_container(1)
+
+            # aligned species are on top of each other
+            for i in range(3):
+                np.testing.assert_array_equal(c0.loc_view(i), c1.loc_view(i))
+
+            # reproducible
+            for i in range(3):
+                np.testing.assert_array_equal(c1.vel_view(i), tile2.get_container(1).vel_view(i))
+
+            # inside the tile and the left half of the box
+            if c0.size() > 0:
+                xs = c0.loc_view(0)
+                ys = c0.loc_view(1)
+                self.assertTrue(np.all(xs < conf.Nx*conf.NxMesh/2))
+                self.assertTrue(np.all(ys >= conf.ymin) and np.all(ys < conf.ymax))
+
+            # drift of species 1 along +x
+            if c1.size() > 0:
+                self.assertGreater(np.mean(c1.vel_view(0)), 0.3)
+
+
+    def test_load_balance(self):
+
+        # weighted partition along the Hilbert curve; hot spot in one corner
+        nx, ny = 8, 8
+        costs = np.ones((nx, ny, 1))
+        costs[0:2, 0:2, 0] = 50.0
+        hind = pytools.hilbert_indices(nx, ny, 1)
+
+        comm_size = 4
+        owners = pytools.hilbert_partition(costs, hind, comm_size)
+        self.assertEqual(sorted(set(owners.flatten())), list(range(comm_size)))
+
+        # contiguous pieces of the curve
+        order = np.argsort(hind, axis=None)
+        self.assertTrue(np.all(np.diff(owners.flatten()[order]) >= 0))
+
+        # better than equal number of tiles per rank
+        equal = np.floor(comm_size*hind/(nx*ny)).astype(int)
+        self.assertLess(pytools.load_imbalance(costs, owners, comm_size), 
+                        pytools.load_imbalance(costs, equal, comm_size))
+
+        # particle counts of a grid
+        conf = Conf()
+        conf.twoD = True
+        conf.Nx = 4
+        conf.Ny = 4
+        conf.NxMesh = 4
+        conf.NyMesh = 4
+        conf.Nspecies = 2
+        conf.update_bbox()
+
+        grid = pycorgi.twoD.Grid(conf.Nx, conf.Ny, conf.Nz)
+        grid.set_grid_lims(conf.xmin, conf.xmax, conf.ymin, conf.ymax)
+        pytools.balance_mpi(grid, conf, do_print=False)
+        pytools.pic.load_tiles(grid, conf)
+
+        inj = pyrunko.pic.twoD.BulkInjector(seed=3)
+        inj.add_species(0, 2.0, 0.1)
+        inj.add_species(1, 2.0, 0.1)
+        inj.set_density(lambda x, y, z, ispc: 1.0 if x < conf.Nx*conf.NxMesh/2 else 0.1)
+        inj.inject(grid)
+
+        counts = pyrunko.pic.twoD.tile_particle_counts(grid)
+        for cid in grid.get_local_tiles():
+            tile = grid.get_tile(cid)
+            n = tile.get_container(0).size() + tile.get_container(1).size()
+            self.assertEqual(counts[cid], n)
+
+        # one rank has nothing to balance
+        if grid.size() == 1:
+            stats = pytools.pic.rebalance(grid, conf)
+            self.assertEqual(stats["moved"], 0)
+            self.assertAlmostEqual(stats["before"], 1.0)
+
+
     def test_test_particle_initialization(self):
 
         conf = Conf()
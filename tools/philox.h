@@ -0,0 +1,49 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+namespace toolbox {
+
+/*! \brief Philox4x32-10 counter-based random number generator
+ *
+ * Salmon et al. 2011, "Parallel random numbers: as easy as 1, 2, 3".
+ * Every call maps a 128-bit counter and a 64-bit key to four independent
+ * 32-bit random numbers; there is no state. Numbers are thus reproducible
+ * from their indices (e.g., tile, cell, particle) alone, independent of the
+ * order and the thread or rank in which they are drawn.
+ */
+struct Philox {
+
+  using Counter = std::array<uint32_t, 4>;
+  using Key     = std::array<uint32_t, 2>;
+
+  static inline Counter generate(Counter c, Key k)
+  {
+    constexpr uint32_t M0 = 0xD2511F53, M1 = 0xCD9E8D57;
+    constexpr uint32_t W0 = 0x9E3779B9, W1 = 0xBB67AE85;
+
+    for(int r=0; r<10; r++) {
+      if(r > 0) { k[0] += W0; k[1] += W1; }
+
+      const uint64_t p0 = static_cast<uint64_t>(M0)*c[0];
+      const uint64_t p1 = static_cast<uint64_t>(M1)*c[2];
+
+      c = {{
+        static_cast<uint32_t>(p1 >> 32) ^ c[1] ^ k[0],
+        static_cast<uint32_t>(p1),
+        static_cast<uint32_t>(p0 >> 32) ^ c[3] ^ k[1],
+        static_cast<uint32_t>(p0)
+      }};
+    }
+    return c;
+  }
+
+  /// uniform float in [0,1)
+  static inline float uniform(uint32_t x) { return (x >> 8)*(1.0f/16777216.0f); }
+
+  /// uniform float in (0,1]; safe for logarithms
+  static inline float uniform_pos(uint32_t x) { return ((x >> 8) + 1)*(1.0f/16777216.0f); }
+};
+
+} // end of namespace toolbox
@@ -0,0 +1,181 @@
+#pragma once
+
+#include <mpi.h>
+#include <cstddef>
+#include <vector>
+
+namespace toolbox {
+
+/*! \brief Node-local MPI-3 shared memory window for on-node tile exchange
+ *
+ * Every rank owns one segment of a window allocated with
+ * MPI_Win_allocate_shared over the ranks of its node. When a tile sends to a
+ * rank on the same node, the payload is packed straight into the sender's
+ * segment and only its location (offset and length in 4-byte words) goes
+ * through MPI; the receiver reads the payload from the sender's memory.
+ *
+ * Exchange phases are separated with begin_phase(), a node barrier after
+ * which the segments are reused. Data of a phase thus stays valid until its
+ * owner allocates again after the next begin_phase() on the node.
+ *
+ * Writes are published with sync() (MPI_Win_sync) before the location
+ * message is sent and the receiver calls sync() before reading.
+ *
+ * allocate() returns nullptr when the segment is full; callers either fall
+ * back to plain MPI messages (particles) or size the window at setup so
+ * that this cannot happen (packed halos, see emf::Tile::shm_halo_words).
+ */
+class ShmWindow
+{
+  MPI_Comm node_comm = MPI_COMM_NULL;
+  MPI_Win win = MPI_WIN_NULL;
+
+  int my_rank = -1;
+
+  /// node-local rank of every world rank; -1 for ranks on other nodes
+  std::vector<int> node_rank;
+
+  /// segment base address of every node-local rank
+  std::vector<float*> segments;
+
+  size_t capacity = 0; // words per rank
+  size_t used = 0;     // words used in the current phase
+  size_t nphase = 0;   // phases started so far
+
+  ShmWindow() = default;
+
+  public:
+
+  ShmWindow(const ShmWindow&) = delete;
+  ShmWindow& operator=(const ShmWindow&) = delete;
+
+  /// window of this rank
+  static ShmWindow& get()
+  {
+    static ShmWindow shm;
+    return shm;
+  }
+
+  /// allocate bytes_per_rank of shared memory on every rank; collective over MPI_COMM_WORLD
+  void init(size_t bytes_per_rank)
+  {
+    if(active()) free();
+
+    MPI_Comm_rank(MPI_COMM_WORLD, &my_rank);
+    MPI_Comm_split_type(MPI_COMM_WORLD, MPI_COMM_TYPE_SHARED, 0, MPI_INFO_NULL, &node_comm);
+
+    // world rank -> node rank
+    int nworld, nnode;
+    MPI_Comm_size(MPI_COMM_WORLD, &nworld);
+    MPI_Comm_size(node_comm, &nnode);
+
+    MPI_Group gworld, gnode;
+    MPI_Comm_group(MPI_COMM_WORLD, &gworld);
+    MPI_Comm_group(node_comm, &gnode);
+
+    std::vector<int> wranks(nworld);
+    for(int r=0; r<nworld; r++) wranks[r] = r;
+    node_rank.assign(nworld, MPI_UNDEFINED);
+    MPI_Group_translate_ranks(gworld, nworld, wranks.data(), gnode, node_rank.data());
+    for(auto& r : node_rank) if(r == MPI_UNDEFINED) r = -1;
+
+    MPI_Group_free(&gworld);
+    MPI_Group_free(&gnode);
+
+    // segments of different ranks need not be contiguous; lets MPI place them on the owner's NUMA node
+    MPI_Info info;
+    MPI_Info_create(&info);
+    MPI_Info_set(info, "alloc_shared_noncontig", "true");
+
+    capacity = bytes_per_rank/sizeof(float);
+    float* base = nullptr;
+    MPI_Win_allocate_shared(capacity*sizeof(float), sizeof(float), info, node_comm, &base, &win);
+    MPI_Info_free(&info);
+
+    segments.assign(nnode, nullptr);
+    for(int r=0; r<nnode; r++) {
+      MPI_Aint size;
+      int disp_unit;
+      MPI_Win_shared_query(win, r, &size, &disp_unit, &segments[r]);
+    }
+
+    // one passive epoch for the whole run; needed for MPI_Win_sync
+    MPI_Win_lock_all(MPI_MODE_NOCHECK, win);
+    used = 0;
+  }
+
+  /// release the window; collective over the node
+  void free()
+  {
+    if(!active()) return;
+
+    MPI_Win_unlock_all(win);
+    MPI_Win_free(&win);
+    MPI_Comm_free(&node_comm);
+
+    win = MPI_WIN_NULL;
+    node_comm = MPI_COMM_NULL;
+    segments.clear();
+    node_rank.clear();
+    capacity = 0;
+    used = 0;
+  }
+
+  bool active() const { return win != MPI_WIN_NULL; }
+
+  /// rank is another rank on this node
+  bool on_node(int rank) const
+  {
+    return active() && rank != my_rank && node_rank[rank] >= 0;
+  }
+
+  /// start a new exchange phase; waits until all ranks of the node are done
+  // with the previous one and reuses the own segment
+  void begin_phase()
+  {
+    if(!active()) return;
+
+    MPI_Win_sync(win);
+    MPI_Barrier(node_comm);
+    used = 0;
+    nphase++;
+  }
+
+  /// memory barrier between own writes / other ranks' reads of the window
+  void sync()
+  {
+    if(active()) MPI_Win_sync(win);
+  }
+
+  /// reserve words in the own segment for this phase; offset is sent to the receiver.
+  // Returns nullptr (and offset -1) if the segment does not have room left.
+  float* allocate(size_t words, int& offset)
+  {
+    if(!active() || used + words > capacity) {
+      offset = -1;
+      return nullptr;
+    }
+
+    offset = static_cast<int>(used);
+    float* ptr = segments[node_rank[my_rank]] + used;
+    used += words;
+    return ptr;
+  }
+
+  /// payload at offset in the segment of rank
+  const float* remote(int rank, int offset) const
+  {
+    return segments[node_rank[rank]] + offset;
+  }
+
+  /// words used in this phase
+  size_t in_use() const { return used; }
+
+  /// size of the own segment in bytes
+  size_t capacity_bytes() const { return capacity*sizeof(float); }
+
+  /// running number of the current phase
+  size_t phase() const { return nphase; }
+};
+
+} // end of namespace toolbox
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <cstddef>
+
+namespace toolbox {
+namespace simd {
+
+/*! \brief Minimal portable SIMD helpers
+ *
+ * Kernels are written as loops over a fixed number of lanes W
+ * (`#pragma omp simd simdlen(W)`) on Lanes<T,W> blocks; with W matching the
+ * register width the compiler emits one vector instruction per operation.
+ * The last, partial block is handled with masked loads and stores.
+ *
+ * The same kernel is compiled several times with the target attributes
+ * below and the fastest supported one is picked at run time with isa().
+ */
+
+
+/// instruction sets with their own kernel versions
+enum class Isa { generic, avx2, avx512 };
+
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define TOOLBOX_SIMD_DISPATCH 1
+#define TOOLBOX_TARGET_AVX2   __attribute__((target("avx2,fma"), flatten))
+#define TOOLBOX_TARGET_AVX512 __attribute__((target("avx512f,avx512vl,avx512dq,avx2,fma"), flatten))
+#else
+#define TOOLBOX_SIMD_DISPATCH 0
+#define TOOLBOX_TARGET_AVX2
+#define TOOLBOX_TARGET_AVX512
+#endif
+
+
+/// best instruction set of this cpu; checked once
+inline Isa isa()
+{
+#if TOOLBOX_SIMD_DISPATCH
+  static const Isa best =
+    __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512vl") && __builtin_cpu_supports("avx512dq") ? Isa::avx512 :
+    __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma") ? Isa::avx2 :
+    Isa::generic;
+  return best;
+#else
+  return Isa::generic;
+#endif
+}
+
+
+/// block of W lanes
+template<typename T, size_t W>
+struct Lanes {
+  alignas(sizeof(T)*W) T v[W];
+
+  inline T& operator[](size_t l) { return v[l]; }
+  inline const T& operator[](size_t l) const { return v[l]; }
+
+  /// load W values
+  inline void load(const T* p)
+  {
+    #pragma omp simd simdlen(W)
+    for(size_t l=0; l<W; l++) v[l] = p[l];
+  }
+
+  /// masked load; only the first n lanes are read and the rest set to fill
+  inline void load(const T* p, size_t n, T fill = T(0))
+  {
+    #pragma omp simd simdlen(W)
+    for(size_t l=0; l<W; l++) v[l] = l < n ? p[l] : fill;
+  }
+
+  /// store W values
+  inline void store(T* p) const
+  {
+    #pragma omp simd simdlen(W)
+    for(size_t l=0; l<W; l++) p[l] = v[l];
+  }
+
+  /// masked store of the first n lanes
+  inline void store(T* p, size_t n) const
+  {
+    for(size_t l=0; l<n; l++) p[l] = v[l];
+  }
+};
+
+
+} // end of namespace simd
+} // end of namespace toolbox